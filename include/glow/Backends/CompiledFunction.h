@@ -16,16 +16,45 @@
 #ifndef GLOW_BACKENDS_COMPILEDFUNCTION_H
 #define GLOW_BACKENDS_COMPILEDFUNCTION_H
 
+#include "glow/CodeGen/MemoryFootprint.h"
+
+#include <memory>
+
 namespace glow {
 
+class ExecutionContext;
+
 /// Interface for executing a compiled function.
 class CompiledFunction {
 public:
   /// Dtor.
   virtual ~CompiledFunction() = default;
 
-  /// Execute the network.
+  /// Execute the network with the default context. The inputs and outputs of
+  /// the network are the payloads of the public variables, unless other
+  /// tensors are bound to them in the default context.
   virtual void execute() = 0;
+
+  /// \returns the context that is used by execute(). Its tensors are the
+  /// payloads of the public variables.
+  virtual ExecutionContext &getDefaultContext() = 0;
+
+  /// \returns a new context for executing the network. The context has a
+  /// tensor for every public variable, that is initialized with the payload of
+  /// the variable.
+  virtual std::unique_ptr<ExecutionContext> createExecutionContext() = 0;
+
+  /// Execute the network with the tensors and the state of \p ctx, which must
+  /// be the default context or have been created by this function. Executions
+  /// with different contexts may run concurrently, as long as they don't
+  /// modify the private variables (i.e. the function was compiled for
+  /// inference).
+  virtual void execute(ExecutionContext &ctx) = 0;
+
+  /// \returns the memory that the function uses: the sizes of the weights,
+  /// of the activations and of the scratch memory, where every buffer is
+  /// placed, and which buffers are alive when the memory usage peaks.
+  virtual MemoryFootprint getMemoryFootprint() const = 0;
 };
 
 } // end namespace glow
@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_BACKENDS_EXECUTIONCONTEXT_H
+#define GLOW_BACKENDS_EXECUTIONCONTEXT_H
+
+#include "glow/Base/Tensor.h"
+#include "glow/Graph/Nodes.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace glow {
+
+class CompiledFunction;
+
+/// The state of the executions of a compiled function that is private to a
+/// single caller. The context holds the tensors that are used in place of the
+/// payloads of the public variables (i.e. the inputs and outputs of the
+/// function), and backends derive from it to keep their own per-execution
+/// state, e.g. the memory for the activations. Executions with different
+/// contexts share the code and the private variables of the function.
+/// A context may only be executed by the function that created it.
+class ExecutionContext {
+  /// The function that created the context.
+  const CompiledFunction *owner_{nullptr};
+  /// Maps the public variables to the tensors that hold their values.
+  std::unordered_map<const Variable *, Tensor *> tensors_;
+  /// The tensors that are owned by the context.
+  std::vector<std::unique_ptr<Tensor>> ownedTensors_;
+
+public:
+  ExecutionContext() = default;
+
+  ExecutionContext(const ExecutionContext &) = delete;
+  ExecutionContext &operator=(const ExecutionContext &) = delete;
+
+  /// Dtor.
+  virtual ~ExecutionContext() = default;
+
+  /// Allocate a tensor for the variable \p v that is initialized with the
+  /// payload of \p v. \returns the new tensor.
+  Tensor *allocate(const Variable *v) {
+    assert(!tensors_.count(v) && "The variable already has a tensor");
+    ownedTensors_.emplace_back(new Tensor(v->getPayload().clone()));
+    bind(v, ownedTensors_.back().get());
+    return ownedTensors_.back().get();
+  }
+
+  /// Use the tensor \p T, which is owned by the caller, to hold the value of
+  /// the variable \p v in this context. Nothing is copied: the executions
+  /// read and write \p T directly until another tensor is bound to \p v. If
+  /// \p T is null then \p v is unbound.
+  /// \returns the tensor that was previously bound to \p v, or null.
+  Tensor *bind(const Variable *v, Tensor *T) {
+    assert(!v->isPrivate() && "Private variables are shared by all contexts");
+    if (!T) {
+      auto it = tensors_.find(v);
+      if (it == tensors_.end()) {
+        return nullptr;
+      }
+      auto *prev = it->second;
+      tensors_.erase(it);
+      return prev;
+    }
+    assert(T->getType().isEqual(*v->getType()) &&
+           "The tensor does not match the type of the variable");
+    auto &bound = tensors_[v];
+    auto *prev = bound;
+    bound = T;
+    return prev;
+  }
+
+  /// \returns the tensor that holds the value of \p v in this context.
+  Tensor *getTensor(const Variable *v) const {
+    auto it = tensors_.find(v);
+    assert(it != tensors_.end() && "The variable has no tensor");
+    return it->second;
+  }
+
+  /// \returns true if \p v has a tensor in this context.
+  bool hasTensor(const Variable *v) const { return tensors_.count(v); }
+
+  /// Set the function that created the context to \p F.
+  void setOwner(const CompiledFunction *F) { owner_ = F; }
+
+  /// \returns the function that created the context.
+  const CompiledFunction *getOwner() const { return owner_; }
+};
+
+} // end namespace glow
+
+#endif // GLOW_BACKENDS_EXECUTIONCONTEXT_H
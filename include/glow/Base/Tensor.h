@@ -326,6 +326,20 @@ public:
               &t->getData()[bufferSize * (slice + 1)], getData());
   }
 
+  /// Update the slice \p slice of the tensor with the content of the tensor
+  /// \p t. This is the inverse of copySlice.
+  void copyToSlice(const Tensor *t, size_t slice) {
+    auto dim = dims().slice(1);
+    (void)dim;
+    assert(dim == t->dims() && "Invalid slice size");
+    assert(getElementType() == t->getElementType() && "Invalid element type");
+    assert(slice < dims()[0] && "Invalid slice index");
+
+    size_t bufferSize = t->size() * type_.getElementSize();
+    std::copy(&t->getData()[0], &t->getData()[bufferSize],
+              &getData()[bufferSize * slice]);
+  }
+
   /// Update the content of the tensor with a sequence of slices from the
   /// tensor \p t. A slice is one index from the first dimension of the tensor.
   /// The copying operation may overlap the end of the tensor \p t one or more
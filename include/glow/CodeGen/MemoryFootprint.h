@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_CODEGEN_MEMORYFOOTPRINT_H
+#define GLOW_CODEGEN_MEMORYFOOTPRINT_H
+
+#include "llvm/ADT/STLExtras.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace glow {
+
+class IRFunction;
+class Value;
+
+/// Describes the memory that a compiled function uses. The constant weights
+/// (the private variables) are shared by all of the execution contexts of the
+/// function, while every context has its own copy of the mutable weights (the
+/// public variables) and of the activations.
+struct MemoryFootprint {
+  /// The kinds of buffers.
+  enum class BufferKind { ConstantWeight, MutableWeight, Activation };
+
+  /// A buffer that holds a weight or an activation.
+  struct Buffer {
+    /// The name of the value.
+    std::string name;
+    /// The kind of the buffer.
+    BufferKind kind;
+    /// The offset of the buffer in the block of memory that holds it, or
+    /// noOffset if the backend does not place the buffer into such a block.
+    size_t offset;
+    /// The size of the buffer, in bytes.
+    size_t size;
+    /// Set for the activations that no instruction reads as an input, i.e.
+    /// that the instructions only use as scratch memory.
+    bool isScratch;
+  };
+
+  /// A reserved value for the buffers that have no offset.
+  static const size_t noOffset;
+
+  /// The bytes of the constant weights.
+  size_t constantWeightBytes{0};
+  /// The bytes of the mutable weights, per context.
+  size_t mutableWeightBytes{0};
+  /// The bytes that are reserved for the activations, per context. This may
+  /// be more than peakLiveBytes because of the fragmentation of the memory.
+  size_t activationBytes{0};
+  /// The bytes of the scratch activations (see Buffer::isScratch).
+  size_t scratchBytes{0};
+  /// The largest number of bytes of activations that are alive at the same
+  /// time during an execution.
+  size_t peakLiveBytes{0};
+  /// The names of the activations that are alive at the peak.
+  std::vector<std::string> peakLiveBuffers;
+  /// The weights of the IR, followed by the activations in the order in which
+  /// they are allocated.
+  std::vector<Buffer> buffers;
+
+  /// \returns the bytes that every additional execution context needs.
+  size_t getContextBytes() const {
+    return mutableWeightBytes + activationBytes;
+  }
+
+  /// \returns the bytes of the function with a single execution context.
+  size_t getTotalBytes() const {
+    return constantWeightBytes + getContextBytes();
+  }
+
+  /// Dump a textual representation of the footprint into \p os.
+  void dump(llvm::raw_ostream &os) const;
+
+  /// Dump a textual representation of the footprint into llvm::outs().
+  void dump() const;
+};
+
+/// \returns the memory footprint of \p F that follows from its IR. The
+/// activations are assumed to take exactly the memory of the live ones, i.e.
+/// activationBytes is peakLiveBytes. If \p getOffset is given, then it
+/// provides the offsets of the buffers, and MemoryFootprint::noOffset
+/// otherwise. Backends that lay out the buffers in memory adjust the sizes of
+/// the blocks afterwards.
+MemoryFootprint computeMemoryFootprint(
+    const IRFunction *F,
+    llvm::function_ref<size_t(const Value *)> getOffset = nullptr);
+
+} // namespace glow
+
+#endif // GLOW_CODEGEN_MEMORYFOOTPRINT_H
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_EXECUTIONENGINE_BATCHBUCKETS_H
+#define GLOW_EXECUTIONENGINE_BATCHBUCKETS_H
+
+#include "glow/Base/Tensor.h"
+#include "glow/Optimizer/Optimizer.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <memory>
+#include <vector>
+
+namespace glow {
+
+class ExecutionEngine;
+class Function;
+class Variable;
+
+/// Compiles a function for a set of batch sizes (buckets) and runs every
+/// batch with the smallest bucket that fits it. The functions of the buckets
+/// are clones of the original function that share its private variables, so
+/// the weights are stored once. A batch that is smaller than its bucket is
+/// padded by repeating its samples, and a batch that is larger than the
+/// largest bucket is split into chunks.
+class BatchBuckets final {
+  /// A function that is compiled for one batch size.
+  struct Bucket {
+    /// The batch size.
+    size_t batchSize;
+    /// The function of the bucket.
+    Function *F;
+    /// The batched input and output variables of F.
+    std::vector<Variable *> inputs;
+    std::vector<Variable *> outputs;
+    /// The tensors that hold the batches that don't fill the bucket.
+    std::vector<std::unique_ptr<Tensor>> inputStaging;
+    std::vector<std::unique_ptr<Tensor>> outputStaging;
+  };
+
+  /// The engine that compiles and runs the functions.
+  ExecutionEngine &EE_;
+  /// The buckets, sorted by the batch size.
+  std::vector<Bucket> buckets_;
+
+  /// Run \p bucket with the samples [\p offset, \p offset + \p count) of the
+  /// tensors \p inputs and \p outputs.
+  void runChunk(Bucket &bucket, llvm::ArrayRef<Tensor *> inputs,
+                llvm::ArrayRef<Tensor *> outputs, size_t offset, size_t count);
+
+public:
+  /// Compile the function \p F in mode \p mode for every batch size in
+  /// \p batchSizes. The batch size of \p F is the first dimension of its
+  /// public variables \p inputs, and \p outputs are the public variables that
+  /// hold its results. The batch sizes that \p F can't be cloned with, see
+  /// Function::cloneWithBatchSize(), are skipped, and at least one batch size
+  /// must be left.
+  BatchBuckets(ExecutionEngine &EE, CompilationMode mode, Function *F,
+               llvm::ArrayRef<Variable *> inputs,
+               llvm::ArrayRef<Variable *> outputs,
+               llvm::ArrayRef<size_t> batchSizes);
+
+  /// \returns the batch size of the bucket that runs \p numSamples samples,
+  /// which is the largest bucket if none of the buckets fits.
+  size_t getBucketSize(size_t numSamples) const;
+
+  /// Run the batch \p inputs, which have one tensor for every input variable
+  /// and any number of samples in the first dimension, and write the results
+  /// to \p outputs. A batch that has the size of a bucket is run without
+  /// copying. This makes the function of the bucket the active function of
+  /// the engine.
+  void run(llvm::ArrayRef<Tensor *> inputs, llvm::ArrayRef<Tensor *> outputs);
+};
+
+} // namespace glow
+
+#endif // GLOW_EXECUTIONENGINE_BATCHBUCKETS_H
@@ -18,13 +18,19 @@
 
 #include "glow/Backends/Backend.h"
 #include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/ExecutionContext.h"
 #include "glow/Base/Train.h"
 #include "glow/Base/Traits.h"
+#include "glow/ExecutionEngine/RequestQueue.h"
+#include "glow/ExecutionEngine/TieredFunction.h"
 #include "glow/Graph/Graph.h"
 #include "glow/Optimizer/Optimizer.h"
+#include "glow/Support/ThreadPool.h"
 
 #include "llvm/ADT/ArrayRef.h"
 
+#include <functional>
+#include <future>
 #include <memory>
 #include <unordered_map>
 
@@ -39,11 +45,29 @@ class ExecutionEngine final {
   Module M_;
   /// The network execution backend.
   std::unique_ptr<Backend> backend_;
-  /// A glow function compiled for this ExecutionEngine's backend.
-  std::unique_ptr<CompiledFunction> function_;
-
-  /// Optimize the graph, generate IR, and optimize the IR.
-  std::unique_ptr<IRFunction> generateIR(CompilationMode mode, Function *F);
+  /// The glow functions compiled for this ExecutionEngine's backend, keyed by
+  /// the functions of the module. They share the variables of the module.
+  std::unordered_map<const Function *, std::unique_ptr<CompiledFunction>>
+      compiledFunctions_;
+  /// The compiled function that is used by the run methods.
+  CompiledFunction *function_{nullptr};
+  /// The workers that perform the asynchronous runs of function_. It is
+  /// declared after the compiled functions so that the workers are stopped
+  /// first.
+  std::unique_ptr<RequestQueue> queue_;
+  /// The helper thread that stages the minibatches of runBatch. It is created
+  /// by the first run of several iterations and kept for the next ones.
+  std::unique_ptr<ThreadPool> stager_;
+
+  /// Optimize the graph, generate IR, and optimize the IR for the backend
+  /// \p backend.
+  std::unique_ptr<IRFunction> generateIR(CompilationMode mode, Function *F,
+                                         const Backend &backend);
+
+  /// Keep \p compiled as the compiled function of \p F and make it the
+  /// active function.
+  void setCompiledFunction(const Function *F,
+                           std::unique_ptr<CompiledFunction> compiled);
 
 public:
   ExecutionEngine(BackendKind backendKind = BackendKind::Interpreter);
@@ -64,20 +88,123 @@ public:
 
   /// Optimize the graph, generate IR, optimize IR and compile it for a
   /// specific target. This method should be invoked before the run method.
+  /// The compiled function is kept by the engine, replacing the previous
+  /// compilation of \p F, and becomes the active function.
   void compile(CompilationMode mode, Function *F);
 
+  /// Compile \p F like compile(), but in two tiers. \p F is compiled for the
+  /// interpreter first, which takes very little time, and can be run right
+  /// away. At the same time, the backend of the engine compiles \p F on a
+  /// background thread, and the runs switch to its code once it is ready. The
+  /// interpreter compiles a copy of \p F that is added to the module, because
+  /// the graph is lowered differently for every backend. The module must not
+  /// be modified until the final tier is ready. \returns the compiled
+  /// function, which is owned by the engine.
+  TieredFunction &compileTiered(CompilationMode mode, Function *F);
+
+  /// \returns true if \p F has been compiled by this engine.
+  bool isCompiled(const Function *F) const {
+    return compiledFunctions_.count(F);
+  }
+
+  /// Make the compiled function of \p F, which must have been compiled
+  /// before, the function that is used by the run methods. No code is
+  /// generated. The execution contexts, the workers and the batchers belong to
+  /// the function that was active when they were created, and switching to
+  /// another function stops the workers.
+  void setActiveFunction(const Function *F);
+
+  /// \returns the memory footprint of the compiled function of \p F, which
+  /// must have been compiled before. See CompiledFunction::getMemoryFootprint.
+  MemoryFootprint getMemoryFootprint(const Function *F) const;
+
+  /// Release the compiled function of \p F. If it is the active function
+  /// then there is no active function afterwards.
+  void eraseCompiledFunction(const Function *F);
+
   /// Save a bundle for a standalone execution. This method takes care of
   /// everything when preparing the bundle for saving. There is no need to
   /// invoke the compile method before it.
   void save(CompilationMode mode, Function *F, llvm::StringRef outputDir);
 
   /// Runs the program in a forward pass. Update the nodes in \p nodes with the
-  /// values \p inputs.
+  /// values \p inputs. This runs the active function.
   void run(llvm::ArrayRef<Variable *> vars, llvm::ArrayRef<Tensor *> inputs);
 
+  /// \returns a new context for running the compiled function. The context
+  /// has its own copy of the public variables and of the activations, so runs
+  /// with different contexts may be performed from different threads at the
+  /// same time. They share the code and the private variables.
+  std::unique_ptr<ExecutionContext> createExecutionContext();
+
+  /// Runs the program in a forward pass with the context \p ctx. Update the
+  /// tensors of the variables \p vars in \p ctx with the values \p inputs.
+  /// The results can be read from the tensors of the output variables in
+  /// \p ctx.
+  void run(ExecutionContext &ctx, llvm::ArrayRef<Variable *> vars,
+           llvm::ArrayRef<Tensor *> inputs);
+
+  /// Runs the program in a forward pass, using the tensors \p tensors, which
+  /// are owned by the caller, as the values of the public variables \p vars.
+  /// Nothing is copied: the inputs are read from and the outputs are written
+  /// directly into the bound tensors, and the payloads of \p vars are not
+  /// modified. The previous bindings are restored when the run is done.
+  void runWithBindings(llvm::ArrayRef<Variable *> vars,
+                       llvm::ArrayRef<Tensor *> tensors);
+
+  /// Runs the program in a forward pass with the context \p ctx, using the
+  /// tensors \p tensors as the values of the public variables \p vars for
+  /// this run only. See runWithBindings() above.
+  void runWithBindings(ExecutionContext &ctx, llvm::ArrayRef<Variable *> vars,
+                       llvm::ArrayRef<Tensor *> tensors);
+
+  /// Execute \p function with its context \p ctx, using the tensors
+  /// \p tensors as the values of the public variables \p vars for this run
+  /// only. This is the same as runWithBindings(), except that it runs
+  /// \p function instead of the active function.
+  static void executeWithBindings(CompiledFunction &function,
+                                  ExecutionContext &ctx,
+                                  llvm::ArrayRef<Variable *> vars,
+                                  llvm::ArrayRef<Tensor *> tensors);
+
+  /// \returns the compiled function that is used by the run methods.
+  CompiledFunction &getActiveFunction() {
+    assert(function_ && "No function has been compiled");
+    return *function_;
+  }
+
+  /// Start \p numWorkers threads that perform the asynchronous runs of the
+  /// compiled function, each with its own execution context. At most
+  /// \p queueCapacity runs may wait for a worker, and runAsync() blocks when
+  /// the queue is full. The previous workers, if any, are stopped first.
+  /// Compiling a new function stops the workers.
+  void startWorkers(unsigned numWorkers, size_t queueCapacity);
+
+  /// Finish all of the asynchronous runs and stop the workers.
+  void stopWorkers();
+
+  /// Enqueue a run of the program in a forward pass, with the tensors
+  /// \p tensors bound to the public variables \p vars as in
+  /// runWithBindings(). \p done is invoked on the worker thread once the
+  /// outputs have been written. The tensors must stay alive until then. The
+  /// runs may finish in any order, and must not modify the private variables
+  /// (i.e. the function must be compiled for inference).
+  void runAsync(llvm::ArrayRef<Variable *> vars,
+                llvm::ArrayRef<Tensor *> tensors, std::function<void()> done);
+
+  /// Enqueue a run of the program like the method above. \returns a future
+  /// that becomes ready once the outputs have been written.
+  std::future<void> runAsync(llvm::ArrayRef<Variable *> vars,
+                             llvm::ArrayRef<Tensor *> tensors);
+
+  /// Block until all of the asynchronous runs have finished.
+  void waitForAsyncRuns();
+
   /// Train the network. Perform \p iterations in the training loop. Each
   /// iteration does a full forward and backward pass of a whole batch.
   /// The method updates the variables in \p vars with the tensors \p inputs.
+  /// When there are several iterations, the next minibatch is copied by a
+  /// helper thread while the current one runs.
   void runBatch(size_t iterations, llvm::ArrayRef<Variable *> vars,
                 llvm::ArrayRef<Tensor *> inputs);
 
@@ -94,6 +221,11 @@ private:
   /// dimension must be identical.
   void loadValueFromTensorSlice(Variable *v, Tensor *input, size_t sampleIdx);
 
+  /// Update the content of the tensor \p t with some slices from \p input,
+  /// like the method above.
+  static void loadValueFromTensorSlice(Tensor &t, Tensor *input,
+                                       size_t sampleIdx);
+
   // Update the content of the tensor \p v with \p input.
   void loadValueFromTensor(Variable *v, Tensor *input);
 };
@@ -0,0 +1,134 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_EXECUTIONENGINE_REQUESTBATCHER_H
+#define GLOW_EXECUTIONENGINE_REQUESTBATCHER_H
+
+#include "glow/Backends/ExecutionContext.h"
+#include "glow/Base/Tensor.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace glow {
+
+class CompiledFunction;
+class ExecutionEngine;
+class Variable;
+
+/// Collects requests for single samples into batches for a function that is
+/// compiled with a fixed batch size (the first dimension of its inputs). A
+/// dispatcher thread waits until enough requests arrive or until the oldest
+/// request has waited for the latency budget, copies the samples into the
+/// slices of the batched inputs, runs the function once, and copies the
+/// slices of the batched outputs back to the requests.
+class RequestBatcher final {
+public:
+  /// The configuration of the batcher.
+  struct Config {
+    /// The maximum number of requests in a batch. Zero means the batch size
+    /// of the compiled function, which is also the upper bound.
+    size_t maxBatchSize{0};
+    /// The longest time that the first request of a batch waits for other
+    /// requests before the batch is run.
+    std::chrono::microseconds maxDelay{std::chrono::microseconds(500)};
+    /// Zero the slices of the inputs that are not used by any request. When
+    /// this is not set the padding slices keep the samples of the previous
+    /// batch, which is cheaper and works for networks whose samples do not
+    /// affect each other.
+    bool zeroPadding{true};
+  };
+
+private:
+  /// A request for a single sample.
+  struct Request {
+    /// The input samples, one for each input variable.
+    std::vector<const Tensor *> inputs;
+    /// The output samples, one for each output variable.
+    std::vector<Tensor *> outputs;
+    /// Fulfilled when the outputs have been written.
+    std::promise<void> done;
+    /// The time when the request was enqueued.
+    std::chrono::steady_clock::time_point enqueued;
+  };
+
+  /// The function that runs the batches.
+  CompiledFunction &function_;
+  /// The batched input and output variables.
+  std::vector<Variable *> inputVars_;
+  std::vector<Variable *> outputVars_;
+  /// The configuration.
+  Config config_;
+  /// The context of the runs of the batches, which belongs to function_.
+  std::unique_ptr<ExecutionContext> ctx_;
+  /// The batched tensors that are bound to inputVars_ and outputVars_.
+  std::vector<std::unique_ptr<Tensor>> inputBatch_;
+  std::vector<std::unique_ptr<Tensor>> outputBatch_;
+  /// The requests that have not been assigned to a batch yet.
+  std::deque<Request> pending_;
+  /// Protects pending_ and stop_.
+  std::mutex mutex_;
+  /// Signalled when a request arrives or when the batcher is destroyed.
+  std::condition_variable cv_;
+  /// Set when the batcher is destroyed. The dispatcher exits once all of the
+  /// requests are done.
+  bool stop_{false};
+  /// The dispatcher thread.
+  std::thread dispatcher_;
+
+  /// The body of the dispatcher thread.
+  void dispatcherLoop();
+
+  /// Run the requests \p batch as a single batch.
+  void runBatch(std::vector<Request> &batch);
+
+public:
+  /// Create a batcher that runs the active function of \p EE. \p inputVars
+  /// and \p outputVars are the batched public variables of the function whose
+  /// slices are the samples of the requests. The batcher keeps running this
+  /// function when another function becomes active in \p EE, but the function
+  /// must not be recompiled or erased while the batcher is alive.
+  RequestBatcher(ExecutionEngine &EE, llvm::ArrayRef<Variable *> inputVars,
+                 llvm::ArrayRef<Variable *> outputVars, const Config &config);
+
+  /// Finish all of the requests and stop the dispatcher.
+  ~RequestBatcher();
+
+  RequestBatcher(const RequestBatcher &) = delete;
+  RequestBatcher &operator=(const RequestBatcher &) = delete;
+
+  /// Enqueue a request for a single sample. \p inputs and \p outputs have one
+  /// tensor for every input and output variable, with the shape of a slice of
+  /// the variable (i.e. without the batch dimension). \returns a future that
+  /// becomes ready once the outputs have been written. The tensors must stay
+  /// alive until then.
+  std::future<void> enqueue(llvm::ArrayRef<const Tensor *> inputs,
+                            llvm::ArrayRef<Tensor *> outputs);
+
+  /// \returns the largest number of requests in a batch.
+  size_t getMaxBatchSize() const { return config_.maxBatchSize; }
+};
+
+} // namespace glow
+
+#endif // GLOW_EXECUTIONENGINE_REQUESTBATCHER_H
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_EXECUTIONENGINE_REQUESTQUEUE_H
+#define GLOW_EXECUTIONENGINE_REQUESTQUEUE_H
+
+#include "glow/Backends/ExecutionContext.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace glow {
+
+/// A bounded queue of requests that are processed by a fixed set of worker
+/// threads. Every worker owns an execution context of a compiled function and
+/// passes it to the requests that it processes, so the requests run
+/// concurrently without sharing any mutable state. Submitting a request
+/// blocks while the queue is full, which throttles the producers when they
+/// are faster than the workers.
+class RequestQueue final {
+public:
+  /// A request is a callback that is invoked on a worker with the context of
+  /// the worker.
+  using Request = std::function<void(ExecutionContext &ctx)>;
+
+  /// Creates the execution contexts of the workers.
+  using ContextFactory = std::function<std::unique_ptr<ExecutionContext>()>;
+
+private:
+  /// The worker threads.
+  std::vector<std::thread> workers_;
+  /// The contexts of the workers.
+  std::vector<std::unique_ptr<ExecutionContext>> contexts_;
+  /// The requests that have not been picked up by a worker yet.
+  std::deque<Request> requests_;
+  /// The maximum number of requests in requests_.
+  size_t capacity_;
+  /// The number of requests that are being processed by the workers.
+  size_t numRunning_{0};
+  /// Protects all of the fields above and stop_.
+  std::mutex mutex_;
+  /// Signalled when a request is submitted or when the queue is stopped.
+  std::condition_variable notEmpty_;
+  /// Signalled when a request is picked up or finishes.
+  std::condition_variable notFull_;
+  /// Set when the queue is destroyed. Workers exit once the queue is empty.
+  bool stop_{false};
+
+  /// The body of a worker thread that processes requests with \p ctx.
+  void workerLoop(ExecutionContext &ctx);
+
+public:
+  /// Create \p numWorkers workers, each with a context that is created by
+  /// \p createContext, and a queue that holds up to \p capacity requests.
+  RequestQueue(unsigned numWorkers, size_t capacity,
+               const ContextFactory &createContext);
+
+  /// Finish all of the submitted requests and join the workers.
+  ~RequestQueue();
+
+  RequestQueue(const RequestQueue &) = delete;
+  RequestQueue &operator=(const RequestQueue &) = delete;
+
+  /// Add \p request to the queue. Blocks while the queue is full.
+  void submit(Request request);
+
+  /// Block until all of the submitted requests have finished.
+  void wait();
+};
+
+} // namespace glow
+
+#endif // GLOW_EXECUTIONENGINE_REQUESTQUEUE_H
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_EXECUTIONENGINE_TIEREDFUNCTION_H
+#define GLOW_EXECUTIONENGINE_TIEREDFUNCTION_H
+
+#include "glow/Backends/Backend.h"
+#include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/ExecutionContext.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace glow {
+
+class IRFunction;
+class TieredContext;
+
+/// A compiled function that runs the code of a fast compiler (the first tier,
+/// e.g. the interpreter) while the code of an optimizing compiler (the final
+/// tier) is being compiled on a background thread. Every run uses the tier that
+/// is ready when the run starts, so the runs switch to the final tier as soon
+/// as it has been compiled, without waiting for the runs that are in progress.
+/// The contexts of a TieredFunction hold a context of each tier, which is
+/// created when the tier is first used with the context.
+class TieredFunction final : public CompiledFunction {
+  /// The public variables of the function. Their tensors in the contexts of
+  /// the TieredFunction are bound to the contexts of the tiers for every run.
+  std::vector<Variable *> vars_;
+  /// The first tier.
+  std::unique_ptr<CompiledFunction> first_;
+  /// The final tier. It is written by the background thread before it is
+  /// published in active_.
+  std::unique_ptr<CompiledFunction> final_;
+  /// The tier that is used by new runs.
+  std::atomic<CompiledFunction *> active_;
+  /// Becomes ready when the final tier is active.
+  std::shared_future<void> finalReady_;
+  /// The thread that compiles the final tier.
+  std::thread compiler_;
+  /// The context that is used by execute().
+  std::unique_ptr<TieredContext> defaultContext_;
+
+  /// \returns the context of the tier \p tier in \p ctx, and creates it if
+  /// needed.
+  ExecutionContext &getTierContext(TieredContext &ctx, CompiledFunction *tier);
+
+public:
+  /// Ctor. \p first is the first tier, which is used right away. The final
+  /// tier is compiled from \p IR by \p backend on a background thread, and
+  /// \p backend must outlive the TieredFunction. \p vars are the public
+  /// variables that are used by the tiers.
+  TieredFunction(std::unique_ptr<CompiledFunction> first,
+                 const Backend &backend, std::unique_ptr<IRFunction> IR,
+                 llvm::ArrayRef<Variable *> vars);
+
+  /// \returns true if the runs use the final tier.
+  bool isFinalTierActive() const { return active_ != first_.get(); }
+
+  /// Block until the final tier has been compiled and is used by the runs.
+  void waitForFinalTier() const { finalReady_.wait(); }
+
+  /// \name CompiledFunction interface
+  ///@{
+  /// Waits for the background compilation to finish.
+  ~TieredFunction() override;
+
+  void execute() override;
+
+  ExecutionContext &getDefaultContext() override;
+
+  std::unique_ptr<ExecutionContext> createExecutionContext() override;
+
+  void execute(ExecutionContext &ctx) override;
+
+  /// \returns the footprint of the tier that is used by new runs.
+  MemoryFootprint getMemoryFootprint() const override {
+    return active_.load()->getMemoryFootprint();
+  }
+  ///@}
+};
+
+} // end namespace glow
+
+#endif // GLOW_EXECUTIONENGINE_TIEREDFUNCTION_H
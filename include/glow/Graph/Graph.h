@@ -102,6 +102,9 @@ public:
 
   const FunctionList &getFunctions() const { return functions_; }
 
+  /// Erase the function \p F from the Module.
+  void eraseFunction(Function *F);
+
   /// Erase the variable \p N from the Module.
   void eraseVariable(Variable *N);
 
@@ -542,6 +545,23 @@ public:
   Function *clone(llvm::StringRef newName,
                   llvm::DenseMap<Node *, Node *> *map = nullptr);
 
+  /// Clone the current function into a new function with the name \p newName
+  /// that processes batches of \p batchSize samples. The batch size is the
+  /// first dimension of the public variables \p inputs. The batch dimension is
+  /// followed from \p inputs through the nodes that depend on them, and the
+  /// types and the members of these nodes are adjusted. The new function uses
+  /// new public variables in place of \p inputs and of the variables that the
+  /// batched results are saved to. All of the other variables are shared with
+  /// the current function. If \p varMap is non-null then the procedure records
+  /// the mapping between the old variables and the new variables in \p varMap.
+  /// \returns the new function, or null if the current function has nodes
+  /// that mix the samples of the batch, e.g. a concat along the batch
+  /// dimension. Nothing is added to the module in that case.
+  Function *
+  cloneWithBatchSize(llvm::StringRef newName, llvm::ArrayRef<Variable *> inputs,
+                     size_t batchSize,
+                     llvm::DenseMap<Variable *, Variable *> *varMap = nullptr);
+
   /// Verify the correctness of the Function.
   void verify() const;
 
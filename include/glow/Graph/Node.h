@@ -323,6 +323,10 @@ public:
   /// \returns the n'th result type of the node.
   TypeRef getType(unsigned idx) const;
 
+  /// Set the type of the result \p idx to \p T. The caller is responsible for
+  /// keeping the types of the users of the result consistent.
+  void setType(unsigned idx, TypeRef T);
+
   /// Methods that forward to the result type (that must be valid):
   /// @{
   ElemKind getElementType(unsigned resNo) const;
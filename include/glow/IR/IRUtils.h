@@ -133,6 +133,21 @@ Value *getOrigin(Value *V);
 /// \returns peels off the layers of tensorviews from a value \p V.
 const Value *getOrigin(const Value *V);
 
+/// \returns the number of arithmetic operations of a convolution that
+/// computes \p dest with the filter \p filter, i.e. two operations for every
+/// multiply-accumulate. The innermost dimension of \p dest is the channel.
+uint64_t getConvolutionFLOPs(const Value *dest, const Value *filter);
+
+/// \returns an estimate of the number of arithmetic operations of \p I.
+/// Instructions that only move data perform no operations, and the other
+/// instructions without a specific estimate perform one operation for every
+/// element of their first operand.
+uint64_t estimateFLOPs(const Instruction *I);
+
+/// \returns the number of bytes of the operands of \p I, which estimates the
+/// memory traffic of \p I when its operands don't fit into the cache.
+uint64_t getOperandsSizeInBytes(const Instruction *I);
+
 } // namespace glow
 
 #endif // GLOW_IR_IRUTILS_H
@@ -23,6 +23,7 @@
 #include "llvm/ADT/ArrayRef.h"
 
 #include <string>
+#include <unordered_map>
 
 namespace onnx {
 class AttributeProto;
@@ -88,6 +89,10 @@ class ONNXModelLoader
   /// ONNX model op_version;
   size_t opsetVersion_;
 
+  /// The public variables of the inputs of the graph that are fed by the
+  /// caller, by name.
+  std::unordered_map<std::string, Variable *> inputVarsByName_;
+
 public:
   /// Loads the ONNX model that's represented by a model description file,
   /// serialized in \p modelDescFilename and populates the network into \p F.
@@ -102,6 +107,23 @@ public:
   /// operators in the network. \returns nullptr otherwise.
   static std::unique_ptr<ONNXModelLoader>
   parse(const void *onnxModel, size_t onnxModelSize, Function &F);
+
+  /// Loads the ONNX model \p onnxModel of size \p onnxModelSize into \p F,
+  /// like the method above. The tensors \p weights with the names
+  /// \p weightNames are loaded as private variables, the other inputs of the
+  /// graph become public variables, and the outputs of the graph are saved
+  /// into public variables. \returns nullptr if the model can't be loaded.
+  static std::unique_ptr<ONNXModelLoader>
+  parse(const void *onnxModel, size_t onnxModelSize,
+        llvm::ArrayRef<const char *> weightNames,
+        llvm::ArrayRef<Tensor *> weights, Function &F);
+
+  /// \returns the map from the names of the inputs of the graph that are fed
+  /// by the caller to their variables.
+  const std::unordered_map<std::string, Variable *> &
+  getInputVarsByName() const {
+    return inputVarsByName_;
+  }
 };
 
 } // namespace glow
@@ -155,6 +155,13 @@ public:
   /// \returns the SaveNode for the external output with \p name.
   /// \pre outputsByName_.find(name) != outputsByName_.end()
   SaveNode *getOutputByName(llvm::StringRef name) const;
+
+  /// \returns the map from the names of the external outputs of the network to
+  /// the SaveNodes that save each output.
+  const std::unordered_map<std::string, SaveNode *> &
+  getOutputsByName() const {
+    return outputsByName_;
+  }
 };
 
 } // namespace glow
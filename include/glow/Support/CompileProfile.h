@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_COMPILEPROFILE_H
+#define GLOW_SUPPORT_COMPILEPROFILE_H
+
+#include "glow/Support/Trace.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace glow {
+
+class CompilePhase;
+
+/// Collects the time, the sizes of the graph or the IR, and the memory usage
+/// of the phases of the compilation, e.g. of the individual graph
+/// and IR optimization passes. The phases are recorded with CompilePhase
+/// objects. The report is a Chrome trace, in which every phase is an event and
+/// the nested phases are shown below the phases that contain them.
+class CompileProfile final {
+  /// The recorded phases.
+  std::vector<TraceEvent> events_;
+  /// The file that the report is written to when the process exits.
+  std::string filename_;
+  /// Set when the phases are recorded.
+  bool enabled_{false};
+  /// The phases that are running, in the order in which they started.
+  std::vector<CompilePhase *> activePhases_;
+  /// Protects events_ and activePhases_, because the phases may run on
+  /// several threads.
+  std::mutex mutex_;
+
+  CompileProfile() = default;
+
+  /// Reset the peak memory usage of the process at the start of \p phase.
+  /// The peak so far is kept by the phases that are running.
+  void startPhase(CompilePhase *phase);
+
+  /// \returns the peak memory usage of the process during \p phase, which
+  /// ends. The peak is kept by the phases that started before \p phase and
+  /// are still running.
+  size_t endPhase(CompilePhase *phase);
+
+  friend class CompilePhase;
+
+public:
+  /// Writes the report if a file was given to enable().
+  ~CompileProfile();
+
+  /// \returns the profile of this process.
+  static CompileProfile &get();
+
+  /// Start recording the phases. If \p filename is not empty, then the report
+  /// is written into it when the process exits.
+  void enable(llvm::StringRef filename = "");
+
+  /// \returns true if the phases are recorded.
+  bool isEnabled() const { return enabled_; }
+
+  /// Record the phase \p event.
+  void addEvent(TraceEvent event);
+
+  /// Write the report into \p os.
+  void writeReport(llvm::raw_ostream &os);
+
+  /// Discard the phases that were recorded so far.
+  void clear();
+};
+
+/// Records a phase of the compilation in the CompileProfile, from the
+/// construction of the object to its destruction. Nothing is recorded when the
+/// profile is not enabled.
+class CompilePhase final {
+public:
+  /// \returns the size of the code that a phase processes, e.g. the number of
+  /// nodes of a graph.
+  using SizeFn = std::function<size_t()>;
+
+private:
+  /// The event of the phase, or null if the phase is not recorded.
+  std::unique_ptr<TraceEvent> event_;
+  /// Computes the size of the code before and after the phase.
+  SizeFn size_;
+  /// The name of the size in the report, e.g. "nodes".
+  const char *sizeName_;
+  /// The resident set size of the process when the phase started.
+  size_t startMemoryKB_{0};
+  /// The peak resident set size of the process during the phase so far, i.e.
+  /// until the last nested phase started or ended.
+  size_t peakMemoryKB_{0};
+  /// Set if the peak resident set size of the process was reset when the
+  /// phase started, i.e. if peakMemoryKB_ is known.
+  bool hasPeakMemory_{false};
+
+  friend class CompileProfile;
+
+public:
+  /// Start the phase \p name of the category \p category, e.g. "graph" for
+  /// the graph optimizations. If \p size is given then the report contains its
+  /// value before and after the phase, in the arguments "<sizeName>_before"
+  /// and "<sizeName>_after". The argument "rss_delta_kb" is the change of the
+  /// resident set size of the process during the phase, and "peak_rss_kb" is
+  /// the peak resident set size of the process during the phase, including
+  /// the memory that was freed before the phase ended. The peak is not
+  /// reported on platforms where it can't be reset, and it is measured for
+  /// the whole process, so it includes the phases that run at the same time
+  /// on other threads.
+  CompilePhase(llvm::StringRef name, llvm::StringRef category,
+               const char *sizeName = nullptr, SizeFn size = nullptr);
+
+  /// End the phase.
+  ~CompilePhase();
+
+  CompilePhase(const CompilePhase &) = delete;
+  CompilePhase &operator=(const CompilePhase &) = delete;
+};
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_COMPILEPROFILE_H
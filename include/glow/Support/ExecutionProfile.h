@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_EXECUTIONPROFILE_H
+#define GLOW_SUPPORT_EXECUTIONPROFILE_H
+
+#include "glow/Support/PerfCounters.h"
+#include "glow/Support/Trace.h"
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace glow {
+
+/// Collects the time that the executions of compiled functions spend in the
+/// individual instructions, e.g. when the instructions are instrumented by a
+/// backend. The times are aggregated per instruction name, and the profile can
+/// be written as a Chrome trace or as a text summary, in which the
+/// instructions are sorted by their total time. Optionally, the hardware
+/// performance counters of the instructions are collected as well, and the
+/// summary shows how close every instruction gets to the roofline of the
+/// machine.
+class ExecutionProfile final {
+public:
+  /// The state of the calling thread when an instruction begins or ends.
+  struct Sample {
+    /// The time (see getTraceTimestamp).
+    uint64_t timestamp{0};
+    /// The counters of the thread, if they are collected.
+    PerfCounterValues counters;
+  };
+
+  /// An estimate of the work of an instruction.
+  struct InstrCost {
+    /// The number of arithmetic operations.
+    uint64_t flops;
+    /// The number of bytes that are read and written.
+    uint64_t bytes;
+
+    InstrCost(uint64_t flops = 0, uint64_t bytes = 0)
+        : flops(flops), bytes(bytes) {}
+  };
+
+  /// The aggregated times of an instruction, in nanoseconds.
+  struct InstrStats {
+    /// The kind of the instruction, e.g. "ConvolutionInst".
+    std::string kind;
+    /// The number of times that the instruction was executed.
+    uint64_t count{0};
+    /// The total time of all of the executions.
+    uint64_t total{0};
+    /// The time of the fastest execution.
+    uint64_t min{0};
+    /// The time of the slowest execution.
+    uint64_t max{0};
+    /// The number of bytes that all of the executions allocated.
+    uint64_t allocatedBytes{0};
+    /// The sum of the costs of all of the executions.
+    InstrCost cost;
+    /// The sum of the counters of all of the executions.
+    PerfCounterValues counters;
+  };
+
+private:
+  /// The category of the events in the trace, e.g. the name of the backend.
+  std::string category_;
+  /// The recorded events. Once maxEvents_ events are recorded, only the
+  /// statistics of the following events are updated.
+  std::vector<TraceEvent> events_;
+  /// The maximal number of events in the trace.
+  size_t maxEvents_;
+  /// Maps the names of the instructions to their statistics.
+  std::map<std::string, InstrStats> stats_;
+  /// The file that the trace is written to when the profile is destroyed.
+  std::string traceFile_;
+  /// The file that the summary is written to when the profile is destroyed.
+  std::string summaryFile_;
+  /// Set if the hardware counters are collected.
+  bool collectCounters_;
+  /// Protects the state, because the instructions may run on several threads.
+  mutable std::mutex mutex_;
+
+public:
+  /// Ctor. The events of the trace belong to the category \p category. At most
+  /// \p maxEvents events are kept for the trace. The hardware counters are
+  /// collected if the -profile-counters option is set.
+  explicit ExecutionProfile(llvm::StringRef category,
+                            size_t maxEvents = 1 << 20);
+
+  /// Writes the trace and the summary into the files given to setOutputFiles.
+  ~ExecutionProfile();
+
+  ExecutionProfile(const ExecutionProfile &) = delete;
+  ExecutionProfile &operator=(const ExecutionProfile &) = delete;
+
+  /// Write the Chrome trace into \p traceFile and the summary into \p
+  /// summaryFile when the profile is destroyed. Empty names are ignored.
+  void setOutputFiles(llvm::StringRef traceFile, llvm::StringRef summaryFile);
+
+  /// Collect the hardware counters of the instructions if \p collect is true.
+  void setCollectCounters(bool collect) { collectCounters_ = collect; }
+
+  /// \returns true if the hardware counters are collected.
+  bool collectsCounters() const { return collectCounters_; }
+
+  /// \returns the current state of the calling thread, to be passed to
+  /// addEvent.
+  Sample sample() const;
+
+  /// Record that the instruction \p name of the kind \p kind ran on the
+  /// calling thread from \p begin to \p end (see sample), performed the work
+  /// \p cost, and allocated \p allocatedBytes bytes of memory.
+  void addEvent(llvm::StringRef name, llvm::StringRef kind, const Sample &begin,
+                const Sample &end, const InstrCost &cost = InstrCost(),
+                uint64_t allocatedBytes = 0);
+
+  /// Record that the instruction \p name of the kind \p kind ran from \p start
+  /// to \p end (see getTraceTimestamp), and allocated \p allocatedBytes bytes
+  /// of memory.
+  void addEvent(llvm::StringRef name, llvm::StringRef kind, uint64_t start,
+                uint64_t end, uint64_t allocatedBytes = 0);
+
+  /// \returns the statistics of the instructions, by name.
+  std::map<std::string, InstrStats> getStats() const;
+
+  /// Write the recorded events into \p os in the Chrome trace_event format.
+  void writeChromeTrace(llvm::raw_ostream &os) const;
+
+  /// Write a table with the statistics of the instructions into \p os. The
+  /// instructions that took the most time come first. The allocated memory is
+  /// only shown if some instruction allocated memory. If the costs or the
+  /// counters of the instructions are known, then a second table shows the
+  /// instructions per cycle, the cache miss rate, the achieved GFLOP/s and
+  /// GB/s and the roofline (see the -roofline-peak-gflops and
+  /// -roofline-peak-gbps options).
+  void writeSummary(llvm::raw_ostream &os) const;
+
+  /// Discard the events and the statistics.
+  void clear();
+};
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_EXECUTIONPROFILE_H
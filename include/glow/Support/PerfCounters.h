@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_PERFCOUNTERS_H
+#define GLOW_SUPPORT_PERFCOUNTERS_H
+
+#include <cstdint>
+
+namespace glow {
+
+/// The values of the hardware performance counters of a thread. The values
+/// of counters that are not supported by the machine are zero.
+struct PerfCounterValues {
+  /// The number of CPU cycles.
+  uint64_t cycles{0};
+  /// The number of retired instructions.
+  uint64_t instructions{0};
+  /// The number of accesses to the last level cache.
+  uint64_t cacheReferences{0};
+  /// The number of accesses that missed the last level cache.
+  uint64_t cacheMisses{0};
+
+  /// \returns the counts between the values \p begin and these values.
+  PerfCounterValues operator-(const PerfCounterValues &begin) const;
+
+  PerfCounterValues &operator+=(const PerfCounterValues &other);
+};
+
+/// The hardware performance counters of the thread that creates the object,
+/// which are read with the Linux perf_event_open interface. The counters are
+/// not available on other platforms, or when the kernel doesn't allow the
+/// process to monitor itself (see /proc/sys/kernel/perf_event_paranoid).
+class PerfCounters final {
+  /// The file descriptor of the leader of the group of counters, or -1.
+  int groupFd_{-1};
+  /// The file descriptors of the other counters of the group.
+  int memberFds_[3] = {-1, -1, -1};
+  /// Maps the positions of the values that are read from the group to the
+  /// fields of PerfCounterValues.
+  uint64_t PerfCounterValues::*fields_[4] = {};
+  /// The number of counters in the group.
+  unsigned numCounters_{0};
+
+public:
+  /// Open and start the counters of the calling thread.
+  PerfCounters();
+
+  /// Close the counters.
+  ~PerfCounters();
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /// \returns true if at least the cycles can be counted.
+  bool isAvailable() const { return groupFd_ != -1; }
+
+  /// \returns the current values of the counters. Must be called on the
+  /// thread that created the counters.
+  PerfCounterValues read() const;
+
+  /// \returns the counters of the calling thread, which are opened by the
+  /// first call on every thread.
+  static const PerfCounters &getThreadCounters();
+};
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_PERFCOUNTERS_H
@@ -17,6 +17,7 @@
 #define GLOW_SUPPORT_SUPPORT_H
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/raw_ostream.h"
 
 #include <chrono>
@@ -58,6 +59,10 @@ llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
 /// The char '\n' becomes '\'+'n' and quotes are handled correctly.
 std::string escapeDottyString(const std::string &str);
 
+/// Write \p str into \p os as a JSON string literal, with the quotes and the
+/// control characters escaped.
+void writeJSONString(llvm::raw_ostream &os, llvm::StringRef str);
+
 /// Add quotes to the string \p in.
 inline std::string quote(const std::string &in) { return '"' + in + '"'; }
 
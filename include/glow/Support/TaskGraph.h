@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_TASKGRAPH_H
+#define GLOW_SUPPORT_TASKGRAPH_H
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <functional>
+#include <vector>
+
+namespace glow {
+
+class ThreadPool;
+
+/// Describes an access of a task to the bytes [begin, end) of the address
+/// space \p space. Accesses to different address spaces never overlap.
+struct MemoryAccess {
+  size_t space;
+  size_t begin;
+  size_t end;
+  bool isWrite;
+
+  /// \returns true if this access and \p other must not be reordered, i.e.
+  /// they touch overlapping memory and at least one of them is a write.
+  bool conflictsWith(const MemoryAccess &other) const {
+    return (isWrite || other.isWrite) && space == other.space &&
+           begin < other.end && other.begin < end;
+  }
+};
+
+/// A directed acyclic graph of tasks. The tasks are added in the order of
+/// their sequential execution and a task depends on every earlier task whose
+/// memory accesses conflict with its own accesses. Running the graph executes
+/// every task as soon as all of its dependencies have finished, which gives
+/// the same results as the sequential execution.
+class TaskGraph final {
+  /// The memory accesses of every task.
+  std::vector<std::vector<MemoryAccess>> accesses_;
+  /// The tasks that depend on every task.
+  std::vector<std::vector<unsigned>> successors_;
+  /// The number of tasks that every task depends on.
+  std::vector<unsigned> numPredecessors_;
+
+public:
+  /// Add a task that performs the memory accesses \p accesses after all of
+  /// the tasks that were added before. \returns the id of the new task.
+  unsigned addTask(llvm::ArrayRef<MemoryAccess> accesses);
+
+  /// \returns the number of tasks in the graph.
+  size_t size() const { return accesses_.size(); }
+
+  /// \returns the tasks that depend on the task \p id.
+  llvm::ArrayRef<unsigned> getSuccessors(unsigned id) const {
+    return successors_[id];
+  }
+
+  /// \returns the number of tasks that the task \p id depends on.
+  unsigned getNumPredecessors(unsigned id) const {
+    return numPredecessors_[id];
+  }
+
+  /// \returns the number of tasks on the longest chain of dependencies, which
+  /// is the number of steps that the graph needs with unlimited parallelism.
+  size_t getCriticalPathLength() const;
+
+  /// Call \p fn(id) for every task of the graph on the threads of \p pool.
+  /// The calling thread participates in the execution. Returns when all of
+  /// the tasks have finished.
+  void run(ThreadPool &pool, const std::function<void(unsigned)> &fn) const;
+};
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_TASKGRAPH_H
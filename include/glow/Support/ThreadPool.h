@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_THREADPOOL_H
+#define GLOW_SUPPORT_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace glow {
+
+/// A fixed-size work-stealing pool of worker threads. Every worker owns a
+/// queue of tasks. Tasks that are enqueued by a worker are pushed to its own
+/// queue and are executed in LIFO order, which keeps the data that the parent
+/// task produced in the cache. Idle workers steal the oldest tasks from the
+/// queues of the other workers. Tasks that are enqueued by other threads go
+/// to a shared queue.
+class ThreadPool final {
+  /// A queue of tasks that is protected by its own lock.
+  struct WorkQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  /// The worker threads.
+  std::vector<std::thread> workers_;
+  /// The queues of the workers, followed by the shared queue.
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  /// The number of tasks in all of the queues.
+  std::atomic<size_t> numPending_{0};
+  /// The number of threads that are blocked in waitUntil.
+  std::atomic<unsigned> numWaiters_{0};
+  /// Protects the sleeping of the workers and of the waiting threads.
+  std::mutex mutex_;
+  /// Signalled when a task is enqueued, when a task finishes while some
+  /// thread is blocked in waitUntil, or when the pool is shutting down.
+  std::condition_variable cv_;
+  /// Set when the pool is destroyed. Workers exit once all queues are empty.
+  bool stop_{false};
+
+  /// The body of the worker thread with index \p id.
+  void workerLoop(unsigned id);
+
+  /// \returns the index of the queue that the calling thread pushes to.
+  unsigned getLocalQueue() const;
+
+  /// Move the newest (if \p lifo is set) or the oldest task of the queue with
+  /// index \p idx into \p task. \returns false if the queue is empty.
+  bool popTask(unsigned idx, bool lifo, std::function<void()> &task);
+
+  /// Take a task from the queue of the calling worker, the shared queue or
+  /// the queue of another worker, in this order, and run it on the calling
+  /// thread. \returns false if all of the queues are empty.
+  bool runPendingTask();
+
+  /// Wake up the threads that are blocked in waitUntil, if there are any.
+  void notifyWaiters();
+
+public:
+  /// Create a pool with \p numWorkers worker threads. If \p pinWorkers is set
+  /// then worker i is bound to the i-th core of the machine (modulo the number
+  /// of cores).
+  explicit ThreadPool(unsigned numWorkers, bool pinWorkers = false);
+
+  /// Finish all of the pending tasks and join the workers.
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /// \returns the number of worker threads.
+  unsigned getNumWorkers() const { return workers_.size(); }
+
+  /// Enqueue \p task for execution on one of the workers.
+  void enqueue(std::function<void()> task);
+
+  /// Enqueue \p task for execution on one of the workers. \returns a future
+  /// that becomes ready when the task has finished.
+  std::future<void> submit(std::function<void()> task);
+
+  /// Run the pending tasks of the pool on the calling thread until \p done
+  /// returns true. \p done is reevaluated every time a task finishes, so the
+  /// condition it checks must be set by a task of this pool. This never
+  /// blocks while there are pending tasks, which makes it safe to wait from
+  /// a worker of the same pool.
+  void waitUntil(const std::function<bool()> &done);
+
+  /// Call \p fn(i) for every i in [0, \p numTasks). The calls are distributed
+  /// between the workers and the calling thread, which participates in the
+  /// execution. Returns when all of the calls have finished. It is safe to
+  /// call this method from a worker of the same pool.
+  void parallelFor(size_t numTasks, const std::function<void(size_t)> &fn);
+};
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_THREADPOOL_H
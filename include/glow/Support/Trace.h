@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_SUPPORT_TRACE_H
+#define GLOW_SUPPORT_TRACE_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace glow {
+
+/// An event that took place during the time range [start, start + duration).
+/// The events of all of the Glow profilers are written in the Chrome
+/// trace_event format, which can be viewed with chrome://tracing.
+struct TraceEvent {
+  /// The name of the event.
+  std::string name;
+  /// The category of the event, e.g. the component that recorded it.
+  std::string category;
+  /// The start time in nanoseconds (see getTraceTimestamp).
+  uint64_t start{0};
+  /// The duration in nanoseconds.
+  uint64_t duration{0};
+  /// The thread that the event took place on (see getTraceThreadId).
+  unsigned tid{0};
+  /// Additional values that are shown with the event.
+  std::vector<std::pair<std::string, int64_t>> args;
+};
+
+/// \returns the current time in nanoseconds, measured by a monotonic clock
+/// from an arbitrary point that is the same for all of the threads.
+uint64_t getTraceTimestamp();
+
+/// \returns a small number that identifies the calling thread in traces.
+unsigned getTraceThreadId();
+
+/// \returns the current resident set size of the process in kilobytes, or 0
+/// if it is not known on this platform.
+size_t getMemoryUsageKB();
+
+/// \returns the peak resident set size of the process in kilobytes since it
+/// started or since the last resetPeakMemoryUsage(), or 0 if it is not known
+/// on this platform.
+size_t getPeakMemoryUsageKB();
+
+/// Set the peak resident set size of the process to the current one.
+/// \returns false if this is not supported on this platform.
+bool resetPeakMemoryUsage();
+
+/// Write the events \p events into \p os as a JSON document in the Chrome
+/// trace_event format.
+void writeChromeTrace(llvm::raw_ostream &os, llvm::ArrayRef<TraceEvent> events);
+
+} // namespace glow
+
+#endif // GLOW_SUPPORT_TRACE_H
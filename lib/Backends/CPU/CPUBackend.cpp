@@ -13,13 +13,20 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#define DEBUG_TYPE "jit"
 
 #include "CPUBackend.h"
 #include "BundleSaver.h"
 #include "CPUFunction.h"
+#include "CommandLine.h"
+#include "JITObjectCache.h"
+#include "ParallelRuntime.h"
+#include "ProfilingRuntime.h"
 
 #include "glow/Graph/Graph.h"
+#include "glow/IR/IRUtils.h"
 #include "glow/IR/Instrs.h"
+#include "glow/Support/CompileProfile.h"
 #include "glow/Support/Debug.h"
 
 #include "llvm/ADT/STLExtras.h"
@@ -27,10 +34,28 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 
+#include <algorithm>
+#include <thread>
+
 using namespace glow;
 
 static llvm::cl::opt<std::string> target("target", llvm::cl::desc("target"));
 
+static llvm::cl::opt<std::string> objectCacheDir(
+    "cpu-object-cache",
+    llvm::cl::desc("Directory of a cache of the object code that is compiled "
+                   "by the CPU backend, which is shared by all processes"),
+    llvm::cl::value_desc("dir"), llvm::cl::init(""),
+    llvm::cl::cat(CPUBackendCat));
+
+static llvm::cl::opt<unsigned> codegenThreads(
+    "cpu-codegen-threads",
+    llvm::cl::desc("Number of threads that generate the machine code of a "
+                   "function in the CPU backend (0 means one thread per core)"),
+    llvm::cl::init(1), llvm::cl::cat(CPUBackendCat));
+
+extern llvm::cl::opt<bool> emitDebugInfo;
+
 namespace glow {
 Backend *createCPUBackend() { return new CPUBackend(); }
 } // namespace glow
@@ -41,58 +66,6 @@ namespace {
 //                   Functions for executing code using JIT
 //===----------------------------------------------------------------------===//
 
-/// Emit the entry point for JIT called "jitmain". It simply calls the main
-/// entry of the module with the constant concrete addresses of all the memory
-/// areas. Since these addresses are constants, the LLVM optimizer will constant
-/// propagate them into relative addressing computations and the like and
-/// produce a very efficient code that uses absolute addressing whenever
-/// possible.
-static void emitJitMain(AllocationsInfo &allocationsInfo, LLVMIRGen &irgen) {
-  llvm::Type *voidTy = llvm::Type::getVoidTy(irgen.getLLVMContext());
-  llvm::FunctionType *jitFuncTy = llvm::FunctionType::get(voidTy, {}, false);
-  auto *func =
-      llvm::Function::Create(jitFuncTy, llvm::Function::ExternalLinkage,
-                             "jitmain", &irgen.getModule());
-  llvm::BasicBlock *entry_bb =
-      llvm::BasicBlock::Create(irgen.getLLVMContext(), "entry", func);
-  llvm::IRBuilder<> builder(entry_bb);
-
-  // Prepare arguments for the "main" function.
-  llvm::SmallVector<llvm::Value *, 4> initFunctionCallArgs;
-  // Get the integer type having the same size in bits as size_t.
-  auto *sizeTType = builder.getIntNTy(sizeof(size_t) * 8);
-  auto int8PtrTy = llvm::Type::getInt8PtrTy(irgen.getLLVMContext());
-
-  initFunctionCallArgs.push_back(builder.CreateIntToPtr(
-      llvm::ConstantInt::get(
-          sizeTType, reinterpret_cast<size_t>(
-                         allocationsInfo.baseConstantWeightVarsAddress_)),
-      int8PtrTy));
-  initFunctionCallArgs.push_back(builder.CreateIntToPtr(
-      llvm::ConstantInt::get(
-          sizeTType, reinterpret_cast<size_t>(
-                         allocationsInfo.baseMutableWeightVarsAddress_)),
-      int8PtrTy));
-  initFunctionCallArgs.push_back(builder.CreateIntToPtr(
-      llvm::ConstantInt::get(
-          sizeTType,
-          reinterpret_cast<size_t>(allocationsInfo.baseActivationsAddress_)),
-      int8PtrTy));
-  // Now form the offsets array and pass it as the last argument.
-  auto offsetsArray =
-      irgen.emitConstOffsetsArray(irgen.getBuilder(), allocationsInfo);
-  initFunctionCallArgs.push_back(offsetsArray);
-  // Invoke the main entry with constant arguments and let LLVM optimizer make
-  // use of it.
-  auto *entryF = irgen.getModule().getFunction(irgen.getMainEntryName());
-  entryF->setLinkage(llvm::Function::InternalLinkage);
-  createCall(builder, entryF, initFunctionCallArgs);
-  // Terminate the function.
-  builder.CreateRetVoid();
-  // Create the debug info for the entry point function.
-  irgen.generateFunctionDebugInfo(func);
-}
-
 /// Perform memory allocation for a JIT execution.
 static void *allocateJITMemory(const IRFunction *F,
                                AllocationsInfo &allocationsInfo) {
@@ -112,6 +85,109 @@ static void *allocateJITMemory(const IRFunction *F,
   return heap;
 }
 
+/// \returns the offsets array that is passed to the entry functions. This is
+/// the runtime counterpart of LLVMIRGen::emitConstOffsetsArray.
+static std::vector<size_t>
+getOffsetsArray(const AllocationsInfo &allocationsInfo) {
+  std::vector<size_t> offsets(allocationsInfo.valueNumbers_.size());
+  for (auto &I : allocationsInfo.valueNumbers_) {
+    offsets[I.second.second] =
+        allocationsInfo.allocatedAddressed_.lookup(I.first);
+  }
+  return offsets;
+}
+
+/// \returns the entries of the offsets array of \p F that hold the addresses
+/// of the public variables (i.e. the mutable weights) and of their views.
+static std::vector<CPUFunction::VariableOffset>
+getVariableOffsets(IRFunction *F, const AllocationsInfo &allocationsInfo) {
+  llvm::DenseMap<const Value *, Variable *> weightToVar;
+  for (auto *v : F->getGraph()->getParent()->getVars()) {
+    weightToVar[F->getWeightForNode(v)] = v;
+  }
+
+  std::vector<CPUFunction::VariableOffset> variableOffsets;
+  for (auto &I : allocationsInfo.valueNumbers_) {
+    if (I.second.first != AllocationsInfo::ValueKind::MutableWeight) {
+      continue;
+    }
+    auto *origin = getOrigin(I.first);
+    assert(weightToVar.count(origin) && "Unknown weight");
+    size_t delta = allocationsInfo.allocatedAddressed_.lookup(I.first) -
+                   allocationsInfo.allocatedAddressed_.lookup(origin);
+    variableOffsets.push_back(
+        {I.second.second, weightToVar.lookup(origin), delta});
+  }
+  return variableOffsets;
+}
+
+/// \returns the memory footprint of \p F with the layout of
+/// \p allocationsInfo. The weights are used in place, so only the activations
+/// are placed into a block of memory.
+static MemoryFootprint
+getMemoryFootprint(const IRFunction *F,
+                   const AllocationsInfo &allocationsInfo) {
+  auto footprint = computeMemoryFootprint(F, [&](const Value *V) {
+    return llvm::isa<AllocActivationInst>(V)
+               ? allocationsInfo.allocatedAddressed_.lookup(V)
+               : MemoryFootprint::noOffset;
+  });
+  footprint.activationBytes = allocationsInfo.activationsMemSize_;
+  return footprint;
+}
+
+/// Build the graph of dependencies between the steps \p steps. A step depends
+/// on the earlier steps that access overlapping memory, which takes into
+/// account the reuse of the activations memory by the allocator.
+static TaskGraph
+buildStepGraph(llvm::ArrayRef<std::vector<const Instruction *>> steps,
+               const AllocationsInfo &allocationsInfo) {
+  TaskGraph graph;
+  for (const auto &step : steps) {
+    llvm::SmallVector<MemoryAccess, 8> accesses;
+    for (const auto *I : step) {
+      for (const auto &op : I->getOperands()) {
+        // Tensor views are not necessarily contiguous, so be conservative and
+        // assume that they access the whole buffer they are based on.
+        auto *V = getOrigin(op.first);
+        auto kind = allocationsInfo.valueNumbers_.lookup(V).first;
+        auto begin = allocationsInfo.allocatedAddressed_.lookup(V);
+        accesses.push_back({static_cast<size_t>(kind), begin,
+                            begin + V->getSizeInBytes(),
+                            op.second != OperandKind::In});
+      }
+    }
+    graph.addTask(accesses);
+  }
+  return graph;
+}
+
+/// \returns the number of threads that generate the machine code of a
+/// function, as requested by the -cpu-codegen-threads option.
+static unsigned getCodegenNumThreads() {
+  // The debug info describes a single module, so the module is not split when
+  // it is requested.
+  if (emitDebugInfo) {
+    return 1;
+  }
+  if (codegenThreads == 0) {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+  return codegenThreads;
+}
+
+/// \returns the cache of compiled functions that is requested by the
+/// -cpu-object-cache option, or null if there is none. Functions with debug
+/// info are never cached, because the debug info refers to the files of the
+/// process that compiled them, and neither are instrumented functions.
+static JITObjectCache *getObjectCache() {
+  if (objectCacheDir.empty() || emitDebugInfo || shouldProfileInstrs()) {
+    return nullptr;
+  }
+  static JITObjectCache cache(objectCacheDir);
+  return &cache;
+}
+
 } // end namespace
 
 std::unique_ptr<CompiledFunction>
@@ -120,17 +196,76 @@ CPUBackend::compile(std::unique_ptr<IRFunction> IR) const {
   LLVMIRGen irgen(IR.get(), allocationsInfo, "");
   irgen.initTargetMachine(target.empty() ? "" : target.getValue(),
                           llvm::CodeModel::Model::Large);
-  irgen.initCodeGen();
   // Perform the address assignment for activations and WeightVars.
   auto heap = allocateJITMemory(IR.get(), allocationsInfo);
-  // Create the jitmain function to be invoked by JIT.
-  emitJitMain(allocationsInfo, irgen);
-  // Emit the code for the body of the entry function.
-  irgen.performCodeGen();
-  // Hand over the module to JIT for the machine code generation.
+  // Split the code into steps that can run in parallel if requested. The steps
+  // are also the units that the code generation is parallelized over.
+  bool runSteps = shouldRunInstrsInParallel();
+  unsigned numCodegenThreads = getCodegenNumThreads();
+  bool emitSteps = runSteps || numCodegenThreads > 1;
+  std::vector<std::vector<const Instruction *>> steps;
+  std::unique_ptr<StepProfile> stepProfile;
+
+  auto *cache = getObjectCache();
+  std::string key;
+  CachedObject cached;
+  if (cache) {
+    key = JITObjectCache::getKey(IR.get(), irgen.getTargetMachine(), emitSteps);
+  }
+  // The offsets array is passed to the code at runtime, so the cached code can
+  // be used as long as the allocator produced the same layout.
+  bool cacheHit;
+  {
+    CompilePhase phase("loadCachedObject", "llvm");
+    cacheHit =
+        cache && cache->load(key, cached) &&
+        cached.activationsMemSize == allocationsInfo.activationsMemSize_ &&
+        cached.layout == CachedObject::getLayout(allocationsInfo);
+  }
+  if (cacheHit) {
+    DEBUG_GLOW(llvm::dbgs() << "Loading cached object " << key << "\n");
+    steps = cached.decodeSteps(IR.get());
+  } else {
+    irgen.initCodeGen();
+    irgen.setEmitSteps(emitSteps);
+    irgen.setInstrumentSteps(shouldProfileInstrs());
+    // Emit the code for the body of the entry function.
+    irgen.performCodeGen();
+    steps = irgen.getSteps().vec();
+    if (shouldProfileInstrs()) {
+      stepProfile =
+          llvm::make_unique<StepProfile>(irgen.getInstrumentedSteps());
+    }
+    // Generate the machine code, in parallel if requested.
+    {
+      CompilePhase phase("emitObjectFiles", "llvm");
+      cached.objects = irgen.emitObjectFiles(numCodegenThreads);
+    }
+    if (cache) {
+      cached.activationsMemSize = allocationsInfo.activationsMemSize_;
+      cached.layout = CachedObject::getLayout(allocationsInfo);
+      cached.steps = CachedObject::encodeSteps(IR.get(), steps);
+      cache->store(key, cached);
+    }
+  }
+
+  // Link the object files in the JIT.
   auto JIT = llvm::make_unique<llvm::orc::GlowJIT>(irgen.getTargetMachine());
-  JIT->addModule(irgen.borrowModule());
-  return llvm::make_unique<CPUFunction>(std::move(JIT), heap);
+  {
+    CompilePhase phase("linkObjectFiles", "llvm");
+    for (auto &object : cached.objects) {
+      JIT->addObject(std::move(object));
+    }
+  }
+  // The steps are only run on their own if they may run in parallel.
+  auto stepGraph =
+      runSteps ? buildStepGraph(steps, allocationsInfo) : TaskGraph();
+  return llvm::make_unique<CPUFunction>(
+      std::move(JIT), heap, allocationsInfo.activationsMemSize_,
+      getOffsetsArray(allocationsInfo),
+      getVariableOffsets(IR.get(), allocationsInfo),
+      getMemoryFootprint(IR.get(), allocationsInfo), std::move(stepGraph),
+      std::move(stepProfile));
 }
 
 void CPUBackend::save(std::unique_ptr<IRFunction> IR,
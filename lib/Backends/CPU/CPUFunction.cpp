@@ -15,26 +15,117 @@
  */
 
 #include "CPUFunction.h"
+#include "LLVMIRGen.h"
+#include "ParallelRuntime.h"
 
+#include "glow/Backends/ExecutionContext.h"
 #include "glow/Support/Compiler.h"
 #include "glow/Support/Memory.h"
 
+#include "llvm/ADT/STLExtras.h"
+
 using namespace glow;
 
-CPUFunction::CPUFunction(std::unique_ptr<llvm::orc::GlowJIT> JIT, void *heap)
-    : JIT_(std::move(JIT)), heap_(heap) {}
+namespace {
+/// The per-context state of a CPUFunction.
+class CPUExecutionContext final : public ExecutionContext {
+public:
+  /// The memory for the activations.
+  void *activations_{nullptr};
+  /// The offsets array, in which the entries of the public variables hold
+  /// the addresses of the tensors of this context.
+  std::vector<size_t> offsets_;
 
-CPUFunction::~CPUFunction() { alignedFree(heap_); }
+  ~CPUExecutionContext() override { alignedFree(activations_); }
+};
 
-void CPUFunction::execute() {
-  auto sym = JIT_->findSymbol("jitmain");
+/// \returns the address of the function \p name in the code loaded by \p JIT.
+CPUFunction::StepFn getEntryPoint(llvm::orc::GlowJIT &JIT,
+                                  const std::string &name) {
+  auto sym = JIT.findSymbol(name);
   assert(sym && "Unable to JIT the code!");
-  using JitFuncType = void (*)(void);
   auto address = sym.getAddress();
-  if (address) {
-    JitFuncType funcPtr = reinterpret_cast<JitFuncType>(address.get());
-    funcPtr();
-  } else {
-    GLOW_ASSERT(false && "Error getting address.");
+  GLOW_ASSERT(address && "Error getting address.");
+  return reinterpret_cast<CPUFunction::StepFn>(address.get());
+}
+} // namespace
+
+CPUFunction::CPUFunction(std::unique_ptr<llvm::orc::GlowJIT> JIT, void *heap,
+                         size_t activationsMemSize, std::vector<size_t> offsets,
+                         std::vector<VariableOffset> variableOffsets,
+                         MemoryFootprint footprint, TaskGraph stepGraph,
+                         std::unique_ptr<StepProfile> stepProfile)
+    : JIT_(std::move(JIT)), activationsMemSize_(activationsMemSize),
+      offsets_(std::move(offsets)),
+      variableOffsets_(std::move(variableOffsets)),
+      stepGraph_(std::move(stepGraph)), stepProfile_(std::move(stepProfile)),
+      footprint_(std::move(footprint)) {
+  installParallelRuntime(*JIT_);
+  if (stepProfile_) {
+    installProfilingRuntime(*JIT_, *stepProfile_);
+  }
+
+  main_ = getEntryPoint(*JIT_, "main");
+  for (size_t i = 0, e = stepGraph_.size(); i < e; i++) {
+    steps_.push_back(getEntryPoint(*JIT_, LLVMIRGen::getStepName(i)));
+  }
+
+  // The default context uses the heap and the payloads of the variables.
+  auto ctx = llvm::make_unique<CPUExecutionContext>();
+  for (const auto &VO : variableOffsets_) {
+    if (!ctx->hasTensor(VO.var)) {
+      ctx->bind(VO.var, &VO.var->getPayload());
+    }
+  }
+  ctx->activations_ = heap;
+  ctx->offsets_ = offsets_;
+  ctx->setOwner(this);
+  defaultContext_ = std::move(ctx);
+}
+
+CPUFunction::~CPUFunction() = default;
+
+void CPUFunction::run(uint8_t *activations, size_t *offsets) {
+  // The JIT addresses the weights with their absolute addresses, so the base
+  // addresses of the weights are null.
+  if (!steps_.empty()) {
+    stepGraph_.run(getCPUThreadPool(), [&](unsigned id) {
+      steps_[id](nullptr, nullptr, activations, offsets);
+    });
+    return;
+  }
+  main_(nullptr, nullptr, activations, offsets);
+}
+
+void CPUFunction::execute() { execute(*defaultContext_); }
+
+std::unique_ptr<ExecutionContext> CPUFunction::createExecutionContext() {
+  auto ctx = llvm::make_unique<CPUExecutionContext>();
+  for (const auto &VO : variableOffsets_) {
+    if (!ctx->hasTensor(VO.var)) {
+      ctx->allocate(VO.var);
+    }
+  }
+  if (activationsMemSize_) {
+    ctx->activations_ = alignedAlloc(activationsMemSize_, TensorAlignment);
+  }
+  ctx->offsets_ = offsets_;
+  ctx->setOwner(this);
+  return std::move(ctx);
+}
+
+void CPUFunction::execute(ExecutionContext &ctx) {
+  assert(ctx.getOwner() == this && "The context belongs to another function");
+  auto &CPUCtx = static_cast<CPUExecutionContext &>(ctx);
+  // Point the offsets of the public variables to the tensors of the context.
+  for (const auto &VO : variableOffsets_) {
+    auto *T = ctx.getTensor(VO.var);
+    // The kernels may use aligned vector accesses.
+    assert(reinterpret_cast<size_t>(T->getUnsafePtr()) % TensorAlignment ==
+               0 &&
+           "The tensors of the variables must be aligned");
+    CPUCtx.offsets_[VO.offsetIdx] =
+        reinterpret_cast<size_t>(T->getUnsafePtr()) + VO.delta;
   }
+  run(static_cast<uint8_t *>(CPUCtx.activations_), CPUCtx.offsets_.data());
 }
@@ -17,28 +17,93 @@
 #define GLOW_BACKENDS_CPU_CPUFUNCTION_H
 
 #include "GlowJIT.h"
+#include "ProfilingRuntime.h"
 
 #include "glow/Backends/CompiledFunction.h"
+#include "glow/Support/TaskGraph.h"
+
+#include <vector>
 
 namespace glow {
 
+class Variable;
+
 /// A Glow IR function compiled for the CPU using LLVM.
 class CPUFunction final : public CompiledFunction {
+public:
+  /// The signature of main and of the step functions.
+  using StepFn = void (*)(uint8_t *constWeights, uint8_t *mutableWeights,
+                          uint8_t *activations, size_t *offsets);
+
+  /// An entry of the offsets array that holds the address of the public
+  /// variable \p var, or of a view that begins \p delta bytes after the
+  /// beginning of \p var. The JIT addresses the public variables with their
+  /// absolute addresses, so the entries point to the payloads of the variables
+  /// by default, and to the tensors of the context when executing with one.
+  struct VariableOffset {
+    size_t offsetIdx;
+    Variable *var;
+    size_t delta;
+  };
+
+private:
   /// The LLVM JIT engine. The jit must be initialized after the ctor
   /// initializes the LLVM backends.
   std::unique_ptr<llvm::orc::GlowJIT> JIT_;
-  /// This represents the heap, that stores the activations at runtime.
-  void *heap_;
+  /// The amount of memory that is required for the activations.
+  size_t activationsMemSize_;
+  /// The offsets array that is passed to main and to the steps.
+  std::vector<size_t> offsets_;
+  /// The entries of offsets_ that hold the addresses of public variables.
+  std::vector<VariableOffset> variableOffsets_;
+  /// The entry point of the function.
+  StepFn main_;
+  /// The dependencies between the steps of the function. Empty unless the
+  /// independent steps are run in parallel.
+  TaskGraph stepGraph_;
+  /// The entry points of the steps.
+  std::vector<StepFn> steps_;
+  /// The context that is used by execute().
+  std::unique_ptr<ExecutionContext> defaultContext_;
+  /// The names of the steps that the code reports the times of, or null if
+  /// the code is not instrumented.
+  std::unique_ptr<StepProfile> stepProfile_;
+  /// The memory that the function uses.
+  MemoryFootprint footprint_;
+
+  /// Run the code with the activations at \p activations and the offsets
+  /// array \p offsets.
+  void run(uint8_t *activations, size_t *offsets);
 
 public:
-  /// Ctor.
-  CPUFunction(std::unique_ptr<llvm::orc::GlowJIT> JIT, void *heap);
+  /// Ctor. \p heap is the memory for the activations of the default context,
+  /// and \p activationsMemSize is its size. The function takes the ownership
+  /// of \p heap. \p offsets is the offsets array that is passed to main, and
+  /// \p variableOffsets describes its entries that hold the addresses of
+  /// public variables, and \p footprint describes the memory of the
+  /// function. If \p stepGraph is not empty, then the steps of the
+  /// function are run in the order given by \p stepGraph instead of main. If
+  /// the code was instrumented, then \p stepProfile names its steps.
+  CPUFunction(std::unique_ptr<llvm::orc::GlowJIT> JIT, void *heap,
+              size_t activationsMemSize, std::vector<size_t> offsets,
+              std::vector<VariableOffset> variableOffsets,
+              MemoryFootprint footprint,
+              TaskGraph stepGraph = TaskGraph(),
+              std::unique_ptr<StepProfile> stepProfile = nullptr);
 
   /// \name CompiledFunction interface
   ///@{
   ~CPUFunction() override;
 
   void execute() override;
+
+  ExecutionContext &getDefaultContext() override { return *defaultContext_; }
+
+  std::unique_ptr<ExecutionContext> createExecutionContext() override;
+
+  void execute(ExecutionContext &ctx) override;
+
+  MemoryFootprint getMemoryFootprint() const override { return footprint_; }
   ///@}
 };
 
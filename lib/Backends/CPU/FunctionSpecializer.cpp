@@ -22,6 +22,7 @@
 #include "glow/IR/Instrs.h"
 #include "glow/Support/Debug.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Utils/Cloning.h"
@@ -33,16 +34,17 @@ using llvm::cast;
 using llvm::dyn_cast;
 using llvm::isa;
 
-namespace {
 /// Perform function specialization with constant arguments taking into account
 /// only dimensions, but not the buffer addresses. This allows for faster JIT
 /// compilation and the does degrade performance.
-static llvm::cl::opt<bool>
+llvm::cl::opt<bool>
     jitSpecializeDims("jit-specialize",
                       llvm::cl::desc("Create specialized functions for "
                                      "operations with constant dimensions"),
                       llvm::cl::init(true), llvm::cl::cat(CPUBackendCat));
 
+namespace {
+
 STATISTIC(NumSpecializations, "Number of created specializations");
 STATISTIC(NumSharedSpecializations, "Number of shared specializations");
 
@@ -230,13 +232,17 @@ class FunctionSpecializer {
     // arguments, its code size, etc.
     const auto *caller = call->getFunction();
     const auto *callee = call->getCalledFunction();
-    // Specialized only calls inside main.
-    assert(caller == entryF_ &&
-           "Only calls inside the entry function are specialized");
+    // Specialized only calls inside main and the step functions.
+    assert(llvm::is_contained(entryFuncs_, caller) &&
+           "Only calls inside the entry functions are specialized");
     (void)caller;
     // Do not specialize any LLVM internal functions.
     if (callee && callee->getName().startswith("llvm."))
       return false;
+    // The tracing calls only differ in the id of the step, so specializing
+    // them would create a copy of the same function for every step.
+    if (callee && callee->getName().startswith("libjit_trace_"))
+      return false;
     // Do not specialize noinline functions, because it does not improve
     // anything.
     return callee != nullptr &&
@@ -244,9 +250,10 @@ class FunctionSpecializer {
   }
 
 public:
-  FunctionSpecializer(llvm::Function *entryF,
+  FunctionSpecializer(llvm::ArrayRef<llvm::Function *> entryFuncs,
                       llvm::DenseSet<llvm::Value *> &dontSpec)
-      : entryF_(entryF), dontSpecializeArgsSet_(dontSpec) {}
+      : entryFuncs_(entryFuncs.begin(), entryFuncs.end()),
+        dontSpecializeArgsSet_(dontSpec) {}
 
   /// Specialize a single call.
   /// \returns the specialized Call instruction if it was possible to specialize
@@ -298,17 +305,18 @@ public:
     // The removal should happen after all specializations are done, because
     // these call instructions are used by the keys in Specializations_ map.
     llvm::SmallVector<llvm::Instruction *, 32> erasedInstructions;
-    auto *F = entryF_;
-    // Collect all eligable calls in the current function.
+    // Collect all eligable calls in the entry functions.
     llvm::SmallVector<llvm::CallInst *, 64> calls;
-    for (auto &BB : *F) {
-      for (auto &I : BB) {
-        auto *CI = dyn_cast<llvm::CallInst>(&I);
-        if (!CI)
-          continue;
-        if (!isEligibleForSpecialization(CI))
-          continue;
-        calls.push_back(CI);
+    for (auto *F : entryFuncs_) {
+      for (auto &BB : *F) {
+        for (auto &I : BB) {
+          auto *CI = dyn_cast<llvm::CallInst>(&I);
+          if (!CI)
+            continue;
+          if (!isEligibleForSpecialization(CI))
+            continue;
+          calls.push_back(CI);
+        }
       }
     }
     // Try to specialize all the collected calls.
@@ -390,8 +398,8 @@ private:
     }
   };
 
-  /// The entry function of the module.
-  llvm::Function *entryF_;
+  /// The entry functions of the module, i.e. main and the step functions.
+  llvm::SmallVector<llvm::Function *, 1> entryFuncs_;
   /// Mapping from specialization keys to the specialized functions.
   std::unordered_map<SpecializationKey, llvm::Function *,
                      SpecializationKeyHasher, SpecializationKeyEq>
@@ -412,7 +420,9 @@ private:
 } // namespace
 
 void LLVMIRGen::performSpecialization() {
-  FunctionSpecializer FuncSpecializer(llmodule_->getFunction("main"),
-                                      dontSpecializeArgsSet_);
+  llvm::SmallVector<llvm::Function *, 16> entryFuncs;
+  entryFuncs.push_back(llmodule_->getFunction("main"));
+  entryFuncs.append(stepFunctions_.begin(), stepFunctions_.end());
+  FunctionSpecializer FuncSpecializer(entryFuncs, dontSpecializeArgsSet_);
   FuncSpecializer.run();
 }
@@ -16,7 +16,11 @@
 
 #include "GlowJIT.h"
 #include "CommandLine.h"
+
+#include "glow/Support/Compiler.h"
+
 #include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/Object/ObjectFile.h"
 #include "llvm/Object/SymbolSize.h"
 
 using GlowJIT = llvm::orc::GlowJIT;
@@ -86,6 +90,17 @@ public:
 };
 #endif
 
+/// \returns the object file in the buffer \p obj in the form that is expected
+/// by the object linking layer.
+std::shared_ptr<llvm::object::OwningBinary<llvm::object::ObjectFile>>
+createObjectBinary(std::unique_ptr<llvm::MemoryBuffer> obj) {
+  auto objFile =
+      llvm::object::ObjectFile::createObjectFile(obj->getMemBufferRef());
+  GLOW_ASSERT(objFile && "Unable to load the object file.");
+  return std::make_shared<llvm::object::OwningBinary<llvm::object::ObjectFile>>(
+      std::move(*objFile), std::move(obj));
+}
+
 } // namespace
 
 #ifdef FACEBOOK_INTERNAL
@@ -121,6 +136,12 @@ llvm::orc::VModuleKey GlowJIT::addModule(std::unique_ptr<Module> M) {
   return K;
 }
 
+llvm::orc::VModuleKey GlowJIT::addObject(std::unique_ptr<MemoryBuffer> obj) {
+  auto K = ES_.allocateVModule();
+  cantFail(objectLayer_.addObject(K, createObjectBinary(std::move(obj))));
+  return K;
+}
+
 void GlowJIT::removeModule(llvm::orc::VModuleKey K) {
   cantFail(compileLayer_.removeModule(K));
 }
@@ -133,12 +154,12 @@ GlowJIT::GlowJIT(llvm::TargetMachine &TM)
   llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
 }
 
-GlowJIT::ModuleHandle GlowJIT::addModule(std::unique_ptr<Module> M) {
+std::shared_ptr<llvm::JITSymbolResolver> GlowJIT::createResolver() {
   // Build our symbol resolver:
   // Lambda 1: Look back into the JIT itself to find symbols that are part of
   //           the same "logical dylib".
   // Lambda 2: Search for external symbols in the host process.
-  auto resolver = createLambdaResolver(
+  return createLambdaResolver(
       [&](const std::string &name) {
         if (auto sym = compileLayer_.findSymbol(name, false))
           return sym;
@@ -149,10 +170,19 @@ GlowJIT::ModuleHandle GlowJIT::addModule(std::unique_ptr<Module> M) {
           return JITSymbol(symAddr, JITSymbolFlags::Exported);
         return JITSymbol(nullptr);
       });
+}
 
+GlowJIT::ModuleHandle GlowJIT::addModule(std::unique_ptr<Module> M) {
   // Add the set to the JIT with the resolver we created above and a newly
   // created SectionMemoryManager.
-  return cantFail(compileLayer_.addModule(std::move(M), std::move(resolver)));
+  return cantFail(compileLayer_.addModule(std::move(M), createResolver()));
+}
+
+GlowJIT::ObjectHandle GlowJIT::addObject(std::unique_ptr<MemoryBuffer> obj) {
+  // The object is linked like the objects that are compiled by addModule, so
+  // its symbols are found by findSymbol.
+  return cantFail(objectLayer_.addObject(createObjectBinary(std::move(obj)),
+                                         createResolver()));
 }
 
 void GlowJIT::removeModule(GlowJIT::ModuleHandle H) {
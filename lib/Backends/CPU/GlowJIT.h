@@ -29,6 +29,7 @@
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Mangler.h"
 #include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include <algorithm>
@@ -53,6 +54,12 @@ private:
   RTDyldObjectLinkingLayer objectLayer_;
   IRCompileLayer<decltype(objectLayer_), SimpleCompiler> compileLayer_;
 
+#ifndef FACEBOOK_INTERNAL
+  /// \returns a resolver that looks up the symbols in the code loaded by the
+  /// JIT, and then in the host process.
+  std::shared_ptr<JITSymbolResolver> createResolver();
+#endif
+
 public:
   GlowJIT(llvm::TargetMachine &TM);
 
@@ -63,12 +70,22 @@ public:
 #ifdef FACEBOOK_INTERNAL
   VModuleKey addModule(std::unique_ptr<Module> M);
 
+  /// Load the object file \p obj, which was compiled earlier (e.g. by another
+  /// process) for the target machine of this JIT.
+  VModuleKey addObject(std::unique_ptr<MemoryBuffer> obj);
+
   void removeModule(VModuleKey K);
 #else
   using ModuleHandle = decltype(compileLayer_)::ModuleHandleT;
 
+  using ObjectHandle = decltype(objectLayer_)::ObjHandleT;
+
   ModuleHandle addModule(std::unique_ptr<Module> M);
 
+  /// Load the object file \p obj, which was compiled earlier (e.g. by another
+  /// process) for the target machine of this JIT.
+  ObjectHandle addObject(std::unique_ptr<MemoryBuffer> obj);
+
   void removeModule(ModuleHandle H);
 #endif
 };
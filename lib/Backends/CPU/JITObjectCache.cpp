@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "JITObjectCache.h"
+#include "LLVMIRGen.h"
+#include "ParallelRuntime.h"
+
+#include "glow/IR/IR.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <sstream>
+
+using namespace glow;
+
+extern llvm::cl::opt<bool> cpuWinograd;
+extern llvm::cl::opt<bool> cpuConvGEMM;
+extern llvm::cl::opt<bool> jitSpecializeDims;
+
+namespace {
+/// The first line of the layout files. It must change whenever the format of
+/// the entries or the way the JIT uses them changes.
+const char *cacheFormatTag = "glow-jit-object-cache 2";
+
+/// Write \p data into the file \p path. The data is written into a temporary
+/// file that is then renamed, so readers never see a partial file.
+void writeFileAtomically(const std::string &path, llvm::StringRef data) {
+  int fd;
+  llvm::SmallString<256> tmpPath;
+  if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%%%.tmp", fd, tmpPath)) {
+    return;
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /* shouldClose */ true);
+    os << data;
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(tmpPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(tmpPath, path)) {
+    llvm::sys::fs::remove(tmpPath);
+  }
+}
+
+/// \returns the extension of the object file \p idx of an entry.
+std::string getObjectExt(size_t idx) {
+  return "." + std::to_string(idx) + ".o";
+}
+} // namespace
+
+std::vector<size_t>
+CachedObject::getLayout(const AllocationsInfo &allocationsInfo) {
+  std::vector<size_t> layout(allocationsInfo.valueNumbers_.size());
+  for (auto &I : allocationsInfo.valueNumbers_) {
+    if (I.second.first == AllocationsInfo::ValueKind::Activation) {
+      layout[I.second.second] =
+          allocationsInfo.allocatedAddressed_.lookup(I.first);
+    }
+  }
+  return layout;
+}
+
+std::vector<std::vector<size_t>> CachedObject::encodeSteps(
+    const IRFunction *F,
+    llvm::ArrayRef<std::vector<const Instruction *>> steps) {
+  llvm::DenseMap<const Instruction *, size_t> indices;
+  size_t idx = 0;
+  for (const auto &I : F->getInstrs()) {
+    indices[&I] = idx++;
+  }
+  std::vector<std::vector<size_t>> encoded;
+  for (const auto &step : steps) {
+    encoded.emplace_back();
+    for (const auto *I : step) {
+      encoded.back().push_back(indices.lookup(I));
+    }
+  }
+  return encoded;
+}
+
+std::vector<std::vector<const Instruction *>>
+CachedObject::decodeSteps(const IRFunction *F) const {
+  std::vector<const Instruction *> instrs;
+  for (const auto &I : F->getInstrs()) {
+    instrs.push_back(&I);
+  }
+  std::vector<std::vector<const Instruction *>> decoded;
+  for (const auto &step : steps) {
+    decoded.emplace_back();
+    for (auto idx : step) {
+      assert(idx < instrs.size() && "Invalid instruction index");
+      decoded.back().push_back(instrs[idx]);
+    }
+  }
+  return decoded;
+}
+
+JITObjectCache::JITObjectCache(llvm::StringRef dir) : dir_(dir) {
+  llvm::sys::fs::create_directories(dir_);
+}
+
+std::string JITObjectCache::getPath(llvm::StringRef key,
+                                    llvm::StringRef ext) const {
+  llvm::SmallString<256> path(dir_);
+  llvm::sys::path::append(path, key + ext);
+  return path.str();
+}
+
+std::string JITObjectCache::getKey(const IRFunction *F,
+                                   llvm::TargetMachine &TM, bool emitSteps) {
+  std::string desc;
+  llvm::raw_string_ostream os(desc);
+  os << cacheFormatTag << "\n";
+  os << TM.getTargetTriple().str() << "\n";
+  os << TM.getTargetCPU() << "\n";
+  os << TM.getTargetFeatureString() << "\n";
+  os << "steps: " << emitSteps << "\n";
+  // The options that select the kernels and the way they are parallelized.
+  os << "winograd: " << bool(cpuWinograd) << "\n";
+  os << "conv-gemm: " << bool(cpuConvGEMM) << "\n";
+  os << "specialize: " << bool(jitSpecializeDims) << "\n";
+  os << "threads: " << getCPUNumThreads() << "\n";
+  os << "parallel-instrs: " << shouldRunInstrsInParallel() << "\n";
+  F->dump(os);
+
+  llvm::MD5 hash;
+  hash.update(os.str());
+  // The code is linked with the standard library, so the key must change
+  // whenever the library is rebuilt.
+  auto lib = llvm::MemoryBuffer::getFile(LLVMIRGen::getStandardLibraryPath());
+  if (lib) {
+    hash.update((*lib)->getBuffer());
+  }
+  llvm::MD5::MD5Result result;
+  hash.final(result);
+  llvm::SmallString<32> key;
+  llvm::MD5::stringifyResult(result, key);
+  return key.str();
+}
+
+bool JITObjectCache::load(llvm::StringRef key, CachedObject &entry) const {
+  auto layoutFile = llvm::MemoryBuffer::getFile(getPath(key, ".layout"));
+  if (!layoutFile) {
+    return false;
+  }
+
+  std::istringstream is((*layoutFile)->getBuffer().str());
+  std::string tag;
+  std::getline(is, tag);
+  if (tag != cacheFormatTag) {
+    return false;
+  }
+  std::string field;
+  size_t numObjects, numValues, numSteps;
+  is >> field >> numObjects;
+  is >> field >> entry.activationsMemSize >> field >> numValues;
+  entry.layout.resize(numValues);
+  for (auto &offset : entry.layout) {
+    is >> offset;
+  }
+  is >> field >> numSteps;
+  entry.steps.resize(numSteps);
+  for (auto &step : entry.steps) {
+    size_t numInstrs;
+    is >> numInstrs;
+    step.resize(numInstrs);
+    for (auto &idx : step) {
+      is >> idx;
+    }
+  }
+  if (is.fail()) {
+    return false;
+  }
+  entry.objects.clear();
+  for (size_t i = 0; i < numObjects; i++) {
+    auto objectFile =
+        llvm::MemoryBuffer::getFile(getPath(key, getObjectExt(i)));
+    if (!objectFile) {
+      return false;
+    }
+    entry.objects.push_back(std::move(*objectFile));
+  }
+  return true;
+}
+
+void JITObjectCache::store(llvm::StringRef key,
+                           const CachedObject &entry) const {
+  std::string layout;
+  llvm::raw_string_ostream os(layout);
+  os << cacheFormatTag << "\n";
+  os << "objects " << entry.objects.size() << "\n";
+  os << "activations " << entry.activationsMemSize << "\n";
+  os << "layout " << entry.layout.size();
+  for (auto offset : entry.layout) {
+    os << " " << offset;
+  }
+  os << "\nsteps " << entry.steps.size() << "\n";
+  for (const auto &step : entry.steps) {
+    os << step.size();
+    for (auto idx : step) {
+      os << " " << idx;
+    }
+    os << "\n";
+  }
+
+  // Write the objects first: an entry is only visible once its layout exists.
+  for (size_t i = 0, e = entry.objects.size(); i < e; i++) {
+    writeFileAtomically(getPath(key, getObjectExt(i)),
+                        entry.objects[i]->getBuffer());
+  }
+  writeFileAtomically(getPath(key, ".layout"), os.str());
+}
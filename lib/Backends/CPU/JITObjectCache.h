@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_BACKENDS_CPU_JITOBJECTCACHE_H
+#define GLOW_BACKENDS_CPU_JITOBJECTCACHE_H
+
+#include "AllocationsInfo.h"
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace glow {
+
+class Instruction;
+class IRFunction;
+
+/// The code of a function that was compiled by the CPU backend, together with
+/// the memory layout that the code was compiled for.
+struct CachedObject {
+  /// The object files that contain main and the step functions.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects;
+  /// The amount of memory that is required for the activations.
+  size_t activationsMemSize{0};
+  /// The offsets array of the function (see getLayout).
+  std::vector<size_t> layout;
+  /// The indices of the instructions that are implemented by every step
+  /// function, in the order of IRFunction::getInstrs().
+  std::vector<std::vector<size_t>> steps;
+
+  /// \returns the offsets array of \p allocationsInfo, with zeros in place of
+  /// the addresses of the weights. The weights are not part of the layout,
+  /// because the JIT addresses them with absolute addresses that differ from
+  /// process to process.
+  static std::vector<size_t> getLayout(const AllocationsInfo &allocationsInfo);
+
+  /// Encode the instructions of the steps \p steps of \p F as indices.
+  static std::vector<std::vector<size_t>>
+  encodeSteps(const IRFunction *F,
+              llvm::ArrayRef<std::vector<const Instruction *>> steps);
+
+  /// \returns the instructions of \p F that are implemented by every step.
+  std::vector<std::vector<const Instruction *>>
+  decodeSteps(const IRFunction *F) const;
+};
+
+/// A content-addressed cache of compiled functions on disk. The entries are
+/// keyed by a hash of everything that determines the generated code: the
+/// optimized IR of the function, the target machine, the options of the
+/// backend that change the code and the standard library.
+/// Every entry consists of files in the cache directory: the object files and a
+/// text file with the layout. They are written atomically, so several processes
+/// can share the directory.
+class JITObjectCache final {
+  /// The directory of the cache.
+  std::string dir_;
+
+  /// \returns the path of the file of the entry \p key with the extension \p
+  /// ext.
+  std::string getPath(llvm::StringRef key, llvm::StringRef ext) const;
+
+public:
+  /// Ctor. The entries are stored in the directory \p dir, which is created if
+  /// it does not exist.
+  explicit JITObjectCache(llvm::StringRef dir);
+
+  /// \returns the key of the function \p F compiled for the target machine \p
+  /// TM with the current options of the backend. \p emitSteps is true if the
+  /// instructions are emitted into separate step functions.
+  static std::string getKey(const IRFunction *F, llvm::TargetMachine &TM,
+                            bool emitSteps);
+
+  /// Load the entry \p key into \p entry. \returns false if there is no such
+  /// entry or it can't be read.
+  bool load(llvm::StringRef key, CachedObject &entry) const;
+
+  /// Store \p entry under the key \p key. Failures are ignored, since the
+  /// cache is only an optimization.
+  void store(llvm::StringRef key, const CachedObject &entry) const;
+};
+
+} // namespace glow
+
+#endif // GLOW_BACKENDS_CPU_JITOBJECTCACHE_H
@@ -23,14 +23,18 @@
 #include "glow/IR/IRUtils.h"
 #include "glow/IR/Instrs.h"
 #include "glow/Quantization/Base/Base.h"
+#include "glow/Support/CompileProfile.h"
 
+#include "llvm/CodeGen/ParallelCG.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 
@@ -128,24 +132,21 @@ void LLVMIRGen::loadBaseAddresses(llvm::IRBuilder<> &builder) {
   offsetsArray_ = F->args().begin() + 3;
 }
 
-// Search for the standard library bitcode file on disk and load it into an
-// LLVM module. We search for the standard library around the current executable
-// and also in the current directory.
-static std::unique_ptr<llvm::Module>
-loadStandardLibrary(llvm::LLVMContext *ctx, llvm::StringRef filename) {
+// Search for the standard library bitcode file on disk. We search for the
+// standard library around the current executable and also in the current
+// directory. \returns the path of the file.
+static std::string findStandardLibrary(llvm::StringRef filename) {
   using llvm::sys::path::append;
   using llvm::sys::path::parent_path;
 
-  llvm::SMDiagnostic error;
-
   auto *envPath = getenv("GLOW_LIBJIT_PATH");
   if (envPath != nullptr) {
-    return llvm::parseIRFile(envPath, error, *ctx);
+    return envPath;
   }
 
   // Figure out the location of the current executable.
   auto mainExec =
-      llvm::sys::fs::getMainExecutable(nullptr, (void *)&loadStandardLibrary);
+      llvm::sys::fs::getMainExecutable(nullptr, (void *)&findStandardLibrary);
   llvm::StringRef basePath = parent_path(mainExec);
 
   // Search for the standard library starting at the location of the executable.
@@ -154,20 +155,32 @@ loadStandardLibrary(llvm::LLVMContext *ctx, llvm::StringRef filename) {
     llvm::SmallString<256> libPath(basePath);
     append(libPath, filename);
     if (llvm::sys::fs::exists(libPath)) {
-      auto res = llvm::parseIRFile(libPath, error, *ctx);
-
-      // If we could not parse the bitcode file then print an error.
-      if (!res.get()) {
-        error.print(mainExec.c_str(), llvm::errs());
-      }
-      return res;
+      return libPath.str();
     }
 
     // Go up the filesystem tree.
     basePath = parent_path(basePath);
   }
 
-  return llvm::parseIRFile(filename, error, *ctx);
+  return filename;
+}
+
+// Load the standard library bitcode file into an LLVM module.
+static std::unique_ptr<llvm::Module>
+loadStandardLibrary(llvm::LLVMContext *ctx, llvm::StringRef filename) {
+  llvm::SMDiagnostic error;
+  auto libPath = findStandardLibrary(filename);
+  auto res = llvm::parseIRFile(libPath, error, *ctx);
+
+  // If we could not parse the bitcode file then print an error.
+  if (!res.get()) {
+    error.print(libPath.c_str(), llvm::errs());
+  }
+  return res;
+}
+
+std::string LLVMIRGen::getStandardLibraryPath() {
+  return findStandardLibrary("libjit.bc");
 }
 
 /// Register a diagnostics handler that prevents the compiler from printing to
@@ -238,11 +251,25 @@ llvm::Type *LLVMIRGen::getElementType(llvm::IRBuilder<> &builder,
   return nullptr;
 }
 
+/// \returns the number of LLVM instructions in \p M.
+static size_t countLLVMInstrs(const llvm::Module &M) {
+  size_t count = 0;
+  for (auto &F : M) {
+    for (auto &BB : F) {
+      count += BB.size();
+    }
+  }
+  return count;
+}
+
 void LLVMIRGen::performCodeGen() {
   auto *func = builder_->GetInsertBlock()->getParent();
-  loadBaseAddresses(*builder_);
-
-  generateLLVMIRForModule(*builder_);
+  auto moduleSize = [this]() { return countLLVMInstrs(getModule()); };
+  {
+    CompilePhase phase("generateLLVMIR", "llvm", "llvm_instrs", moduleSize);
+    loadBaseAddresses(*builder_);
+    generateLLVMIRForModule(*builder_);
+  }
 
   // Terminate the function.
   builder_->CreateRetVoid();
@@ -265,7 +292,11 @@ void LLVMIRGen::performCodeGen() {
   }
 
   // Optimize the module.
-  optimizeLLVMModule(func, getTargetMachine());
+  {
+    CompilePhase phase("optimizeLLVMModule", "llvm", "llvm_instrs",
+                       moduleSize);
+    optimizeLLVMModule(func, getTargetMachine());
+  }
 
   // Generate debug information.
   generateDebugInfo();
@@ -288,6 +319,44 @@ void LLVMIRGen::performCodeGen() {
   }
 }
 
+std::vector<std::unique_ptr<llvm::MemoryBuffer>>
+LLVMIRGen::emitObjectFiles(unsigned numThreads) {
+  std::vector<llvm::SmallVector<char, 0>> buffers(numThreads);
+  std::vector<std::unique_ptr<llvm::raw_svector_ostream>> streams;
+  std::vector<llvm::raw_pwrite_stream *> OSs;
+  for (auto &buffer : buffers) {
+    streams.emplace_back(new llvm::raw_svector_ostream(buffer));
+    OSs.push_back(streams.back().get());
+  }
+
+  // Every thread compiles its part with its own copy of the target machine.
+  const llvm::Target &target = TM_->getTarget();
+  std::string triple = TM_->getTargetTriple().str();
+  std::string cpu = TM_->getTargetCPU();
+  std::string features = TM_->getTargetFeatureString();
+  llvm::TargetOptions options = TM_->Options;
+  auto relocModel = TM_->getRelocationModel();
+  auto codeModel = TM_->getCodeModel();
+  auto optLevel = TM_->getOptLevel();
+  auto createTM = [=, &target]() {
+    return std::unique_ptr<llvm::TargetMachine>(target.createTargetMachine(
+        triple, cpu, features, options, relocModel, codeModel, optLevel,
+        /* JIT */ true));
+  };
+
+  // The symbols that are internal to the module become visible to the other
+  // parts when the module is split.
+  llvm::splitCodeGen(std::move(llmodule_), OSs, {}, createTM);
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects;
+  for (size_t i = 0; i < numThreads; i++) {
+    objects.push_back(llvm::MemoryBuffer::getMemBufferCopy(
+        llvm::StringRef(buffers[i].data(), buffers[i].size()),
+        "part" + std::to_string(i)));
+  }
+  return objects;
+}
+
 llvm::Value *LLVMIRGen::emitValueAddress(llvm::IRBuilder<> &builder,
                                          glow::Value *val) {
   assert(allocationsInfo_.allocatedAddressed_.count(val) &&
@@ -694,9 +763,9 @@ void LLVMIRGen::generateLLVMIRForModule(llvm::IRBuilder<> &builder) {
       if (isa<AllocActivationInst>(&I) || isa<DeallocActivationInst>(&I) ||
           isa<TensorViewInst>(&I))
         continue;
-      emitDataParallelKernel(builder, bundle);
+      emitStep(builder, bundle);
       bundle.clear();
-      generateLLVMIRForInstr(builder, &I);
+      emitStep(builder, &I);
       continue;
     }
 
@@ -732,14 +801,70 @@ void LLVMIRGen::generateLLVMIRForModule(llvm::IRBuilder<> &builder) {
     // If the instruction cannot be added to the current bundle, emit the kernel
     // for the current bundle and start a new bundle.
     if (!isBundleCompatible) {
-      emitDataParallelKernel(builder, bundle);
+      emitStep(builder, bundle);
       bundle.clear();
     }
     // Add a data parallel instruction to the bundle.
     bundle.push_back(&I);
   }
 
-  emitDataParallelKernel(builder, bundle);
+  emitStep(builder, bundle);
+}
+
+std::string LLVMIRGen::getStepName(size_t idx) {
+  return "step_" + std::to_string(idx);
+}
+
+void LLVMIRGen::emitStep(llvm::IRBuilder<> &builder,
+                         llvm::ArrayRef<const Instruction *> step) {
+  if (step.empty())
+    return;
+
+  auto emitBody = [&](llvm::IRBuilder<> &bodyBuilder) {
+    llvm::Value *stepId = nullptr;
+    if (instrumentSteps_) {
+      stepId = emitConstSizeT(bodyBuilder, instrumentedSteps_.size());
+      createCall(bodyBuilder, getFunction("trace_begin"), {stepId});
+    }
+    if (step[0]->isDataParallel()) {
+      emitDataParallelKernel(bodyBuilder, step);
+    } else {
+      assert(step.size() == 1 && "Only data parallel instructions are bundled");
+      generateLLVMIRForInstr(bodyBuilder, step[0]);
+    }
+    if (instrumentSteps_) {
+      createCall(bodyBuilder, getFunction("trace_end"), {stepId});
+      instrumentedSteps_.emplace_back(step.begin(), step.end());
+    }
+  };
+
+  if (!emitSteps_) {
+    emitBody(builder);
+    return;
+  }
+
+  // The step function has the same parameters as main, and it computes the
+  // addresses of the buffers relative to its own base address arguments.
+  auto *mainF = builder.GetInsertBlock()->getParent();
+  auto *stepF = llvm::Function::Create(
+      mainF->getFunctionType(), llvm::Function::ExternalLinkage,
+      getStepName(stepFunctions_.size()), llmodule_.get());
+  llvm::BasicBlock *entryBB = llvm::BasicBlock::Create(ctx_, "entry", stepF);
+  llvm::IRBuilder<> stepBuilder(entryBB);
+  loadBaseAddresses(stepBuilder);
+  emitBody(stepBuilder);
+  stepBuilder.CreateRetVoid();
+  stepFunctions_.push_back(stepF);
+  steps_.emplace_back(step.begin(), step.end());
+
+  // Call the step from main with the arguments of main. All of the code of
+  // main is emitted into the steps, so the base addresses that were loaded for
+  // the step are not used by main.
+  llvm::SmallVector<llvm::Value *, 4> args;
+  for (auto &arg : mainF->args()) {
+    args.push_back(&arg);
+  }
+  createCall(builder, stepF, args);
 }
 
 void LLVMIRGen::generateLLVMIRForDataParallelInstr(
@@ -1513,6 +1638,178 @@ void LLVMIRGen::generateLLVMIRForInstr(llvm::IRBuilder<> &builder,
     break;
   }
 
+  case Kinded::Kind::CPUWinogradConvInstKind: {
+    auto *CI = cast<CPUWinogradConvInst>(I);
+    auto *dest = CI->getDest();
+    auto *src = CI->getSrc();
+    auto *filter = CI->getFilter();
+    auto *bias = CI->getBias();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *pads = emitConstArray(builder, CI->getPads());
+    auto *group = emitConstSizeT(builder, CI->getGroup());
+    auto *tileSize = emitConstSizeT(builder, CI->getTileSize());
+
+    auto *F = getFunction("winogradConv", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                filterDims, biasDims, pads, group, tileSize});
+    break;
+  }
+
+  case Kinded::Kind::CPUConvGEMMInstKind: {
+    auto *CI = cast<CPUConvGEMMInst>(I);
+    auto *dest = CI->getDest();
+    auto *src = CI->getSrc();
+    auto *filter = CI->getFilter();
+    auto *bias = CI->getBias();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *kernel = emitConstSizeT(builder, CI->getKernel());
+    auto *stride = emitConstSizeT(builder, CI->getStride());
+    auto *pads = emitConstArray(builder, CI->getPads());
+    auto *group = emitConstSizeT(builder, CI->getGroup());
+
+    auto *F = getFunction("convGEMM", dest->getElementType());
+    createCall(builder, F,
+               {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                filterDims, biasDims, kernel, stride, pads, group});
+    break;
+  }
+
+  case Kinded::Kind::CPUDepthwiseConvInstKind: {
+    auto *CI = cast<CPUDepthwiseConvInst>(I);
+    auto *dest = CI->getDest();
+    auto *src = CI->getSrc();
+    auto *filter = CI->getFilter();
+    auto *bias = CI->getBias();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *kernel = emitConstSizeT(builder, CI->getKernel());
+    auto *stride = emitConstSizeT(builder, CI->getStride());
+    auto *pads = emitConstArray(builder, CI->getPads());
+
+    auto *F = getFunction("depthwiseConv", dest->getElementType());
+
+    if (src->getType()->isQuantizedType()) {
+      auto *destTy = dest->getType();
+      auto *srcTy = src->getType();
+      auto *filterTy = filter->getType();
+      auto *biasTy = bias->getType();
+
+      auto *destOffset = emitConstI32(builder, destTy->getOffset());
+      auto *srcOffset = emitConstI32(builder, srcTy->getOffset());
+      auto *filterOffset = emitConstI32(builder, filterTy->getOffset());
+      auto *biasOffset = emitConstI32(builder, biasTy->getOffset());
+
+      // Calculate the scaling parameters for the bias and the output, like
+      // for the regular quantized convolution.
+      float matMulScale = srcTy->getScale() * filterTy->getScale();
+      auto biasScaleParam = quantization::quantizeScaleOffset32To8(
+          biasTy->getScale() / matMulScale, biasTy->getOffset());
+      auto outScaleParam = quantization::quantizeScaleOffset32To8(
+          matMulScale / destTy->getScale(), 0);
+
+      auto *biasPre = emitConstI32(builder, biasScaleParam.pre);
+      auto *biasPost = emitConstI32(builder, biasScaleParam.post);
+      auto *biasScale = emitConstI32(builder, biasScaleParam.scale);
+      auto *outPre = emitConstI32(builder, outScaleParam.pre);
+      auto *outPost = emitConstI32(builder, outScaleParam.post);
+      auto *outScale = emitConstI32(builder, outScaleParam.scale);
+
+      createCall(builder, F,
+                 {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                  filterDims, biasDims, kernel, stride, pads, destOffset,
+                  srcOffset, filterOffset, biasOffset, biasPre, biasPost,
+                  biasScale, outPre, outPost, outScale});
+    } else {
+      createCall(builder, F,
+                 {destPtr, srcPtr, filterPtr, biasPtr, destDims, srcDims,
+                  filterDims, biasDims, kernel, stride, pads});
+    }
+    break;
+  }
+
+  case Kinded::Kind::CPUQuantizedConvInstKind: {
+    auto *CI = cast<CPUQuantizedConvInst>(I);
+    auto *dest = CI->getDest();
+    auto *src = CI->getSrc();
+    auto *filter = CI->getFilter();
+    auto *bias = CI->getBias();
+    auto *destPtr = emitValueAddress(builder, dest);
+    auto *srcPtr = emitValueAddress(builder, src);
+    auto *filterPtr = emitValueAddress(builder, filter);
+    auto *biasPtr = emitValueAddress(builder, bias);
+
+    auto *destDims = emitValueDims(builder, dest);
+    auto *srcDims = emitValueDims(builder, src);
+    auto *filterDims = emitValueDims(builder, filter);
+    auto *biasDims = emitValueDims(builder, bias);
+
+    auto *kernel = emitConstSizeT(builder, CI->getKernel());
+    auto *stride = emitConstSizeT(builder, CI->getStride());
+    auto *pads = emitConstArray(builder, CI->getPads());
+    auto *group = emitConstSizeT(builder, CI->getGroup());
+
+    auto *destTy = dest->getType();
+    auto *srcTy = src->getType();
+    auto *filterTy = filter->getType();
+    auto *biasTy = bias->getType();
+
+    auto *destOffset = emitConstI32(builder, destTy->getOffset());
+    auto *srcOffset = emitConstI32(builder, srcTy->getOffset());
+    auto *filterOffset = emitConstI32(builder, filterTy->getOffset());
+    auto *biasOffset = emitConstI32(builder, biasTy->getOffset());
+
+    // Calculate the scaling parameters for the bias and the output, like for
+    // the regular quantized convolution.
+    float matMulScale = srcTy->getScale() * filterTy->getScale();
+    auto biasScaleParam = quantization::quantizeScaleOffset32To8(
+        biasTy->getScale() / matMulScale, biasTy->getOffset());
+    auto outScaleParam = quantization::quantizeScaleOffset32To8(
+        matMulScale / destTy->getScale(), 0);
+
+    auto *biasPre = emitConstI32(builder, biasScaleParam.pre);
+    auto *biasPost = emitConstI32(builder, biasScaleParam.post);
+    auto *biasScale = emitConstI32(builder, biasScaleParam.scale);
+    auto *outPre = emitConstI32(builder, outScaleParam.pre);
+    auto *outPost = emitConstI32(builder, outScaleParam.post);
+    auto *outScale = emitConstI32(builder, outScaleParam.scale);
+
+    auto *F = getFunction("quantizedConv", dest->getElementType());
+    createCall(builder, F,
+               {destPtr,    srcPtr,     filterPtr,  biasPtr,   destDims,
+                srcDims,    filterDims, biasDims,   kernel,    stride,
+                pads,       group,      destOffset, srcOffset, filterOffset,
+                biasOffset, biasPre,    biasPost,   biasScale, outPre,
+                outPost,    outScale});
+    break;
+  }
+
   case Kinded::Kind::ConvolutionGradInstKind: {
     auto *CG = cast<ConvolutionGradInst>(I);
     auto *srcGrad = CG->getSrcGrad();
@@ -26,6 +26,7 @@
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Target/TargetMachine.h"
 
 namespace glow {
@@ -118,6 +119,18 @@ class LLVMIRGen {
   /// A set that contains all of the argument that we request from the
   /// specializer not to specialize.
   llvm::DenseSet<llvm::Value *> dontSpecializeArgsSet_;
+  /// If set, every instruction (or bundle of data-parallel instructions) is
+  /// emitted into a separate step function. See setEmitSteps.
+  bool emitSteps_{false};
+  /// The step functions, in the order in which main calls them.
+  std::vector<llvm::Function *> stepFunctions_;
+  /// The instructions that are implemented by each of the step functions.
+  std::vector<std::vector<const Instruction *>> steps_;
+  /// Set if the code reports the time of every step to the host. See
+  /// setInstrumentSteps.
+  bool instrumentSteps_{false};
+  /// The instructions of each of the instrumented steps, by step id.
+  std::vector<std::vector<const Instruction *>> instrumentedSteps_;
 
   /// Generates LLVM IR that computes the address of \p val using \p builder.
   /// The address type is specified by \p ptrTy.
@@ -158,6 +171,12 @@ class LLVMIRGen {
   void
   emitDataParallelKernel(llvm::IRBuilder<> &builder,
                          llvm::ArrayRef<const Instruction *> stackedInstrs);
+  /// Emit the code for \p step, which is either a single instruction or a
+  /// bundle of data-parallel instructions, using \p builder. If the steps are
+  /// emitted as separate functions, then create the step function and emit a
+  /// call to it instead.
+  void emitStep(llvm::IRBuilder<> &builder,
+                llvm::ArrayRef<const Instruction *> step);
   /// Emit IR for the data parallel instruction \p I which is invoked inside the
   /// stacked \p kernel. The current loop count is described by \p loopCount.
   /// The \p bufferToArgNum map can be used to find the required buffers, which
@@ -228,6 +247,9 @@ public:
   std::string getMainEntryName() const;
   /// Set the name of the main entry point.
   void setMainEntryName(std::string name);
+  /// \returns the path of the standard library bitcode file (libjit.bc) that
+  /// is loaded by initCodeGen.
+  static std::string getStandardLibraryPath();
   /// Creates an LLVM module, the entry function, etc.
   void initCodeGen();
   /// Emits the code of the entry function, performs optimizations, etc.
@@ -238,6 +260,13 @@ public:
   llvm::TargetMachine &getTargetMachine() { return *TM_; }
   /// \returns the LLVMContext being used.
   llvm::LLVMContext &getLLVMContext() { return ctx_; }
+  /// Generate the machine code of the module on \p numThreads threads. The
+  /// module is split into \p numThreads parts that are compiled in parallel,
+  /// and the functions of different parts refer to each other by name, so the
+  /// resulting object files must be linked together. \returns the object
+  /// files. The module cannot be used by the LLVMIRGen afterwards.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>>
+  emitObjectFiles(unsigned numThreads);
   /// Borrows the LLVM module for further processing, e.g. by a JIT.
   /// The module cannot be used by the LLVMIRGen afterwards.
   std::unique_ptr<llvm::Module> borrowModule() { return std::move(llmodule_); }
@@ -258,6 +287,30 @@ public:
   llvm::Value *emitStringConst(llvm::IRBuilder<> &builder, llvm::StringRef str);
   /// Register \p val as an argument that should not be specialized.
   void markArgAsUnspecialized(llvm::Value *val);
+  /// Emit every instruction (or bundle of data-parallel instructions) into a
+  /// separate externally visible function named by getStepName, that has the
+  /// same parameters as main. main calls the steps in order, but a JIT can
+  /// also call the steps directly, e.g. to run independent steps in parallel.
+  /// Must be set before performCodeGen.
+  void setEmitSteps(bool emitSteps) { emitSteps_ = emitSteps; }
+  /// \returns the instructions that are implemented by each of the step
+  /// functions. Empty if the steps are not emitted as separate functions.
+  llvm::ArrayRef<std::vector<const Instruction *>> getSteps() const {
+    return steps_;
+  }
+  /// Emit calls to libjit_trace_begin and libjit_trace_end, which notify the
+  /// host, before and after the code of every instruction (or bundle of
+  /// data-parallel instructions). The calls pass the id of the step. Must be
+  /// set before performCodeGen.
+  void setInstrumentSteps(bool instrument) { instrumentSteps_ = instrument; }
+  /// \returns the instructions of each of the instrumented steps, indexed by
+  /// the ids that are passed to libjit_trace_begin and libjit_trace_end.
+  llvm::ArrayRef<std::vector<const Instruction *>>
+  getInstrumentedSteps() const {
+    return instrumentedSteps_;
+  }
+  /// \returns the name of the step function with index \p idx.
+  static std::string getStepName(size_t idx);
 };
 
 } // namespace glow
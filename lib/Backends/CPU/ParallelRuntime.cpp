@@ -0,0 +1,85 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ParallelRuntime.h"
+#include "CommandLine.h"
+
+#include "glow/Support/ThreadPool.h"
+
+#include <algorithm>
+#include <thread>
+
+using namespace glow;
+
+extern llvm::cl::opt<bool> emitDebugInfo;
+
+namespace {
+llvm::cl::opt<unsigned> cpuThreads(
+    "cpu-threads",
+    llvm::cl::desc("Number of threads that the CPU backend kernels split "
+                   "their work across (0 means one thread per core)"),
+    llvm::cl::init(1), llvm::cl::cat(CPUBackendCat));
+
+llvm::cl::opt<bool>
+    cpuThreadAffinity("cpu-thread-affinity",
+                      llvm::cl::desc("Pin the worker threads of the CPU "
+                                     "backend to distinct cores"),
+                      llvm::cl::init(false), llvm::cl::cat(CPUBackendCat));
+
+llvm::cl::opt<bool> cpuParallelInstrs(
+    "cpu-parallel-instrs",
+    llvm::cl::desc("Run independent instructions of the CPU backend in "
+                   "parallel on the threads requested by -cpu-threads"),
+    llvm::cl::init(false), llvm::cl::cat(CPUBackendCat));
+
+/// The signatures of the runtime hooks from libjit_defs.h.
+using TaskFn = void (*)(void *ctx, size_t taskId);
+using ParallelForFn = void (*)(size_t numTasks, TaskFn fn, void *ctx);
+
+/// The dispatcher that is installed into libjit_hook_parallel_for.
+void parallelFor(size_t numTasks, TaskFn fn, void *ctx) {
+  getCPUThreadPool().parallelFor(numTasks, [=](size_t i) { fn(ctx, i); });
+}
+} // namespace
+
+unsigned glow::getCPUNumThreads() {
+  if (cpuThreads == 0) {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+  return cpuThreads;
+}
+
+ThreadPool &glow::getCPUThreadPool() {
+  // The calling thread participates in every parallel loop, so the pool has
+  // one thread less than the number of threads that is requested.
+  static ThreadPool pool(getCPUNumThreads() - 1, cpuThreadAffinity);
+  return pool;
+}
+
+bool glow::shouldRunInstrsInParallel() {
+  // The debug info describes a single entry function, so the instructions
+  // are not split into steps when it is requested.
+  return cpuParallelInstrs && getCPUNumThreads() > 1 && !emitDebugInfo;
+}
+
+void glow::installParallelRuntime(llvm::orc::GlowJIT &JIT) {
+  unsigned numThreads = getCPUNumThreads();
+  if (numThreads == 1) {
+    return;
+  }
+  setRuntimeHook<ParallelForFn>(JIT, "libjit_hook_parallel_for", &parallelFor);
+  setRuntimeHook<size_t>(JIT, "libjit_hook_num_threads", numThreads);
+}
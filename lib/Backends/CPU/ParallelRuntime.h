@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_BACKENDS_CPU_PARALLELRUNTIME_H
+#define GLOW_BACKENDS_CPU_PARALLELRUNTIME_H
+
+#include "GlowJIT.h"
+
+#include "glow/Support/Compiler.h"
+
+namespace glow {
+
+class ThreadPool;
+
+/// \returns the number of threads that the CPU backend kernels split their
+/// work across, as requested by the -cpu-threads option.
+unsigned getCPUNumThreads();
+
+/// \returns the thread pool that runs the kernel tasks and the steps of the
+/// CPU backend.
+ThreadPool &getCPUThreadPool();
+
+/// \returns true if the independent instructions of a function should be run
+/// in parallel, as requested by the -cpu-parallel-instrs option.
+bool shouldRunInstrsInParallel();
+
+/// Write \p value into the runtime hook \p name, a global variable of the
+/// code loaded by \p JIT (see libjit_defs.h). Hooks that were not linked into
+/// the module are ignored.
+template <typename T>
+void setRuntimeHook(llvm::orc::GlowJIT &JIT, const char *name, T value) {
+  auto sym = JIT.findSymbol(name);
+  if (!sym) {
+    return;
+  }
+  auto address = sym.getAddress();
+  GLOW_ASSERT(address && "Error getting address.");
+  *reinterpret_cast<T *>(address.get()) = value;
+}
+
+/// Connect the code loaded by \p JIT to the thread pool of the CPU backend by
+/// writing the runtime hooks of libjit (see libjit_defs.h). This is a no-op
+/// when the kernels are configured to run on a single thread.
+void installParallelRuntime(llvm::orc::GlowJIT &JIT);
+
+} // end namespace glow
+
+#endif // GLOW_BACKENDS_CPU_PARALLELRUNTIME_H
@@ -64,6 +64,10 @@ void LLVMIRGen::optimizeLLVMModule(llvm::Function *F, llvm::TargetMachine &TM) {
     // Do not internalize declarations.
     if (GV.isDeclaration())
       return true;
+    // The runtime hooks are written by the host after the code is loaded, so
+    // they must stay visible and must not be constant folded.
+    if (name.startswith("libjit_hook_"))
+      return true;
     // Do not preserve any internal symbols, which typically have no name or
     // start with jit_
     if (name.empty() || name.startswith("libjit_"))
@@ -82,6 +86,12 @@ void LLVMIRGen::optimizeLLVMModule(llvm::Function *F, llvm::TargetMachine &TM) {
     FF.removeFnAttr(llvm::Attribute::AttrKind::NoInline);
   }
 
+  // The steps are called by the JIT on their own, so inlining them into main
+  // would only duplicate their code.
+  for (auto *stepF : stepFunctions_) {
+    stepF->addFnAttr(llvm::Attribute::AttrKind::NoInline);
+  }
+
   // Perform specialization of functions for constant arguments before anything
   // else.
   performSpecialization();
@@ -120,9 +130,9 @@ void LLVMIRGen::optimizeLLVMModule(llvm::Function *F, llvm::TargetMachine &TM) {
   }
 
   // The "main" function is parameterized by the base addresses of memory areas
-  // and it is always invoked from either the "jitmain" function or the AOT
-  // entry point. To enable better LLVM optimizations "main" should always be
-  // inlined.
+  // and the offsets array. The JIT calls it directly, with the addresses of the
+  // memory of the execution. In bundles it is always invoked from the AOT
+  // entry point, and to enable better LLVM optimizations it should be inlined.
   M->getFunction("main")->addFnAttr(llvm::Attribute::AttrKind::AlwaysInline);
 
   llvm::legacy::FunctionPassManager FPM(M);
@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ProfilingRuntime.h"
+#include "CommandLine.h"
+#include "ParallelRuntime.h"
+
+#include "glow/IR/IRUtils.h"
+#include "glow/IR/Instrs.h"
+
+using namespace glow;
+
+namespace {
+llvm::cl::opt<std::string>
+    cpuProfile("cpu-profile",
+               llvm::cl::desc("Time every instruction of the code generated "
+                              "by the CPU backend, and write a Chrome trace "
+                              "of the executions into the file"),
+               llvm::cl::value_desc("file.json"), llvm::cl::cat(CPUBackendCat));
+
+llvm::cl::opt<std::string> cpuProfileSummary(
+    "cpu-profile-summary",
+    llvm::cl::desc("Time every instruction of the code generated by the CPU "
+                   "backend, and write the total time of every instruction "
+                   "into the file"),
+    llvm::cl::value_desc("file.txt"), llvm::cl::cat(CPUBackendCat));
+
+/// The signature of the tracing hooks from libjit_defs.h.
+using TraceFn = void (*)(void *ctx, size_t stepId);
+
+/// The samples of the steps that are running on this thread. The steps on a
+/// thread end in the reverse order in which they begin, even if a thread that
+/// waits for the tasks of a step runs other steps in the meantime.
+thread_local std::vector<ExecutionProfile::Sample> runningSteps;
+
+/// The tracing hooks that are installed into libjit_hook_trace_begin and
+/// libjit_hook_trace_end. \p ctx is the StepProfile of the function.
+void traceBegin(void *ctx, size_t stepId) {
+  static_cast<const StepProfile *>(ctx)->begin(stepId);
+}
+
+void traceEnd(void *ctx, size_t stepId) {
+  static_cast<const StepProfile *>(ctx)->end(stepId);
+}
+} // namespace
+
+StepProfile::StepProfile(
+    llvm::ArrayRef<std::vector<const Instruction *>> steps) {
+  for (const auto &step : steps) {
+    assert(!step.empty() && "Empty steps are not emitted");
+    std::string name = step[0]->getName().str();
+    for (size_t i = 1, e = step.size(); i < e; i++) {
+      name += "+" + step[i]->getName().str();
+    }
+    names_.push_back(name);
+    // Bundles of data-parallel instructions are fused into a single kernel.
+    kinds_.push_back(step.size() == 1 ? step[0]->getKindName()
+                                      : "DataParallelBundle");
+    ExecutionProfile::InstrCost cost;
+    for (const auto *I : step) {
+      if (auto *CI = llvm::dyn_cast<CPUConvDKKC8Inst>(I)) {
+        cost.flops += getConvolutionFLOPs(CI->getDest(), CI->getFilter());
+      } else if (auto *CI = llvm::dyn_cast<CPUQuantizedConvInst>(I)) {
+        // The packed filter is padded, so count the channels of the input.
+        size_t kernel = CI->getKernel();
+        size_t inCperG = CI->getSrc()->dims()[3] / CI->getGroup();
+        cost.flops += 2 * CI->getDest()->size() * kernel * kernel * inCperG;
+      } else if (auto *CI = llvm::dyn_cast<CPUConvGEMMInst>(I)) {
+        size_t kernel = CI->getKernel();
+        size_t inCperG = CI->getSrc()->dims()[3] / CI->getGroup();
+        cost.flops += 2 * CI->getDest()->size() * kernel * kernel * inCperG;
+      } else if (auto *CI = llvm::dyn_cast<CPUDepthwiseConvInst>(I)) {
+        size_t kernel = CI->getKernel();
+        cost.flops += 2 * CI->getDest()->size() * kernel * kernel;
+      } else if (auto *CI = llvm::dyn_cast<CPUWinogradConvInst>(I)) {
+        // Count the FLOPs of the direct convolution, so that the GFLOP/s are
+        // comparable with the other convolutions.
+        size_t inCperG = CI->getSrc()->dims()[3] / CI->getGroup();
+        cost.flops += 2 * CI->getDest()->size() * 3 * 3 * inCperG;
+      } else {
+        cost.flops += estimateFLOPs(I);
+      }
+      cost.bytes += getOperandsSizeInBytes(I);
+    }
+    costs_.push_back(cost);
+  }
+}
+
+void StepProfile::begin(size_t stepId) const {
+  (void)stepId;
+  runningSteps.push_back(getCPUProfile().sample());
+}
+
+void StepProfile::end(size_t stepId) const {
+  auto &profile = getCPUProfile();
+  auto end = profile.sample();
+  assert(!runningSteps.empty() && "The step did not begin");
+  assert(stepId < names_.size() && "Invalid step id");
+  profile.addEvent(names_[stepId], kinds_[stepId], runningSteps.back(), end,
+                   costs_[stepId]);
+  runningSteps.pop_back();
+}
+
+bool glow::shouldProfileInstrs() {
+  return !cpuProfile.empty() || !cpuProfileSummary.empty();
+}
+
+ExecutionProfile &glow::getCPUProfile() {
+  static ExecutionProfile profile("cpu");
+  return profile;
+}
+
+void glow::installProfilingRuntime(llvm::orc::GlowJIT &JIT,
+                                   const StepProfile &steps) {
+  // The files are written when the profile is destroyed at exit.
+  getCPUProfile().setOutputFiles(cpuProfile, cpuProfileSummary);
+  setRuntimeHook<TraceFn>(JIT, "libjit_hook_trace_begin", &traceBegin);
+  setRuntimeHook<TraceFn>(JIT, "libjit_hook_trace_end", &traceEnd);
+  setRuntimeHook<const void *>(JIT, "libjit_hook_trace_ctx", &steps);
+}
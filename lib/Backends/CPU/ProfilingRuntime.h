@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef GLOW_BACKENDS_CPU_PROFILINGRUNTIME_H
+#define GLOW_BACKENDS_CPU_PROFILINGRUNTIME_H
+
+#include "GlowJIT.h"
+
+#include "glow/Support/ExecutionProfile.h"
+
+#include "llvm/ADT/ArrayRef.h"
+
+#include <string>
+#include <vector>
+
+namespace glow {
+
+class Instruction;
+
+/// The instrumented steps of a compiled function (see
+/// LLVMIRGen::setInstrumentSteps). The code notifies the StepProfile when the
+/// steps begin and end, and the steps are recorded in the profile of the CPU
+/// backend.
+class StepProfile final {
+  /// The name of each of the steps, by step id.
+  std::vector<std::string> names_;
+  /// The kind of each of the steps, by step id.
+  std::vector<std::string> kinds_;
+  /// The estimated work of each of the steps, by step id.
+  std::vector<ExecutionProfile::InstrCost> costs_;
+
+public:
+  /// Ctor. \p steps are the instructions of the steps, by step id.
+  explicit StepProfile(llvm::ArrayRef<std::vector<const Instruction *>> steps);
+
+  /// Called when the step \p stepId begins on the calling thread.
+  void begin(size_t stepId) const;
+
+  /// Called when the step \p stepId ends on the calling thread.
+  void end(size_t stepId) const;
+};
+
+/// \returns true if the instructions of the compiled functions should be
+/// profiled, as requested by the -cpu-profile and -cpu-profile-summary
+/// options.
+bool shouldProfileInstrs();
+
+/// \returns the profile of the instructions of all of the functions that are
+/// run by the CPU backend.
+ExecutionProfile &getCPUProfile();
+
+/// Report the times of the steps of the code loaded by \p JIT to \p steps, by
+/// writing the tracing hooks of libjit (see libjit_defs.h).
+void installProfilingRuntime(llvm::orc::GlowJIT &JIT, const StepProfile &steps);
+
+} // end namespace glow
+
+#endif // GLOW_BACKENDS_CPU_PROFILINGRUNTIME_H
@@ -15,14 +15,250 @@
  */
 
 #include "CPUBackend.h"
+#include "CommandLine.h"
 
 #include "glow/Graph/Graph.h"
 #include "glow/Graph/Nodes.h"
 
+#include <algorithm>
+
 using namespace glow;
 using llvm::dyn_cast;
 using llvm::isa;
 
+llvm::cl::opt<bool> cpuWinograd(
+    "cpu-winograd",
+    llvm::cl::desc("Compute the 3x3 float convolutions with stride 1 with the "
+                   "Winograd algorithm"),
+    llvm::cl::init(true), llvm::cl::cat(CPUBackendCat));
+
+llvm::cl::opt<bool> cpuConvGEMM(
+    "cpu-conv-gemm",
+    llvm::cl::desc("Compute the float convolutions as matrix multiplications "
+                   "of the input patches (im2col) with the filter"),
+    llvm::cl::init(true), llvm::cl::cat(CPUBackendCat));
+
+/// Try to optimize the depthwise Convolution, whose group is the number of
+/// input channels, into a target-specific convolution whose filter is
+/// transposed to the layout [K, K, D]. Every group has a single input channel,
+/// so the generic kernels can't vectorize across the channels of a group, but
+/// the channels are contiguous in the input, the transposed filter and the
+/// output.
+static Node *optimizeCPUDepthwiseConv(ConvolutionNode *CN, Function *F) {
+  auto *M = F->getParent();
+  auto group = CN->getGroup();
+  auto kernel = CN->getKernel();
+  ShapeNHWC idim(CN->getInput().dims());
+  ShapeNHWC odim(CN->getResult().dims());
+
+  if (group == 1 || group != idim.c) {
+    return nullptr;
+  }
+
+  ElemKind kind = CN->getResult().getElementType();
+  if ((kind != ElemKind::FloatTy && kind != ElemKind::Int8QTy) ||
+      CN->getInput().getElementType() != kind ||
+      CN->getBias().getElementType() != kind) {
+    return nullptr;
+  }
+
+  Variable *filter = dyn_cast<Variable>(CN->getFilter());
+  if (!filter || filter->getNumUsers() != 1 || !filter->isPrivate() ||
+      filter->getElementType() != kind) {
+    // Can't mutate the filter.
+    return nullptr;
+  }
+
+  TypeRef filterTy = filter->getType();
+  Variable *transposed;
+  if (kind == ElemKind::Int8QTy) {
+    transposed = M->createVariable(kind, {kernel, kernel, odim.c},
+                                   filterTy->getScale(), filterTy->getOffset(),
+                                   filter->getName(), VisibilityKind::Private,
+                                   false);
+    auto TH = transposed->getHandle<int8_t>();
+    auto FH = filter->getHandle<int8_t>();
+    for (size_t d = 0; d < odim.c; d++)
+      for (size_t x = 0; x < kernel; x++)
+        for (size_t y = 0; y < kernel; y++) {
+          TH.at({x, y, d}) = FH.at({d, x, y, 0});
+        }
+  } else {
+    transposed = M->createVariable(kind, {kernel, kernel, odim.c},
+                                   filter->getName(), VisibilityKind::Private,
+                                   false);
+    auto TH = transposed->getHandle();
+    auto FH = filter->getHandle();
+    for (size_t d = 0; d < odim.c; d++)
+      for (size_t x = 0; x < kernel; x++)
+        for (size_t y = 0; y < kernel; y++) {
+          TH.at({x, y, d}) = FH.at({d, x, y, 0});
+        }
+  }
+
+  return F->addNode(new CPUDepthwiseConvNode(
+      CN->getName(), CN->getResult().getType(), CN->getInput(), transposed,
+      CN->getBias(), kernel, CN->getStride(), CN->getPads()));
+}
+
+/// The filter transforms G of the Winograd convolutions F(2x2, 3x3) and
+/// F(4x4, 3x3), whose input tiles are 4x4 and 6x6 pixels.
+static const double winogradG2[4][3] = {
+    {1, 0, 0}, {0.5, 0.5, 0.5}, {0.5, -0.5, 0.5}, {0, 0, 1}};
+static const double winogradG4[6][3] = {{1. / 4, 0, 0},
+                                        {-1. / 6, -1. / 6, -1. / 6},
+                                        {-1. / 6, 1. / 6, -1. / 6},
+                                        {1. / 24, 1. / 12, 1. / 6},
+                                        {1. / 24, -1. / 12, 1. / 6},
+                                        {0, 0, 1}};
+
+/// Try to optimize the 3x3 float Convolution with stride 1 into a Winograd
+/// convolution F(m x m, 3 x 3), which computes tiles of m x m output pixels
+/// with 2-4x fewer multiplications. The filter is transformed into the tiles
+/// U = G g G^T, which are stored with the layout [G, A * A, D/16, C, 16],
+/// where A = m + 2 is the size of the input tiles. The kernel multiplies the
+/// input tiles with U separately for every element of the tiles, and the
+/// strips of 16 output channels are contiguous for its vector loads.
+static Node *optimizeCPUWinogradConv(ConvolutionNode *CN, Function *F) {
+  auto *M = F->getParent();
+  auto group = CN->getGroup();
+
+  if (!cpuWinograd || CN->getKernel() != 3 || CN->getStride() != 1 ||
+      CN->getResult().getElementType() != ElemKind::FloatTy) {
+    return nullptr;
+  }
+
+  Variable *filter = dyn_cast<Variable>(CN->getFilter());
+  if (!filter || filter->getNumUsers() != 1 || !filter->isPrivate() ||
+      filter->getElementType() != ElemKind::FloatTy) {
+    // Can't mutate the filter.
+    return nullptr;
+  }
+
+  // The transforms of the tiles are amortized over the channels, and most of
+  // the tiles of a small output are padding. Leave these layers to the
+  // direct kernels.
+  ShapeNHWC idim(CN->getInput().dims());
+  ShapeNHWC odim(CN->getResult().dims());
+  size_t inCperG = idim.c / group;
+  size_t outCperG = odim.c / group;
+  if (inCperG < 8 || outCperG < 8 || odim.h < 4 || odim.w < 4) {
+    return nullptr;
+  }
+
+  // F(4x4, 3x3) needs fewer multiplications, unless its tiles are mostly
+  // padding, where both algorithms need the same number.
+  size_t tileSize = (odim.h < 6 || odim.w < 6) ? 2 : 4;
+  size_t alpha = tileSize + 2;
+  size_t strips = (outCperG + 15) / 16;
+
+  // Every task of the kernel keeps at least 6 tiles on its stack.
+  if (alpha * alpha * 6 * (inCperG + strips * 16) * sizeof(float) >
+      (2 << 20)) {
+    return nullptr;
+  }
+
+  auto *transformed = M->createVariable(
+      ElemKind::FloatTy, {group, alpha * alpha, strips, inCperG, 16},
+      filter->getName(), VisibilityKind::Private, false);
+
+  auto UH = transformed->getHandle();
+  auto FH = filter->getHandle();
+  UH.clear(0);
+  const double(*G)[3] = tileSize == 2 ? winogradG2 : winogradG4;
+  for (size_t d = 0; d < odim.c; d++) {
+    size_t g = d / outCperG;
+    size_t s = (d % outCperG) / 16;
+    for (size_t c = 0; c < inCperG; c++) {
+      // Compute U = G g G^T in double precision.
+      double Gg[6][3];
+      for (size_t i = 0; i < alpha; i++)
+        for (size_t j = 0; j < 3; j++) {
+          Gg[i][j] = 0;
+          for (size_t k = 0; k < 3; k++) {
+            Gg[i][j] += G[i][k] * FH.at({d, k, j, c});
+          }
+        }
+      for (size_t i = 0; i < alpha; i++)
+        for (size_t j = 0; j < alpha; j++) {
+          double u = 0;
+          for (size_t k = 0; k < 3; k++) {
+            u += Gg[i][k] * G[j][k];
+          }
+          UH.at({g, i * alpha + j, s, c, d % outCperG % 16}) = u;
+        }
+    }
+  }
+
+  return F->addNode(new CPUWinogradConvNode(
+      CN->getName(), CN->getResult().getType(), CN->getInput(), transformed,
+      CN->getBias(), CN->getPads(), group, tileSize));
+}
+
+/// Try to optimize the float Convolution into a matrix multiplication of the
+/// input patches (im2col) with the filter, which is transposed to the layout
+/// [G, K, K, C, D/G], so that the filter of a group is a (K * K * C) x D/G
+/// matrix. The register-blocked GEMM is several times faster than the direct
+/// kernels for most shapes, including the ones with few channels, because the
+/// patches of many pixels share the loads of the filter.
+static Node *optimizeCPUConvGEMM(ConvolutionNode *CN, Function *F) {
+  auto *M = F->getParent();
+  auto group = CN->getGroup();
+  auto kernel = CN->getKernel();
+
+  if (!cpuConvGEMM || CN->getResult().getElementType() != ElemKind::FloatTy) {
+    return nullptr;
+  }
+
+  Variable *filter = dyn_cast<Variable>(CN->getFilter());
+  if (!filter || filter->getNumUsers() != 1 || !filter->isPrivate() ||
+      filter->getElementType() != ElemKind::FloatTy) {
+    // Can't mutate the filter.
+    return nullptr;
+  }
+
+  ShapeNHWC idim(CN->getInput().dims());
+  ShapeNHWC odim(CN->getResult().dims());
+  size_t inCperG = idim.c / group;
+  size_t outCperG = odim.c / group;
+
+  // The kernel gathers the patches of a block of pixels into a buffer of 256K
+  // floats on its stack (gemmBufferSize in libjit_conv.cpp), and the block
+  // holds at least one pixel, so a larger patch would overflow the stack.
+  if (kernel * kernel * inCperG > 256 * 1024) {
+    return nullptr;
+  }
+
+  // The GEMM of a single output pixel is a vector-matrix product, which
+  // streams the whole filter for a single row. The direct kernels are faster
+  // when the filter does not fit in the cache, or when they can skip the taps
+  // of the filter that fall on the padding.
+  auto pads = CN->getPads();
+  bool padded = std::any_of(pads.begin(), pads.end(),
+                            [](size_t pad) { return pad != 0; });
+  size_t filterSize = kernel * kernel * inCperG * outCperG * sizeof(float);
+  if (odim.h * odim.w == 1 && (padded || filterSize > (2 << 20))) {
+    return nullptr;
+  }
+
+  auto *transformed = M->createVariable(
+      ElemKind::FloatTy, {group, kernel, kernel, inCperG, outCperG},
+      filter->getName(), VisibilityKind::Private, false);
+
+  auto TH = transformed->getHandle();
+  auto FH = filter->getHandle();
+  for (size_t d = 0; d < odim.c; d++)
+    for (size_t x = 0; x < kernel; x++)
+      for (size_t y = 0; y < kernel; y++)
+        for (size_t c = 0; c < inCperG; c++) {
+          TH.at({d / outCperG, x, y, c, d % outCperG}) = FH.at({d, x, y, c});
+        }
+
+  return F->addNode(new CPUConvGEMMNode(
+      CN->getName(), CN->getResult().getType(), CN->getInput(), transformed,
+      CN->getBias(), kernel, CN->getStride(), CN->getPads(), group));
+}
+
 /// Try to optimize the regular Convolution into a target-specific convolution
 /// with a different filter memory layout. This optimization adds a new kind of
 /// cpu-specific convolution that operates on filter weight data in a
@@ -79,17 +315,105 @@ static Node *optimizeCPUConv(ConvolutionNode *CN, Function *F) {
       CN->getBias(), CN->getKernel(), CN->getStride(), CN->getPads(), group));
 }
 
+/// Try to optimize the quantized Convolution into a target-specific
+/// convolution with a packed filter. The output channels of every group are
+/// split into strips of 16 channels, and the input channels into pairs, so
+/// that the layout of the filter is [D/16, K, K, C/2, 16, 2], where D and C
+/// are rounded up per group. The kernel loads the pairs of all channels of a
+/// strip with two vector loads, and multiplies them with pairs of input
+/// channels. The padding holds the offset of the filter, i.e. zero.
+static Node *optimizeCPUQuantizedConv(ConvolutionNode *CN, Function *F) {
+  auto *M = F->getParent();
+  auto group = CN->getGroup();
+  auto kernel = CN->getKernel();
+
+  if (CN->getInput().getElementType() != ElemKind::Int8QTy ||
+      CN->getBias().getElementType() != ElemKind::Int8QTy ||
+      CN->getResult().getElementType() != ElemKind::Int8QTy) {
+    return nullptr;
+  }
+
+  Variable *filter = dyn_cast<Variable>(CN->getFilter());
+  if (!filter || filter->getNumUsers() != 1 || !filter->isPrivate() ||
+      filter->getElementType() != ElemKind::Int8QTy) {
+    // Can't mutate the filter.
+    return nullptr;
+  }
+
+  ShapeNHWC idim(CN->getInput().dims());
+  ShapeNHWC odim(CN->getResult().dims());
+  size_t inCperG = idim.c / group;
+  size_t outCperG = odim.c / group;
+  size_t strips = (outCperG + 15) / 16;
+  size_t cPairs = (inCperG + 1) / 2;
+
+  // Every task of the kernel keeps the input rows of an output row on its
+  // stack. Leave very wide layers to the generic kernel.
+  size_t rowWidth = (odim.w - 1) * CN->getStride() + kernel;
+  if (kernel * rowWidth * cPairs * sizeof(int32_t) > (1 << 20)) {
+    return nullptr;
+  }
+
+  TypeRef filterTy = filter->getType();
+  auto *packed = M->createVariable(
+      ElemKind::Int8QTy, {group * strips, kernel, kernel, cPairs, 16, 2},
+      filterTy->getScale(), filterTy->getOffset(), filter->getName(),
+      VisibilityKind::Private, false);
+
+  auto PH = packed->getHandle<int8_t>();
+  auto FH = filter->getHandle<int8_t>();
+  PH.clear(filterTy->getOffset());
+  for (size_t d = 0; d < odim.c; d++) {
+    size_t g = d / outCperG;
+    size_t s = g * strips + (d % outCperG) / 16;
+    for (size_t x = 0; x < kernel; x++)
+      for (size_t y = 0; y < kernel; y++)
+        for (size_t c = 0; c < inCperG; c++) {
+          PH.at({s, x, y, c / 2, d % outCperG % 16, c % 2}) =
+              FH.at({d, x, y, c});
+        }
+  }
+
+  return F->addNode(new CPUQuantizedConvNode(
+      CN->getName(), CN->getResult().getType(), CN->getInput(), packed,
+      CN->getBias(), kernel, CN->getStride(), CN->getPads(), group));
+}
+
 bool CPUBackend::transformPostLowering(Function *F,
                                        CompilationMode mode) const {
   bool changed = false;
   for (auto &node : F->getNodes()) {
 
     if (auto *CN = dyn_cast<ConvolutionNode>(&node)) {
+      // Select the algorithm of the convolution by its shape: the depthwise
+      // kernel for the layers with one input channel per group, Winograd for
+      // the 3x3 layers with stride 1, GEMM for the other float layers, and the
+      // DKKC8 or the direct kernels for the layers that they reject.
+      if (Node *NCN = optimizeCPUDepthwiseConv(CN, F)) {
+        NodeValue(&node, 0).replaceAllUsesOfWith(NCN);
+        changed = true;
+        continue;
+      }
+      if (Node *NCN = optimizeCPUWinogradConv(CN, F)) {
+        NodeValue(&node, 0).replaceAllUsesOfWith(NCN);
+        changed = true;
+        continue;
+      }
+      if (Node *NCN = optimizeCPUConvGEMM(CN, F)) {
+        NodeValue(&node, 0).replaceAllUsesOfWith(NCN);
+        changed = true;
+        continue;
+      }
       if (Node *NCN = optimizeCPUConv(CN, F)) {
         NodeValue(&node, 0).replaceAllUsesOfWith(NCN);
         changed = true;
         continue;
       }
+      if (Node *NCN = optimizeCPUQuantizedConv(CN, F)) {
+        NodeValue(&node, 0).replaceAllUsesOfWith(NCN);
+        changed = true;
+        continue;
+      }
     }
     if (auto *MN = dyn_cast<MaxNode>(&node)) {
       if (auto *splat = dyn_cast<SplatNode>(MN->getLHS())) {
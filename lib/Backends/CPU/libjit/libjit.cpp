@@ -459,11 +459,15 @@ void libjit_pool_max_generic(const T *inW, T *outW, const size_t *inWdims,
                              size_t stride, size_t *pads) {
   size_t pad_t = pads[0];
   size_t pad_l = pads[1];
-  // For each sample in the batch:
-  for (size_t n = 0; n < outWdims[0]; n++) {
+  // Split the rows of every sample in the batch between the threads.
+  libjit_nhwc_split split(outWdims[0], outWdims[1], 1);
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], 1, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
     // For each (x,y) step in the input/output tensor:
-    ssize_t x = -(ssize_t)pad_t;
-    for (size_t ax = 0; ax < outWdims[1]; x += stride, ax++) {
+    ssize_t x = (ssize_t)(axBegin * stride) - (ssize_t)pad_t;
+    for (size_t ax = axBegin; ax < axEnd; x += stride, ax++) {
       ssize_t y = -(ssize_t)pad_l;
       for (size_t ay = 0; ay < outWdims[2]; y += stride, ay++) {
 
@@ -498,7 +502,8 @@ void libjit_pool_max_generic(const T *inW, T *outW, const size_t *inWdims,
         } // C
       }   // W
     }     // H
-  }       // N
+  };
+  libjit_parallel_for(split.numTasks, task);
 }
 
 template <typename T>
@@ -507,12 +512,16 @@ void libjit_pool_max_xy_generic(const T *inW, T *outW, size_t *inXY,
                                 size_t kernel, size_t stride, size_t *pads) {
   size_t pad_t = pads[0];
   size_t pad_l = pads[1];
-  // For each input in the batch:
-  for (size_t n = 0; n < outWdims[0]; n++) {
+  // Split the rows of every sample in the batch between the threads.
+  libjit_nhwc_split split(outWdims[0], outWdims[1], 1);
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], 1, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
 
     // For each (x,y) step in the input/output tensor:
-    ssize_t x = -(ssize_t)pad_t;
-    for (size_t ax = 0; ax < outWdims[1]; x += stride, ax++) {
+    ssize_t x = (ssize_t)(axBegin * stride) - (ssize_t)pad_t;
+    for (size_t ax = axBegin; ax < axEnd; x += stride, ax++) {
       ssize_t y = -(ssize_t)pad_l;
       for (size_t ay = 0; ay < outWdims[2]; y += stride, ay++) {
 
@@ -553,13 +562,37 @@ void libjit_pool_max_xy_generic(const T *inW, T *outW, size_t *inXY,
         } // C
       }   // W
     }     // H
-  }       // N
+  };
+  libjit_parallel_for(split.numTasks, task);
 }
 
 } // namespace
 
 extern "C" {
 
+/// The runtime hooks declared in libjit_defs.h. The host overrides them after
+/// the code is loaded to enable intra-op parallelism.
+libjit_parallel_for_fn libjit_hook_parallel_for = nullptr;
+size_t libjit_hook_num_threads = 1;
+libjit_trace_fn libjit_hook_trace_begin = nullptr;
+libjit_trace_fn libjit_hook_trace_end = nullptr;
+void *libjit_hook_trace_ctx = nullptr;
+
+/// Notify the host that the step \p stepId begins. The calls are emitted
+/// around the steps when the code is instrumented.
+void libjit_trace_begin(size_t stepId) {
+  if (libjit_hook_trace_begin) {
+    libjit_hook_trace_begin(libjit_hook_trace_ctx, stepId);
+  }
+}
+
+/// Notify the host that the step \p stepId ends.
+void libjit_trace_end(size_t stepId) {
+  if (libjit_hook_trace_end) {
+    libjit_hook_trace_end(libjit_hook_trace_ctx, stepId);
+  }
+}
+
 /// Macro to define a mini-kernel for data-parallel operations. The body of the
 /// kernel is auto-generated by the macro.
 /// \p name the name of the kernel
@@ -983,11 +1016,15 @@ void libjit_pool_avg_i8(const int8_t *inW, int8_t *outW, const size_t *inWdims,
                         int32_t outScale) {
   size_t pad_t = pads[0];
   size_t pad_l = pads[1];
-  // For each input in the batch:
-  for (size_t n = 0; n < outWdims[0]; n++) {
+  // Split the rows of every sample in the batch between the threads.
+  libjit_nhwc_split split(outWdims[0], outWdims[1], 1);
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], 1, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
     // For each (x,y) step in the input/output tensor:
-    ssize_t x = -ssize_t(pad_t);
-    for (size_t ax = 0; ax < outWdims[1]; x += stride, ax++) {
+    ssize_t x = (ssize_t)(axBegin * stride) - (ssize_t)pad_t;
+    for (size_t ax = axBegin; ax < axEnd; x += stride, ax++) {
       ssize_t y = -ssize_t(pad_l);
       for (size_t ay = 0; ay < outWdims[2]; y += stride, ay++) {
         // For each layer in the output tensor:
@@ -1015,7 +1052,8 @@ void libjit_pool_avg_i8(const int8_t *inW, int8_t *outW, const size_t *inWdims,
         } // C
       }   // W
     }     // H
-  }       // N
+  };
+  libjit_parallel_for(split.numTasks, task);
 }
 
 void libjit_pool_avg_f(const float *inW, float *outW, const size_t *inWdims,
@@ -1024,11 +1062,15 @@ void libjit_pool_avg_f(const float *inW, float *outW, const size_t *inWdims,
   size_t pad_t = pads[0];
   size_t pad_l = pads[1];
   float filterArea = filterSize * filterSize;
-  // For each input in the batch:
-  for (size_t n = 0; n < outWdims[0]; n++) {
+  // Split the rows of every sample in the batch between the threads.
+  libjit_nhwc_split split(outWdims[0], outWdims[1], 1);
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], 1, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
     // For each (x,y) step in the input/output tensor:
-    ssize_t x = -(ssize_t)pad_t;
-    for (size_t ax = 0; ax < outWdims[1]; x += stride, ax++) {
+    ssize_t x = (ssize_t)(axBegin * stride) - (ssize_t)pad_t;
+    for (size_t ax = axBegin; ax < axEnd; x += stride, ax++) {
       ssize_t y = -(ssize_t)pad_l;
       for (size_t ay = 0; ay < outWdims[2]; y += stride, ay++) {
         // For each layer in the output tensor:
@@ -1055,7 +1097,8 @@ void libjit_pool_avg_f(const float *inW, float *outW, const size_t *inWdims,
         } // C
       }   // W
     }     // H
-  }       // N
+  };
+  libjit_parallel_for(split.numTasks, task);
 }
 
 void libjit_pool_avg_grad_f(float *inG, const float *outG,
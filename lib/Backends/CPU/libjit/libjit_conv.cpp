@@ -25,17 +25,20 @@
 #include "libjit_defs.h"
 
 namespace {
-// Initialize the convolution output frame for slice \p N with the bias \p
+// Initialize the rows [\p axBegin, \p axEnd) and the channels [\p dBegin,
+// \p dEnd) of the convolution output frame for slice \p N with the bias \p
 // biasW.
 void libjit_conv_init_output_with_bias(size_t N, float *outW,
                                        const float *biasW,
                                        const size_t *outWdims,
-                                       const size_t *biasWdims) {
+                                       const size_t *biasWdims, size_t axBegin,
+                                       size_t axEnd, size_t dBegin,
+                                       size_t dEnd) {
   // For each (x,y) step in the output tensor:
-  for (size_t ax = 0; ax < outWdims[1]; ax++) {
+  for (size_t ax = axBegin; ax < axEnd; ax++) {
     for (size_t ay = 0; ay < outWdims[2]; ay++) {
       // For each output channel:
-      for (size_t d = 0; d < outWdims[3]; d++) {
+      for (size_t d = dBegin; d < dEnd; d++) {
         // Store the results to the output buffer.
         float bias = biasW[d];
         auto outIdx = libjit_getXYZW(outWdims, N, ax, ay, d);
@@ -107,14 +110,16 @@ void libjit_convDKKC8_convolve_channel(
 /// Process the input buffer in the convolution by iterating on the filter and
 /// then on the pixels. This means that we process the whole input image for
 /// each pixel in the filter. We try to unroll and process multiple inputs on
-/// the Y row together.
+/// the Y row together. Only the output rows [\p outXBegin, \p outXEnd) are
+/// computed.
 void libjit_convDKKC8_foreach_xy_filter_pixels(
     size_t sampleN, size_t outChannel, unsigned numDepthRegs,
     unsigned depthStrips, unsigned sizeGroupY, size_t numChannels, float *outW,
     const float *inW, const float *filterW, const float *biasW,
     const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
     const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
-    size_t group, size_t endChannelIndex) {
+    size_t group, size_t endChannelIndex, size_t outXBegin,
+    size_t outXEnd) {
   // The loops below look scary but the the idea is simple. We iterate over
   // the pixels in the output tensor and calculate the coordinate of the source
   // tensor. When we process the Y row we try to process [sizeGroupY] elements
@@ -128,7 +133,7 @@ void libjit_convDKKC8_foreach_xy_filter_pixels(
     for (size_t fy = 0; fy < filterSize; fy++) {
 
       // For each x step in the input/output tensor:
-      for (size_t outx = 0; outx < outWdims[1]; outx++) {
+      for (size_t outx = outXBegin; outx < outXEnd; outx++) {
         ssize_t inx = (ssize_t)outx * stride - pad_t + fx;
 
         // Ignore out-of-bounds X values.
@@ -198,19 +203,21 @@ void libjit_convDKKC8_foreach_xy_filter_pixels(
 
 // Process the input buffer in the convolution by iterating on the input buffer
 // and then on the filter. This means that we process the whole input filter for
-// each pixel in the input buffer.
+// each pixel in the input buffer. Only the output rows [\p outXBegin, \p
+// outXEnd) are computed.
 void libjit_convDKKC8_foreach_xy_pixels_filter(
     size_t sampleN, size_t outChannel, unsigned numDepthRegs,
     unsigned depthStrips, unsigned sizeGroupY, size_t numChannels, float *outW,
     const float *inW, const float *filterW, const float *biasW,
     const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
     const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
-    size_t group, size_t endChannelIndex) {
+    size_t group, size_t endChannelIndex, size_t outXBegin,
+    size_t outXEnd) {
 
   size_t pad_t = pads[0];
   size_t pad_l = pads[1];
   // For each (x,y) step in the input/output tensor:
-  for (size_t outx = 0; outx < outWdims[1]; outx++) {
+  for (size_t outx = outXBegin; outx < outXEnd; outx++) {
     for (size_t outy = 0; outy < outWdims[2]; outy++) {
 
       // For each element in the convolution-filter:
@@ -243,6 +250,702 @@ void libjit_convDKKC8_foreach_xy_pixels_filter(
   }       // For each X in the output.
 }
 
+/// Number of output pixels of a row that the quantized convolution computes at
+/// once.
+constexpr size_t qconvPixels = 4;
+/// Number of output channels in a strip of the packed quantized filter.
+constexpr size_t qconvChannels = 16;
+
+/// Pack the \p filterSize input rows that start at row \p inX of the sample
+/// \p sampleN into \p rows, for the input channels [\p c, \p c + \p
+/// numChannels) of a group. Every row holds \p rowWidth pixels, starting at
+/// column -\p padL. The channels of a pixel are stored as pairs of int16
+/// values (see libjit_pair_i16), with the offset \p inOffset subtracted. The
+/// padding is zero, so that it does not contribute to the sums.
+void libjit_quantizedConv_pack_rows(const int8_t *inW, const size_t *inWdims,
+                                    size_t sampleN, ssize_t inX,
+                                    size_t filterSize, size_t padL,
+                                    size_t rowWidth, size_t c,
+                                    size_t numChannels, int32_t inOffset,
+                                    int32_t *rows) {
+  size_t cPairs = (numChannels + 1) / 2;
+  memset(rows, 0, filterSize * rowWidth * cPairs * sizeof(int32_t));
+  for (size_t fx = 0; fx < filterSize; fx++) {
+    ssize_t x = inX + (ssize_t)fx;
+    if (x < 0 || x >= (ssize_t)inWdims[1]) {
+      continue;
+    }
+    int32_t *row = &rows[fx * rowWidth * cPairs];
+    for (size_t py = 0; py < rowWidth; py++) {
+      ssize_t y = (ssize_t)py - (ssize_t)padL;
+      if (y < 0 || y >= (ssize_t)inWdims[2]) {
+        continue;
+      }
+      const int8_t *px = &inW[libjit_getXYZW(inWdims, sampleN, x, y, c)];
+      for (size_t q = 0; q < cPairs; q++) {
+        int16_t lo = px[2 * q] - inOffset;
+        int16_t hi = 2 * q + 1 < numChannels ? px[2 * q + 1] - inOffset : 0;
+        row[py * cPairs + q] = libjit_pair_i16(lo, hi);
+      }
+    }
+  }
+}
+
+/// Compute \p pixels adjacent output pixels of a strip of output channels,
+/// and add them to \p acc. \p rows are the packed input rows of the output row
+/// (see libjit_quantizedConv_pack_rows), starting at the first input column of
+/// the first pixel. \p filter is the strip of the packed filter, with the
+/// layout [K, K, C/2, 16, 2], and \p filterOffset its offset.
+template <size_t pixels>
+void libjit_quantizedConv_tile(const int32_t *rows, size_t rowWidth,
+                               size_t cPairs, const int8_t *filter,
+                               size_t filterSize, size_t stride,
+                               int16x16 filterOffset,
+                               int32x8 (&acc)[pixels][2]) {
+  for (size_t fx = 0; fx < filterSize; fx++) {
+    for (size_t fy = 0; fy < filterSize; fy++) {
+      const int32_t *in = &rows[(fx * rowWidth + fy) * cPairs];
+      for (size_t q = 0; q < cPairs; q++) {
+        int8x16 f0, f1;
+        memcpy(&f0, filter, sizeof(f0));
+        memcpy(&f1, filter + 16, sizeof(f1));
+        filter += 32;
+        int16x16 b0 = __builtin_convertvector(f0, int16x16) - filterOffset;
+        int16x16 b1 = __builtin_convertvector(f1, int16x16) - filterOffset;
+        for (size_t p = 0; p < pixels; p++) {
+          int32x8 pair = {};
+          int16x16 a = (int16x16)(pair + in[p * stride * cPairs + q]);
+          acc[p][0] += libjit_madd_i16(a, b0);
+          acc[p][1] += libjit_madd_i16(a, b1);
+        }
+      }
+    }
+  }
+}
+
+/// The parameters of a quantized convolution that the tiles need.
+struct libjit_quantizedConv_params {
+  size_t filterSize;
+  size_t stride;
+  size_t rowWidth;
+  size_t cPairs;
+  int16x16 filterOffset;
+  int32_t outOffset;
+  int32_t outPre;
+  int32_t outPost;
+  int32_t outScale;
+};
+
+/// Compute \p pixels adjacent output pixels of the first \p cols channels of a
+/// strip, starting with the scaled bias \p bias, and store them to \p out,
+/// whose pixels are \p outChannels channels apart.
+template <size_t pixels>
+void libjit_quantizedConv_pixels(const int32_t *rows, const int8_t *filter,
+                                 const int32x8 (&bias)[2], int8_t *out,
+                                 size_t outChannels, size_t cols,
+                                 const libjit_quantizedConv_params &p) {
+  int32x8 acc[pixels][2];
+  for (size_t i = 0; i < pixels; i++) {
+    acc[i][0] = bias[0];
+    acc[i][1] = bias[1];
+  }
+  libjit_quantizedConv_tile<pixels>(rows, p.rowWidth, p.cPairs, filter,
+                                    p.filterSize, p.stride, p.filterOffset,
+                                    acc);
+  for (size_t i = 0; i < pixels; i++) {
+    for (size_t v = 0; v < 2 && v * 8 < cols; v++) {
+      int8x8 res = libjit_scale_i32i8_x8(acc[i][v], p.outPre, p.outPost,
+                                         p.outScale, p.outOffset);
+      memcpy(&out[i * outChannels + v * 8], &res, MIN(cols - v * 8, 8));
+    }
+  }
+}
+
+/// The transforms of the Winograd convolution F(m x m, 3 x 3), which computes
+/// tiles of m x m output pixels from tiles of alpha x alpha input pixels (see
+/// Lavin and Gray, "Fast Algorithms for Convolutional Neural Networks"). The
+/// transforms are separable, so they are applied to the columns and then to
+/// the rows of a tile. The filter transform is done at compile time.
+template <size_t m> struct libjit_winograd;
+
+template <> struct libjit_winograd<2> {
+  static constexpr size_t alpha = 4;
+
+  /// Compute v = B^T d, where the elements of \p d and \p v are \p ds and
+  /// \p vs vectors apart.
+  static void input(const float8 *d, size_t ds, float8 *v, size_t vs) {
+    float8 d0 = d[0], d1 = d[ds], d2 = d[2 * ds], d3 = d[3 * ds];
+    v[0] = d0 - d2;
+    v[vs] = d1 + d2;
+    v[2 * vs] = d2 - d1;
+    v[3 * vs] = d1 - d3;
+  }
+
+  /// Compute y = A^T t, where the elements of \p t and \p y are \p ts and
+  /// \p ys vectors apart.
+  static void output(const float8 *t, size_t ts, float8 *y, size_t ys) {
+    y[0] = t[0] + t[ts] + t[2 * ts];
+    y[ys] = t[ts] - t[2 * ts] - t[3 * ts];
+  }
+};
+
+template <> struct libjit_winograd<4> {
+  static constexpr size_t alpha = 6;
+
+  /// Compute v = B^T d, where the elements of \p d and \p v are \p ds and
+  /// \p vs vectors apart.
+  static void input(const float8 *d, size_t ds, float8 *v, size_t vs) {
+    float8 d0 = d[0], d1 = d[ds], d2 = d[2 * ds], d3 = d[3 * ds];
+    float8 d4 = d[4 * ds], d5 = d[5 * ds];
+    v[0] = 4.0f * d0 - 5.0f * d2 + d4;
+    v[vs] = d3 + d4 - 4.0f * (d1 + d2);
+    v[2 * vs] = 4.0f * (d1 - d2) + d4 - d3;
+    v[3 * vs] = 2.0f * (d3 - d1) + d4 - d2;
+    v[4 * vs] = 2.0f * (d1 - d3) + d4 - d2;
+    v[5 * vs] = 4.0f * d1 - 5.0f * d3 + d5;
+  }
+
+  /// Compute y = A^T t, where the elements of \p t and \p y are \p ts and
+  /// \p ys vectors apart.
+  static void output(const float8 *t, size_t ts, float8 *y, size_t ys) {
+    float8 sum12 = t[ts] + t[2 * ts], diff12 = t[ts] - t[2 * ts];
+    float8 sum34 = t[3 * ts] + t[4 * ts], diff34 = t[3 * ts] - t[4 * ts];
+    y[0] = t[0] + sum12 + sum34;
+    y[ys] = diff12 + 2.0f * diff34;
+    y[2 * ys] = sum12 + 4.0f * sum34;
+    y[3 * ys] = diff12 + 8.0f * diff34 + t[5 * ts];
+  }
+};
+
+/// Number of tiles that the Winograd convolution multiplies at once.
+constexpr size_t wgTiles = 6;
+/// Number of output channels in a strip of the transformed filter.
+constexpr size_t wgChannels = 16;
+/// Number of floats that the buffers of a Winograd task should not exceed.
+constexpr size_t wgBufferSize = 128 * 1024;
+
+/// The shape of a Winograd convolution, shared by its steps.
+struct libjit_winograd_params {
+  const size_t *inWdims;
+  const size_t *outWdims;
+  size_t inCperG;
+  size_t outCperG;
+  size_t padT;
+  size_t padL;
+  /// The number of tiles in a row of the output.
+  size_t tilesW;
+  /// The number of tiles in a block, a multiple of wgTiles.
+  size_t blockTiles;
+  /// The number of strips of output channels of a group.
+  size_t strips;
+};
+
+/// Transform the tiles [\p t0, \p t0 + \p numTiles) of the sample \p n and the
+/// group \p g of the input into \p V, with the layout [alpha * alpha, T / 6,
+/// C, 6], where T is the number of tiles of a block and C the number of input
+/// channels of a group. The missing tiles of the last row block are zero.
+template <size_t m>
+void libjit_winograd_input(const float *inW, size_t n, size_t g, size_t t0,
+                           size_t numTiles, const libjit_winograd_params &p,
+                           float *V) {
+  constexpr size_t alpha = libjit_winograd<m>::alpha;
+  size_t C = p.inCperG;
+  ssize_t inHeight = p.inWdims[1];
+  ssize_t inWidth = p.inWdims[2];
+  size_t elemSize = (p.blockTiles / wgTiles) * C * wgTiles;
+  // Only the row blocks that hold some of the tiles are multiplied.
+  size_t endTile = (numTiles + wgTiles - 1) / wgTiles * wgTiles;
+
+  for (size_t t = 0; t < endTile; t++) {
+    size_t tile = t0 + t;
+    ssize_t x0 = (ssize_t)(tile / p.tilesW * m) - (ssize_t)p.padT;
+    ssize_t y0 = (ssize_t)(tile % p.tilesW * m) - (ssize_t)p.padL;
+    for (size_t c = 0; c < C; c += 8) {
+      size_t lanes = MIN(C - c, 8);
+      float8 d[alpha][alpha];
+      for (size_t i = 0; i < alpha; i++) {
+        for (size_t j = 0; j < alpha; j++) {
+          ssize_t x = x0 + (ssize_t)i;
+          ssize_t y = y0 + (ssize_t)j;
+          d[i][j] = BroadcastFloat8(0.0f);
+          if (t >= numTiles || x < 0 || x >= inHeight || y < 0 ||
+              y >= inWidth) {
+            continue;
+          }
+          const float *in =
+              &inW[libjit_getXYZW(p.inWdims, n, x, y, g * C + c)];
+          if (lanes == 8) {
+            d[i][j] = LoaduFloat8(in);
+          } else {
+            memcpy(&d[i][j], in, lanes * sizeof(float));
+          }
+        }
+      }
+
+      float8 tmp[alpha][alpha];
+      float8 v[alpha][alpha];
+      for (size_t j = 0; j < alpha; j++) {
+        libjit_winograd<m>::input(&d[0][j], alpha, &tmp[0][j], alpha);
+      }
+      for (size_t i = 0; i < alpha; i++) {
+        libjit_winograd<m>::input(&tmp[i][0], 1, &v[i][0], 1);
+      }
+
+      // Scatter the channels, so that the tiles of a row block are adjacent.
+      float *out = &V[(t / wgTiles * C + c) * wgTiles + t % wgTiles];
+      for (size_t e = 0; e < alpha * alpha; e++) {
+        for (size_t l = 0; l < lanes; l++) {
+          out[e * elemSize + l * wgTiles] = v[e / alpha][e % alpha][l];
+        }
+      }
+    }
+  }
+}
+
+/// Multiply a row block \p v of the transformed tiles, with the layout [C, 6],
+/// with a strip \p u of the transformed filter, with the layout [C, 16], and
+/// store the 6 x 16 products to \p out, whose rows are \p ldo floats apart.
+void libjit_winograd_dot(size_t C, const float *v, const float *u, float *out,
+                         size_t ldo) {
+  float8 acc[wgTiles][2] = {{0.0}};
+  for (size_t c = 0; c < C; c++) {
+    float8 u0 = LoaduFloat8(u);
+    float8 u1 = LoaduFloat8(u + 8);
+    for (size_t t = 0; t < wgTiles; t++) {
+      float8 vv = BroadcastFloat8(v[t]);
+      acc[t][0] += vv * u0;
+      acc[t][1] += vv * u1;
+    }
+    u += wgChannels;
+    v += wgTiles;
+  }
+  for (size_t t = 0; t < wgTiles; t++) {
+    StoreuFloat8(&out[t * ldo], acc[t][0]);
+    StoreuFloat8(&out[t * ldo + 8], acc[t][1]);
+  }
+}
+
+/// Transform the products \p M of the tiles [\p t0, \p t0 + \p numTiles) of
+/// the sample \p n and the group \p g, with the layout [alpha * alpha, T,
+/// S * 16], into output pixels, add the bias \p biasW and store the pixels
+/// that are inside of the output to \p outW.
+template <size_t m>
+void libjit_winograd_output(float *outW, const float *biasW, size_t n,
+                            size_t g, size_t t0, size_t numTiles,
+                            const libjit_winograd_params &p, const float *M) {
+  constexpr size_t alpha = libjit_winograd<m>::alpha;
+  size_t K = p.outCperG;
+  size_t ldm = p.strips * wgChannels;
+  size_t outHeight = p.outWdims[1];
+  size_t outWidth = p.outWdims[2];
+
+  for (size_t t = 0; t < numTiles; t++) {
+    size_t tile = t0 + t;
+    size_t x0 = tile / p.tilesW * m;
+    size_t y0 = tile % p.tilesW * m;
+    for (size_t k = 0; k < K; k += 8) {
+      size_t lanes = MIN(K - k, 8);
+      float8 mm[alpha][alpha];
+      for (size_t e = 0; e < alpha * alpha; e++) {
+        mm[e / alpha][e % alpha] =
+            LoaduFloat8(&M[(e * p.blockTiles + t) * ldm + k]);
+      }
+
+      float8 tmp[m][alpha];
+      float8 y[m][m];
+      for (size_t j = 0; j < alpha; j++) {
+        libjit_winograd<m>::output(&mm[0][j], alpha, &tmp[0][j], alpha);
+      }
+      for (size_t i = 0; i < m; i++) {
+        libjit_winograd<m>::output(&tmp[i][0], 1, &y[i][0], 1);
+      }
+
+      float8 bias = BroadcastFloat8(0.0f);
+      memcpy(&bias, &biasW[g * K + k], lanes * sizeof(float));
+      for (size_t i = 0; i < m && x0 + i < outHeight; i++) {
+        for (size_t j = 0; j < m && y0 + j < outWidth; j++) {
+          float *out = &outW[libjit_getXYZW(p.outWdims, n, x0 + i, y0 + j,
+                                            g * K + k)];
+          float8 res = y[i][j] + bias;
+          if (lanes == 8) {
+            StoreuFloat8(out, res);
+          } else {
+            memcpy(out, &res, lanes * sizeof(float));
+          }
+        }
+      }
+    }
+  }
+}
+
+/// Compute the Winograd convolution F(\p m x \p m, 3 x 3). The tiles of every
+/// sample and group are split into blocks, which are the tasks. A task
+/// transforms the tiles of its block, multiplies them with the transformed
+/// filter separately for every element of the tiles, and transforms the
+/// products into output pixels.
+template <size_t m>
+void libjit_winograd_conv(float *outW, const float *inW, const float *filterW,
+                          const float *biasW, const size_t *outWdims,
+                          const size_t *inWdims, const size_t *pads,
+                          size_t group) {
+  constexpr size_t alpha = libjit_winograd<m>::alpha;
+  libjit_winograd_params p;
+  p.inWdims = inWdims;
+  p.outWdims = outWdims;
+  p.inCperG = inWdims[3] / group;
+  p.outCperG = outWdims[3] / group;
+  p.padT = pads[0];
+  p.padL = pads[1];
+  p.tilesW = (outWdims[2] + m - 1) / m;
+  p.strips = (p.outCperG + wgChannels - 1) / wgChannels;
+  size_t ldm = p.strips * wgChannels;
+  size_t tilesPerImage = (outWdims[1] + m - 1) / m * p.tilesW;
+  size_t N = inWdims[0];
+
+  // Make the buffers of a task fit into the budget, and make enough blocks
+  // for all of the threads.
+  size_t threads = libjit_num_threads();
+  size_t blockTiles = wgBufferSize / (alpha * alpha * (p.inCperG + ldm));
+  blockTiles = MIN(blockTiles, (N * group * tilesPerImage + threads - 1) /
+                                   threads);
+  blockTiles = MIN(blockTiles, tilesPerImage);
+  p.blockTiles = MAX(blockTiles / wgTiles, 1) * wgTiles;
+  size_t blocksPerImage = (tilesPerImage + p.blockTiles - 1) / p.blockTiles;
+  size_t filterGroupSize = alpha * alpha * ldm * p.inCperG;
+
+  auto task = [&](size_t taskId) {
+    size_t b = taskId % blocksPerImage;
+    size_t g = taskId / blocksPerImage % group;
+    size_t n = taskId / blocksPerImage / group;
+    size_t t0 = b * p.blockTiles;
+    size_t numTiles = MIN(tilesPerImage - t0, p.blockTiles);
+    size_t rowBlocks = p.blockTiles / wgTiles;
+    float V[alpha * alpha * p.blockTiles * p.inCperG]
+        __attribute__((aligned(64)));
+    float M[alpha * alpha * p.blockTiles * ldm] __attribute__((aligned(64)));
+
+    libjit_winograd_input<m>(inW, n, g, t0, numTiles, p, V);
+
+    // Every element of the tiles is a matrix multiplication of the row
+    // blocks with the strips of the filter. The strip stays in the L1 cache
+    // while it is multiplied with all of the row blocks.
+    const float *U = &filterW[g * filterGroupSize];
+    for (size_t e = 0; e < alpha * alpha; e++) {
+      for (size_t s = 0; s < p.strips; s++) {
+        const float *u = &U[(e * p.strips + s) * p.inCperG * wgChannels];
+        for (size_t r = 0; r * wgTiles < numTiles; r++) {
+          libjit_winograd_dot(
+              p.inCperG, &V[(e * rowBlocks + r) * p.inCperG * wgTiles], u,
+              &M[(e * p.blockTiles + r * wgTiles) * ldm + s * wgChannels],
+              ldm);
+        }
+      }
+    }
+
+    libjit_winograd_output<m>(outW, biasW, n, g, t0, numTiles, p, M);
+  };
+  libjit_parallel_for(N * group * blocksPerImage, task);
+}
+
+/// Number of floats that the im2col buffer of the GEMM convolution should not
+/// exceed. The CPU backend only selects the GEMM convolution when a single row
+/// of patches fits in it.
+constexpr size_t gemmBufferSize = 256 * 1024;
+
+/// Gather the patches of the output pixels [\p pBegin, \p pEnd) of the sample
+/// \p n into the rows of \p patches (im2col). The row of a pixel holds the
+/// K x K x C input values of the group \p g that the filter covers, in the
+/// order of the filter, and zeros for the padding.
+void libjit_convGEMM_im2col(const float *inW, const size_t *inWdims,
+                            const size_t *outWdims, size_t n, size_t g,
+                            size_t C, size_t filterSize, size_t stride,
+                            const size_t *pads, size_t pBegin, size_t pEnd,
+                            float *patches) {
+  ssize_t inHeight = inWdims[1];
+  ssize_t inWidth = inWdims[2];
+  size_t outWidth = outWdims[2];
+  size_t rowSize = filterSize * filterSize * C;
+
+  for (size_t p = pBegin; p < pEnd; p++) {
+    float *row = &patches[(p - pBegin) * rowSize];
+    ssize_t x0 = (ssize_t)(p / outWidth * stride) - (ssize_t)pads[0];
+    ssize_t y0 = (ssize_t)(p % outWidth * stride) - (ssize_t)pads[1];
+    for (size_t kx = 0; kx < filterSize; kx++) {
+      for (size_t ky = 0; ky < filterSize; ky++) {
+        ssize_t x = x0 + (ssize_t)kx;
+        ssize_t y = y0 + (ssize_t)ky;
+        float *dst = &row[(kx * filterSize + ky) * C];
+        if (x < 0 || x >= inHeight || y < 0 || y >= inWidth) {
+          memset(dst, 0, C * sizeof(float));
+          continue;
+        }
+        memcpy(dst, &inW[libjit_getXYZW(inWdims, n, x, y, g * C)],
+               C * sizeof(float));
+      }
+    }
+  }
+}
+
+/// Number of consecutive output pixels of a row that the depthwise kernels
+/// compute together, so that they share the loads of the filter.
+constexpr size_t dwPixels = 4;
+
+/// Number of output channels in a strip of the depthwise kernels.
+constexpr size_t dwChannels = 16;
+
+/// The arithmetic of the float depthwise convolution.
+struct libjit_depthwise_float {
+  typedef float elem;
+  typedef float accum;
+  typedef float8 vec;
+
+  const float *biasW;
+
+  float8 loadIn(const float *p) const { return LoaduFloat8(p); }
+  float8 loadFilter(const float *p) const { return LoaduFloat8(p); }
+  float in(float v) const { return v; }
+  float filter(float v) const { return v; }
+  float bias(size_t d) const { return biasW[d]; }
+  void store(float *p, float8 v) const { StoreuFloat8(p, v); }
+  void store(float *p, float v) const { *p = v; }
+};
+
+/// The arithmetic of the quantized depthwise convolution, which subtracts the
+/// offsets of the input and the filter, accumulates in int32 starting from the
+/// scaled bias, and scales the sums back to the output.
+struct libjit_depthwise_i8 {
+  typedef int8_t elem;
+  typedef int32_t accum;
+  typedef int32x8 vec;
+
+  const int8_t *biasW;
+  int32_t outOffset;
+  int32_t inOffset;
+  int32_t filterOffset;
+  int32_t biasOffset;
+  int32_t biasPre;
+  int32_t biasPost;
+  int32_t biasScale;
+  int32_t outPre;
+  int32_t outPost;
+  int32_t outScale;
+
+  int32x8 loadIn(const int8_t *p) const {
+    int8x8 v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, int32x8) - inOffset;
+  }
+  int32x8 loadFilter(const int8_t *p) const {
+    int8x8 v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, int32x8) - filterOffset;
+  }
+  int32_t in(int8_t v) const { return v - inOffset; }
+  int32_t filter(int8_t v) const { return v - filterOffset; }
+  int32_t bias(size_t d) const {
+    return libjit_scale_i32i8((int32_t)biasW[d] - biasOffset, biasPre,
+                              biasPost, biasScale, 0);
+  }
+  void store(int8_t *p, int32x8 v) const {
+    int8x8 r = libjit_scale_i32i8_x8(v, outPre, outPost, outScale, outOffset);
+    memcpy(p, &r, sizeof(r));
+  }
+  void store(int8_t *p, int32_t v) const {
+    *p = libjit_clip(
+        libjit_scale_i32i8(v, outPre, outPost, outScale, outOffset));
+  }
+};
+
+/// The distances between the elements of the depthwise convolution.
+struct libjit_depthwise_params {
+  /// Elements between the input rows.
+  size_t inRow;
+  /// Elements between the input pixels, i.e. the number of input channels.
+  size_t inPixel;
+  /// Elements between the input pixels of consecutive output pixels.
+  size_t inStep;
+  /// Elements between the rows of the filter.
+  size_t filterRow;
+  /// Elements between the taps of the filter and between the output pixels,
+  /// i.e. the number of output channels.
+  size_t D;
+};
+
+/// Compute \p pixels consecutive output pixels of a row, for 8 * \p V
+/// channels, where every output channel reads the input channel with the same
+/// index. \p in points to the first input tap of the first pixel and \p filter
+/// to the same tap of the filter, at the first channel. The \p numKx x
+/// \p numKy taps are accumulated in the same order for every pixel, starting
+/// from \p bias, and the filter is loaded once for all pixels.
+template <size_t pixels, size_t V, typename Ops>
+void libjit_depthwise_block(const Ops &ops, const typename Ops::elem *in,
+                            const typename Ops::elem *filter,
+                            const typename Ops::accum *bias,
+                            typename Ops::elem *out, size_t numKx, size_t numKy,
+                            const libjit_depthwise_params &p) {
+  typedef typename Ops::vec vec;
+  vec acc[pixels][V];
+  for (size_t v = 0; v < V; v++) {
+    vec b;
+    memcpy(&b, &bias[v * 8], sizeof(b));
+    for (size_t i = 0; i < pixels; i++) {
+      acc[i][v] = b;
+    }
+  }
+
+  for (size_t kx = 0; kx < numKx; kx++) {
+    for (size_t ky = 0; ky < numKy; ky++) {
+      const typename Ops::elem *inTap = &in[kx * p.inRow + ky * p.inPixel];
+      const typename Ops::elem *filterTap =
+          &filter[kx * p.filterRow + ky * p.D];
+      vec f[V];
+      for (size_t v = 0; v < V; v++) {
+        f[v] = ops.loadFilter(&filterTap[v * 8]);
+      }
+      for (size_t i = 0; i < pixels; i++) {
+        for (size_t v = 0; v < V; v++) {
+          acc[i][v] += ops.loadIn(&inTap[i * p.inStep + v * 8]) * f[v];
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < pixels; i++) {
+    for (size_t v = 0; v < V; v++) {
+      ops.store(&out[i * p.D + v * 8], acc[i][v]);
+    }
+  }
+}
+
+/// Compute the output channels [\p d, \p d + \p cols) of a pixel with scalar
+/// operations. The output channel e reads the input channel e / \p multiplier.
+/// \p in points to the first input tap at channel 0, \p filter to the same tap
+/// of the filter at channel \p d, and \p out to the output at channel \p d.
+template <typename Ops>
+void libjit_depthwise_scalar(const Ops &ops, const typename Ops::elem *in,
+                             const typename Ops::elem *filter,
+                             const typename Ops::accum *bias,
+                             typename Ops::elem *out, size_t numKx,
+                             size_t numKy, const libjit_depthwise_params &p,
+                             size_t multiplier, size_t d, size_t cols) {
+  for (size_t i = 0; i < cols; i++) {
+    size_t c = (d + i) / multiplier;
+    typename Ops::accum sum = bias[i];
+    for (size_t kx = 0; kx < numKx; kx++) {
+      for (size_t ky = 0; ky < numKy; ky++) {
+        sum += ops.in(in[kx * p.inRow + ky * p.inPixel + c]) *
+               ops.filter(filter[kx * p.filterRow + ky * p.D + i]);
+      }
+    }
+    ops.store(&out[i], sum);
+  }
+}
+
+/// Perform the depthwise convolution, where every group has a single input
+/// channel, with the filter \p filterW of the layout [K, K, D]. The tasks
+/// split the rows and the strips of 16 output channels. When every output
+/// channel reads the input channel with the same index, the kernel vectorizes
+/// across the channels and computes the pixels that read no padding columns
+/// in blocks of dwPixels.
+template <typename Ops>
+void libjit_depthwise_conv(const Ops &ops, typename Ops::elem *outW,
+                           const typename Ops::elem *inW,
+                           const typename Ops::elem *filterW,
+                           const size_t *outWdims, const size_t *inWdims,
+                           size_t filterSize, size_t stride,
+                           const size_t *pads) {
+  ssize_t inHeight = inWdims[1];
+  ssize_t inWidth = inWdims[2];
+  ssize_t K = filterSize;
+  size_t outWidth = outWdims[2];
+  size_t C = inWdims[3];
+  size_t D = outWdims[3];
+  size_t multiplier = D / C;
+
+  libjit_depthwise_params p;
+  p.inRow = inWidth * C;
+  p.inPixel = C;
+  p.inStep = stride * C;
+  p.filterRow = K * D;
+  p.D = D;
+
+  // The output pixels [ayBegin, ayEnd) of a row read no padding columns.
+  size_t ayBegin = MIN((pads[1] + stride - 1) / stride, outWidth);
+  size_t ayEnd = ayBegin;
+  if (inWidth + (ssize_t)pads[1] >= K) {
+    ayEnd = MAX(MIN((inWidth + pads[1] - K) / stride + 1, outWidth), ayBegin);
+  }
+
+  size_t numUnits = (D + dwChannels - 1) / dwChannels;
+  libjit_nhwc_split split(inWdims[0], outWdims[1], numUnits);
+
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], numUnits, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
+
+    for (size_t ax = axBegin; ax < axEnd; ax++) {
+      // The taps [kxBegin, kxEnd) of the filter are inside the input rows.
+      ssize_t x = (ssize_t)(ax * stride) - (ssize_t)pads[0];
+      ssize_t kxBegin = MIN(MAX(-x, 0), K);
+      ssize_t kxEnd = MAX(MIN(K, inHeight - x), kxBegin);
+      size_t numKx = kxEnd - kxBegin;
+
+      for (size_t u = unitBegin; u < unitEnd; u++) {
+        size_t d = u * dwChannels;
+        size_t cols = MIN(D - d, dwChannels);
+        typename Ops::accum bias[dwChannels];
+        for (size_t i = 0; i < cols; i++) {
+          bias[i] = ops.bias(d + i);
+        }
+        const typename Ops::elem *filter = &filterW[kxBegin * p.filterRow + d];
+        typename Ops::elem *out = &outW[libjit_getXYZW(outWdims, n, ax, 0, d)];
+
+        size_t ay = 0;
+        while (ay < outWidth) {
+          ssize_t y = (ssize_t)(ay * stride) - (ssize_t)pads[1];
+          if (multiplier == 1 && cols == dwChannels && numKx &&
+              ay >= ayBegin && ay + dwPixels <= ayEnd) {
+            const typename Ops::elem *in =
+                &inW[libjit_getXYZW(inWdims, n, x + kxBegin, y, d)];
+            libjit_depthwise_block<dwPixels, 2>(ops, in, filter, bias,
+                                                &out[ay * D], numKx, K, p);
+            ay += dwPixels;
+            continue;
+          }
+
+          // Compute a single pixel, whose taps may fall on the padding.
+          ssize_t kyBegin = MIN(MAX(-y, 0), K);
+          ssize_t kyEnd = MAX(MIN(K, inWidth - y), kyBegin);
+          size_t numKy = kyEnd - kyBegin;
+          size_t inIdx = 0;
+          if (numKx && numKy) {
+            inIdx = libjit_getXYZW(inWdims, n, x + kxBegin, y + kyBegin, 0);
+          }
+          const typename Ops::elem *in = &inW[inIdx];
+          const typename Ops::elem *f = &filter[kyBegin * D];
+          typename Ops::elem *o = &out[ay * D];
+          size_t i = 0;
+          if (multiplier == 1) {
+            for (; i + 16 <= cols; i += 16) {
+              libjit_depthwise_block<1, 2>(ops, &in[d + i], &f[i], &bias[i],
+                                           &o[i], numKx, numKy, p);
+            }
+            for (; i + 8 <= cols; i += 8) {
+              libjit_depthwise_block<1, 1>(ops, &in[d + i], &f[i], &bias[i],
+                                           &o[i], numKx, numKy, p);
+            }
+          }
+          libjit_depthwise_scalar(ops, in, &f[i], &bias[i], &o[i], numKx,
+                                  numKy, p, multiplier, d + i, cols - i);
+          ay++;
+        }
+      }
+    }
+  };
+  libjit_parallel_for(split.numTasks, task);
+}
+
 } // namespace
 
 extern "C" {
@@ -263,30 +966,39 @@ void libjit_convDKKC8_f(float *outW, const float *inW, const float *filterW,
       (pixelScanFirst ? &libjit_convDKKC8_foreach_xy_pixels_filter
                       : &libjit_convDKKC8_foreach_xy_filter_pixels);
 
-  // For each input in the batch:
-  for (size_t n = 0; n < inWdims[0]; n++) {
-
-    // Initialize the output frame for the N'th slice with the bias.
-    // Later we will accumulate values into this slice.
-    libjit_conv_init_output_with_bias(n, outW, biasW, outWdims, biasWdims);
-
-    // For each group of input channels:
-    for (size_t g = 0; g < group; g++) {
-
-      // For each output channel, process [numDepthRegs x float8] elements.
-      size_t startChannelIndex = g * outCperG;
+  // The output channels of every group are processed in strips of
+  // [numDepthRegs x float8 x depthStrips] elements. The strips of all groups
+  // are the channel units that are distributed between the tasks.
+  size_t stripSize = 8 * numDepthRegs * depthStrips;
+  size_t stripsPerGroup = (outCperG + stripSize - 1) / stripSize;
+  size_t numUnits = group * stripsPerGroup;
+  libjit_nhwc_split split(inWdims[0], outWdims[1], numUnits);
+
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], numUnits, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
+
+    // For each strip of output channels in the task:
+    for (size_t u = unitBegin; u < unitEnd; u++) {
+      size_t g = u / stripsPerGroup;
+      size_t d = g * outCperG + (u % stripsPerGroup) * stripSize;
       size_t endChannelIndex = (g + 1) * outCperG;
-      for (size_t d = startChannelIndex; d < endChannelIndex;
-           d += 8 * numDepthRegs * depthStrips) {
 
-        // Perform the convolution for each pixel.
-        eachPixelConv(n, d, numDepthRegs, depthStrips, sizeGroupY, inCperG,
-                      outW, inW, filterW, biasW, outWdims, inWdims, filterWdims,
-                      biasWdims, filterSize, stride, pads, g, endChannelIndex);
-
-      } // For each D (the depth, or the output channel).
-    }   // for each G, the group
-  }     // For each N, the sample in the batch.
+      // Initialize the output frame of the strip with the bias. Later we will
+      // accumulate values into it.
+      libjit_conv_init_output_with_bias(n, outW, biasW, outWdims, biasWdims,
+                                        axBegin, axEnd, d,
+                                        MIN(d + stripSize, endChannelIndex));
+
+      // Perform the convolution for each pixel.
+      eachPixelConv(n, d, numDepthRegs, depthStrips, sizeGroupY, inCperG, outW,
+                    inW, filterW, biasW, outWdims, inWdims, filterWdims,
+                    biasWdims, filterSize, stride, pads, g, endChannelIndex,
+                    axBegin, axEnd);
+    } // For each D (the depth, or the output channel).
+  };
+  libjit_parallel_for(split.numTasks, task);
 }
 
 void libjit_convolution_f(float *outW, const float *inW, const float *filterW,
@@ -312,96 +1024,104 @@ void libjit_convolution_f(float *outW, const float *inW, const float *filterW,
   // compromise between the two.
   constexpr unsigned cbSize = 512;
 
-  // For each input in the batch:
-  for (size_t n = 0; n < inWdims[0]; n++) {
+  // Split the output between the tasks. The channel units are groups of
+  // 'depthUnroll' output channels, which never cross the group boundary.
+  size_t numUnits = outChannels / depthUnroll;
+  libjit_nhwc_split split(inWdims[0], outWdims[1], numUnits);
 
-    // Initialize the output frame for the N'th slice with the bias.
-    // Later we will accumulate values into this slice.
-    libjit_conv_init_output_with_bias(n, outW, biasW, outWdims, biasWdims);
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], numUnits, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
+    size_t dBegin = unitBegin * depthUnroll;
+    size_t dEnd = unitEnd * depthUnroll;
 
-    // For each group of input channels:
-    for (size_t g = 0; g < group; g++) {
-      // Process the body of the loop in tiles of "channel-block".
-      for (size_t cb = 0; cb < inCperG; cb += cbSize) {
+    // Initialize the part of the output frame of the N'th slice that belongs
+    // to this task with the bias. Later we will accumulate values into it.
+    libjit_conv_init_output_with_bias(n, outW, biasW, outWdims, biasWdims,
+                                      axBegin, axEnd, dBegin, dEnd);
 
-        // For each output channel in the group. Process 'depthUnroll' output
-        // layers together.
-        for (size_t d = g * outCperG; d < (g + 1) * outCperG;
-             d += depthUnroll) {
+    // Process the body of the loop in tiles of "channel-block".
+    for (size_t cb = 0; cb < inCperG; cb += cbSize) {
 
-          // For each element in the convolution-filter:
-          for (size_t fx = 0; fx < filterSize; fx++) {
-            for (size_t fy = 0; fy < filterSize; fy++) {
+      // For each output channel of the task. Process 'depthUnroll' output
+      // layers together.
+      for (size_t d = dBegin; d < dEnd; d += depthUnroll) {
+        // The group of input channels that is used by this output channel.
+        size_t g = d / outCperG;
+
+        // For each element in the convolution-filter:
+        for (size_t fx = 0; fx < filterSize; fx++) {
+          for (size_t fy = 0; fy < filterSize; fy++) {
+
+            // For each convolution 'jump' in the input tensor:
+            for (size_t outx = axBegin; outx < axEnd; outx++) {
+              for (size_t outy = 0; outy < outWdims[2]; outy++) {
+
+                // Process 'depthUnroll' output pixels at once. Each scalar
+                // here represents the convolution sum for one (x,y) point in
+                // the output. We process the same pixel for different output
+                // channel (D) values. The compiler should perform scalar
+                // replacement of aggregates and split this tiny array to
+                // registers.
+                float sum[depthUnroll];
+                for (unsigned i = 0; i < depthUnroll; i++) {
+                  sum[i] = 0;
+                }
 
-              // For each convolution 'jump' in the input tensor:
-              for (size_t outx = 0; outx < outWdims[1]; outx++) {
-                for (size_t outy = 0; outy < outWdims[2]; outy++) {
-
-                  // Process 'depthUnroll' output pixels at once. Each scalar
-                  // here represents the convolution sum for one (x,y) point in
-                  // the output. We process the same pixel for different output
-                  // channel (D) values. The compiler should perform scalar
-                  // replacement of aggregates and split this tiny array to
-                  // registers.
-                  float sum[depthUnroll];
-                  for (unsigned i = 0; i < depthUnroll; i++) {
-                    sum[i] = 0;
-                  }
+                // Calculate the specific input x,y that we process in this
+                // iteration.
+                ssize_t inx = (ssize_t)outx * stride - pad_t + fx;
+                ssize_t iny = (ssize_t)outy * stride - pad_l + fy;
 
-                  // Calculate the specific input x,y that we process in this
-                  // iteration.
-                  ssize_t inx = (ssize_t)outx * stride - pad_t + fx;
-                  ssize_t iny = (ssize_t)outy * stride - pad_l + fy;
+                // Ignore index access below zero (this is due to padding).
+                if (inx < 0 || iny < 0 || inx >= (ssize_t)inWdims[1] ||
+                    iny >= (ssize_t)inWdims[2]) {
+                  continue;
+                }
 
-                  // Ignore index access below zero (this is due to padding).
-                  if (inx < 0 || iny < 0 || inx >= (ssize_t)inWdims[1] ||
-                      iny >= (ssize_t)inWdims[2]) {
-                    continue;
-                  }
+                // Calculate the indices into the Filter and Input buffers.
+                size_t inIdx = libjit_getXYZW(inWdims, n, (size_t)inx,
+                                              (size_t)iny, g * inCperG);
+                size_t filterIdx = libjit_getXYZW(filterWdims, d, fx, fy, 0);
+                size_t sliceSize =
+                    filterWdims[1] * filterWdims[2] * filterWdims[3];
 
-                  // Calculate the indices into the Filter and Input buffers.
-                  size_t inIdx = libjit_getXYZW(inWdims, n, (size_t)inx,
-                                                (size_t)iny, g * inCperG);
-                  size_t filterIdx = libjit_getXYZW(filterWdims, d, fx, fy, 0);
-                  size_t sliceSize =
-                      filterWdims[1] * filterWdims[2] * filterWdims[3];
+                // Perform the heart of the convolution, 4 elements at a time
+                // to reduce register pressure.
+                for (size_t fd = cb, e = MIN(cb + cbSize, inCperG); fd < e;
+                     fd++) {
+                  float in = inW[inIdx + fd];
+                  for (unsigned i = 0; i < MIN(4, depthUnroll); i++) {
+                    sum[i] += filterW[filterIdx + (sliceSize * i) + fd] * in;
+                  }
+                }
 
-                  // Perform the heart of the convolution, 4 elements at a time
-                  // to reduce register pressure.
+                // And run the innermost loop again for the second group of
+                // depth slices:
+                if (depthUnroll > 4) {
                   for (size_t fd = cb, e = MIN(cb + cbSize, inCperG); fd < e;
                        fd++) {
                     float in = inW[inIdx + fd];
-                    for (unsigned i = 0; i < MIN(4, depthUnroll); i++) {
+                    for (unsigned i = 4; i < MIN(8, depthUnroll); i++) {
                       sum[i] += filterW[filterIdx + (sliceSize * i) + fd] * in;
                     }
                   }
+                }
 
-                  // And run the innermost loop again for the second group of
-                  // depth slices:
-                  if (depthUnroll > 4) {
-                    for (size_t fd = cb, e = MIN(cb + cbSize, inCperG); fd < e;
-                         fd++) {
-                      float in = inW[inIdx + fd];
-                      for (unsigned i = 4; i < MIN(8, depthUnroll); i++) {
-                        sum[i] +=
-                            filterW[filterIdx + (sliceSize * i) + fd] * in;
-                      }
-                    }
-                  }
-
-                  // Store the results to the output buffer.
-                  for (unsigned i = 0; i < depthUnroll; i++) {
-                    outW[libjit_getXYZW(outWdims, n, outx, outy, d + i)] +=
-                        sum[i];
-                  }
+                // Store the results to the output buffer.
+                for (unsigned i = 0; i < depthUnroll; i++) {
+                  outW[libjit_getXYZW(outWdims, n, outx, outy, d + i)] +=
+                      sum[i];
                 }
               }
-            } // For each Y in the filter.
-          }   // For each X in the filter.
-        }     // For each D (the depth, or the output channel).
-      }       // For each block in the input channel.
-    }         // For each group in the input channel.
-  }           // For each N, the sample in the batch.
+            }
+          } // For each Y in the filter.
+        }   // For each X in the filter.
+      }     // For each D (the depth, or the output channel).
+    }       // For each block in the input channel.
+  };
+  libjit_parallel_for(split.numTasks, task);
 }
 
 void libjit_convolution_i8(
@@ -418,82 +1138,328 @@ void libjit_convolution_i8(
   size_t pad_t = pads[0];
   size_t pad_l = pads[1];
 
-  // For each input in the batch:
-  for (size_t n = 0; n < inWdims[0]; n++) {
-    // For each group of input channels:
-    for (size_t g = 0; g < group; g++) {
-
-      // For each output channel in the group. Process 'depthUnroll' output
-      // layers together.
-      for (size_t d = g * outCperG; d < (g + 1) * outCperG; d += depthUnroll) {
-        // For each convolution 'jump' in the input tensor:
-        ssize_t x = -(ssize_t)pad_t;
-        for (size_t ax = 0; ax < outWdims[1]; x += stride, ax++) {
-          ssize_t y = -(ssize_t)pad_l;
-          for (size_t ay = 0; ay < outWdims[2]; y += stride, ay++) {
-            int32_t sum[depthUnroll];
+  // Split the output between the tasks. The channel units are groups of
+  // 'depthUnroll' output channels, which never cross the group boundary.
+  size_t numUnits = outChannels / depthUnroll;
+  libjit_nhwc_split split(inWdims[0], outWdims[1], numUnits);
+
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], numUnits, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
+
+    // For each output channel of the task. Process 'depthUnroll' output
+    // layers together.
+    for (size_t d = unitBegin * depthUnroll; d < unitEnd * depthUnroll;
+         d += depthUnroll) {
+      // The group of input channels that is used by this output channel.
+      size_t g = d / outCperG;
+      // For each convolution 'jump' in the input tensor:
+      ssize_t x = (ssize_t)(axBegin * stride) - (ssize_t)pad_t;
+      for (size_t ax = axBegin; ax < axEnd; x += stride, ax++) {
+        ssize_t y = -(ssize_t)pad_l;
+        for (size_t ay = 0; ay < outWdims[2]; y += stride, ay++) {
+          int32_t sum[depthUnroll];
+
+          for (unsigned i = 0; i < depthUnroll; i++) {
+            // Scale the bias to match the scale of the matrix multiplication.
+            sum[i] = libjit_scale_i32i8((int32_t)biasW[d + i] - biasOffset,
+                                        biasPre, biasPost, biasScale, 0);
+          }
 
-            for (unsigned i = 0; i < depthUnroll; i++) {
-              // Scale the bias to match the scale of the matrix multiplication.
-              sum[i] = libjit_scale_i32i8((int32_t)biasW[d + i] - biasOffset,
-                                          biasPre, biasPost, biasScale, 0);
-            }
+          // For each element in the convolution-filter:
+          for (size_t fx = 0; fx < filterSize; fx++) {
+            for (size_t fy = 0; fy < filterSize; fy++) {
+              ssize_t ox = x + fx;
+              ssize_t oy = y + fy;
 
-            // For each element in the convolution-filter:
-            for (size_t fx = 0; fx < filterSize; fx++) {
-              for (size_t fy = 0; fy < filterSize; fy++) {
-                ssize_t ox = x + fx;
-                ssize_t oy = y + fy;
+              // Ignore index access below zero (this is due to padding).
+              if (ox < 0 || oy < 0 || ox >= (ssize_t)inWdims[1] ||
+                  oy >= (ssize_t)inWdims[2]) {
+                continue;
+              }
 
-                // Ignore index access below zero (this is due to padding).
-                if (ox < 0 || oy < 0 || ox >= (ssize_t)inWdims[1] ||
-                    oy >= (ssize_t)inWdims[2]) {
-                  continue;
+              // Calculate the indices into the Filter and Input buffers.
+              size_t inIdx = libjit_getXYZW(inWdims, n, (size_t)ox,
+                                            (size_t)oy, g * inCperG);
+              size_t filterIdx = libjit_getXYZW(filterWdims, d, fx, fy, 0);
+              size_t sliceSize =
+                  filterWdims[1] * filterWdims[2] * filterWdims[3];
+
+              // Perform the innermost loop of the convolution using 4 vector
+              // registers.
+              for (size_t fd = 0; fd < inCperG; fd++) {
+                int32_t in = inW[inIdx + fd] - inOffset;
+                for (unsigned i = 0; i < MIN(4, depthUnroll); i++) {
+                  sum[i] += (filterW[filterIdx + (sliceSize * i) + fd] -
+                             filterOffset) *
+                            in;
                 }
+              }
 
-                // Calculate the indices into the Filter and Input buffers.
-                size_t inIdx = libjit_getXYZW(inWdims, n, (size_t)ox,
-                                              (size_t)oy, g * inCperG);
-                size_t filterIdx = libjit_getXYZW(filterWdims, d, fx, fy, 0);
-                size_t sliceSize =
-                    filterWdims[1] * filterWdims[2] * filterWdims[3];
-
-                // Perform the innermost loop of the convolution using 4 vector
-                // registers.
+              // And perform the innermost loop again with 4 more registers.
+              if (depthUnroll > 4)
                 for (size_t fd = 0; fd < inCperG; fd++) {
                   int32_t in = inW[inIdx + fd] - inOffset;
-                  for (unsigned i = 0; i < MIN(4, depthUnroll); i++) {
+                  for (unsigned i = 4; i < MIN(8, depthUnroll); i++) {
                     sum[i] += (filterW[filterIdx + (sliceSize * i) + fd] -
                                filterOffset) *
                               in;
                   }
                 }
-
-                // And perform the innermost loop again with 4 more registers.
-                if (depthUnroll > 4)
-                  for (size_t fd = 0; fd < inCperG; fd++) {
-                    int32_t in = inW[inIdx + fd] - inOffset;
-                    for (unsigned i = 4; i < MIN(8, depthUnroll); i++) {
-                      sum[i] += (filterW[filterIdx + (sliceSize * i) + fd] -
-                                 filterOffset) *
-                                in;
-                    }
-                  }
-              }
             }
+          }
 
-            for (unsigned i = 0; i < depthUnroll; i++) {
-              // Scale the result back to the expected destination scale.
-              int32_t scaledSum = libjit_scale_i32i8(sum[i], outPre, outPost,
-                                                     outScale, outOffset);
-              outW[libjit_getXYZW(outWdims, n, ax, ay, d + i)] =
-                  libjit_clip(scaledSum);
-            }
-          } // W
-        }   // H
-      }     // C
-    }       // G
-  }         // N
+          for (unsigned i = 0; i < depthUnroll; i++) {
+            // Scale the result back to the expected destination scale.
+            int32_t scaledSum = libjit_scale_i32i8(sum[i], outPre, outPost,
+                                                   outScale, outOffset);
+            outW[libjit_getXYZW(outWdims, n, ax, ay, d + i)] =
+                libjit_clip(scaledSum);
+          }
+        } // W
+      }   // H
+    }     // C
+  };
+  libjit_parallel_for(split.numTasks, task);
+}
+
+/// Performs the quantized convolution with the filter \p filterW, that is
+/// packed with the layout [G * S, K, K, C / 2, 16, 2], where S is the number of
+/// strips of 16 output channels of a group and C is the number of input
+/// channels of a group. The pairs of input channels are interleaved for every
+/// output channel, the padding is filled with the filter offset. The input
+/// rows of every output row are packed as pairs of int16 values, with the
+/// offset subtracted and the padding filled with zeros. Then every tile of 4
+/// pixels and 16 channels is accumulated in int32 with pmaddwd-style
+/// operations, starting from the scaled bias, and requantized in vectors.
+void libjit_quantizedConv_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW, const int8_t *biasW,
+    const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
+    const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
+    size_t group, int32_t outOffset, int32_t inOffset, int32_t filterOffset,
+    int32_t biasOffset, int32_t biasPre, int32_t biasPost, int32_t biasScale,
+    int32_t outPre, int32_t outPost, int32_t outScale) {
+  size_t inChannels = inWdims[3];
+  size_t outChannels = outWdims[3];
+  size_t inCperG = inChannels / group;
+  size_t outCperG = outChannels / group;
+  size_t stripsPerGroup = (outCperG + qconvChannels - 1) / qconvChannels;
+  size_t outWidth = outWdims[2];
+  size_t pad_t = pads[0];
+  size_t pad_l = pads[1];
+
+  libjit_quantizedConv_params p;
+  p.filterSize = filterSize;
+  p.stride = stride;
+  p.rowWidth = (outWidth - 1) * stride + filterSize;
+  p.cPairs = (inCperG + 1) / 2;
+  int16x16 zero = {};
+  p.filterOffset = zero + (int16_t)filterOffset;
+  p.outOffset = outOffset;
+  p.outPre = outPre;
+  p.outPost = outPost;
+  p.outScale = outScale;
+  size_t stripSize = filterSize * filterSize * p.cPairs * qconvChannels * 2;
+
+  // The channel units are the strips of output channels of all groups.
+  size_t numUnits = group * stripsPerGroup;
+  libjit_nhwc_split split(inWdims[0], outWdims[1], numUnits);
+
+  auto task = [&](size_t taskId) {
+    size_t n, axBegin, axEnd, unitBegin, unitEnd;
+    split.getTask(taskId, outWdims[1], numUnits, n, axBegin, axEnd, unitBegin,
+                  unitEnd);
+    int32_t rows[filterSize * p.rowWidth * p.cPairs]
+        __attribute__((aligned(64)));
+
+    for (size_t ax = axBegin; ax < axEnd; ax++) {
+      ssize_t inX = (ssize_t)(ax * stride) - (ssize_t)pad_t;
+      // The group whose input rows are in the buffer.
+      size_t packedGroup = group;
+
+      for (size_t u = unitBegin; u < unitEnd; u++) {
+        size_t g = u / stripsPerGroup;
+        size_t c = (u % stripsPerGroup) * qconvChannels;
+        size_t d = g * outCperG + c;
+        size_t cols = MIN(outCperG - c, qconvChannels);
+        if (g != packedGroup) {
+          libjit_quantizedConv_pack_rows(inW, inWdims, n, inX, filterSize,
+                                         pad_l, p.rowWidth, g * inCperG,
+                                         inCperG, inOffset, rows);
+          packedGroup = g;
+        }
+
+        // Scale the bias to match the scale of the accumulators.
+        int32_t biasSum[qconvChannels] = {0};
+        for (size_t i = 0; i < cols; i++) {
+          biasSum[i] = libjit_scale_i32i8((int32_t)biasW[d + i] - biasOffset,
+                                          biasPre, biasPost, biasScale, 0);
+        }
+        int32x8 bias[2];
+        memcpy(bias, biasSum, sizeof(bias));
+
+        const int8_t *filter = &filterW[u * stripSize];
+        int8_t *out = &outW[libjit_getXYZW(outWdims, n, ax, 0, d)];
+        size_t ay = 0;
+        for (; ay + qconvPixels <= outWidth; ay += qconvPixels) {
+          libjit_quantizedConv_pixels<qconvPixels>(
+              &rows[ay * stride * p.cPairs], filter, bias,
+              &out[ay * outChannels], outChannels, cols, p);
+        }
+        const int32_t *in = &rows[ay * stride * p.cPairs];
+        switch (outWidth - ay) {
+        case 3:
+          libjit_quantizedConv_pixels<3>(in, filter, bias,
+                                         &out[ay * outChannels], outChannels,
+                                         cols, p);
+          break;
+        case 2:
+          libjit_quantizedConv_pixels<2>(in, filter, bias,
+                                         &out[ay * outChannels], outChannels,
+                                         cols, p);
+          break;
+        case 1:
+          libjit_quantizedConv_pixels<1>(in, filter, bias,
+                                         &out[ay * outChannels], outChannels,
+                                         cols, p);
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  };
+  libjit_parallel_for(split.numTasks, task);
+}
+
+/// Performs the convolution with a 3 x 3 filter and stride 1 with the
+/// Winograd algorithm F(\p tileSize x \p tileSize, 3 x 3), where the tile size
+/// is 2 or 4. The filter \p filterW is transformed at compile time, with the
+/// layout [G, A * A, S, C, 16], where A = tileSize + 2 is the size of the
+/// input tiles, S is the number of strips of 16 output channels of a group
+/// and C is the number of input channels of a group.
+void libjit_winogradConv_f(float *outW, const float *inW, const float *filterW,
+                           const float *biasW, const size_t *outWdims,
+                           const size_t *inWdims, const size_t *filterWdims,
+                           const size_t *biasWdims, size_t *pads, size_t group,
+                           size_t tileSize) {
+  if (tileSize == 2) {
+    libjit_winograd_conv<2>(outW, inW, filterW, biasW, outWdims, inWdims,
+                            pads, group);
+  } else {
+    libjit_winograd_conv<4>(outW, inW, filterW, biasW, outWdims, inWdims,
+                            pads, group);
+  }
+}
+
+/// Performs the convolution as matrix multiplications with the GEMM of
+/// libjit_matmul_f. The filter \p filterW is transposed at compile time to
+/// the layout [G, K, K, C, D], where C and D are the input and output channels
+/// of a group, so that the filter of a group is a (K * K * C) x D matrix. The
+/// patches of a block of output pixels are gathered into the rows of a matrix
+/// (im2col), which is multiplied with the filter and accumulated into the
+/// output, that is initialized with the bias. The input of a 1x1 convolution
+/// with stride 1 and no padding is already such a matrix, so it is multiplied
+/// directly.
+void libjit_convGEMM_f(float *outW, const float *inW, const float *filterW,
+                       const float *biasW, const size_t *outWdims,
+                       const size_t *inWdims, const size_t *filterWdims,
+                       const size_t *biasWdims, size_t filterSize,
+                       size_t stride, size_t *pads, size_t group) {
+  size_t N = inWdims[0];
+  size_t inChannels = inWdims[3];
+  size_t outChannels = outWdims[3];
+  size_t C = inChannels / group;
+  size_t D = outChannels / group;
+  size_t outPixels = outWdims[1] * outWdims[2];
+  size_t rowSize = filterSize * filterSize * C;
+
+  // Initialize the output with the bias, every task initializes a row.
+  auto initTask = [&](size_t taskId) {
+    size_t ax = taskId % outWdims[1];
+    libjit_conv_init_output_with_bias(taskId / outWdims[1], outW, biasW,
+                                      outWdims, biasWdims, ax, ax + 1, 0,
+                                      outChannels);
+  };
+  libjit_parallel_for(N * outWdims[1], initTask);
+
+  if (filterSize == 1 && stride == 1 && !pads[0] && !pads[1] && !pads[2] &&
+      !pads[3]) {
+    for (size_t g = 0; g < group; g++) {
+      libjit_matmul_acc_f(&outW[g * D], &inW[g * C], &filterW[g * C * D],
+                          N * outPixels, D, C, outChannels, inChannels, D);
+    }
+    return;
+  }
+
+  size_t blockPixels = MAX(MIN(gemmBufferSize / rowSize, outPixels), 1);
+  float patches[blockPixels * rowSize] __attribute__((aligned(64)));
+  size_t threads = libjit_num_threads();
+
+  for (size_t n = 0; n < N; n++) {
+    for (size_t g = 0; g < group; g++) {
+      for (size_t p = 0; p < outPixels; p += blockPixels) {
+        size_t numPixels = MIN(outPixels - p, blockPixels);
+        // Gather the patches of the block in parallel.
+        size_t chunk = (numPixels + threads - 1) / threads;
+        auto task = [&](size_t taskId) {
+          size_t begin = p + taskId * chunk;
+          size_t end = MIN(begin + chunk, p + numPixels);
+          libjit_convGEMM_im2col(inW, inWdims, outWdims, n, g, C, filterSize,
+                                 stride, pads, begin, end,
+                                 &patches[(begin - p) * rowSize]);
+        };
+        libjit_parallel_for((numPixels + chunk - 1) / chunk, task);
+
+        libjit_matmul_acc_f(&outW[(n * outPixels + p) * outChannels + g * D],
+                            patches, &filterW[g * rowSize * D], numPixels, D,
+                            rowSize, outChannels, rowSize, D);
+      }
+    }
+  }
+}
+
+/// Performs the depthwise convolution, where the number of groups is the
+/// number of input channels, with the filter \p filterW of the layout
+/// [K, K, D] that is transposed at compile time. The channels are contiguous
+/// in the input, the filter and the output, so the kernel vectorizes across
+/// them.
+void libjit_depthwiseConv_f(float *outW, const float *inW,
+                            const float *filterW, const float *biasW,
+                            const size_t *outWdims, const size_t *inWdims,
+                            const size_t *filterWdims, const size_t *biasWdims,
+                            size_t filterSize, size_t stride, size_t *pads) {
+  libjit_depthwise_float ops;
+  ops.biasW = biasW;
+  libjit_depthwise_conv(ops, outW, inW, filterW, outWdims, inWdims, filterSize,
+                        stride, pads);
+}
+
+/// Performs the quantized depthwise convolution like libjit_depthwiseConv_f.
+/// The products are accumulated in int32, starting from the scaled bias, and
+/// the sums are scaled back to the output like in libjit_convolution_i8.
+void libjit_depthwiseConv_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW, const int8_t *biasW,
+    const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
+    const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
+    int32_t outOffset, int32_t inOffset, int32_t filterOffset,
+    int32_t biasOffset, int32_t biasPre, int32_t biasPost, int32_t biasScale,
+    int32_t outPre, int32_t outPost, int32_t outScale) {
+  libjit_depthwise_i8 ops;
+  ops.biasW = biasW;
+  ops.outOffset = outOffset;
+  ops.inOffset = inOffset;
+  ops.filterOffset = filterOffset;
+  ops.biasOffset = biasOffset;
+  ops.biasPre = biasPre;
+  ops.biasPost = biasPost;
+  ops.biasScale = biasScale;
+  ops.outPre = outPre;
+  ops.outPost = outPost;
+  ops.outScale = outScale;
+  libjit_depthwise_conv(ops, outW, inW, filterW, outWdims, inWdims, filterSize,
+                        stride, pads);
 }
 
 void libjit_convolution_grad_f(float *inG, const float *outG, const float *inW,
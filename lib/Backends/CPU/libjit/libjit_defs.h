@@ -21,6 +21,11 @@
 
 typedef float float4 __attribute__((ext_vector_type(4)));
 typedef float float8 __attribute__((ext_vector_type(8)));
+typedef int8_t int8x8 __attribute__((ext_vector_type(8)));
+typedef int8_t int8x16 __attribute__((ext_vector_type(16)));
+typedef int16_t int16x8 __attribute__((ext_vector_type(8)));
+typedef int16_t int16x16 __attribute__((ext_vector_type(16)));
+typedef int32_t int32x8 __attribute__((ext_vector_type(8)));
 
 /// Loads a simd float8 value from \p ptr.
 #define LoadFloat8(PTR) *((const float8 *)(PTR))
@@ -88,6 +93,101 @@ inline size_t libjit_getXY(const size_t *dims, size_t x, size_t y) {
   return (x * dims[1]) + y;
 }
 
+extern "C" {
+/// A task that is executed by libjit_parallel_for. \p ctx is the opaque
+/// context pointer passed to libjit_parallel_for and \p taskId is the index of
+/// the task.
+typedef void (*libjit_task_fn)(void *ctx, size_t taskId);
+
+/// A dispatcher that runs tasks [0, numTasks) of \p fn in parallel and returns
+/// when all of them have finished.
+typedef void (*libjit_parallel_for_fn)(size_t numTasks, libjit_task_fn fn,
+                                       void *ctx);
+
+/// Notifies the host that the step \p stepId of the code begins or ends on the
+/// calling thread. \p ctx is the opaque pointer in libjit_hook_trace_ctx.
+typedef void (*libjit_trace_fn)(void *ctx, size_t stepId);
+
+/// The runtime hooks are written by the host after the code has been loaded.
+/// They are null/1 by default, which runs all of the kernels serially on the
+/// calling thread (e.g. in AOT bundles) and does not trace the steps.
+extern libjit_parallel_for_fn libjit_hook_parallel_for;
+extern size_t libjit_hook_num_threads;
+extern libjit_trace_fn libjit_hook_trace_begin;
+extern libjit_trace_fn libjit_hook_trace_end;
+extern void *libjit_hook_trace_ctx;
+}
+
+/// \returns the number of threads that the kernels should split their work
+/// across.
+inline size_t libjit_num_threads() {
+  return libjit_hook_parallel_for ? MAX(libjit_hook_num_threads, 1) : 1;
+}
+
+/// Run \p fn(id) for every id in [0, \p numTasks), in parallel if the host
+/// installed a dispatcher. \p fn must only write to memory that is disjoint
+/// from the memory written by the other tasks.
+template <typename Fn> void libjit_parallel_for(size_t numTasks, Fn &fn) {
+  auto trampoline = [](void *ctx, size_t taskId) { (*(Fn *)ctx)(taskId); };
+  if (numTasks > 1 && libjit_hook_parallel_for) {
+    libjit_hook_parallel_for(numTasks, trampoline, &fn);
+    return;
+  }
+  for (size_t i = 0; i < numTasks; i++) {
+    fn(i);
+  }
+}
+
+/// Adds the product of the row-major matrices \p a (\p m x \p k) and \p b
+/// (\p k x \p n) to the row-major matrix \p c (\p m x \p n). The rows of
+/// \p c, \p a and \p b are \p ldc, \p lda and \p ldb floats apart. This is
+/// the GEMM of libjit_matmul_f, which is shared with the convolutions.
+void libjit_matmul_acc_f(float *c, const float *a, const float *b, size_t m,
+                         size_t n, size_t k, size_t ldc, size_t lda,
+                         size_t ldb);
+
+/// Describes how the NHWC output of a kernel is split into tasks. Every task
+/// processes a range of rows (the H dimension) and a range of channel units of
+/// a single sample in the batch. A channel unit is a kernel-specific group of
+/// output channels that must be processed together (e.g. the unrolled depth).
+struct libjit_nhwc_split {
+  size_t rowTasks;
+  size_t rowsPerTask;
+  size_t unitTasks;
+  size_t unitsPerTask;
+  size_t numTasks;
+
+  /// Split \p N samples of \p H rows and \p units channel units into tasks,
+  /// so that there is roughly one task per thread. Samples are never split
+  /// when there are enough of them to keep all threads busy.
+  libjit_nhwc_split(size_t N, size_t H, size_t units) {
+    size_t threads = libjit_num_threads();
+    size_t perSample = (threads + N - 1) / N;
+    rowTasks = MIN(MAX(H, 1), perSample);
+    unitTasks = MIN(MAX(units, 1), (perSample + rowTasks - 1) / rowTasks);
+    rowsPerTask = (H + rowTasks - 1) / rowTasks;
+    unitsPerTask = (units + unitTasks - 1) / unitTasks;
+    // Drop the empty tasks that the rounding above could have created.
+    rowTasks = rowsPerTask ? (H + rowsPerTask - 1) / rowsPerTask : 1;
+    unitTasks = unitsPerTask ? (units + unitsPerTask - 1) / unitsPerTask : 1;
+    numTasks = N * rowTasks * unitTasks;
+  }
+
+  /// Decode the task \p taskId into the sample \p n, the row range
+  /// [\p rowBegin, \p rowEnd) and the unit range [\p unitBegin, \p unitEnd).
+  void getTask(size_t taskId, size_t H, size_t units, size_t &n,
+               size_t &rowBegin, size_t &rowEnd, size_t &unitBegin,
+               size_t &unitEnd) const {
+    size_t unitTask = taskId % unitTasks;
+    size_t rowTask = (taskId / unitTasks) % rowTasks;
+    n = taskId / (unitTasks * rowTasks);
+    rowBegin = rowTask * rowsPerTask;
+    rowEnd = MIN(rowBegin + rowsPerTask, H);
+    unitBegin = unitTask * unitsPerTask;
+    unitEnd = MIN(unitBegin + unitsPerTask, units);
+  }
+};
+
 inline int8_t libjit_clip(int32_t val) {
   return (int8_t)MIN(MAX(val, -128), 127);
 }
@@ -109,4 +209,37 @@ inline int32_t libjit_scale_i32i8(int32_t input, int32_t pre, int32_t post,
   return ((((input >> pre) * scale) + rtn) >> post) + offset;
 }
 
+/// Scales eight 32-bit integers like libjit_scale_i32i8, and clips them to
+/// int8.
+inline int8x8 libjit_scale_i32i8_x8(int32x8 input, int32_t pre, int32_t post,
+                                    int32_t scale, int32_t offset) {
+  int32_t rtn = (post > 0) ? (1 << (post - 1)) : 0;
+  int32x8 s = ((((input >> pre) * scale) + rtn) >> post) + offset;
+  int32x8 over = s > 127;
+  s = (s & ~over) | (over & 127);
+  int32x8 under = s < -128;
+  s = (s & ~under) | (under & -128);
+  return __builtin_convertvector(s, int8x8);
+}
+
+/// \returns the int16 values \p lo and \p hi as a pair in an int32, in the
+/// order of the elements of a vector.
+inline int32_t libjit_pair_i16(int16_t lo, int16_t hi) {
+  return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+/// \returns the sums of the products of the adjacent pairs of int16 values in
+/// \p a and \p b. LLVM selects pmaddwd (or vpdpwssd with AVX-512 VNNI) for
+/// this pattern.
+inline int32x8 libjit_madd_i16(int16x16 a, int16x16 b) {
+  int16x8 aEven = __builtin_shufflevector(a, a, 0, 2, 4, 6, 8, 10, 12, 14);
+  int16x8 aOdd = __builtin_shufflevector(a, a, 1, 3, 5, 7, 9, 11, 13, 15);
+  int16x8 bEven = __builtin_shufflevector(b, b, 0, 2, 4, 6, 8, 10, 12, 14);
+  int16x8 bOdd = __builtin_shufflevector(b, b, 1, 3, 5, 7, 9, 11, 13, 15);
+  return __builtin_convertvector(aEven, int32x8) *
+             __builtin_convertvector(bEven, int32x8) +
+         __builtin_convertvector(aOdd, int32x8) *
+             __builtin_convertvector(bOdd, int32x8);
+}
+
 #endif // GLOW_BACKENDS_CPU_LIBJIT_LIBJIT_DEFS_H
@@ -221,11 +221,17 @@ void libjit_matmul_inner(int m, int n, int k, const float *a, int lda,
 /// \p c is a \p m x \p n column-major matrix.
 /// \p lda, \p ldb, and \p ldc are the leading dimensions of A, B, and C,
 /// respectively.
+/// The mc * nc blocks of C are independent, so they are distributed between
+/// the threads. When there are fewer blocks than threads, the columns of each
+/// block are split further at multiples of the kernel width, which keeps the
+/// results bit-identical to the serial computation.
 template <bool pack>
 void __attribute__((noinline))
 libjit_matmul_outer(size_t m, size_t n, size_t k, const float *a, size_t lda,
                     const float *b, size_t ldb, float *c, size_t ldc) {
   float packedB[kc * nc] __attribute__((aligned(64)));
+  size_t threads = libjit_num_threads();
+  size_t iBlocks = (m + mc - 1) / mc;
 
   for (size_t p = 0; p < k; p += kc) {
     size_t pb = MIN(k - p, kc);
@@ -234,11 +240,21 @@ libjit_matmul_outer(size_t m, size_t n, size_t k, const float *a, size_t lda,
       if (pack) {
         pack_matrix_b<regsB>(jb, pb, &B(p, j), ldb, packedB);
       }
-      for (size_t i = 0; i < m; i += mc) {
+      // Split the columns of the panel into chunks of whole kernel widths.
+      size_t jChunks = MAX(MIN((threads + iBlocks - 1) / iBlocks, jb / nr), 1);
+      size_t jChunk = (jb + jChunks - 1) / jChunks;
+      jChunk = (jChunk + nr - 1) / nr * nr;
+      jChunks = (jb + jChunk - 1) / jChunk;
+
+      auto task = [&](size_t taskId) {
+        size_t i = (taskId / jChunks) * mc;
+        size_t jj = (taskId % jChunks) * jChunk;
         size_t ib = MIN(m - i, mc);
-        libjit_matmul_inner<pack>(ib, jb, pb, &A(i, p), lda, &B(p, j), ldb,
-                                  &C(i, j), ldc, packedB);
-      }
+        size_t jjb = MIN(jb - jj, jChunk);
+        libjit_matmul_inner<pack>(ib, jjb, pb, &A(i, p), lda, &B(p, j + jj),
+                                  ldb, &C(i, j + jj), ldc, packedB + jj * pb);
+      };
+      libjit_parallel_for(iBlocks * jChunks, task);
     }
   }
 }
@@ -247,8 +263,225 @@ libjit_matmul_outer(size_t m, size_t n, size_t k, const float *a, size_t lda,
 #undef B
 #undef A
 
+/// Number of rows of the output that the int8 kernel computes at once.
+constexpr size_t i8Rows = 4;
+/// Number of columns of the output that the int8 kernel computes at once. The
+/// accumulators of every row are two vectors of eight int32 values.
+constexpr size_t i8Cols = 16;
+/// Number of rows of the output that are assigned to a single task.
+constexpr size_t i8RowBlock = 64;
+/// Number of int16 elements in the buffer of the packed rhs panel.
+constexpr size_t i8PanelSize = 512 * 1024;
+/// Maximal number of columns in a packed rhs panel.
+constexpr size_t i8MaxPanelCols = 4096;
+/// Number of int32 elements in the buffer of the packed lhs rows of a task.
+/// This is enough for a group of i8Rows rows of the largest supported k.
+constexpr size_t i8PackedRowsSize = i8Rows * i8PanelSize / (i8Cols * 2);
+
+/// The parameters of a quantized matrix multiplication.
+struct libjit_matmul_i8_params {
+  size_t k;
+  int32_t lhsOffset;
+  int32_t rhsOffset;
+  int32_t outOffset;
+  int32_t outPre;
+  int32_t outPost;
+  int32_t outScale;
+};
+
+/// Pack the columns [\p j, \p j + \p cols) of the row-major k x n matrix \p b
+/// into \p packed, as strips of i8Cols columns. Every strip holds the pairs of
+/// adjacent rows of its columns as int16 values: {b(0, j), b(1, j), b(0, j +
+/// 1), b(1, j + 1), ...}, then the rows 2 and 3, etc. The strips are padded
+/// with zeros to a whole number of columns and of row pairs. The sums of the
+/// columns are written to \p colSum.
+void libjit_pack_matrix_b_i8(size_t k, size_t n, size_t j, size_t cols,
+                             const int8_t *b, int16_t *packed,
+                             int32_t *colSum) {
+  size_t kPairs = (k + 1) / 2;
+  size_t strips = (cols + i8Cols - 1) / i8Cols;
+  auto task = [&](size_t s) {
+    int16x16 *to = (int16x16 *)&packed[s * kPairs * i8Cols * 2];
+    size_t sb = MIN(cols - s * i8Cols, i8Cols);
+    const int8_t *from = &b[j + s * i8Cols];
+    int32x8 sum[2] = {};
+    for (size_t q = 0; q < kPairs; q++) {
+      const int8_t *lo = &from[2 * q * n];
+      bool hasHi = 2 * q + 1 < k;
+      const int8_t *hi = hasHi ? &from[(2 * q + 1) * n] : lo;
+      int8x16 l = {}, h = {};
+      if (sb == i8Cols) {
+        memcpy(&l, lo, sizeof(l));
+        if (hasHi) {
+          memcpy(&h, hi, sizeof(h));
+        }
+      } else {
+        memcpy(&l, lo, sb);
+        if (hasHi) {
+          memcpy(&h, hi, sb);
+        }
+      }
+      int16x16 l16 = __builtin_convertvector(l, int16x16);
+      int16x16 h16 = __builtin_convertvector(h, int16x16);
+      *to++ = __builtin_shufflevector(l16, h16, 0, 16, 1, 17, 2, 18, 3, 19, 4,
+                                      20, 5, 21, 6, 22, 7, 23);
+      *to++ = __builtin_shufflevector(l16, h16, 8, 24, 9, 25, 10, 26, 11, 27,
+                                      12, 28, 13, 29, 14, 30, 15, 31);
+      int16x16 pairSum = l16 + h16;
+      sum[0] += __builtin_convertvector(
+          __builtin_shufflevector(pairSum, pairSum, 0, 1, 2, 3, 4, 5, 6, 7),
+          int32x8);
+      sum[1] += __builtin_convertvector(
+          __builtin_shufflevector(pairSum, pairSum, 8, 9, 10, 11, 12, 13, 14,
+                                  15),
+          int32x8);
+    }
+    memcpy(&colSum[s * i8Cols], sum, sizeof(sum));
+  };
+  libjit_parallel_for(strips, task);
+}
+
+/// Pack \p rows rows of the row-major matrix \p a, whose leading dimension is
+/// \p k, into \p packed, in groups of i8Rows rows. The pairs of adjacent
+/// elements are stored as int32 values (see libjit_pair_i16), and the pairs of
+/// the rows of a group are interleaved. The sums of the rows are written to
+/// \p rowSum.
+void libjit_pack_matrix_a_i8(size_t k, size_t rows, const int8_t *a,
+                             int32_t *packed, int32_t *rowSum) {
+  size_t kPairs = (k + 1) / 2;
+  for (size_t g = 0; g < rows; g += i8Rows) {
+    size_t gb = MIN(rows - g, i8Rows);
+    for (size_t r = 0; r < gb; r++) {
+      const int8_t *row = &a[(g + r) * k];
+      int32_t sum = 0;
+      for (size_t q = 0; q < kPairs; q++) {
+        int8_t hi = 2 * q + 1 < k ? row[2 * q + 1] : 0;
+        packed[q * gb + r] = libjit_pair_i16(row[2 * q], hi);
+        sum += row[2 * q] + hi;
+      }
+      rowSum[g + r] = sum;
+    }
+    packed += gb * kPairs;
+  }
+}
+
+/// Compute the products of \p rows packed rows \p a with a strip of the
+/// packed rhs \p b, and add them to \p acc. Every step multiplies a pair of
+/// rows of the strip with a pair of columns of \p a.
+template <size_t rows>
+void libjit_matmul_i8_dot(size_t kPairs, const int32_t *a, const int16x16 *b,
+                          int32x8 (&acc)[rows][2]) {
+  for (size_t q = 0; q < kPairs; q++) {
+    int16x16 b0 = b[2 * q];
+    int16x16 b1 = b[2 * q + 1];
+    for (size_t r = 0; r < rows; r++) {
+      int32x8 pair = {};
+      int16x16 aa = (int16x16)(pair + a[q * rows + r]);
+      acc[r][0] += libjit_madd_i16(aa, b0);
+      acc[r][1] += libjit_madd_i16(aa, b1);
+    }
+  }
+}
+
+/// Compute a block of \p rows x \p cols elements of the output \p c, whose
+/// leading dimension is \p ldc, from the packed rows \p a and the packed strip
+/// \p b. The offsets of the operands are folded in with the sums of the rows of
+/// the lhs \p rowSum and the sums of the columns of the rhs \p colSum: the
+/// product of the offset matrices is sum(a * b) - rhsOffset * rowSum -
+/// lhsOffset * colSum + k * lhsOffset * rhsOffset. The results are then
+/// requantized, eight at a time.
+template <size_t rows>
+void libjit_matmul_i8_block(const int32_t *a, const int16x16 *b, int8_t *c,
+                            size_t ldc, size_t cols, const int32_t *rowSum,
+                            const int32_t *colSum,
+                            const libjit_matmul_i8_params &p) {
+  int32x8 acc[rows][2] = {};
+  libjit_matmul_i8_dot<rows>((p.k + 1) / 2, a, b, acc);
+
+  int32_t kOffset = int32_t(p.k) * p.lhsOffset * p.rhsOffset;
+  for (size_t r = 0; r < rows; r++) {
+    for (size_t v = 0; v < 2 && v * 8 < cols; v++) {
+      int32x8 cs;
+      memcpy(&cs, &colSum[v * 8], sizeof(cs));
+      int32x8 s =
+          acc[r][v] - p.rhsOffset * rowSum[r] - p.lhsOffset * cs + kOffset;
+      int8x8 res = libjit_scale_i32i8_x8(s, p.outPre, p.outPost, p.outScale,
+                                         p.outOffset);
+      memcpy(&c[r * ldc + v * 8], &res, MIN(cols - v * 8, 8));
+    }
+  }
+}
+
+/// Compute the \p rows x \p cols block of the output \p c, whose leading
+/// dimension is \p ldc, from the packed rows \p a and the packed strip \p b.
+/// The strip is reused by all of the groups of rows.
+void libjit_matmul_i8_strip(size_t rows, const int32_t *a, const int16x16 *b,
+                            int8_t *c, size_t ldc, size_t cols,
+                            const int32_t *rowSum, const int32_t *colSum,
+                            const libjit_matmul_i8_params &p) {
+  size_t kPairs = (p.k + 1) / 2;
+  for (size_t r = 0; r < rows; r += i8Rows) {
+    const int32_t *group = &a[r * kPairs];
+    int8_t *out = &c[r * ldc];
+    switch (MIN(rows - r, i8Rows)) {
+    case 4:
+      libjit_matmul_i8_block<4>(group, b, out, ldc, cols, &rowSum[r], colSum,
+                                p);
+      break;
+    case 3:
+      libjit_matmul_i8_block<3>(group, b, out, ldc, cols, &rowSum[r], colSum,
+                                p);
+      break;
+    case 2:
+      libjit_matmul_i8_block<2>(group, b, out, ldc, cols, &rowSum[r], colSum,
+                                p);
+      break;
+    case 1:
+      libjit_matmul_i8_block<1>(group, b, out, ldc, cols, &rowSum[r], colSum,
+                                p);
+      break;
+    }
+  }
+}
+
+/// The reference implementation of the quantized matrix multiplication, for
+/// matrices whose rhs panels do not fit in the packing buffer.
+void libjit_matmul_i8_naive(int8_t *outW, const int8_t *lhsW,
+                            const int8_t *rhsW, size_t m, size_t n,
+                            const libjit_matmul_i8_params &p) {
+  for (size_t x = 0; x < m; x++) {
+    for (size_t y = 0; y < n; y++) {
+      int32_t sum = 0;
+      for (size_t i = 0; i < p.k; i++) {
+        int32_t lhs = lhsW[x * p.k + i] - p.lhsOffset;
+        int32_t rhs = rhsW[i * n + y] - p.rhsOffset;
+        sum += lhs * rhs;
+      }
+      int32_t s = libjit_scale_i32i8(sum, p.outPre, p.outPost, p.outScale,
+                                     p.outOffset);
+      outW[x * n + y] = libjit_clip(s);
+    }
+  }
+}
 } // namespace
 
+void libjit_matmul_acc_f(float *c, const float *a, const float *b, size_t m,
+                         size_t n, size_t k, size_t ldc, size_t lda,
+                         size_t ldb) {
+  // The "outer" helper assumes the matrices are given in column-major format
+  // (the packing algorithm is more effective with column-major matrices), while
+  // the input is row-major. So we compute C += B * A, which is equivalent.
+  //
+  // The matrix multiplication routine is heavily inspired by:
+  // https://github.com/flame/how-to-optimize-gemm
+  bool pack = n >= pack_threshold;
+  if (pack) {
+    libjit_matmul_outer<true>(n, m, k, b, ldb, a, lda, c, ldc);
+  } else {
+    libjit_matmul_outer<false>(n, m, k, b, ldb, a, lda, c, ldc);
+  }
+}
+
 extern "C" {
 
 /// Performs the matrix multiplication c = a * b, where c, a, and b are
@@ -260,44 +493,73 @@ void libjit_matmul_f(float *c, const float *a, const float *b,
                      const size_t *cDims, const size_t *aDims,
                      const size_t *bDims) {
   memset(c, 0, cDims[0] * cDims[1] * sizeof(float));
-  // Call the matrix multiplication routine with appropriate dimensions and
-  // leading dimensions. The "leading dimension" for a row-major matrix is equal
-  // to the number of columns in the matrix.  For a, this is k; for b and c,
-  // this is n.
-  //
-  // This "outer" helper assumes the matrices are given in column-major format
-  // (the packing algorithm is more effective with column-major matrices), while
-  // the input is row-major. So we compute C += B * A, which is equivalent.
-  //
-  // The matrix multiplication routine is heavily inspired by:
-  // https://github.com/flame/how-to-optimize-gemm
-  int m = cDims[1];
-  int n = cDims[0];
-  int k = aDims[1];
-  bool pack = m >= pack_threshold;
-  if (pack) {
-    libjit_matmul_outer<true>(m, n, k, b, bDims[1], a, aDims[1], c, cDims[1]);
-  } else {
-    libjit_matmul_outer<false>(m, n, k, b, bDims[1], a, aDims[1], c, cDims[1]);
-  }
+  // The "leading dimension" for a row-major matrix is equal to the number of
+  // columns in the matrix.  For a, this is k; for b and c, this is n.
+  libjit_matmul_acc_f(c, a, b, cDims[0], cDims[1], aDims[1], cDims[1],
+                      aDims[1], bDims[1]);
 }
 
+/// Performs the quantized matrix multiplication out = lhs * rhs, where out,
+/// lhs and rhs are row-major int8 matrices. The rhs is packed into panels of
+/// int16 pairs and the rows of the lhs into int32 pairs, that the
+/// register-blocked kernel multiplies with pmaddwd-style operations. The
+/// products are accumulated in int32 on the raw values of the operands, and
+/// the offsets are folded in by the requantization epilogue.
 void libjit_matmul_i8(int8_t *outW, const int8_t *lhsW, const int8_t *rhsW,
                       const size_t *outWdims, const size_t *lhsWdims,
                       const size_t *rhsWdims, int32_t outOffset,
                       int32_t lhsOffset, int32_t rhsOffset, int32_t outPre,
                       int32_t outPost, int32_t outScale) {
-  for (size_t x = 0; x < outWdims[0]; x++) {
-    for (size_t y = 0; y < outWdims[1]; y++) {
-      int32_t sum = 0;
-      for (size_t i = 0; i < lhsWdims[1]; i++) {
-        int32_t lhs = lhsW[libjit_getXY(lhsWdims, x, i)] - lhsOffset;
-        int32_t rhs = rhsW[libjit_getXY(rhsWdims, i, y)] - rhsOffset;
-        sum += lhs * rhs;
+  size_t m = outWdims[0];
+  size_t n = outWdims[1];
+  libjit_matmul_i8_params p = {lhsWdims[1], lhsOffset, rhsOffset, outOffset,
+                               outPre,      outPost,   outScale};
+  size_t kPairs = (p.k + 1) / 2;
+  size_t stripSize = kPairs * i8Cols * 2;
+  if (stripSize > i8PanelSize) {
+    libjit_matmul_i8_naive(outW, lhsW, rhsW, m, n, p);
+    return;
+  }
+
+  int16_t packedB[i8PanelSize] __attribute__((aligned(64)));
+  int32_t colSum[i8MaxPanelCols] __attribute__((aligned(64)));
+  size_t nc = MIN(i8PanelSize / stripSize * i8Cols, i8MaxPanelCols);
+  // The number of rows whose packed pairs fit in the buffer of a task.
+  size_t mc = MIN(i8PackedRowsSize / (kPairs * i8Rows) * i8Rows, i8RowBlock);
+  size_t threads = libjit_num_threads();
+  size_t iBlocks = (m + i8RowBlock - 1) / i8RowBlock;
+
+  for (size_t j = 0; j < n; j += nc) {
+    size_t jb = MIN(n - j, nc);
+    libjit_pack_matrix_b_i8(p.k, n, j, jb, rhsW, packedB, colSum);
+
+    // Split the columns of the panel into chunks of whole strips.
+    size_t strips = (jb + i8Cols - 1) / i8Cols;
+    size_t jChunks = MAX(MIN((threads + iBlocks - 1) / iBlocks, strips), 1);
+    size_t jChunk = (strips + jChunks - 1) / jChunks * i8Cols;
+    jChunks = (jb + jChunk - 1) / jChunk;
+
+    auto task = [&](size_t taskId) {
+      size_t i = (taskId / jChunks) * i8RowBlock;
+      size_t jj = (taskId % jChunks) * jChunk;
+      size_t ib = MIN(m - i, i8RowBlock);
+      size_t jjb = MIN(jb - jj, jChunk);
+      int32_t packedA[i8PackedRowsSize] __attribute__((aligned(64)));
+      int32_t rowSum[i8RowBlock];
+
+      for (size_t ii = 0; ii < ib; ii += mc) {
+        size_t iib = MIN(ib - ii, mc);
+        libjit_pack_matrix_a_i8(p.k, iib, &lhsW[(i + ii) * p.k], packedA,
+                                rowSum);
+        for (size_t s = jj; s < jj + jjb; s += i8Cols) {
+          libjit_matmul_i8_strip(
+              iib, packedA, (const int16x16 *)&packedB[s / i8Cols * stripSize],
+              &outW[(i + ii) * n + j + s], n, MIN(jj + jjb - s, i8Cols),
+              rowSum, &colSum[s], p);
+        }
       }
-      int32_t s = libjit_scale_i32i8(sum, outPre, outPost, outScale, outOffset);
-      outW[libjit_getXY(outWdims, x, y)] = libjit_clip(s);
-    }
+    };
+    libjit_parallel_for(iBlocks * jChunks, task);
   }
 }
 }
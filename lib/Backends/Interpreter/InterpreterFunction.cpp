@@ -19,25 +19,102 @@
 #include "glow/IR/IR.h"
 #include "glow/IR/IRUtils.h"
 #include "glow/IR/Instrs.h"
+#include "glow/Support/ExecutionProfile.h"
+#include "glow/Support/ThreadPool.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <algorithm>
+#include <thread>
 
 using namespace glow;
 
+namespace {
+llvm::cl::opt<unsigned> interpreterThreads(
+    "interpreter-threads",
+    llvm::cl::desc("Number of threads that run independent instructions of "
+                   "the interpreter in parallel (0 means one thread per core)"),
+    llvm::cl::init(1));
+
+llvm::cl::opt<std::string> interpreterProfile(
+    "interpreter-profile",
+    llvm::cl::desc("Time every instruction that the interpreter runs, and "
+                   "write a Chrome trace of the executions into the file"),
+    llvm::cl::value_desc("file.json"));
+
+llvm::cl::opt<std::string> interpreterProfileSummary(
+    "interpreter-profile-summary",
+    llvm::cl::desc("Time every instruction that the interpreter runs, and "
+                   "write the total time and the allocated memory of every "
+                   "instruction into the file"),
+    llvm::cl::value_desc("file.txt"));
+
+/// The number of bytes that the tensors created by getOrCreateTensor on this
+/// thread occupy, while the instructions are profiled.
+thread_local uint64_t threadAllocatedBytes = 0;
+
+/// \returns the profile that the instructions are recorded in, or null if they
+/// are not profiled.
+ExecutionProfile *getInterpreterProfile() {
+  if (interpreterProfile.empty() && interpreterProfileSummary.empty()) {
+    return nullptr;
+  }
+  // The files are written when the profile is destroyed at exit.
+  static ExecutionProfile profile("interpreter");
+  profile.setOutputFiles(interpreterProfile, interpreterProfileSummary);
+  return &profile;
+}
+
+/// \returns the number of threads that the interpreter runs on.
+unsigned getInterpreterNumThreads() {
+  if (interpreterThreads == 0) {
+    return std::max(1u, std::thread::hardware_concurrency());
+  }
+  return interpreterThreads;
+}
+
+/// \returns the thread pool that runs the instructions. The thread that calls
+/// execute() participates, so the pool has one thread less than requested.
+ThreadPool &getThreadPool() {
+  static ThreadPool pool(getInterpreterNumThreads() - 1);
+  return pool;
+}
+} // namespace
+
 InterpreterFunction::InterpreterFunction(std::unique_ptr<IRFunction> F)
     : F_(std::move(F)) {
-  for (auto &v : F_->getGraph()->getParent()->getVars()) {
-    auto *w = F_->getWeightForNode(v);
-    assert(!externalTensors_.count(w) && "The tensor is already registered");
-    externalTensors_[w] = &v->getPayload();
+  // Only the weights that the instructions use are bound, so variables that
+  // are added to the module later, or that only other functions use, are
+  // never looked up.
+  for (auto &p : F_->getVariableMap()) {
+    if (p.second->hasUsers()) {
+      // The IR refers to the variables of the module, which are mutable.
+      auto *v = llvm::cast<Variable>(const_cast<Node *>(p.first));
+      weights_.emplace_back(v, p.second);
+    }
   }
+  for (auto &w : weights_) {
+    if (!w.first->isPrivate()) {
+      defaultContext_.bind(w.first, &w.first->getPayload());
+    }
+  }
+  defaultContext_.setOwner(this);
 
-  for (auto *W : F_->getWeights()) {
-    getOrCreateTensor(W);
+  if (getInterpreterNumThreads() > 1) {
+    buildParallelGraph();
   }
 }
 
-InterpreterFunction::~InterpreterFunction() {
+InterpreterFunction::~InterpreterFunction() = default;
+
+BoundInterpreterFunction::BoundInterpreterFunction(
+    std::unordered_map<const Value *, Tensor *> externalTensors,
+    ExecutionProfile *profile)
+    : externalTensors_(std::move(externalTensors)), profile_(profile) {}
+
+BoundInterpreterFunction::~BoundInterpreterFunction() {
   // Delete the tensors that are owned by this backend.
   for (auto p : tensors_) {
     delete p.second;
@@ -46,7 +123,7 @@ InterpreterFunction::~InterpreterFunction() {
   externalTensors_.clear();
 }
 
-Tensor *InterpreterFunction::getTensor(const Value *v) const {
+Tensor *BoundInterpreterFunction::getTensor(const Value *v) const {
   auto it = tensors_.find(v);
   if (it != tensors_.end()) {
     return it->second;
@@ -57,7 +134,7 @@ Tensor *InterpreterFunction::getTensor(const Value *v) const {
   return ie->second;
 }
 
-Tensor *InterpreterFunction::getOrCreateTensor(const Value *v) {
+Tensor *BoundInterpreterFunction::getOrCreateTensor(const Value *v) {
   auto ie = externalTensors_.find(v);
   if (ie != externalTensors_.end()) {
     return ie->second;
@@ -68,14 +145,16 @@ Tensor *InterpreterFunction::getOrCreateTensor(const Value *v) {
   if (it == tensors_.end()) {
     auto *T = new Tensor(v->getType());
     tensors_[v] = T;
+    if (profile_) {
+      threadAllocatedBytes += T->getType().getSizeInBytes();
+    }
     return T;
   }
   return it->second;
 }
 
-Tensor *
-InterpreterFunction::getOrCreateUnownedTensor(const Value *v, const Value *src,
-                                              llvm::ArrayRef<size_t> offsets) {
+Tensor *BoundInterpreterFunction::getOrCreateUnownedTensor(
+    const Value *v, const Value *src, llvm::ArrayRef<size_t> offsets) {
   assert(llvm::isa<TensorViewInst>(v) && "Expected a tensor view");
 
   // Pick the tensor.
@@ -92,7 +171,7 @@ InterpreterFunction::getOrCreateUnownedTensor(const Value *v, const Value *src,
   return T;
 }
 
-void InterpreterFunction::deleteTensor(const Value *v) {
+void BoundInterpreterFunction::deleteTensor(const Value *v) {
   auto it = tensors_.find(v);
   if (it == tensors_.end()) {
     return;
@@ -102,22 +181,126 @@ void InterpreterFunction::deleteTensor(const Value *v) {
   tensors_.erase(it);
 }
 
-void InterpreterFunction::execute() {
-// Do the forward pass.
+void BoundInterpreterFunction::fwdInstr(const Instruction *I) {
+  if (!profile_) {
+    dispatch(I);
+    return;
+  }
+  // The instruction runs on this thread, so the tensors that this thread
+  // created in the meantime were created by the instruction.
+  uint64_t allocatedBytes = threadAllocatedBytes;
+  auto begin = profile_->sample();
+  dispatch(I);
+  auto end = profile_->sample();
+  ExecutionProfile::InstrCost cost;
+  cost.flops = estimateFLOPs(I);
+  cost.bytes = getOperandsSizeInBytes(I);
+  profile_->addEvent(I->getName(), I->getKindName(), begin, end, cost,
+                     threadAllocatedBytes - allocatedBytes);
+}
+
+void BoundInterpreterFunction::dispatch(const Instruction *I) {
 #define DEF_VALUE(CLASS, NAME)
 #define DEF_INSTR(CLASS, NAME)                                                 \
   case Kinded::Kind::CLASS##Kind: {                                            \
-    fwd##CLASS(llvm::cast<CLASS>(&I));                                         \
+    fwd##CLASS(llvm::cast<CLASS>(I));                                          \
     break;                                                                     \
   }
 #define DEF_BACKEND_SPECIFIC_INSTR(CLASS, NAME)
+  switch (I->getKind()) {
+#include "glow/AutoGenInstr.def"
+
+  default:
+    llvm_unreachable("Invalid instruction.");
+  }
+}
+
+void InterpreterFunction::buildParallelGraph() {
+  for (const auto &I : F_->getInstrs()) {
+    // The tensors of the memory management instructions are created before
+    // and destroyed after the parallel part of the execution.
+    if (llvm::isa<AllocActivationInst>(&I) ||
+        llvm::isa<DeallocActivationInst>(&I) ||
+        llvm::isa<TensorViewInst>(&I)) {
+      continue;
+    }
+    // Every allocation and weight is backed by its own tensor, so two
+    // operands overlap iff they have the same origin. The address of the
+    // origin identifies the tensor.
+    llvm::SmallVector<MemoryAccess, 4> accesses;
+    for (const auto &op : I.getOperands()) {
+      auto origin = reinterpret_cast<size_t>(getOrigin(op.first));
+      accesses.push_back({origin, 0, 1, op.second != OperandKind::In});
+    }
+    parallelGraph_.addTask(accesses);
+    parallelInstrs_.push_back(&I);
+  }
+}
+
+void InterpreterFunction::runParallel(BoundInterpreterFunction &bound) const {
+  // The instructions can't create and destroy tensors while other
+  // instructions are running, so all of the activations of the function are
+  // alive during the whole execution.
+  for (const auto &I : F_->getInstrs()) {
+    if (llvm::isa<AllocActivationInst>(&I) || llvm::isa<TensorViewInst>(&I)) {
+      bound.fwdInstr(&I);
+    }
+  }
+
+  parallelGraph_.run(getThreadPool(), [&](unsigned id) {
+    bound.fwdInstr(parallelInstrs_[id]);
+  });
+
+  for (const auto &I : F_->getInstrs()) {
+    if (llvm::isa<DeallocActivationInst>(&I)) {
+      bound.fwdInstr(&I);
+    }
+  }
+}
+
+void InterpreterFunction::run(BoundInterpreterFunction &bound) const {
+  if (!parallelInstrs_.empty()) {
+    runParallel(bound);
+    return;
+  }
+
   // Dispatch the interpreter on each instruction in the program:
   for (const auto &I : F_->getInstrs()) {
-    switch (I.getKind()) {
-#include "glow/AutoGenInstr.def"
+    bound.fwdInstr(&I);
+  }
+}
+
+void InterpreterFunction::execute() { execute(defaultContext_); }
 
-    default:
-      llvm_unreachable("Invalid instruction.");
+std::unique_ptr<ExecutionContext>
+InterpreterFunction::createExecutionContext() {
+  auto ctx = llvm::make_unique<ExecutionContext>();
+  for (auto &w : weights_) {
+    if (!w.first->isPrivate()) {
+      ctx->allocate(w.first);
     }
   }
+  ctx->setOwner(this);
+  return ctx;
+}
+
+void InterpreterFunction::execute(ExecutionContext &ctx) {
+  assert(ctx.getOwner() == this && "The context belongs to another function");
+  // The public variables are backed by the tensors of the context, and the
+  // private variables are shared by all of the contexts.
+  std::unordered_map<const Value *, Tensor *> externalTensors;
+  for (auto &w : weights_) {
+    auto *v = w.first;
+    externalTensors[w.second] =
+        v->isPrivate() ? &v->getPayload() : ctx.getTensor(v);
+  }
+  BoundInterpreterFunction bound(std::move(externalTensors),
+                                 getInterpreterProfile());
+  run(bound);
+}
+
+MemoryFootprint InterpreterFunction::getMemoryFootprint() const {
+  // The weights are used in place, and every activation is a tensor of its
+  // own, so the activations take the memory of the live ones.
+  return computeMemoryFootprint(F_.get());
 }
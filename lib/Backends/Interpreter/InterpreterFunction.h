@@ -17,16 +17,23 @@
 #define GLOW_BACKENDS_INTERPRETER_INTERPRETERFUNCTION_H
 
 #include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/ExecutionContext.h"
 #include "glow/Base/Tensor.h"
+#include "glow/Support/TaskGraph.h"
 
 #include "llvm/ADT/ArrayRef.h"
 
 #include <memory>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace glow {
 
+class BoundInterpreterFunction;
 class Context;
+class ExecutionProfile;
+class Instruction;
 class IRFunction;
 class Value;
 class Tensor;
@@ -42,10 +49,17 @@ class Variable;
 class InterpreterFunction final : public CompiledFunction {
   /// The IR to be executed.
   std::unique_ptr<IRFunction> F_;
-  /// Maps values to Tensors, that are owned by this class.
-  std::unordered_map<const Value *, Tensor *> tensors_;
-  /// Maps values to Tensors, that are *not* owned by this class.
-  std::unordered_map<const Value *, Tensor *> externalTensors_;
+  /// The instructions that are run by execute() in parallel, i.e. all of the
+  /// instructions except for the memory management ones. Empty if the
+  /// interpreter runs on a single thread.
+  std::vector<const Instruction *> parallelInstrs_;
+  /// The dependencies between the instructions in parallelInstrs_.
+  TaskGraph parallelGraph_;
+  /// The weights that the instructions use, and the variables that they are
+  /// lowered from.
+  std::vector<std::pair<Variable *, const Value *>> weights_;
+  /// The context that is used by execute().
+  ExecutionContext defaultContext_;
 
 public:
   InterpreterFunction(std::unique_ptr<IRFunction> F);
@@ -55,9 +69,56 @@ public:
   ~InterpreterFunction() override;
 
   void execute() override;
+
+  ExecutionContext &getDefaultContext() override { return defaultContext_; }
+
+  std::unique_ptr<ExecutionContext> createExecutionContext() override;
+
+  void execute(ExecutionContext &ctx) override;
+
+  MemoryFootprint getMemoryFootprint() const override;
   ///@}
 
 private:
+  /// Build parallelGraph_ from the operands of the instructions.
+  void buildParallelGraph();
+
+  /// Execute the instructions of the function with the tensors of \p bound.
+  void run(BoundInterpreterFunction &bound) const;
+
+  /// Execute the function with the tensors of \p bound by running independent
+  /// instructions in parallel.
+  void runParallel(BoundInterpreterFunction &bound) const;
+};
+
+/// The tensors of a single execution of an InterpreterFunction. The weights
+/// are bound to external tensors, and the activations are created and
+/// destroyed by the instructions during the execution.
+class BoundInterpreterFunction {
+  /// Maps values to Tensors, that are owned by this class.
+  std::unordered_map<const Value *, Tensor *> tensors_;
+  /// Maps values to Tensors, that are *not* owned by this class.
+  std::unordered_map<const Value *, Tensor *> externalTensors_;
+  /// The profile that the instructions are recorded in, or null.
+  ExecutionProfile *profile_;
+
+public:
+  /// Ctor. The weights are backed by the tensors in \p externalTensors. If
+  /// \p profile is not null, then the time and the memory that every
+  /// instruction allocates are recorded in it.
+  explicit BoundInterpreterFunction(
+      std::unordered_map<const Value *, Tensor *> externalTensors,
+      ExecutionProfile *profile = nullptr);
+
+  ~BoundInterpreterFunction();
+
+  /// Execute the instruction \p I, and record it in the profile.
+  void fwdInstr(const Instruction *I);
+
+private:
+  /// Dispatch the instruction \p I to its implementation.
+  void dispatch(const Instruction *I);
+
   /// \returns a pointer to the tensor that is saved under \p v.
   Tensor *getTensor(const Value *v) const;
 
@@ -30,14 +30,14 @@ using namespace glow;
 //                       Convolution
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdCopyInst(const CopyInst *I) {
+void BoundInterpreterFunction::fwdCopyInst(const CopyInst *I) {
   auto inT = getTensor(I->getSrc());
   auto outT = getTensor(I->getDest());
   outT->copyRawFrom(inT);
 }
 
 // This is the floating point implementation of Convolution.
-void InterpreterFunction::fwdConvolutionInst_FloatImpl(
+void BoundInterpreterFunction::fwdConvolutionInst_FloatImpl(
     Value *inV, Value *outV, Value *filterV, Value *biasV, size_t filterSize,
     size_t stride, llvm::ArrayRef<size_t> pads, size_t group) {
 
@@ -100,7 +100,7 @@ void InterpreterFunction::fwdConvolutionInst_FloatImpl(
 }
 
 // This is the quantized i8 implementation of Convolution.
-void InterpreterFunction::fwdConvolutionInst_I8Impl(
+void BoundInterpreterFunction::fwdConvolutionInst_I8Impl(
     Value *inV, Value *outV, Value *filterV, Value *biasV, size_t filterSize,
     size_t stride, llvm::ArrayRef<size_t> pads, size_t group) {
   auto inW = getWeightHandle<int8_t>(inV);
@@ -191,7 +191,7 @@ void InterpreterFunction::fwdConvolutionInst_I8Impl(
   }         // N
 }
 
-void InterpreterFunction::fwdConvolutionInst(const ConvolutionInst *I) {
+void BoundInterpreterFunction::fwdConvolutionInst(const ConvolutionInst *I) {
   size_t filterSize = I->getKernel();
   llvm::ArrayRef<size_t> pads = I->getPads();
   size_t stride = I->getStride();
@@ -207,7 +207,8 @@ void InterpreterFunction::fwdConvolutionInst(const ConvolutionInst *I) {
                                I->getBias(), filterSize, stride, pads, group);
 }
 
-void InterpreterFunction::fwdConvolutionGradInst(const ConvolutionGradInst *I) {
+void BoundInterpreterFunction::fwdConvolutionGradInst(
+    const ConvolutionGradInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto inG = getWeightHandle(I->getSrcGrad());
   auto outG = getWeightHandle(I->getDestGrad());
@@ -343,7 +344,7 @@ static void fwdPoolMax(Tensor *inW, Tensor *outW, Handle<size_t> *SXY,
   }       // N
 }
 
-void InterpreterFunction::fwdPoolMaxInst(const PoolMaxInst *I) {
+void BoundInterpreterFunction::fwdPoolMaxInst(const PoolMaxInst *I) {
   auto inW = getTensor(I->getSrc());
   auto outW = getTensor(I->getDest());
 
@@ -356,7 +357,8 @@ void InterpreterFunction::fwdPoolMaxInst(const PoolMaxInst *I) {
   }
 }
 
-void InterpreterFunction::fwdPoolMaxWithXYInst(const PoolMaxWithXYInst *I) {
+void BoundInterpreterFunction::fwdPoolMaxWithXYInst(
+    const PoolMaxWithXYInst *I) {
   auto inW = getTensor(I->getSrc());
   auto outW = getTensor(I->getDest());
   auto SXY = getTensor(I->getSrcXY())->getHandle<size_t>();
@@ -370,7 +372,7 @@ void InterpreterFunction::fwdPoolMaxWithXYInst(const PoolMaxWithXYInst *I) {
   }
 }
 
-void InterpreterFunction::fwdPoolAvgInst(const PoolAvgInst *I) {
+void BoundInterpreterFunction::fwdPoolAvgInst(const PoolAvgInst *I) {
   ShapeNHWC odim(I->getDest()->dims());
   ShapeNHWC idim(I->getSrc()->dims());
 
@@ -462,7 +464,7 @@ void InterpreterFunction::fwdPoolAvgInst(const PoolAvgInst *I) {
   }       // N
 }
 
-void InterpreterFunction::fwdPoolMaxWithXYGradInst(
+void BoundInterpreterFunction::fwdPoolMaxWithXYGradInst(
     const PoolMaxWithXYGradInst *I) {
   auto inG = getWeightHandle(I->getSrcGrad());
   auto outW = getWeightHandle(I->getDest());
@@ -496,7 +498,7 @@ void InterpreterFunction::fwdPoolMaxWithXYGradInst(
   }       // N
 }
 
-void InterpreterFunction::fwdPoolAvgGradInst(const PoolAvgGradInst *I) {
+void BoundInterpreterFunction::fwdPoolAvgGradInst(const PoolAvgGradInst *I) {
   auto inG = getWeightHandle(I->getSrcGrad());
   auto outW = getWeightHandle(I->getDest());
   auto outG = getWeightHandle(I->getDestGrad());
@@ -548,7 +550,7 @@ void InterpreterFunction::fwdPoolAvgGradInst(const PoolAvgGradInst *I) {
 //                       Activation functions
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdSigmoidInst(const SigmoidInst *I) {
+void BoundInterpreterFunction::fwdSigmoidInst(const SigmoidInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto outW = getWeightHandle(I->getDest());
 
@@ -558,7 +560,7 @@ void InterpreterFunction::fwdSigmoidInst(const SigmoidInst *I) {
   }
 }
 
-void InterpreterFunction::fwdTanhInst(const TanhInst *I) {
+void BoundInterpreterFunction::fwdTanhInst(const TanhInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto outW = getWeightHandle(I->getDest());
 
@@ -572,7 +574,7 @@ void InterpreterFunction::fwdTanhInst(const TanhInst *I) {
 //                        Loss Functions (Softmax/regression/...)
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdSoftMaxInst(const SoftMaxInst *I) {
+void BoundInterpreterFunction::fwdSoftMaxInst(const SoftMaxInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto outW = getWeightHandle(I->getDest());
   auto idim = inW.dims();
@@ -599,7 +601,7 @@ void InterpreterFunction::fwdSoftMaxInst(const SoftMaxInst *I) {
   } // N
 }
 
-void InterpreterFunction::fwdSoftMaxGradInst(const SoftMaxGradInst *I) {
+void BoundInterpreterFunction::fwdSoftMaxGradInst(const SoftMaxGradInst *I) {
   auto inG = getWeightHandle(I->getSrcGrad());
   auto idim = inG.dims();
   auto outW = getWeightHandle(I->getOrigDest());
@@ -617,7 +619,7 @@ void InterpreterFunction::fwdSoftMaxGradInst(const SoftMaxGradInst *I) {
   }
 }
 
-void InterpreterFunction::fwdCrossEntropyLossInst(
+void BoundInterpreterFunction::fwdCrossEntropyLossInst(
     const CrossEntropyLossInst *I) {
   auto P = getWeightHandle(I->getP());
   auto labels = getTensor(I->getLabels())->getHandle<size_t>();
@@ -630,7 +632,7 @@ void InterpreterFunction::fwdCrossEntropyLossInst(
   }
 }
 
-void InterpreterFunction::fwdCrossEntropyLossGradInst(
+void BoundInterpreterFunction::fwdCrossEntropyLossGradInst(
     const CrossEntropyLossGradInst *I) {
   auto P = getWeightHandle(I->getP());
   auto Labels = getTensor(I->getLabels())->getHandle<size_t>();
@@ -646,7 +648,7 @@ void InterpreterFunction::fwdCrossEntropyLossGradInst(
 //===----------------------------------------------------------------------===//
 //                       Tensor shape (transpose/concat/...)
 //===----------------------------------------------------------------------===//
-void InterpreterFunction::fwdTransposeInst(const TransposeInst *I) {
+void BoundInterpreterFunction::fwdTransposeInst(const TransposeInst *I) {
   auto inT = getTensor(I->getSrc());
   (void)inT;
   auto outT = getTensor(I->getDest());
@@ -660,11 +662,11 @@ void InterpreterFunction::fwdTransposeInst(const TransposeInst *I) {
   }
 }
 
-void InterpreterFunction::fwdTensorViewInst(const TensorViewInst *I) {
+void BoundInterpreterFunction::fwdTensorViewInst(const TensorViewInst *I) {
   getOrCreateUnownedTensor(I, I->getSrc(), I->getOffsets());
 }
 
-void InterpreterFunction::fwdSplatInst(const glow::SplatInst *I) {
+void BoundInterpreterFunction::fwdSplatInst(const glow::SplatInst *I) {
   auto *T = getTensor(I->getDest());
   ElemKind k = T->getElementType();
 
@@ -688,7 +690,8 @@ void InterpreterFunction::fwdSplatInst(const glow::SplatInst *I) {
   llvm_unreachable("Unsupported tensor type");
 }
 
-void InterpreterFunction::fwdInsertTensorInst(const glow::InsertTensorInst *I) {
+void BoundInterpreterFunction::fwdInsertTensorInst(
+    const glow::InsertTensorInst *I) {
   Tensor *outT = getTensor(I->getDest());
   Tensor *inT = getTensor(I->getSrc());
   ElemKind k = outT->getElementType();
@@ -707,7 +710,7 @@ void InterpreterFunction::fwdInsertTensorInst(const glow::InsertTensorInst *I) {
   llvm_unreachable("Unsupported tensor type");
 }
 
-void InterpreterFunction::fwdExtractTensorInst(
+void BoundInterpreterFunction::fwdExtractTensorInst(
     const glow::ExtractTensorInst *I) {
   Tensor *outT = getTensor(I->getDest());
   Tensor *inT = getTensor(I->getSrc());
@@ -727,7 +730,7 @@ void InterpreterFunction::fwdExtractTensorInst(
   llvm_unreachable("Unsupported tensor type");
 }
 
-void InterpreterFunction::fwdGatherInst(const glow::GatherInst *I) {
+void BoundInterpreterFunction::fwdGatherInst(const glow::GatherInst *I) {
   Tensor *dataT = getTensor(I->getData());
   auto &dataTy = dataT->getType();
   Tensor *indicesT = getTensor(I->getIndices());
@@ -760,7 +763,7 @@ void InterpreterFunction::fwdGatherInst(const glow::GatherInst *I) {
   }
 }
 
-void InterpreterFunction::fwdScatterAssignInst(
+void BoundInterpreterFunction::fwdScatterAssignInst(
     const glow::ScatterAssignInst *I) {
   Tensor *dataT = getTensor(I->getData());
   Tensor *indicesT = getTensor(I->getIndices());
@@ -783,7 +786,7 @@ void InterpreterFunction::fwdScatterAssignInst(
 //                      Local Response Normalization
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdLocalResponseNormalizationInst(
+void BoundInterpreterFunction::fwdLocalResponseNormalizationInst(
     const glow::LocalResponseNormalizationInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto outW = getWeightHandle(I->getDest());
@@ -838,7 +841,7 @@ void InterpreterFunction::fwdLocalResponseNormalizationInst(
   }
 }
 
-void InterpreterFunction::fwdLocalResponseNormalizationGradInst(
+void BoundInterpreterFunction::fwdLocalResponseNormalizationGradInst(
     const glow::LocalResponseNormalizationGradInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto inG = getWeightHandle(I->getSrcGrad());
@@ -912,7 +915,7 @@ void InterpreterFunction::fwdLocalResponseNormalizationGradInst(
 //                       Arithmetic operations
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdElementAddInst(const ElementAddInst *I) {
+void BoundInterpreterFunction::fwdElementAddInst(const ElementAddInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto lhsTy = I->getLHS()->getType();
     auto rhsTy = I->getRHS()->getType();
@@ -953,7 +956,7 @@ void InterpreterFunction::fwdElementAddInst(const ElementAddInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementSubInst(const ElementSubInst *I) {
+void BoundInterpreterFunction::fwdElementSubInst(const ElementSubInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto destTy = I->getDest()->getType();
     auto lhsTy = I->getLHS()->getType();
@@ -989,7 +992,7 @@ void InterpreterFunction::fwdElementSubInst(const ElementSubInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementMulInst(const ElementMulInst *I) {
+void BoundInterpreterFunction::fwdElementMulInst(const ElementMulInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto lhsTy = I->getLHS()->getType();
     auto rhsTy = I->getRHS()->getType();
@@ -1019,7 +1022,7 @@ void InterpreterFunction::fwdElementMulInst(const ElementMulInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementDivInst(const ElementDivInst *I) {
+void BoundInterpreterFunction::fwdElementDivInst(const ElementDivInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto destTy = I->getDest()->getType();
     auto lhsTy = I->getLHS()->getType();
@@ -1055,7 +1058,7 @@ void InterpreterFunction::fwdElementDivInst(const ElementDivInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementMaxInst(const ElementMaxInst *I) {
+void BoundInterpreterFunction::fwdElementMaxInst(const ElementMaxInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto lhsTy = I->getLHS()->getType();
     auto rhsTy = I->getRHS()->getType();
@@ -1091,7 +1094,7 @@ void InterpreterFunction::fwdElementMaxInst(const ElementMaxInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementMinInst(const ElementMinInst *I) {
+void BoundInterpreterFunction::fwdElementMinInst(const ElementMinInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto lhsTy = I->getLHS()->getType();
     auto rhsTy = I->getRHS()->getType();
@@ -1126,7 +1129,8 @@ void InterpreterFunction::fwdElementMinInst(const ElementMinInst *I) {
 
 // For both quantized and non-quantized CmpLTE, we set the result to 1.0/0.0.
 // In the quantized case, we assume that the scale params are (1.0, 0).
-void InterpreterFunction::fwdElementCmpLTEInst(const ElementCmpLTEInst *I) {
+void BoundInterpreterFunction::fwdElementCmpLTEInst(
+    const ElementCmpLTEInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto lhsTy = I->getLHS()->getType();
     auto rhsTy = I->getRHS()->getType();
@@ -1157,7 +1161,7 @@ void InterpreterFunction::fwdElementCmpLTEInst(const ElementCmpLTEInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementCmpEQInst(const ElementCmpEQInst *I) {
+void BoundInterpreterFunction::fwdElementCmpEQInst(const ElementCmpEQInst *I) {
   auto outW = getWeightHandle<size_t>(I->getDest());
   auto lhsW = getWeightHandle<size_t>(I->getLHS());
   auto rhsW = getWeightHandle<size_t>(I->getRHS());
@@ -1166,7 +1170,8 @@ void InterpreterFunction::fwdElementCmpEQInst(const ElementCmpEQInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementPowInst(const glow::ElementPowInst *I) {
+void BoundInterpreterFunction::fwdElementPowInst(
+    const glow::ElementPowInst *I) {
   auto baseW = getWeightHandle(I->getBase());
   float exp = I->getExp();
   auto outW = getWeightHandle(I->getDest());
@@ -1175,7 +1180,7 @@ void InterpreterFunction::fwdElementPowInst(const glow::ElementPowInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementLogInst(const ElementLogInst *I) {
+void BoundInterpreterFunction::fwdElementLogInst(const ElementLogInst *I) {
   auto inW = getWeightHandle(I->getSrc());
   auto outW = getWeightHandle(I->getDest());
   for (size_t i = 0, e = inW.size(); i < e; i++) {
@@ -1184,7 +1189,7 @@ void InterpreterFunction::fwdElementLogInst(const ElementLogInst *I) {
   }
 }
 
-void InterpreterFunction::fwdElementSelectInst(
+void BoundInterpreterFunction::fwdElementSelectInst(
     const glow::ElementSelectInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto destTy = I->getDest()->getType();
@@ -1221,7 +1226,7 @@ void InterpreterFunction::fwdElementSelectInst(
   }
 }
 
-void InterpreterFunction::fwdMatMulInst(const glow::MatMulInst *I) {
+void BoundInterpreterFunction::fwdMatMulInst(const glow::MatMulInst *I) {
   if (getTensor(I->getLHS())->getType().isQuantizedType()) {
     auto lhs = getTensor(I->getLHS())->getHandle<int8_t>();
     auto rhs = getTensor(I->getRHS())->getHandle<int8_t>();
@@ -1289,7 +1294,8 @@ void InterpreterFunction::fwdMatMulInst(const glow::MatMulInst *I) {
   }
 }
 
-void InterpreterFunction::fwdBatchedAddInst(const glow::BatchedAddInst *I) {
+void BoundInterpreterFunction::fwdBatchedAddInst(
+    const glow::BatchedAddInst *I) {
   if (getTensor(I->getBatch())->getType().isQuantizedType()) {
     auto batch = getTensor(I->getBatch())->getHandle<int8_t>();
     auto slice = getTensor(I->getSlice())->getHandle<int8_t>();
@@ -1354,7 +1360,7 @@ void InterpreterFunction::fwdBatchedAddInst(const glow::BatchedAddInst *I) {
   }
 }
 
-void InterpreterFunction::fwdBatchedReduceAddInst(
+void BoundInterpreterFunction::fwdBatchedReduceAddInst(
     const glow::BatchedReduceAddInst *I) {
   static_assert(max_tensor_dimensions == 6,
                 "Loops below assume max_tensor_dimensions = 6.");
@@ -1453,7 +1459,7 @@ void InterpreterFunction::fwdBatchedReduceAddInst(
   }
 }
 
-void InterpreterFunction::fwdSparseLengthsSumInst(
+void BoundInterpreterFunction::fwdSparseLengthsSumInst(
     const SparseLengthsSumInst *I) {
   auto out = getTensor(I->getDest());
   auto data = getTensor(I->getData());
@@ -1526,7 +1532,7 @@ static void fwdTopK(Tensor *outW, Tensor *indW, Tensor *inW, size_t k) {
   }
 }
 
-void InterpreterFunction::fwdTopKInst(const TopKInst *I) {
+void BoundInterpreterFunction::fwdTopKInst(const TopKInst *I) {
   auto outW = getTensor(I->getValues());
   auto indW = getTensor(I->getIndices());
   auto inW = getTensor(I->getInput());
@@ -1543,11 +1549,12 @@ void InterpreterFunction::fwdTopKInst(const TopKInst *I) {
 //                  Tensor allocation operations
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdAllocActivationInst(const AllocActivationInst *I) {
+void BoundInterpreterFunction::fwdAllocActivationInst(
+    const AllocActivationInst *I) {
   getOrCreateTensor(I);
 }
 
-void InterpreterFunction::fwdDeallocActivationInst(
+void BoundInterpreterFunction::fwdDeallocActivationInst(
     const DeallocActivationInst *I) {
   deleteTensor(I->getSrc());
 }
@@ -1555,7 +1562,7 @@ void InterpreterFunction::fwdDeallocActivationInst(
 /// Prints a value of the instruction's operand.
 /// In most cases it will be the name of the variable and the value of the
 /// tensor.
-void InterpreterFunction::fwdDebugPrintInst(const DebugPrintInst *I) {
+void BoundInterpreterFunction::fwdDebugPrintInst(const DebugPrintInst *I) {
   auto *V = I->getSrc();
   llvm::outs() << I->getName() << ": ";
   // Dump the content of a value.
@@ -1569,7 +1576,7 @@ void InterpreterFunction::fwdDebugPrintInst(const DebugPrintInst *I) {
 //                Instructions used by Quantization
 //===----------------------------------------------------------------------===//
 
-void InterpreterFunction::fwdQuantizationProfileInst(
+void BoundInterpreterFunction::fwdQuantizationProfileInst(
     const glow::QuantizationProfileInst *I) {
   auto inputTensor = getWeightHandle(I->getInputTensor());
   auto currentHistogram = getWeightHandle(I->getHistogram());
@@ -1584,7 +1591,7 @@ void InterpreterFunction::fwdQuantizationProfileInst(
 }
 /// Quantize floating point tensor. Scale and Offset are based on return type
 /// of the instruction \p I.
-void InterpreterFunction::fwdQuantizeInst(const glow::QuantizeInst *I) {
+void BoundInterpreterFunction::fwdQuantizeInst(const glow::QuantizeInst *I) {
   auto srcHandle = getWeightHandle(I->getSrc());
   auto *destTensor = getTensor(I->getDest());
 
@@ -1598,7 +1605,8 @@ void InterpreterFunction::fwdQuantizeInst(const glow::QuantizeInst *I) {
 }
 /// Dequantize integer tensor. Scale and Offset are based
 /// on the source tensor type.
-void InterpreterFunction::fwdDequantizeInst(const glow::DequantizeInst *I) {
+void BoundInterpreterFunction::fwdDequantizeInst(
+    const glow::DequantizeInst *I) {
   auto *srcTensor = getTensor(I->getSrc());
   auto destHandle = getWeightHandle(I->getDest());
 
@@ -1611,7 +1619,7 @@ void InterpreterFunction::fwdDequantizeInst(const glow::DequantizeInst *I) {
   }
 }
 
-void InterpreterFunction::fwdRescaleQuantizedInst(
+void BoundInterpreterFunction::fwdRescaleQuantizedInst(
     const glow::RescaleQuantizedInst *I) {
   auto src = I->getSrc();
   auto dest = I->getDest();
@@ -1630,7 +1638,8 @@ void InterpreterFunction::fwdRescaleQuantizedInst(
   }
 }
 
-void InterpreterFunction::fwdIntLookupTableInst(const IntLookupTableInst *I) {
+void BoundInterpreterFunction::fwdIntLookupTableInst(
+    const IntLookupTableInst *I) {
   auto srcH = getWeightHandle<int8_t>(I->getSrc());
   auto destH = getWeightHandle<int8_t>(I->getDest());
   auto mappingH = getWeightHandle<int8_t>(I->getMapping());
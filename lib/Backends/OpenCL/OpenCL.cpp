@@ -25,6 +25,7 @@
 #include "glow/Quantization/Base/Base.h"
 #include "glow/Support/Debug.h"
 
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
@@ -103,6 +104,13 @@ OpenCLFunction::OpenCLFunction(std::unique_ptr<IRFunction> F)
   /// Create the program from the source.
   createProgram(SHADER_CODE, {}, commands_);
   allocateMemory();
+
+  for (auto *v : F_->getGraph()->getParent()->getVars()) {
+    if (!v->isPrivate()) {
+      defaultContext_.bind(v, &v->getPayload());
+    }
+  }
+  defaultContext_.setOwner(this);
 }
 
 OpenCLFunction::~OpenCLFunction() {
@@ -1233,6 +1241,40 @@ void OpenCLFunction::execute() {
                           << " bytes from OpenCL device\n");
 }
 
+std::unique_ptr<ExecutionContext> OpenCLFunction::createExecutionContext() {
+  auto ctx = llvm::make_unique<ExecutionContext>();
+  for (auto *v : F_->getGraph()->getParent()->getVars()) {
+    if (!v->isPrivate()) {
+      ctx->allocate(v);
+    }
+  }
+  ctx->setOwner(this);
+  return ctx;
+}
+
+void OpenCLFunction::execute(ExecutionContext &ctx) {
+  assert(ctx.getOwner() == this && "The context belongs to another function");
+  // All of the executions share the device buffer and the command queue, so
+  // they run one at a time. The context only provides the host tensors that
+  // the public variables are copied from and to.
+  std::lock_guard<std::mutex> lock(contextMutex_);
+  std::unordered_map<const Value *, Tensor *> payloads;
+  for (auto *v : F_->getGraph()->getParent()->getVars()) {
+    if (v->isPrivate()) {
+      continue;
+    }
+    auto *w = F_->getWeightForNode(v);
+    payloads[w] = externalTensors_[w];
+    externalTensors_[w] = ctx.getTensor(v);
+  }
+
+  execute();
+
+  for (auto &p : payloads) {
+    externalTensors_[p.first] = p.second;
+  }
+}
+
 size_t OpenCLFunction::copyValueToDevice(const Value *v, void *buf) {
   size_t copiedBytes = 0;
   auto it = tensors_.find(v);
@@ -1407,10 +1449,29 @@ void OpenCLFunction::allocateMemory() {
   }
 
   deviceBuffer_ = allocDeviceBuffer(requiredSpace);
+  deviceBufferSize_ = requiredSpace;
   // Copy constant weights just once.
   copyConstantWeightsToDevice();
 }
 
+MemoryFootprint OpenCLFunction::getMemoryFootprint() const {
+  // All of the buffers are placed into the device buffer, the weights first.
+  auto footprint = computeMemoryFootprint(F_.get(), [&](const Value *V) {
+    auto it = tensors_.find(V);
+    return it == tensors_.end() ? MemoryFootprint::noOffset : it->second;
+  });
+  size_t weightsEnd = 0;
+  for (const auto &B : footprint.buffers) {
+    if (B.kind != MemoryFootprint::BufferKind::Activation) {
+      weightsEnd = std::max(weightsEnd, B.offset + B.size);
+    }
+  }
+  weightsEnd = alignedSize(weightsEnd, TensorAlignment);
+  footprint.activationBytes =
+      deviceBufferSize_ > weightsEnd ? deviceBufferSize_ - weightsEnd : 0;
+  return footprint;
+}
+
 Tensor *OpenCLFunction::getTensor(const Value *v) const {
   assert(externalTensors_.count(v) && "Unknown value");
   auto ie = externalTensors_.find(v);
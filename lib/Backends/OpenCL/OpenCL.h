@@ -18,11 +18,13 @@
 
 #include "glow/Backends/Backend.h"
 #include "glow/Backends/CompiledFunction.h"
+#include "glow/Backends/ExecutionContext.h"
 #include "glow/Base/Tensor.h"
 #include "glow/Base/Traits.h"
 
 #include "llvm/ADT/ArrayRef.h"
 
+#include <mutex>
 #include <unordered_map>
 
 #if defined(__APPLE__) || defined(__MACOSX)
@@ -87,8 +89,14 @@ class OpenCLFunction final : public CompiledFunction {
   std::unordered_map<ProgramKey, cl_program, ProgramKeyHash> programsCache_;
   /// A pointer to the on-device memory buffer.
   cl_mem deviceBuffer_{0};
+  /// The size of the on-device memory buffer.
+  size_t deviceBufferSize_{0};
   /// Information about kernel launches.
   std::vector<KernelLaunch> kernelLaunches_;
+  /// Serializes the executions with contexts, which share the device buffer.
+  std::mutex contextMutex_;
+  /// The context whose tensors are the payloads of the public variables.
+  ExecutionContext defaultContext_;
 
 public:
   /// Ctor.
@@ -99,6 +107,14 @@ public:
   ~OpenCLFunction() override;
 
   void execute() override;
+
+  ExecutionContext &getDefaultContext() override { return defaultContext_; }
+
+  std::unique_ptr<ExecutionContext> createExecutionContext() override;
+
+  void execute(ExecutionContext &ctx) override;
+
+  MemoryFootprint getMemoryFootprint() const override;
   ///@}
 
 private:
@@ -0,0 +1,153 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/CodeGen/MemoryFootprint.h"
+#include "glow/Graph/Graph.h"
+#include "glow/IR/IR.h"
+#include "glow/IR/IRUtils.h"
+#include "glow/IR/Instrs.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace glow;
+using llvm::dyn_cast;
+using llvm::isa;
+
+const size_t MemoryFootprint::noOffset = -1;
+
+/// \returns the name of the buffer kind \p kind.
+static const char *getBufferKindName(MemoryFootprint::BufferKind kind) {
+  switch (kind) {
+  case MemoryFootprint::BufferKind::ConstantWeight:
+    return "constant";
+  case MemoryFootprint::BufferKind::MutableWeight:
+    return "mutable";
+  case MemoryFootprint::BufferKind::Activation:
+    return "activation";
+  }
+  llvm_unreachable("Unknown buffer kind");
+}
+
+void MemoryFootprint::dump(llvm::raw_ostream &os) const {
+  os << "Constant weights:  " << constantWeightBytes << " bytes\n";
+  os << "Mutable weights:   " << mutableWeightBytes << " bytes per context\n";
+  os << "Activations:       " << activationBytes << " bytes per context\n";
+  os << "Scratch:           " << scratchBytes << " bytes\n";
+  os << "Peak live:         " << peakLiveBytes << " bytes in "
+     << peakLiveBuffers.size() << " buffers\n";
+  for (const auto &name : peakLiveBuffers) {
+    os << "  " << name << "\n";
+  }
+  os << "Buffers:\n";
+  for (const auto &B : buffers) {
+    os << "  " << llvm::left_justify(getBufferKindName(B.kind), 12);
+    if (B.offset == noOffset) {
+      os << llvm::right_justify("-", 12);
+    } else {
+      os << llvm::format("%12zu", B.offset);
+    }
+    os << llvm::format(" %12zu", B.size);
+    os << (B.isScratch ? "  scratch  " : "           ") << B.name << "\n";
+  }
+}
+
+void MemoryFootprint::dump() const { dump(llvm::outs()); }
+
+MemoryFootprint glow::computeMemoryFootprint(
+    const IRFunction *F, llvm::function_ref<size_t(const Value *)> getOffset) {
+  MemoryFootprint footprint;
+  auto addBuffer = [&](const Value *V, MemoryFootprint::BufferKind kind) {
+    size_t offset = getOffset ? getOffset(V) : MemoryFootprint::noOffset;
+    footprint.buffers.push_back(
+        {V->getName().str(), kind, offset, V->getSizeInBytes(), false});
+  };
+
+  // The weights of the IR. The variables that were added to the module after
+  // the function was compiled have no weight, and are not part of it.
+  for (const auto *w : F->getWeights()) {
+    if (w->getVisibility() == VisibilityKind::Private) {
+      footprint.constantWeightBytes += w->getSizeInBytes();
+      addBuffer(w, MemoryFootprint::BufferKind::ConstantWeight);
+    } else {
+      footprint.mutableWeightBytes += w->getSizeInBytes();
+      addBuffer(w, MemoryFootprint::BufferKind::MutableWeight);
+    }
+  }
+
+  // Find the activations that are read by some instruction, and replay the
+  // allocations to find the peak of the live memory.
+  llvm::SmallPtrSet<const Value *, 16> readActivations;
+  llvm::DenseMap<const Value *, size_t> activationIndex;
+  size_t liveBytes = 0;
+  const Instruction *peak = nullptr;
+  for (const auto &I : F->getInstrs()) {
+    if (auto *A = dyn_cast<AllocActivationInst>(&I)) {
+      activationIndex[A] = footprint.buffers.size();
+      addBuffer(A, MemoryFootprint::BufferKind::Activation);
+      liveBytes += A->getSizeInBytes();
+      if (liveBytes > footprint.peakLiveBytes) {
+        footprint.peakLiveBytes = liveBytes;
+        peak = &I;
+      }
+      continue;
+    }
+    if (auto *D = dyn_cast<DeallocActivationInst>(&I)) {
+      liveBytes -= D->getAlloc()->getSizeInBytes();
+      continue;
+    }
+    // Creating a view does not read the buffer.
+    if (isa<TensorViewInst>(&I)) {
+      continue;
+    }
+    for (const auto &op : I.getOperands()) {
+      if (op.second == OperandKind::In) {
+        readActivations.insert(getOrigin(op.first));
+      }
+    }
+  }
+  footprint.activationBytes = footprint.peakLiveBytes;
+
+  for (const auto &entry : activationIndex) {
+    if (!readActivations.count(entry.first)) {
+      auto &B = footprint.buffers[entry.second];
+      B.isScratch = true;
+      footprint.scratchBytes += B.size;
+    }
+  }
+
+  // Collect the activations that are alive right after the peak allocation.
+  llvm::SmallPtrSet<const Value *, 16> live;
+  for (const auto &I : F->getInstrs()) {
+    if (auto *A = dyn_cast<AllocActivationInst>(&I)) {
+      live.insert(A);
+    } else if (auto *D = dyn_cast<DeallocActivationInst>(&I)) {
+      live.erase(D->getAlloc());
+    }
+    if (&I == peak) {
+      break;
+    }
+  }
+  for (const auto &I : F->getInstrs()) {
+    if (live.count(&I)) {
+      footprint.peakLiveBuffers.push_back(I.getName().str());
+    }
+  }
+  return footprint;
+}
@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/ExecutionEngine/BatchBuckets.h"
+#include "glow/ExecutionEngine/ExecutionEngine.h"
+#include "glow/Graph/Graph.h"
+#include "glow/Support/Compiler.h"
+
+#include <algorithm>
+#include <string>
+
+using namespace glow;
+
+/// \returns an unowned tensor that refers to the slices [\p offset, \p offset
+/// + \p count) of \p T.
+static Tensor getSlices(Tensor *T, size_t offset, size_t count) {
+  ShapeVector dims(T->dims().begin(), T->dims().end());
+  size_t sliceSize = T->size() / dims[0] * T->getType().getElementSize();
+  dims[0] = count;
+  auto ty = Type::newShape(T->getType(), dims);
+  return Tensor(T->getUnsafePtr() + offset * sliceSize, &ty);
+}
+
+BatchBuckets::BatchBuckets(ExecutionEngine &EE, CompilationMode mode,
+                           Function *F, llvm::ArrayRef<Variable *> inputs,
+                           llvm::ArrayRef<Variable *> outputs,
+                           llvm::ArrayRef<size_t> batchSizes)
+    : EE_(EE) {
+  assert(!inputs.empty() && "No batched inputs");
+  assert(!batchSizes.empty() && "No batch sizes");
+  std::vector<size_t> sizes(batchSizes.begin(), batchSizes.end());
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+  // Clone all of the buckets before anything is compiled, because the
+  // compilation optimizes the function in place.
+  size_t batchSize = inputs[0]->dims()[0];
+  for (size_t size : sizes) {
+    assert(size > 0 && "Invalid batch size");
+    Bucket bucket;
+    bucket.batchSize = size;
+    if (size == batchSize) {
+      bucket.F = F;
+      bucket.inputs.assign(inputs.begin(), inputs.end());
+      bucket.outputs.assign(outputs.begin(), outputs.end());
+    } else {
+      llvm::DenseMap<Variable *, Variable *> varMap;
+      std::string name = F->getName().str() + "_b" + std::to_string(size);
+      bucket.F = F->cloneWithBatchSize(name, inputs, size, &varMap);
+      // The batch size of the function can't be changed, so the bucket is
+      // refused.
+      if (!bucket.F) {
+        continue;
+      }
+      for (auto *V : inputs) {
+        bucket.inputs.push_back(varMap[V]);
+      }
+      for (auto *V : outputs) {
+        assert(varMap.count(V) && "The output does not depend on the batch");
+        bucket.outputs.push_back(varMap[V]);
+      }
+    }
+    for (auto *V : bucket.inputs) {
+      bucket.inputStaging.emplace_back(new Tensor(V->getType()));
+    }
+    for (auto *V : bucket.outputs) {
+      bucket.outputStaging.emplace_back(new Tensor(V->getType()));
+    }
+    buckets_.push_back(std::move(bucket));
+  }
+  GLOW_ASSERT(!buckets_.empty() &&
+              "The batch size of the function can't be changed");
+
+  for (auto &bucket : buckets_) {
+    EE_.compile(mode, bucket.F);
+  }
+}
+
+size_t BatchBuckets::getBucketSize(size_t numSamples) const {
+  for (const auto &bucket : buckets_) {
+    if (bucket.batchSize >= numSamples) {
+      return bucket.batchSize;
+    }
+  }
+  return buckets_.back().batchSize;
+}
+
+void BatchBuckets::runChunk(Bucket &bucket, llvm::ArrayRef<Tensor *> inputs,
+                            llvm::ArrayRef<Tensor *> outputs, size_t offset,
+                            size_t count) {
+  std::vector<Variable *> vars(bucket.inputs);
+  vars.insert(vars.end(), bucket.outputs.begin(), bucket.outputs.end());
+  EE_.setActiveFunction(bucket.F);
+
+  // Bind the tensors of the caller if they have the size of the bucket.
+  if (offset == 0 && count == inputs[0]->dims()[0] &&
+      count == bucket.batchSize) {
+    std::vector<Tensor *> tensors(inputs.begin(), inputs.end());
+    tensors.insert(tensors.end(), outputs.begin(), outputs.end());
+    EE_.runWithBindings(vars, tensors);
+    return;
+  }
+
+  // Otherwise fill the bucket with the samples of the chunk, repeating them
+  // if the chunk is smaller than the bucket.
+  std::vector<Tensor *> tensors;
+  for (size_t i = 0, e = inputs.size(); i < e; i++) {
+    Tensor slices = getSlices(inputs[i], offset, count);
+    bucket.inputStaging[i]->copyConsecutiveSlices(&slices, 0);
+    tensors.push_back(bucket.inputStaging[i].get());
+  }
+  for (auto &T : bucket.outputStaging) {
+    tensors.push_back(T.get());
+  }
+  EE_.runWithBindings(vars, tensors);
+
+  for (size_t i = 0, e = outputs.size(); i < e; i++) {
+    Tensor slices = getSlices(outputs[i], offset, count);
+    slices.copyConsecutiveSlices(bucket.outputStaging[i].get(), 0);
+  }
+}
+
+void BatchBuckets::run(llvm::ArrayRef<Tensor *> inputs,
+                       llvm::ArrayRef<Tensor *> outputs) {
+  assert(inputs.size() == buckets_[0].inputs.size() &&
+         "Invalid number of inputs");
+  assert(outputs.size() == buckets_[0].outputs.size() &&
+         "Invalid number of outputs");
+  size_t numSamples = inputs[0]->dims()[0];
+  for (size_t offset = 0; offset < numSamples;) {
+    size_t bucketSize = getBucketSize(numSamples - offset);
+    size_t count = std::min(bucketSize, numSamples - offset);
+    auto it = std::find_if(
+        buckets_.begin(), buckets_.end(),
+        [&](const Bucket &B) { return B.batchSize == bucketSize; });
+    runChunk(*it, inputs, outputs, offset, count);
+    offset += count;
+  }
+}
@@ -22,8 +22,10 @@
 #include "glow/IR/IRBuilder.h"
 #include "glow/IR/Instrs.h"
 #include "glow/Optimizer/Optimizer.h"
+#include "glow/Support/CompileProfile.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/CommandLine.h"
 
 using namespace glow;
@@ -36,15 +38,33 @@ static llvm::cl::opt<std::string>
 
 static llvm::cl::opt<bool> dumpIR("dump-ir",
                                   llvm::cl::desc("Prints IR to stdout"));
+
+static llvm::cl::opt<std::string> compileProfile(
+    "compile-profile",
+    llvm::cl::desc("Write the time, the code size and the peak memory usage "
+                   "of the compilation phases into a JSON file"),
+    llvm::cl::value_desc("file.json"));
+
+/// \returns the number of nodes of \p F.
+CompilePhase::SizeFn countNodes(const Function *F) {
+  return [F]() { return F->getNodes().size(); };
+}
 } // namespace
 
 ExecutionEngine::ExecutionEngine(BackendKind backendKind)
-    : backend_(createBackend(backendKind)) {}
+    : backend_(createBackend(backendKind)) {
+  if (!compileProfile.empty()) {
+    CompileProfile::get().enable(compileProfile);
+  }
+}
 
 // Set the code generator kind to \p backendKind.
 void ExecutionEngine::setBackend(BackendKind backendKind) {
+  stopWorkers();
+  // The compiled functions may still be using the previous backend.
+  function_ = nullptr;
+  compiledFunctions_.clear();
   backend_.reset(createBackend(backendKind));
-  function_.reset();
 }
 
 ExecutionEngine::~ExecutionEngine() = default;
@@ -65,6 +85,119 @@ void ExecutionEngine::run(llvm::ArrayRef<Variable *> vars,
   function_->execute();
 }
 
+std::unique_ptr<ExecutionContext> ExecutionEngine::createExecutionContext() {
+  assert(function_ && "No function has been compiled");
+  return function_->createExecutionContext();
+}
+
+void ExecutionEngine::run(ExecutionContext &ctx,
+                          llvm::ArrayRef<Variable *> vars,
+                          llvm::ArrayRef<Tensor *> inputs) {
+  assert(function_ && "No function has been compiled");
+  assert(ctx.getOwner() == function_ &&
+         "The context was created for another function");
+  assert(inputs.size() == vars.size() &&
+         "The number of inputs does not match the number of variables");
+
+  // Update the tensors of the input variables in the context.
+  for (int i = 0, e = vars.size(); i < e; i++) {
+    assert(vars[i]->getVisibilityKind() == VisibilityKind::Public &&
+           "Trying to update a private variable");
+    // The function does not read the variable, so it has nothing to update.
+    if (!ctx.hasTensor(vars[i])) {
+      continue;
+    }
+    auto *T = ctx.getTensor(vars[i]);
+    assert(T->dims() == inputs[i]->dims() && "Invalid slice size");
+    T->copyFrom(inputs[i]);
+  }
+
+  function_->execute(ctx);
+}
+
+void ExecutionEngine::runWithBindings(llvm::ArrayRef<Variable *> vars,
+                                      llvm::ArrayRef<Tensor *> tensors) {
+  assert(function_ && "No function has been compiled");
+  runWithBindings(function_->getDefaultContext(), vars, tensors);
+}
+
+void ExecutionEngine::runWithBindings(ExecutionContext &ctx,
+                                      llvm::ArrayRef<Variable *> vars,
+                                      llvm::ArrayRef<Tensor *> tensors) {
+  assert(function_ && "No function has been compiled");
+  assert(ctx.getOwner() == function_ &&
+         "The context was created for another function");
+  executeWithBindings(*function_, ctx, vars, tensors);
+}
+
+void ExecutionEngine::executeWithBindings(CompiledFunction &function,
+                                          ExecutionContext &ctx,
+                                          llvm::ArrayRef<Variable *> vars,
+                                          llvm::ArrayRef<Tensor *> tensors) {
+  assert(tensors.size() == vars.size() &&
+         "The number of tensors does not match the number of variables");
+
+  // Bind the tensors of the caller and remember the tensors that they
+  // replace.
+  std::vector<Tensor *> prev(vars.size());
+  for (int i = 0, e = vars.size(); i < e; i++) {
+    assert(vars[i]->getVisibilityKind() == VisibilityKind::Public &&
+           "Trying to bind a private variable");
+    prev[i] = ctx.bind(vars[i], tensors[i]);
+  }
+
+  function.execute(ctx);
+
+  // Restore the previous bindings in reverse order, so that a variable that
+  // appears twice in vars ends up with its original tensor.
+  for (int i = vars.size() - 1; i >= 0; i--) {
+    ctx.bind(vars[i], prev[i]);
+  }
+}
+
+void ExecutionEngine::startWorkers(unsigned numWorkers,
+                                   size_t queueCapacity) {
+  assert(function_ && "No function has been compiled");
+  stopWorkers();
+  queue_ = llvm::make_unique<RequestQueue>(
+      numWorkers, queueCapacity,
+      [this]() { return function_->createExecutionContext(); });
+}
+
+void ExecutionEngine::stopWorkers() { queue_.reset(); }
+
+void ExecutionEngine::runAsync(llvm::ArrayRef<Variable *> vars,
+                               llvm::ArrayRef<Tensor *> tensors,
+                               std::function<void()> done) {
+  assert(queue_ && "The workers have not been started");
+  assert(tensors.size() == vars.size() &&
+         "The number of tensors does not match the number of variables");
+  std::vector<Variable *> varsCopy(vars.begin(), vars.end());
+  std::vector<Tensor *> tensorsCopy(tensors.begin(), tensors.end());
+  queue_->submit([this, varsCopy, tensorsCopy, done](ExecutionContext &ctx) {
+    runWithBindings(ctx, varsCopy, tensorsCopy);
+    if (done) {
+      done();
+    }
+  });
+}
+
+std::future<void> ExecutionEngine::runAsync(llvm::ArrayRef<Variable *> vars,
+                                            llvm::ArrayRef<Tensor *> tensors) {
+  // std::function requires a copyable callable, so keep the promise behind a
+  // shared pointer.
+  auto promise = std::make_shared<std::promise<void>>();
+  auto future = promise->get_future();
+  runAsync(vars, tensors, [promise]() { promise->set_value(); });
+  return future;
+}
+
+void ExecutionEngine::waitForAsyncRuns() {
+  if (queue_) {
+    queue_->wait();
+  }
+}
+
 void ExecutionEngine::runBatch(size_t iterations,
                                llvm::ArrayRef<Variable *> vars,
                                llvm::ArrayRef<Tensor *> inputs) {
@@ -78,13 +211,58 @@ void ExecutionEngine::runBatch(size_t iterations,
   // This is the size of one batch (the number of samples in the batch).
   size_t batchSize = vars[0]->getType()->dims()[0];
 
-  for (size_t i = 0; i < iterations; i++) {
-    // Pick up one slice from the input tensors, and load it into corresponding
-    // network Variables. Then, run a single pass over the network.
-    updateInputsAndRunNetwork(vars, inputs, trainCounter);
+  if (iterations < 2) {
+    for (size_t i = 0; i < iterations; i++) {
+      // Pick up one slice from the input tensors, and load it into
+      // corresponding network Variables. Then, run a single pass over the
+      // network.
+      updateInputsAndRunNetwork(vars, inputs, trainCounter);
 
+      trainCounter += batchSize;
+    }
+    return;
+  }
+
+  // Stage the minibatches in two sets of buffers. While the network runs with
+  // one set bound to the variables, a helper thread copies the next minibatch
+  // into the other set, so the copies are off the critical path.
+  std::vector<std::unique_ptr<Tensor>> buffers[2];
+  std::vector<Tensor *> bound[2];
+  for (unsigned b = 0; b < 2; b++) {
+    for (auto *v : vars) {
+      buffers[b].emplace_back(new Tensor(v->getType()));
+      bound[b].push_back(buffers[b].back().get());
+    }
+  }
+  auto stage = [&](unsigned b, size_t sampleIdx) {
+    for (int i = 0, e = vars.size(); i < e; i++) {
+      loadValueFromTensorSlice(*buffers[b][i], inputs[i], sampleIdx);
+    }
+  };
+
+  if (!stager_) {
+    stager_ = llvm::make_unique<ThreadPool>(1);
+  }
+  stage(0, trainCounter);
+  for (size_t i = 0; i < iterations; i++) {
+    unsigned cur = i % 2;
+    std::future<void> next;
+    if (i + 1 < iterations) {
+      size_t nextIdx = trainCounter + batchSize;
+      next = stager_->submit(
+          [&stage, cur, nextIdx]() { stage(1 - cur, nextIdx); });
+    }
+    runWithBindings(vars, bound[cur]);
+    if (next.valid()) {
+      next.wait();
+    }
     trainCounter += batchSize;
   }
+
+  // Leave the last minibatch in the variables, like the serial loop does.
+  for (int i = 0, e = vars.size(); i < e; i++) {
+    vars[i]->getPayload().copyFrom(bound[(iterations - 1) % 2][i]);
+  }
 }
 
 void ExecutionEngine::updateInputsAndRunNetwork(llvm::ArrayRef<Variable *> vars,
@@ -102,8 +280,11 @@ void ExecutionEngine::updateInputsAndRunNetwork(llvm::ArrayRef<Variable *> vars,
 void ExecutionEngine::loadValueFromTensorSlice(Variable *v, Tensor *input,
                                                size_t sampleIdx) {
   assert(v && "Invalid value");
-  auto &t = v->getPayload();
+  loadValueFromTensorSlice(v->getPayload(), input, sampleIdx);
+}
 
+void ExecutionEngine::loadValueFromTensorSlice(Tensor &t, Tensor *input,
+                                               size_t sampleIdx) {
   auto dim = input->dims();
   assert(t.dims().drop_front() == dim.drop_front() && "Invalid slice size");
   // Extract the n'th slice, that must be a tensor.
@@ -120,8 +301,11 @@ void ExecutionEngine::loadValueFromTensor(Variable *v, Tensor *input) {
   t.copyFrom(input);
 }
 
-std::unique_ptr<IRFunction> ExecutionEngine::generateIR(CompilationMode mode,
-                                                        Function *F) {
+std::unique_ptr<IRFunction>
+ExecutionEngine::generateIR(CompilationMode mode, Function *F,
+                            const Backend &backend) {
+  CompilePhase phase("generateIR", "compile", "nodes", countNodes(F));
+
   // Verify the function pre-optimization/lowering.
   F->verify();
 
@@ -129,20 +313,34 @@ std::unique_ptr<IRFunction> ExecutionEngine::generateIR(CompilationMode mode,
   ::glow::optimize(F, mode);
 
   // Allow the backend to transform the graph prior to lowering.
-  if (backend_->transformPreLowering(F, mode)) {
+  bool changed;
+  {
+    CompilePhase phase("transformPreLowering", "backend", "nodes",
+                       countNodes(F));
+    changed = backend.transformPreLowering(F, mode);
+  }
+  if (changed) {
     // Optimize the graph again after the backend transformation.
     // In particular, DCE is very likely to be useful.
     ::glow::optimize(F, mode);
   }
 
   // Lower the graph into a sequence of low-level linear algebra operations.
-  ::glow::lower(F, *backend_);
+  {
+    CompilePhase phase("lower", "graph", "nodes", countNodes(F));
+    ::glow::lower(F, backend);
+  }
 
   // Optimize the graph again.
   ::glow::optimize(F, mode);
 
   // Allow the backend to transform the graph after lowering.
-  if (backend_->transformPostLowering(F, mode)) {
+  {
+    CompilePhase phase("transformPostLowering", "backend", "nodes",
+                       countNodes(F));
+    changed = backend.transformPostLowering(F, mode);
+  }
+  if (changed) {
     // Optimize the graph again after the backend transformation.
     // In particular, DCE is very likely to be useful.
     ::glow::optimize(F, mode);
@@ -152,10 +350,14 @@ std::unique_ptr<IRFunction> ExecutionEngine::generateIR(CompilationMode mode,
   auto IR = llvm::make_unique<IRFunction>(F);
 
   // Generate IR from the graph.
-  IR->generateIR();
+  {
+    CompilePhase phase("IRGen", "ir", "instrs",
+                       [&IR]() { return IR->getInstrs().size(); });
+    IR->generateIR();
+  }
 
   // Optimize the generated IR.
-  ::glow::optimize(*IR, mode, *backend_);
+  ::glow::optimize(*IR, mode, backend);
 
   // If requested, dump IR to stdout and/or dot file for debugging.
   if (dumpIR) {
@@ -168,11 +370,93 @@ std::unique_ptr<IRFunction> ExecutionEngine::generateIR(CompilationMode mode,
   return IR;
 }
 
+void ExecutionEngine::setCompiledFunction(
+    const Function *F, std::unique_ptr<CompiledFunction> compiled) {
+  // The contexts of the workers belong to the previous function.
+  stopWorkers();
+  function_ = compiled.get();
+  compiledFunctions_[F] = std::move(compiled);
+}
+
 void ExecutionEngine::compile(CompilationMode mode, Function *F) {
-  function_ = backend_->compile(generateIR(mode, F));
+  // A tiered compilation of F must finish before F is optimized again.
+  if (isCompiled(F)) {
+    eraseCompiledFunction(F);
+  }
+  auto IR = generateIR(mode, F, *backend_);
+  CompilePhase phase("compile", "backend");
+  setCompiledFunction(F, backend_->compile(std::move(IR)));
+}
+
+TieredFunction &ExecutionEngine::compileTiered(CompilationMode mode,
+                                               Function *F) {
+  // A tiered compilation of F must finish before F is optimized again.
+  if (isCompiled(F)) {
+    eraseCompiledFunction(F);
+  }
+
+  // Collect the public variables of F before the graph is optimized.
+  llvm::SmallPtrSet<Variable *, 8> seen;
+  std::vector<Variable *> vars;
+  for (auto &N : F->getNodes()) {
+    for (unsigned i = 0, e = N.getNumInputs(); i < e; i++) {
+      auto *v = llvm::dyn_cast<Variable>(N.getNthInput(i).getNode());
+      if (v && !v->isPrivate() && seen.insert(v).second) {
+        vars.push_back(v);
+      }
+    }
+  }
+
+  // The first tier runs a copy of F on the interpreter.
+  std::string name = F->getName().str() + "_tier0";
+  while (M_.hasFunction(name)) {
+    name += "_";
+  }
+  auto *firstF = F->clone(name);
+  std::unique_ptr<Backend> interpreter(
+      createBackend(BackendKind::Interpreter));
+  auto firstIR = generateIR(mode, firstF, *interpreter);
+  std::unique_ptr<CompiledFunction> first;
+  {
+    CompilePhase phase("compile", "backend");
+    first = interpreter->compile(std::move(firstIR));
+  }
+
+  // The graph and the IR of the final tier are generated on this thread, so
+  // that only the backend reads the module in the background.
+  auto tiered = llvm::make_unique<TieredFunction>(
+      std::move(first), *backend_, generateIR(mode, F, *backend_), vars);
+  auto &result = *tiered;
+  setCompiledFunction(F, std::move(tiered));
+  return result;
+}
+
+void ExecutionEngine::setActiveFunction(const Function *F) {
+  auto it = compiledFunctions_.find(F);
+  assert(it != compiledFunctions_.end() && "The function was not compiled");
+  if (it->second.get() != function_) {
+    stopWorkers();
+    function_ = it->second.get();
+  }
+}
+
+MemoryFootprint ExecutionEngine::getMemoryFootprint(const Function *F) const {
+  auto it = compiledFunctions_.find(F);
+  assert(it != compiledFunctions_.end() && "The function was not compiled");
+  return it->second->getMemoryFootprint();
+}
+
+void ExecutionEngine::eraseCompiledFunction(const Function *F) {
+  auto it = compiledFunctions_.find(F);
+  assert(it != compiledFunctions_.end() && "The function was not compiled");
+  if (it->second.get() == function_) {
+    stopWorkers();
+    function_ = nullptr;
+  }
+  compiledFunctions_.erase(it);
 }
 
 void ExecutionEngine::save(CompilationMode mode, Function *F,
                            llvm::StringRef outputDir) {
-  backend_->save(generateIR(mode, F), outputDir);
+  backend_->save(generateIR(mode, F, *backend_), outputDir);
 }
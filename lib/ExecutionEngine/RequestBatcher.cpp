@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/ExecutionEngine/RequestBatcher.h"
+#include "glow/Backends/CompiledFunction.h"
+#include "glow/ExecutionEngine/ExecutionEngine.h"
+#include "glow/Graph/Nodes.h"
+
+#include <algorithm>
+
+using namespace glow;
+
+RequestBatcher::RequestBatcher(ExecutionEngine &EE,
+                               llvm::ArrayRef<Variable *> inputVars,
+                               llvm::ArrayRef<Variable *> outputVars,
+                               const Config &config)
+    : function_(EE.getActiveFunction()),
+      inputVars_(inputVars.begin(), inputVars.end()),
+      outputVars_(outputVars.begin(), outputVars.end()), config_(config),
+      ctx_(function_.createExecutionContext()) {
+  assert(!inputVars_.empty() && "The batcher needs an input");
+  size_t batchSize = inputVars_[0]->getType()->dims()[0];
+  for (auto *v : inputVars_) {
+    assert(v->getType()->dims()[0] == batchSize &&
+           "The inputs have different batch sizes");
+    inputBatch_.emplace_back(new Tensor(v->getType()));
+    inputBatch_.back()->zero();
+  }
+  for (auto *v : outputVars_) {
+    assert(v->getType()->dims()[0] == batchSize &&
+           "The outputs have different batch sizes");
+    outputBatch_.emplace_back(new Tensor(v->getType()));
+  }
+  if (config_.maxBatchSize == 0 || config_.maxBatchSize > batchSize) {
+    config_.maxBatchSize = batchSize;
+  }
+  dispatcher_ = std::thread(&RequestBatcher::dispatcherLoop, this);
+}
+
+RequestBatcher::~RequestBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  dispatcher_.join();
+}
+
+std::future<void> RequestBatcher::enqueue(llvm::ArrayRef<const Tensor *> inputs,
+                                          llvm::ArrayRef<Tensor *> outputs) {
+  assert(inputs.size() == inputVars_.size() && "Invalid number of inputs");
+  assert(outputs.size() == outputVars_.size() && "Invalid number of outputs");
+  Request request;
+  request.inputs.assign(inputs.begin(), inputs.end());
+  request.outputs.assign(outputs.begin(), outputs.end());
+  auto future = request.done.get_future();
+  request.enqueued = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    assert(!stop_ && "Enqueueing a request to a stopped batcher");
+    pending_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return future;
+}
+
+void RequestBatcher::dispatcherLoop() {
+  std::vector<Request> batch;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return stop_ || !pending_.empty(); });
+      if (pending_.empty()) {
+        // The batcher is shutting down and there is no more work.
+        return;
+      }
+      // Wait for more requests until the batch is full or the first request
+      // runs out of its latency budget, which started when it was enqueued
+      // and not when the dispatcher got to it. Don't wait when shutting down.
+      auto deadline = pending_.front().enqueued + config_.maxDelay;
+      cv_.wait_until(lock, deadline, [&] {
+        return stop_ || pending_.size() >= config_.maxBatchSize;
+      });
+      size_t n = std::min(pending_.size(), config_.maxBatchSize);
+      for (size_t i = 0; i < n; i++) {
+        batch.push_back(std::move(pending_.front()));
+        pending_.pop_front();
+      }
+    }
+    runBatch(batch);
+    batch.clear();
+  }
+}
+
+void RequestBatcher::runBatch(std::vector<Request> &batch) {
+  // Pack the samples into the slices of the batched inputs.
+  for (size_t i = 0, e = inputVars_.size(); i < e; i++) {
+    auto &T = *inputBatch_[i];
+    if (config_.zeroPadding && batch.size() < T.dims()[0]) {
+      T.zero();
+    }
+    for (size_t s = 0, se = batch.size(); s < se; s++) {
+      T.copyToSlice(batch[s].inputs[i], s);
+    }
+  }
+
+  std::vector<Variable *> vars(inputVars_);
+  vars.insert(vars.end(), outputVars_.begin(), outputVars_.end());
+  std::vector<Tensor *> tensors;
+  for (auto &T : inputBatch_) {
+    tensors.push_back(T.get());
+  }
+  for (auto &T : outputBatch_) {
+    tensors.push_back(T.get());
+  }
+  ExecutionEngine::executeWithBindings(function_, *ctx_, vars, tensors);
+
+  // Scatter the slices of the batched outputs back to the requests.
+  for (size_t s = 0, se = batch.size(); s < se; s++) {
+    for (size_t i = 0, e = outputVars_.size(); i < e; i++) {
+      batch[s].outputs[i]->copySlice(outputBatch_[i].get(), s);
+    }
+    batch[s].done.set_value();
+  }
+}
@@ -0,0 +1,89 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/ExecutionEngine/RequestQueue.h"
+
+#include <cassert>
+
+using namespace glow;
+
+RequestQueue::RequestQueue(unsigned numWorkers, size_t capacity,
+                           const ContextFactory &createContext)
+    : capacity_(capacity) {
+  assert(numWorkers > 0 && "The queue needs at least one worker");
+  assert(capacity > 0 && "The queue must be able to hold a request");
+  // Create the contexts on the calling thread, because the factory is not
+  // required to be thread safe.
+  for (unsigned i = 0; i < numWorkers; i++) {
+    contexts_.push_back(createContext());
+  }
+  workers_.reserve(numWorkers);
+  for (auto &ctx : contexts_) {
+    workers_.emplace_back(&RequestQueue::workerLoop, this, std::ref(*ctx));
+  }
+}
+
+RequestQueue::~RequestQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  notEmpty_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void RequestQueue::workerLoop(ExecutionContext &ctx) {
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      notEmpty_.wait(lock, [&] { return stop_ || !requests_.empty(); });
+      if (requests_.empty()) {
+        // The queue is shutting down and there is no more work.
+        return;
+      }
+      request = std::move(requests_.front());
+      requests_.pop_front();
+      numRunning_++;
+    }
+    notFull_.notify_all();
+
+    request(ctx);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      numRunning_--;
+    }
+    notFull_.notify_all();
+  }
+}
+
+void RequestQueue::submit(Request request) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    assert(!stop_ && "Submitting a request to a stopped queue");
+    notFull_.wait(lock, [&] { return requests_.size() < capacity_; });
+    requests_.push_back(std::move(request));
+  }
+  notEmpty_.notify_one();
+}
+
+void RequestQueue::wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  notFull_.wait(lock, [&] { return requests_.empty() && numRunning_ == 0; });
+}
@@ -0,0 +1,111 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/ExecutionEngine/TieredFunction.h"
+
+#include "glow/IR/IR.h"
+#include "glow/Support/CompileProfile.h"
+
+#include "llvm/ADT/STLExtras.h"
+
+using namespace glow;
+
+namespace glow {
+/// The context of a TieredFunction. Its tensors are bound to the context of
+/// the tier that performs a run.
+class TieredContext final : public ExecutionContext {
+public:
+  /// The contexts of the first and of the final tier, or null if the tier was
+  /// not used with this context yet.
+  ExecutionContext *firstCtx{nullptr};
+  ExecutionContext *finalCtx{nullptr};
+  /// The contexts of the tiers that are owned by this context.
+  std::vector<std::unique_ptr<ExecutionContext>> owned;
+};
+} // namespace glow
+
+TieredFunction::TieredFunction(std::unique_ptr<CompiledFunction> first,
+                               const Backend &backend,
+                               std::unique_ptr<IRFunction> IR,
+                               llvm::ArrayRef<Variable *> vars)
+    : vars_(vars.begin(), vars.end()), first_(std::move(first)),
+      active_(first_.get()) {
+  defaultContext_ = llvm::make_unique<TieredContext>();
+  for (auto *v : vars_) {
+    defaultContext_->bind(v, &v->getPayload());
+  }
+  defaultContext_->setOwner(this);
+
+  std::promise<void> ready;
+  finalReady_ = ready.get_future().share();
+  // The IR and the promise are moved into the thread, which owns them.
+  compiler_ = std::thread(
+      [this, &backend](std::unique_ptr<IRFunction> IR,
+                       std::promise<void> ready) {
+        {
+          CompilePhase phase("compile", "backend");
+          final_ = backend.compile(std::move(IR));
+        }
+        active_ = final_.get();
+        ready.set_value();
+      },
+      std::move(IR), std::move(ready));
+}
+
+TieredFunction::~TieredFunction() { compiler_.join(); }
+
+ExecutionContext &TieredFunction::getTierContext(TieredContext &ctx,
+                                                 CompiledFunction *tier) {
+  auto *&tierCtx = tier == first_.get() ? ctx.firstCtx : ctx.finalCtx;
+  if (!tierCtx) {
+    // The default contexts of the tiers are only used by the default context
+    // of this function, so they can be rebound freely.
+    if (&ctx == defaultContext_.get()) {
+      tierCtx = &tier->getDefaultContext();
+    } else {
+      ctx.owned.push_back(tier->createExecutionContext());
+      tierCtx = ctx.owned.back().get();
+    }
+  }
+  return *tierCtx;
+}
+
+void TieredFunction::execute() { execute(*defaultContext_); }
+
+ExecutionContext &TieredFunction::getDefaultContext() {
+  return *defaultContext_;
+}
+
+std::unique_ptr<ExecutionContext> TieredFunction::createExecutionContext() {
+  auto ctx = llvm::make_unique<TieredContext>();
+  for (auto *v : vars_) {
+    ctx->allocate(v);
+  }
+  ctx->setOwner(this);
+  return std::move(ctx);
+}
+
+void TieredFunction::execute(ExecutionContext &ctx) {
+  assert(ctx.getOwner() == this && "The context belongs to another function");
+  auto &tieredCtx = static_cast<TieredContext &>(ctx);
+  // Pick the tier once, so that the whole run uses the same code.
+  auto *tier = active_.load();
+  auto &tierCtx = getTierContext(tieredCtx, tier);
+  for (auto *v : vars_) {
+    tierCtx.bind(v, ctx.getTensor(v));
+  }
+  tier->execute(tierCtx);
+}
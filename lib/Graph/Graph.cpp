@@ -16,6 +16,7 @@
 
 #include "glow/Graph/Graph.h"
 #include "glow/Graph/Nodes.h"
+#include "glow/Graph/Utils.h"
 #include "glow/Support/Support.h"
 
 #include "llvm/ADT/DenseMap.h"
@@ -1884,6 +1885,13 @@ Variable *Module::getVariableByName(llvm::StringRef name) {
   return nullptr;
 }
 
+void Module::eraseFunction(Function *F) {
+  auto I = std::find(functions_.begin(), functions_.end(), F);
+  assert(I != functions_.end() && "The function is not in the module");
+  functions_.erase(I);
+  delete F;
+}
+
 void Module::eraseVariable(Variable *N) {
   auto &vars = getVars();
   auto I = std::find(vars.begin(), vars.end(), N);
@@ -1947,6 +1955,252 @@ Function *Function::clone(llvm::StringRef newName,
   return newF;
 }
 
+Function *
+Function::cloneWithBatchSize(llvm::StringRef newName,
+                             llvm::ArrayRef<Variable *> inputs,
+                             size_t batchSize,
+                             llvm::DenseMap<Variable *, Variable *> *varMap) {
+  assert(!inputs.empty() && "No batched inputs");
+  size_t oldBatchSize = inputs[0]->dims()[0];
+  Module *M = getParent();
+  auto *newF = clone(newName);
+
+  // \returns the type \p T with the new batch size in the dimension \p dim.
+  auto rebatchType = [&](TypeRef T, unsigned dim) {
+    assert(T->dims()[dim] == oldBatchSize && "Not a batch dimension");
+    ShapeVector dims(T->dims().begin(), T->dims().end());
+    dims[dim] = batchSize;
+    return M->uniqueTypeWithNewShape(T, dims);
+  };
+
+  // Maps the results that depend on the batch to their batch dimension. The
+  // batch dimension of the inputs is their first dimension, and the nodes
+  // below propagate it to their results.
+  llvm::DenseMap<std::pair<const Node *, unsigned>, unsigned> batchDims;
+  // \returns true if the result \p NV has the batch dimension \p dim.
+  auto hasBatchDim = [&](NodeValue NV, unsigned dim) {
+    return NV.dims().size() > dim && NV.dims()[dim] == oldBatchSize;
+  };
+  // Give the result \p idx of \p N the new batch size in the dimension \p dim.
+  auto rebatchResult = [&](Node *N, unsigned idx, unsigned dim) {
+    N->setType(idx, rebatchType(N->getType(idx), dim));
+    batchDims[{N, idx}] = dim;
+  };
+
+  // Maps the batched public variables to their replacements.
+  llvm::DenseMap<Variable *, Variable *> newVars;
+  auto getNewVar = [&](Variable *V, unsigned dim) {
+    auto &newV = newVars[V];
+    if (!newV) {
+      assert(!V->isPrivate() && "A private variable has the batch dimension");
+      newV = M->createVariable(rebatchType(V->getType(), dim), V->getName(),
+                               VisibilityKind::Public, V->isTraining());
+      batchDims[{newV, 0}] = dim;
+    }
+    return newV;
+  };
+  for (auto *V : inputs) {
+    assert(V->dims()[0] == oldBatchSize && "The batch sizes don't match");
+    getNewVar(V, 0);
+  }
+
+  // Erase the new function and variables when a node can't be rebatched.
+  auto unsupported = [&]() -> Function * {
+    M->eraseFunction(newF);
+    for (auto &it : newVars) {
+      M->eraseVariable(it.second);
+    }
+    return nullptr;
+  };
+  for (auto &N : newF->getNodes()) {
+    for (unsigned i = 0, e = N.getNumInputs(); i < e; i++) {
+      auto *V = dyn_cast<Variable>(N.getNthInput(i).getNode());
+      if (V && newVars.count(V)) {
+        N.setNthInput(i, newVars[V]);
+      }
+    }
+  }
+
+  // Visit the nodes in post order, which means that the batch dimensions of
+  // the operands of a node are known before the node is visited.
+  GraphPostOrderVisitor visitor(*newF);
+  for (auto *N : visitor.getPostOrder()) {
+    if (isa<Variable>(N)) {
+      continue;
+    }
+
+    // A node depends on the batch if one of its operands does, and all of
+    // these operands must agree on the batch dimension.
+    int dim = -1;
+    for (unsigned i = 0, e = N->getNumInputs(); i < e; i++) {
+      auto input = N->getNthInput(i);
+      auto it = batchDims.find({input.getNode(), input.getResNo()});
+      if (it == batchDims.end()) {
+        continue;
+      }
+      if (dim >= 0 && unsigned(dim) != it->second) {
+        // The operands have different batch dimensions.
+        return unsupported();
+      }
+      dim = it->second;
+    }
+    if (dim < 0) {
+      continue;
+    }
+
+    // Splats that are combined with the batch, e.g. the tensors that tiles are
+    // inserted into, are recreated with the new batch size.
+    bool allBatched = true;
+    for (unsigned i = 0, e = N->getNumInputs(); i < e; i++) {
+      auto input = N->getNthInput(i);
+      if (batchDims.count({input.getNode(), input.getResNo()})) {
+        continue;
+      }
+      auto *splat = dyn_cast<SplatNode>(input.getNode());
+      if (!splat || !hasBatchDim(input, dim)) {
+        allBatched = false;
+        continue;
+      }
+      auto *newSplat =
+          newF->createSplat(splat->getName(), rebatchType(input.getType(), dim),
+                            splat->getValue());
+      N->setNthInput(i, newSplat);
+      batchDims[{newSplat, 0}] = dim;
+      if (splat->getNumUsers() == 0) {
+        newF->eraseNode(splat);
+      }
+    }
+
+    switch (N->getKind()) {
+    case Kinded::Kind::SaveNodeKind: {
+      // The public variable that holds the batched result is replaced too.
+      auto *SN = cast<SaveNode>(N);
+      auto *V = SN->getVariable();
+      if (V->isPrivate() || !hasBatchDim(V, dim)) {
+        // A batched result is saved to a non-batched variable.
+        return unsupported();
+      }
+      for (unsigned i = 0, e = SN->getNumInputs(); i < e; i++) {
+        if (SN->getNthInput(i).getNode() == V) {
+          SN->setNthInput(i, getNewVar(V, dim));
+        }
+      }
+      continue;
+    }
+
+    case Kinded::Kind::ReshapeNodeKind: {
+      // The Dims member of reshape nodes holds the batch size too, so they are
+      // recreated.
+      auto *RN = cast<ReshapeNode>(N);
+      ShapeVector dims(RN->getDims().begin(), RN->getDims().end());
+      if (dim != 0 || dims[0] != oldBatchSize) {
+        // The reshape does not keep the batch dimension.
+        return unsupported();
+      }
+      dims[0] = batchSize;
+      auto *newRN = newF->createReshape(RN->getName(), RN->getInput(), dims);
+      RN->setType(0, newRN->getResult().getType());
+      RN->getResult().replaceAllUsesOfWith(newRN);
+      newF->eraseNode(RN);
+      batchDims[{newRN, 0}] = 0;
+      continue;
+    }
+
+    case Kinded::Kind::TransposeNodeKind: {
+      // The batch dimension moves to the position of the shuffle that takes
+      // it.
+      auto shuffle = cast<TransposeNode>(N)->getShuffle();
+      auto pos = std::find(shuffle.begin(), shuffle.end(), unsigned(dim));
+      rebatchResult(N, 0, pos - shuffle.begin());
+      continue;
+    }
+
+    case Kinded::Kind::BatchedReduceAddNodeKind: {
+      size_t axis = cast<BatchedReduceAddNode>(N)->getAxis();
+      if (axis == unsigned(dim)) {
+        // The reduction adds up the samples of the batch.
+        return unsupported();
+      }
+      rebatchResult(N, 0, axis < unsigned(dim) ? dim - 1 : dim);
+      continue;
+    }
+
+    case Kinded::Kind::SliceNodeKind: {
+      // The Start member is not affected as long as the slice takes the
+      // whole batch.
+      auto *SN = cast<SliceNode>(N);
+      if (SN->getStart()[dim] != 0 || !hasBatchDim(SN->getResult(), dim)) {
+        // The slice does not take the whole batch.
+        return unsupported();
+      }
+      break;
+    }
+
+    case Kinded::Kind::ConcatNodeKind: {
+      auto *CN = cast<ConcatNode>(N);
+      if (CN->getDim() == unsigned(dim) || !allBatched) {
+        // The concat does not keep the batch dimension.
+        return unsupported();
+      }
+      break;
+    }
+
+    case Kinded::Kind::InsertTensorNodeKind: {
+      auto *IN = cast<InsertTensorNode>(N);
+      auto big = IN->getBig();
+      if (!batchDims.count({big.getNode(), big.getResNo()})) {
+        // The batch is inserted into a non-batched tensor.
+        return unsupported();
+      }
+      if (IN->getStart()[dim] != 0 ||
+          (IN->getAxis() == unsigned(dim) && IN->getCount() != 1)) {
+        // The tiles are inserted along the batch dimension.
+        return unsupported();
+      }
+      break;
+    }
+
+    case Kinded::Kind::GatherNodeKind: {
+      auto *GN = cast<GatherNode>(N);
+      auto data = GN->getData();
+      if (GN->getBatchDims() == 0 &&
+          batchDims.count({data.getNode(), data.getResNo()})) {
+        // The gather picks samples of the batch.
+        return unsupported();
+      }
+      break;
+    }
+
+    default:
+      break;
+    }
+
+    // The other nodes keep the batch dimension of their operands in the
+    // results that have it.
+    bool found = false;
+    for (unsigned i = 0, e = N->getNumResults(); i < e; i++) {
+      if (hasBatchDim(N->getNthResult(i), dim)) {
+        rebatchResult(N, i, dim);
+        found = true;
+      }
+    }
+    if (!found) {
+      // The node does not keep the batch dimension.
+      return unsupported();
+    }
+  }
+
+  if (varMap) {
+    assert(varMap->empty() && "The external map must be empty");
+    for (auto it : newVars) {
+      varMap->insert(it);
+    }
+  }
+
+  newF->verify();
+  return newF;
+}
+
 /// Verify the input \p idx of a node \p N. Check that the node \p N is in the
 /// use-list of the corresponding input node.
 static void verifyNodeInput(const Node &N, size_t idx) {
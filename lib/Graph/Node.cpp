@@ -66,6 +66,11 @@ TypeRef Node::getType(unsigned idx) const {
   return types_[idx];
 }
 
+void Node::setType(unsigned idx, TypeRef T) {
+  assert(idx < numRes_ && "Result number does not exist.");
+  types_[idx] = T;
+}
+
 ElemKind Node::getElementType(unsigned resNo) const {
   TypeRef TR = getType(resNo);
   return TR->getElementType();
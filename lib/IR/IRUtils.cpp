@@ -20,6 +20,7 @@
 #include "llvm/Support/Casting.h"
 
 using namespace glow;
+using llvm::cast;
 using llvm::dyn_cast;
 using llvm::isa;
 
@@ -51,3 +52,59 @@ const Value *glow::getOrigin(const Value *V) {
   }
   return V;
 }
+
+uint64_t glow::getConvolutionFLOPs(const Value *dest, const Value *filter) {
+  // Every output element accumulates the products of one filter channel.
+  size_t outChannels = dest->dims().back();
+  return 2 * dest->size() * (filter->size() / outChannels);
+}
+
+uint64_t glow::estimateFLOPs(const Instruction *I) {
+  switch (I->getKind()) {
+  case Kinded::Kind::AllocActivationInstKind:
+  case Kinded::Kind::DeallocActivationInstKind:
+  case Kinded::Kind::TensorViewInstKind:
+  case Kinded::Kind::CopyInstKind:
+  case Kinded::Kind::TransposeInstKind:
+  case Kinded::Kind::SplatInstKind:
+  case Kinded::Kind::InsertTensorInstKind:
+  case Kinded::Kind::ExtractTensorInstKind:
+  case Kinded::Kind::GatherInstKind:
+  case Kinded::Kind::DebugPrintInstKind:
+    return 0;
+
+  case Kinded::Kind::ConvolutionInstKind: {
+    auto *CI = cast<ConvolutionInst>(I);
+    return getConvolutionFLOPs(CI->getDest(), CI->getFilter());
+  }
+
+  case Kinded::Kind::MatMulInstKind: {
+    auto *MM = cast<MatMulInst>(I);
+    return 2 * MM->getDest()->size() * MM->getLHS()->dims().back();
+  }
+
+  case Kinded::Kind::PoolMaxInstKind: {
+    auto *PM = cast<PoolMaxInst>(I);
+    return PM->getDest()->size() * PM->getKernel() * PM->getKernel();
+  }
+
+  case Kinded::Kind::PoolAvgInstKind: {
+    auto *PA = cast<PoolAvgInst>(I);
+    return PA->getDest()->size() * PA->getKernel() * PA->getKernel();
+  }
+
+  case Kinded::Kind::BatchedReduceAddInstKind:
+    return cast<BatchedReduceAddInst>(I)->getBatch()->size();
+
+  default:
+    return I->getNumOperands() ? I->getOperand(0).first->size() : 0;
+  }
+}
+
+uint64_t glow::getOperandsSizeInBytes(const Instruction *I) {
+  uint64_t bytes = 0;
+  for (const auto &op : I->getOperands()) {
+    bytes += op.first->getSizeInBytes();
+  }
+  return bytes;
+}
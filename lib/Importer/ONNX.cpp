@@ -499,6 +499,46 @@ std::unique_ptr<ONNXModelLoader> ONNXModelLoader::parse(const void *onnxModel,
   return onnxLoader;
 }
 
+std::unique_ptr<ONNXModelLoader>
+ONNXModelLoader::parse(const void *onnxModel, size_t onnxModelSize,
+                       llvm::ArrayRef<const char *> weightNames,
+                       llvm::ArrayRef<Tensor *> weights, Function &F) {
+  assert(weightNames.size() == weights.size() && "Invalid weights");
+  std::unique_ptr<ONNXModelLoader> onnxLoader(new ONNXModelLoader(F));
+
+  onnx::GraphProto modelDef;
+  if (!onnxLoader->loadProto(modelDef, onnxModel, onnxModelSize)) {
+    return nullptr;
+  }
+
+  for (size_t i = 0, e = weights.size(); i < e; i++) {
+    onnxLoader->createAndRememberVariable(weightNames[i], *weights[i],
+                                          VisibilityKind::Private, false);
+  }
+
+  // The initializers of the model are weights too. The other inputs are fed
+  // by the caller.
+  onnxLoader->loadInitializers(modelDef);
+  for (const auto &in : modelDef.input()) {
+    if (onnxLoader->hasNodeByName(in.name()) ||
+        onnxLoader->tensors_.count(in.name())) {
+      continue;
+    }
+    Tensor T;
+    loadShape(in.type(), &T);
+    onnxLoader->inputVarsByName_[in.name()] =
+        onnxLoader->createAndRememberVariable(in.name(), T,
+                                              VisibilityKind::Public, false);
+  }
+
+  if (!onnxLoader->loadNetwork(modelDef)) {
+    return nullptr;
+  }
+  onnxLoader->setOutputNodes(modelDef);
+
+  return onnxLoader;
+}
+
 ONNXModelLoader::ONNXModelLoader(Function &F)
     : CommonOperatorLoader({}, {}, F) {}
 
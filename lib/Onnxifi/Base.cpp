@@ -15,6 +15,10 @@
  */
 #include "Base.h"
 
+#include "glow/Importer/ONNX.h"
+
+#include "llvm/ADT/STLExtras.h"
+
 namespace glow {
 namespace onnxifi {
 
@@ -35,18 +39,181 @@ void Event::wait() {
   cond_.wait(guard, [this] { return fired_; });
 }
 
+namespace {
+/// The backend that compiles the graphs.
+#ifdef GLOW_WITH_CPU
+constexpr BackendKind graphBackendKind = BackendKind::CPU;
+#else
+constexpr BackendKind graphBackendKind = BackendKind::Interpreter;
+#endif
+
+/// The maximum number of runs of a graph that wait for the worker.
+constexpr size_t maxPendingRuns = 64;
+
+/// Set \p ty to the type of the tensor that is described by \p desc.
+/// \returns an error if the descriptor is not supported.
+onnxStatus getDescriptorType(const onnxTensorDescriptorV1 &desc, Type &ty) {
+  if (desc.tag != ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1) {
+    return ONNXIFI_STATUS_UNSUPPORTED_TAG;
+  }
+  if (desc.memoryType != ONNXIFI_MEMORY_TYPE_CPU) {
+    return ONNXIFI_STATUS_UNSUPPORTED_MEMORY_TYPE;
+  }
+  if (!desc.buffer || (desc.dimensions && !desc.shape)) {
+    return ONNXIFI_STATUS_INVALID_POINTER;
+  }
+
+  ElemKind kind;
+  switch (desc.dataType) {
+  case ONNXIFI_DATATYPE_FLOAT32:
+    kind = ElemKind::FloatTy;
+    break;
+  case ONNXIFI_DATATYPE_INT64:
+    kind = ElemKind::IndexTy;
+    break;
+  default:
+    return ONNXIFI_STATUS_UNSUPPORTED_DATATYPE;
+  }
+
+  std::vector<size_t> dims(desc.shape, desc.shape + desc.dimensions);
+  ty = Type(kind, dims);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+} // namespace
+
+Graph::Graph(BackendPtr backendPtr)
+    : backendPtr_(backendPtr), EE_(graphBackendKind) {}
+
 onnxStatus Graph::initGraph(const void *onnxModel, size_t onnxModelSize,
                             uint32_t weightCount,
                             const onnxTensorDescriptorV1 *weightDescriptors) {
+  // The weights are copied, because the buffers of the descriptors are only
+  // valid during this call.
+  std::vector<std::unique_ptr<Tensor>> weights;
+  std::vector<Tensor *> weightPtrs;
+  std::vector<const char *> weightNames;
+  for (uint32_t i = 0; i < weightCount; i++) {
+    const auto &desc = weightDescriptors[i];
+    Type ty;
+    auto status = getDescriptorType(desc, ty);
+    if (status != ONNXIFI_STATUS_SUCCESS) {
+      return status;
+    }
+    Tensor buffer(reinterpret_cast<void *>(desc.buffer), &ty);
+    weights.emplace_back(new Tensor(buffer.clone()));
+    weightPtrs.push_back(weights.back().get());
+    weightNames.push_back(desc.name);
+  }
+
+  auto *F = EE_.getModule().createFunction("onnxifi");
+  auto loader = ONNXModelLoader::parse(onnxModel, onnxModelSize, weightNames,
+                                       weightPtrs, *F);
+  if (!loader) {
+    return ONNXIFI_STATUS_UNSUPPORTED_OPERATOR;
+  }
+  inputVarsByName_ = loader->getInputVarsByName();
+  for (const auto &output : loader->getOutputsByName()) {
+    outputVarsByName_[output.first] = output.second->getVariable();
+  }
+
+  EE_.compile(CompilationMode::Infer, F);
+  queue_ = llvm::make_unique<RequestQueue>(
+      1, maxPendingRuns, [this]() { return EE_.createExecutionContext(); });
   return ONNXIFI_STATUS_SUCCESS;
 }
 
-onnxStatus Graph::run() { return ONNXIFI_STATUS_SUCCESS; }
+onnxStatus Graph::bindDescriptor(IOBindings &io, Variable *var,
+                                 const onnxTensorDescriptorV1 &desc,
+                                 bool isInput) {
+  Type ty;
+  auto status = getDescriptorType(desc, ty);
+  if (status != ONNXIFI_STATUS_SUCCESS) {
+    return status;
+  }
+  if (ty.getElementType() != var->getElementType()) {
+    return ONNXIFI_STATUS_MISMATCHING_DATATYPE;
+  }
+  if (ty.dims() != var->dims()) {
+    return ONNXIFI_STATUS_MISMATCHING_SHAPE;
+  }
+
+  std::unique_ptr<Tensor> buffer(
+      new Tensor(reinterpret_cast<void *>(desc.buffer), var->getType()));
+  io.vars.push_back(var);
+  if (desc.buffer % TensorAlignment == 0) {
+    io.tensors.push_back(std::move(buffer));
+    return ONNXIFI_STATUS_SUCCESS;
+  }
+
+  // The backends may access the tensors with aligned vector instructions, so
+  // misaligned buffers are copied through a staging tensor.
+  io.tensors.emplace_back(new Tensor(var->getType()));
+  auto &copies = isInput ? io.copyIn : io.copyOut;
+  copies.emplace_back(io.tensors.back().get(), std::move(buffer));
+  return ONNXIFI_STATUS_SUCCESS;
+}
 
 onnxStatus Graph::setIO(uint32_t inputsCount,
                         const onnxTensorDescriptorV1 *inputDescriptors,
                         uint32_t outputsCount,
                         const onnxTensorDescriptorV1 *outputDescriptors) {
+  if (!queue_) {
+    return ONNXIFI_STATUS_INVALID_STATE;
+  }
+
+  auto io = std::make_shared<IOBindings>();
+  for (uint32_t i = 0; i < inputsCount; i++) {
+    const auto &desc = inputDescriptors[i];
+    auto it = inputVarsByName_.find(desc.name ? desc.name : "");
+    if (it == inputVarsByName_.end()) {
+      return ONNXIFI_STATUS_UNIDENTIFIED_NAME;
+    }
+    auto status = bindDescriptor(*io, it->second, desc, true);
+    if (status != ONNXIFI_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+  for (uint32_t i = 0; i < outputsCount; i++) {
+    const auto &desc = outputDescriptors[i];
+    auto it = outputVarsByName_.find(desc.name ? desc.name : "");
+    if (it == outputVarsByName_.end()) {
+      return ONNXIFI_STATUS_UNIDENTIFIED_NAME;
+    }
+    auto status = bindDescriptor(*io, it->second, desc, false);
+    if (status != ONNXIFI_STATUS_SUCCESS) {
+      return status;
+    }
+  }
+
+  io_ = std::move(io);
+  return ONNXIFI_STATUS_SUCCESS;
+}
+
+onnxStatus Graph::run(EventPtr inputEvent, EventPtr outputEvent) {
+  if (!queue_ || !io_) {
+    return ONNXIFI_STATUS_INVALID_STATE;
+  }
+
+  // The run keeps the bindings alive, even if setIO is called again before
+  // the run is performed.
+  auto io = io_;
+  queue_->submit([this, io, inputEvent, outputEvent](ExecutionContext &ctx) {
+    inputEvent->wait();
+    for (auto &copy : io->copyIn) {
+      copy.first->copyRawFrom(copy.second.get());
+    }
+
+    std::vector<Tensor *> tensors;
+    for (auto &T : io->tensors) {
+      tensors.push_back(T.get());
+    }
+    EE_.runWithBindings(ctx, io->vars, tensors);
+
+    for (auto &copy : io->copyOut) {
+      copy.second->copyRawFrom(copy.first);
+    }
+    outputEvent->signal();
+  });
   return ONNXIFI_STATUS_SUCCESS;
 }
 
@@ -17,11 +17,17 @@
 #define GLOW_ONNXIFI_BASE_H
 
 #include "glow/ExecutionEngine/ExecutionEngine.h"
+#include "glow/ExecutionEngine/RequestQueue.h"
 
 #include "onnx/onnxifi.h"
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace glow {
 namespace onnxifi {
@@ -65,22 +71,56 @@ typedef Event *EventPtr;
 
 class Graph {
 public:
-  explicit Graph(BackendPtr backendPtr) : backendPtr_(backendPtr) {}
+  explicit Graph(BackendPtr backendPtr);
 
-  /// InitGraph.
+  /// InitGraph. Load the model and compile it.
   onnxStatus initGraph(const void *onnxModel, size_t onnxModelSize,
                        uint32_t weightCount,
                        const onnxTensorDescriptorV1 *weightDescriptors);
-  /// Set IO.
+  /// Set IO. Bind the buffers of the descriptors to the inputs and the
+  /// outputs of the graph. The buffers are used in place when they are
+  /// aligned like the tensors of Glow.
   onnxStatus setIO(uint32_t inputsCount,
                    const onnxTensorDescriptorV1 *inputDescriptors,
                    uint32_t outputsCount,
                    const onnxTensorDescriptorV1 *outputDescriptors);
-  /// Run graph.
-  onnxStatus run();
+  /// Run graph. The run is performed by a worker once \p inputEvent is
+  /// signalled, and \p outputEvent is signalled when the outputs are ready.
+  onnxStatus run(EventPtr inputEvent, EventPtr outputEvent);
 
 private:
+  /// The tensors that are bound to the variables of the graph by setIO.
+  struct IOBindings {
+    /// The bound variables.
+    std::vector<Variable *> vars;
+    /// The tensors of the variables. They either refer to the buffers of the
+    /// caller or are staging tensors.
+    std::vector<std::unique_ptr<Tensor>> tensors;
+    /// The staging tensors of the inputs and the buffers of the caller that
+    /// are copied into them before a run.
+    std::vector<std::pair<Tensor *, std::unique_ptr<Tensor>>> copyIn;
+    /// The staging tensors of the outputs and the buffers of the caller that
+    /// they are copied to after a run.
+    std::vector<std::pair<Tensor *, std::unique_ptr<Tensor>>> copyOut;
+  };
+
   BackendPtr backendPtr_;
+  /// The engine that compiles and runs the graph.
+  ExecutionEngine EE_;
+  /// The inputs and outputs of the graph by name.
+  std::unordered_map<std::string, Variable *> inputVarsByName_;
+  std::unordered_map<std::string, Variable *> outputVarsByName_;
+  /// The current bindings. The runs keep a reference to the bindings that
+  /// were current when they were submitted.
+  std::shared_ptr<IOBindings> io_;
+  /// The worker that performs the runs. It is declared last so that it is
+  /// destroyed first, after the in-flight runs complete.
+  std::unique_ptr<RequestQueue> queue_;
+
+  /// Bind the buffer of \p desc to the variable \p var in \p io. \p isInput
+  /// tells whether \p var is an input of the graph.
+  onnxStatus bindDescriptor(IOBindings &io, Variable *var,
+                            const onnxTensorDescriptorV1 &desc, bool isInput);
 };
 
 typedef Graph *GraphPtr;
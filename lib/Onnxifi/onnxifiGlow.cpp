@@ -209,7 +209,7 @@ onnxSignalEvent(onnxEvent event) {
     return ONNXIFI_STATUS_INVALID_EVENT;
   }
 
-  if (glowEvent->signal()) {
+  if (!glowEvent->signal()) {
     return ONNXIFI_STATUS_INVALID_STATE;
   }
 
@@ -263,6 +263,7 @@ onnxInitGraph(onnxBackend backend, size_t onnxModelSize, const void *onnxModel,
   auto ret = glowGraph->initGraph(onnxModel, onnxModelSize, weightsCount,
                                   weightDescriptors);
   if (ret != ONNXIFI_STATUS_SUCCESS) {
+    delete glowGraph;
     return ret;
   }
 
@@ -308,7 +309,21 @@ onnxRunGraph(onnxGraph graph, const onnxMemoryFenceV1 *inputFence,
     return ONNXIFI_STATUS_UNSUPPORTED_TAG;
   }
 
-  // Implement graph run procedure.
+  auto *inputEvent =
+      reinterpret_cast<glow::onnxifi::EventPtr>(inputFence->event);
+  if (!inputEvent) {
+    return ONNXIFI_STATUS_INVALID_EVENT;
+  }
+
+  // The output event is single-shot, so it is created by the backend and
+  // signalled by the worker when the outputs are ready.
+  auto *outputEvent = new glow::onnxifi::Event();
+  auto ret = glowGraph->run(inputEvent, outputEvent);
+  if (ret != ONNXIFI_STATUS_SUCCESS) {
+    delete outputEvent;
+    return ret;
+  }
+  outputFence->event = outputEvent;
 
   return ONNXIFI_STATUS_SUCCESS;
 }
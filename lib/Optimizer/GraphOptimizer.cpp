@@ -19,6 +19,7 @@
 #include "glow/Graph/Nodes.h"
 #include "glow/Optimizer/Optimizer.h"
 #include "glow/Quantization/Base/Base.h"
+#include "glow/Support/CompileProfile.h"
 
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CommandLine.h"
@@ -1739,61 +1740,74 @@ static bool sinkRescaleQuantizedNode(Function *F) {
   return changed;
 }
 
+/// Run the pass \p pass on \p F, and record it as the phase \p name in the
+/// compile profile. \returns the result of the pass.
+template <typename PassFn>
+static auto runPass(const char *name, Function *F, PassFn pass)
+    -> decltype(pass(F)) {
+  CompilePhase phase(name, "graph", "nodes",
+                     [F]() { return F->getNodes().size(); });
+  return pass(F);
+}
+
 void glow::optimize(Function *F, CompilationMode mode) {
+  CompilePhase phase("optimize", "graph", "nodes",
+                     [F]() { return F->getNodes().size(); });
+
   // Sink transpose operations in an attempt to cancel them out.
   // Perform code sinking until a fixed-point is reached.
   // On big functions, the number of iterations until the fixpoint
   // is usually at most 2 or 3 iterations.
-  while (sinkCode(F)) {
+  while (runPass("sinkCode", F, sinkCode)) {
     // Perform Dead Code Elimination between rounds of code sinking.
-    DCE(F);
+    runPass("DCE", F, DCE);
   }
 
   // Optimize the pooling operation.
-  optimizePool(F);
+  runPass("optimizePool", F, optimizePool);
 
   // Perform Common Subexpression Elimination.
-  CSE(F);
+  runPass("CSE", F, CSE);
 
   // Merge multiple matmul nodes into a single large matmul.
-  mergeMatMul(F);
+  runPass("mergeMatMul", F, mergeMatMul);
 
   // Merge multiple batched adds into a larger batched add.
-  mergeBatchedAdd(F);
+  runPass("mergeBatchedAdd", F, mergeBatchedAdd);
 
   // Perform Dead Code Elimination.
-  DCE(F);
+  runPass("DCE", F, DCE);
 
   if (mode == CompilationMode::Infer) {
     // Merge batch normalization operations.
-    optimizeBatchNorm(F);
+    runPass("optimizeBatchNorm", F, optimizeBatchNorm);
 
     // Constant-fold transpose operations.
-    optimizeTranspose(F);
+    runPass("optimizeTranspose", F, optimizeTranspose);
   }
 
   // Perform Common Subexpression Elimination.
-  CSE(F);
+  runPass("CSE", F, CSE);
 
   // Optimize Concat nodes.
-  optimizeConcatNodes(F);
+  runPass("optimizeConcatNodes", F, optimizeConcatNodes);
 
   // Optimize arithmetic nodes based on algebraic identities.
-  optimizeArithmeticNodes(F);
+  runPass("optimizeArithmeticNodes", F, optimizeArithmeticNodes);
 
   // Optimize Tensor shape transformations.
-  optimizeSliceOfSplat(F);
+  runPass("optimizeSliceOfSplat", F, optimizeSliceOfSplat);
 
-  optimizeReshape(F);
+  runPass("optimizeReshape", F, optimizeReshape);
 
   // Optimize things that are related to quantization.
-  optimizeQuantization(F);
+  runPass("optimizeQuantization", F, optimizeQuantization);
 
-  while (sinkRescaleQuantizedNode(F)) {
-    DCE(F);
-    optimizeQuantization(F);
+  while (runPass("sinkRescaleQuantizedNode", F, sinkRescaleQuantizedNode)) {
+    runPass("DCE", F, DCE);
+    runPass("optimizeQuantization", F, optimizeQuantization);
   }
 
   // Perform Dead Code Elimination.
-  DCE(F);
+  runPass("DCE", F, DCE);
 }
@@ -22,6 +22,7 @@
 #include "glow/IR/IRUtils.h"
 #include "glow/IR/Instrs.h"
 #include "glow/Optimizer/Optimizer.h"
+#include "glow/Support/CompileProfile.h"
 #include "glow/Support/Debug.h"
 
 #include "llvm/Support/Casting.h"
@@ -1592,40 +1593,52 @@ void performPeepholeOptimizations(IRFunction &M) {
   }
 }
 
+/// Run the pass \p pass on \p M, and record it as the phase \p name in the
+/// compile profile.
+template <typename PassFn>
+static void runPass(const char *name, IRFunction &M, PassFn pass) {
+  CompilePhase phase(name, "ir", "instrs",
+                     [&M]() { return M.getInstrs().size(); });
+  pass(M);
+}
+
 /// Perform optimizations on the IR representation.
 void glow::optimize(IRFunction &M, CompilationMode mode, const Backend &B) {
   M.verify();
   if (!optimizeIR)
     return;
 
-  performPeepholeOptimizations(M);
+  CompilePhase phase("optimize", "ir", "instrs",
+                     [&M]() { return M.getInstrs().size(); });
+
+  runPass("performPeepholeOptimizations", M, performPeepholeOptimizations);
 
-  eliminateDeadStores(M);
+  runPass("eliminateDeadStores", M, eliminateDeadStores);
 
   // Replace applicable InsertTensors and ExtractTensors with TensorViews.
-  optimizeInserts(M);
-  optimizeExtracts(M);
+  runPass("optimizeInserts", M, optimizeInserts);
+  runPass("optimizeExtracts", M, optimizeExtracts);
 
   // Reuse buffers from previous operations.
   if (B.shouldShareBuffers())
-    shareBuffers(M);
+    runPass("shareBuffers", M, shareBuffers);
 
-  performPeepholeOptimizations(M);
+  runPass("performPeepholeOptimizations", M, performPeepholeOptimizations);
 
   // Shorten the lifetime of buffers.
-  hoistDealloc(M);
-  sinkAllocas(M);
+  runPass("hoistDealloc", M, hoistDealloc);
+  runPass("sinkAllocas", M, sinkAllocas);
 
   // Perform Dead Store Elimination.
-  eliminateDeadStores(M);
+  runPass("eliminateDeadStores", M, eliminateDeadStores);
 
-  deleteDeadAllocs(M);
+  runPass("deleteDeadAllocs", M, deleteDeadAllocs);
 
   // Turn read-only weights into constant weights.
-  makeWeightsConst(M);
+  runPass("makeWeightsConst", M, makeWeightsConst);
 
   // Perform a debug instrumentation if required.
-  performDebugInstrumentation(M);
+  runPass("performDebugInstrumentation", M, performDebugInstrumentation);
 
   // Print the module to stdout if requested.
   if (dumpOptMod)
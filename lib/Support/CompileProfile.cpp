@@ -0,0 +1,123 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/CompileProfile.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/FileSystem.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace glow;
+
+CompileProfile &CompileProfile::get() {
+  static CompileProfile profile;
+  return profile;
+}
+
+CompileProfile::~CompileProfile() {
+  if (filename_.empty()) {
+    return;
+  }
+  std::error_code EC;
+  llvm::raw_fd_ostream os(filename_, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "Unable to write the compile profile " << filename_
+                 << ": " << EC.message() << "\n";
+    return;
+  }
+  writeReport(os);
+}
+
+void CompileProfile::enable(llvm::StringRef filename) {
+  filename_ = filename;
+  enabled_ = true;
+}
+
+void CompileProfile::addEvent(TraceEvent event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back(std::move(event));
+}
+
+void CompileProfile::startPhase(CompilePhase *phase) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Resetting the peak would lose it for the phases that are running.
+  size_t peak = getPeakMemoryUsageKB();
+  for (auto *P : activePhases_) {
+    P->peakMemoryKB_ = std::max(P->peakMemoryKB_, peak);
+  }
+  phase->hasPeakMemory_ = resetPeakMemoryUsage();
+  phase->peakMemoryKB_ = getPeakMemoryUsageKB();
+  activePhases_.push_back(phase);
+}
+
+size_t CompileProfile::endPhase(CompilePhase *phase) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t peak = std::max(phase->peakMemoryKB_, getPeakMemoryUsageKB());
+  auto it = std::find(activePhases_.begin(), activePhases_.end(), phase);
+  assert(it != activePhases_.end() && "The phase is not running");
+  for (auto P = activePhases_.begin(); P != it; ++P) {
+    (*P)->peakMemoryKB_ = std::max((*P)->peakMemoryKB_, peak);
+  }
+  activePhases_.erase(it);
+  return peak;
+}
+
+void CompileProfile::writeReport(llvm::raw_ostream &os) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  writeChromeTrace(os, events_);
+}
+
+void CompileProfile::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+}
+
+CompilePhase::CompilePhase(llvm::StringRef name, llvm::StringRef category,
+                           const char *sizeName, SizeFn size)
+    : size_(std::move(size)), sizeName_(sizeName) {
+  if (!CompileProfile::get().isEnabled()) {
+    return;
+  }
+  event_ = llvm::make_unique<TraceEvent>();
+  event_->name = name;
+  event_->category = category;
+  event_->tid = getTraceThreadId();
+  if (size_) {
+    event_->args.emplace_back(std::string(sizeName_) + "_before", size_());
+  }
+  startMemoryKB_ = getMemoryUsageKB();
+  CompileProfile::get().startPhase(this);
+  event_->start = getTraceTimestamp();
+}
+
+CompilePhase::~CompilePhase() {
+  if (!event_) {
+    return;
+  }
+  event_->duration = getTraceTimestamp() - event_->start;
+  if (size_) {
+    event_->args.emplace_back(std::string(sizeName_) + "_after", size_());
+  }
+  event_->args.emplace_back("rss_delta_kb", int64_t(getMemoryUsageKB()) -
+                                                int64_t(startMemoryKB_));
+  size_t peak = CompileProfile::get().endPhase(this);
+  if (hasPeakMemory_) {
+    event_->args.emplace_back("peak_rss_kb", peak);
+  }
+  CompileProfile::get().addEvent(std::move(*event_));
+}
@@ -0,0 +1,257 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/ExecutionProfile.h"
+
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+
+#include <algorithm>
+
+using namespace glow;
+
+namespace {
+llvm::cl::opt<bool> profileCounters(
+    "profile-counters",
+    llvm::cl::desc("Collect the hardware performance counters of every "
+                   "instruction that is profiled (Linux only)"),
+    llvm::cl::init(false));
+
+llvm::cl::opt<double> rooflinePeakGFLOPs(
+    "roofline-peak-gflops",
+    llvm::cl::desc("The peak GFLOP/s of the machine, which bounds the roofline "
+                   "in the summaries of the execution profiles"),
+    llvm::cl::init(0));
+
+llvm::cl::opt<double> rooflinePeakGBs(
+    "roofline-peak-gbps",
+    llvm::cl::desc("The peak memory bandwidth of the machine in GB/s, which "
+                   "bounds the roofline in the summaries of the execution "
+                   "profiles"),
+    llvm::cl::init(0));
+
+/// Write the report \p write into the file \p filename, if it is not empty.
+template <typename WriteFn>
+void writeFile(llvm::StringRef filename, WriteFn write) {
+  if (filename.empty()) {
+    return;
+  }
+  std::error_code EC;
+  llvm::raw_fd_ostream os(filename, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    llvm::errs() << "Unable to write the execution profile " << filename
+                 << ": " << EC.message() << "\n";
+    return;
+  }
+  write(os);
+}
+
+/// Write \p num / \p den with the format \p fmt into \p os, or a dash if
+/// \p den is zero. Every column is \p width characters wide.
+void writeRatio(llvm::raw_ostream &os, const char *fmt, double num, double den,
+                unsigned width) {
+  if (den == 0) {
+    os << llvm::right_justify("-", width);
+    return;
+  }
+  os << llvm::format(fmt, num / den);
+}
+} // namespace
+
+ExecutionProfile::ExecutionProfile(llvm::StringRef category, size_t maxEvents)
+    : category_(category), maxEvents_(maxEvents),
+      collectCounters_(profileCounters) {}
+
+ExecutionProfile::~ExecutionProfile() {
+  writeFile(traceFile_,
+            [this](llvm::raw_ostream &os) { writeChromeTrace(os); });
+  writeFile(summaryFile_, [this](llvm::raw_ostream &os) { writeSummary(os); });
+}
+
+void ExecutionProfile::setOutputFiles(llvm::StringRef traceFile,
+                                      llvm::StringRef summaryFile) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  traceFile_ = traceFile;
+  summaryFile_ = summaryFile;
+}
+
+ExecutionProfile::Sample ExecutionProfile::sample() const {
+  Sample sample;
+  // Read the counters first, so that reading the clock is not counted.
+  if (collectCounters_) {
+    sample.counters = PerfCounters::getThreadCounters().read();
+  }
+  sample.timestamp = getTraceTimestamp();
+  return sample;
+}
+
+void ExecutionProfile::addEvent(llvm::StringRef name, llvm::StringRef kind,
+                                uint64_t start, uint64_t end,
+                                uint64_t allocatedBytes) {
+  Sample begin, finish;
+  begin.timestamp = start;
+  finish.timestamp = end;
+  addEvent(name, kind, begin, finish, InstrCost(), allocatedBytes);
+}
+
+void ExecutionProfile::addEvent(llvm::StringRef name, llvm::StringRef kind,
+                                const Sample &begin, const Sample &end,
+                                const InstrCost &cost,
+                                uint64_t allocatedBytes) {
+  uint64_t duration = end.timestamp - begin.timestamp;
+  auto counters = end.counters - begin.counters;
+  unsigned tid = getTraceThreadId();
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto &stats = stats_[name];
+  if (stats.count == 0) {
+    stats.kind = kind;
+    stats.min = duration;
+  }
+  stats.count++;
+  stats.total += duration;
+  stats.min = std::min(stats.min, duration);
+  stats.max = std::max(stats.max, duration);
+  stats.allocatedBytes += allocatedBytes;
+  stats.cost.flops += cost.flops;
+  stats.cost.bytes += cost.bytes;
+  stats.counters += counters;
+
+  if (events_.size() == maxEvents_) {
+    return;
+  }
+  events_.emplace_back();
+  auto &event = events_.back();
+  event.name = name;
+  event.category = category_;
+  event.start = begin.timestamp;
+  event.duration = duration;
+  event.tid = tid;
+  if (allocatedBytes) {
+    event.args.emplace_back("allocated_bytes", allocatedBytes);
+  }
+  if (cost.flops) {
+    event.args.emplace_back("flops", cost.flops);
+  }
+  if (counters.cycles) {
+    event.args.emplace_back("cycles", counters.cycles);
+    event.args.emplace_back("instructions", counters.instructions);
+    event.args.emplace_back("cache_references", counters.cacheReferences);
+    event.args.emplace_back("cache_misses", counters.cacheMisses);
+  }
+}
+
+std::map<std::string, ExecutionProfile::InstrStats>
+ExecutionProfile::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void ExecutionProfile::writeChromeTrace(llvm::raw_ostream &os) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  glow::writeChromeTrace(os, events_);
+}
+
+void ExecutionProfile::writeSummary(llvm::raw_ostream &os) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<std::pair<const std::string *, const InstrStats *>> sorted;
+  uint64_t total = 0;
+  uint64_t allocatedBytes = 0;
+  bool hasCosts = false;
+  for (const auto &it : stats_) {
+    sorted.emplace_back(&it.first, &it.second);
+    total += it.second.total;
+    allocatedBytes += it.second.allocatedBytes;
+    hasCosts |= it.second.cost.flops || it.second.counters.cycles;
+  }
+  std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+    return a.second->total > b.second->total;
+  });
+
+  // The times in the table are in microseconds, and the sizes in kilobytes.
+  os << llvm::right_justify("total(us)", 12) << llvm::right_justify("%", 8)
+     << llvm::right_justify("count", 9) << llvm::right_justify("avg(us)", 11)
+     << llvm::right_justify("min(us)", 11)
+     << llvm::right_justify("max(us)", 11);
+  if (allocatedBytes) {
+    os << llvm::right_justify("alloc(KB)", 11);
+  }
+  os << "  " << llvm::left_justify("kind", 24) << " name\n";
+  for (const auto &entry : sorted) {
+    const auto &stats = *entry.second;
+    double percent = total ? 100.0 * stats.total / total : 0;
+    os << llvm::format("%12.1f %7.2f %8llu %10.2f %10.2f %10.2f",
+                       stats.total / 1e3, percent,
+                       (unsigned long long)stats.count,
+                       stats.total / 1e3 / stats.count, stats.min / 1e3,
+                       stats.max / 1e3);
+    if (allocatedBytes) {
+      os << llvm::format(" %10.1f", stats.allocatedBytes / 1024.0);
+    }
+    os << "  " << llvm::left_justify(stats.kind, 24) << ' ' << *entry.first
+       << '\n';
+  }
+  os << llvm::format("%12.1f %7.2f", total / 1e3, total ? 100.0 : 0.0)
+     << "  total\n";
+
+  if (!hasCosts) {
+    return;
+  }
+
+  // The roofline is the performance that an instruction with the arithmetic
+  // intensity (FLOP/B) of the instruction can achieve on the machine.
+  double peakGFLOPs = rooflinePeakGFLOPs;
+  double peakGBs = rooflinePeakGBs;
+  bool hasRoofline = peakGFLOPs > 0 && peakGBs > 0;
+  os << "\n"
+     << llvm::right_justify("IPC", 8) << llvm::right_justify("miss%", 8)
+     << llvm::right_justify("GFLOP/s", 10) << llvm::right_justify("GB/s", 10)
+     << llvm::right_justify("FLOP/B", 10);
+  if (hasRoofline) {
+    os << llvm::right_justify("roofline", 10) << llvm::right_justify("%", 8);
+  }
+  os << "  name\n";
+  for (const auto &entry : sorted) {
+    const auto &stats = *entry.second;
+    const auto &counters = stats.counters;
+    writeRatio(os, "%8.2f", counters.instructions, counters.cycles, 8);
+    writeRatio(os, "%8.2f", 100.0 * counters.cacheMisses,
+               counters.cacheReferences, 8);
+    // FLOP per nanosecond is GFLOP/s.
+    writeRatio(os, "%10.2f", stats.cost.flops, stats.total, 10);
+    writeRatio(os, "%10.2f", stats.cost.bytes, stats.total, 10);
+    writeRatio(os, "%10.2f", stats.cost.flops, stats.cost.bytes, 10);
+    if (hasRoofline) {
+      double roofline = peakGFLOPs;
+      if (stats.cost.bytes) {
+        double intensity = double(stats.cost.flops) / stats.cost.bytes;
+        roofline = std::min(peakGFLOPs, intensity * peakGBs);
+      }
+      // The roofline is meaningless for instructions that don't compute.
+      writeRatio(os, "%10.2f", roofline, stats.cost.flops ? 1 : 0, 10);
+      // The roofline in GFLOP/s is the number of FLOP per nanosecond.
+      writeRatio(os, "%8.1f", 100.0 * stats.cost.flops, roofline * stats.total,
+                 8);
+    }
+    os << "  " << *entry.first << '\n';
+  }
+}
+
+void ExecutionProfile::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.clear();
+  stats_.clear();
+}
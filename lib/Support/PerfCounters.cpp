@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+using namespace glow;
+
+PerfCounterValues PerfCounterValues::
+operator-(const PerfCounterValues &begin) const {
+  PerfCounterValues diff;
+  diff.cycles = cycles - begin.cycles;
+  diff.instructions = instructions - begin.instructions;
+  diff.cacheReferences = cacheReferences - begin.cacheReferences;
+  diff.cacheMisses = cacheMisses - begin.cacheMisses;
+  return diff;
+}
+
+PerfCounterValues &PerfCounterValues::
+operator+=(const PerfCounterValues &other) {
+  cycles += other.cycles;
+  instructions += other.instructions;
+  cacheReferences += other.cacheReferences;
+  cacheMisses += other.cacheMisses;
+  return *this;
+}
+
+#ifdef __linux__
+namespace {
+/// Open the hardware counter \p config of the calling thread in the group
+/// \p groupFd, or as the leader of a new group if \p groupFd is -1.
+/// \returns the file descriptor of the counter, or -1.
+int openCounter(uint64_t config, int groupFd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Only count the code of the process, which also lowers the privileges
+  // that are required.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, /* pid */ 0, /* cpu */ -1,
+                 groupFd, /* flags */ 0);
+}
+} // namespace
+
+PerfCounters::PerfCounters() {
+  groupFd_ = openCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (groupFd_ == -1) {
+    return;
+  }
+  fields_[numCounters_++] = &PerfCounterValues::cycles;
+
+  // The other counters are optional, e.g. virtual machines often don't
+  // support the cache counters.
+  struct {
+    uint64_t config;
+    uint64_t PerfCounterValues::*field;
+  } members[] = {
+      {PERF_COUNT_HW_INSTRUCTIONS, &PerfCounterValues::instructions},
+      {PERF_COUNT_HW_CACHE_REFERENCES, &PerfCounterValues::cacheReferences},
+      {PERF_COUNT_HW_CACHE_MISSES, &PerfCounterValues::cacheMisses},
+  };
+  for (unsigned i = 0; i < 3; i++) {
+    memberFds_[i] = openCounter(members[i].config, groupFd_);
+    if (memberFds_[i] != -1) {
+      fields_[numCounters_++] = members[i].field;
+    }
+  }
+}
+
+PerfCounters::~PerfCounters() {
+  for (int fd : memberFds_) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+  if (groupFd_ != -1) {
+    close(groupFd_);
+  }
+}
+
+PerfCounterValues PerfCounters::read() const {
+  PerfCounterValues values;
+  if (groupFd_ == -1) {
+    return values;
+  }
+  // The group is read as the number of counters followed by their values.
+  uint64_t buffer[1 + 4];
+  if (::read(groupFd_, buffer, sizeof(buffer)) <= 0) {
+    return values;
+  }
+  for (unsigned i = 0; i < buffer[0] && i < numCounters_; i++) {
+    values.*fields_[i] = buffer[1 + i];
+  }
+  return values;
+}
+#else
+PerfCounters::PerfCounters() {}
+
+PerfCounters::~PerfCounters() {}
+
+PerfCounterValues PerfCounters::read() const { return PerfCounterValues(); }
+#endif
+
+const PerfCounters &PerfCounters::getThreadCounters() {
+  thread_local PerfCounters counters;
+  return counters;
+}
@@ -16,6 +16,7 @@
 
 #include "glow/Support/Support.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 
 #include <cctype>
 #include <sstream>
@@ -75,4 +76,31 @@ std::string escapeDottyString(const std::string &str) {
   }
   return out;
 }
+
+void writeJSONString(llvm::raw_ostream &os, llvm::StringRef str) {
+  os << '"';
+  for (unsigned char c : str) {
+    switch (c) {
+    case '"':
+      os << "\\\"";
+      break;
+    case '\\':
+      os << "\\\\";
+      break;
+    case '\n':
+      os << "\\n";
+      break;
+    case '\t':
+      os << "\\t";
+      break;
+    default:
+      if (c < 0x20) {
+        os << llvm::format("\\u%04x", c);
+      } else {
+        os << c;
+      }
+    }
+  }
+  os << '"';
+}
 } // namespace glow
@@ -0,0 +1,110 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/TaskGraph.h"
+#include "glow/Support/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace glow;
+
+unsigned TaskGraph::addTask(llvm::ArrayRef<MemoryAccess> accesses) {
+  unsigned id = size();
+  unsigned numPredecessors = 0;
+  for (unsigned prev = 0; prev < id; prev++) {
+    bool conflicts = false;
+    for (const auto &A : accesses) {
+      for (const auto &B : accesses_[prev]) {
+        conflicts |= A.conflictsWith(B);
+      }
+    }
+    if (conflicts) {
+      successors_[prev].push_back(id);
+      numPredecessors++;
+    }
+  }
+  accesses_.emplace_back(accesses.begin(), accesses.end());
+  successors_.emplace_back();
+  numPredecessors_.push_back(numPredecessors);
+  return id;
+}
+
+size_t TaskGraph::getCriticalPathLength() const {
+  // Every edge goes from an earlier task to a later one, so the ids are a
+  // topological order of the graph.
+  std::vector<size_t> depth(size(), 1);
+  size_t maxDepth = 0;
+  for (unsigned id = 0, e = size(); id < e; id++) {
+    for (unsigned succ : successors_[id]) {
+      depth[succ] = std::max(depth[succ], depth[id] + 1);
+    }
+    maxDepth = std::max(maxDepth, depth[id]);
+  }
+  return maxDepth;
+}
+
+void TaskGraph::run(ThreadPool &pool,
+                    const std::function<void(unsigned)> &fn) const {
+  size_t numTasks = size();
+  if (numTasks == 0) {
+    return;
+  }
+
+  // The number of unfinished dependencies of every task.
+  std::unique_ptr<std::atomic<unsigned>[]> numWaiting(
+      new std::atomic<unsigned>[numTasks]);
+  for (size_t i = 0; i < numTasks; i++) {
+    numWaiting[i] = numPredecessors_[i];
+  }
+  std::atomic<size_t> numRemaining{numTasks};
+
+  // Run the task \p id and then the tasks that became ready when it finished.
+  // One of them continues on the same thread and the others are enqueued to
+  // the pool, where they can be stolen by idle workers.
+  std::function<void(unsigned)> runFrom = [&](unsigned id) {
+    const unsigned none = ~0u;
+    while (true) {
+      fn(id);
+      unsigned next = none;
+      for (unsigned succ : successors_[id]) {
+        if (--numWaiting[succ] != 0) {
+          continue;
+        }
+        if (next == none) {
+          next = succ;
+        } else {
+          pool.enqueue([&runFrom, succ]() { runFrom(succ); });
+        }
+      }
+      // The state of this invocation must not be touched after the last task
+      // has finished, because run() returns at that point.
+      numRemaining--;
+      if (next == none) {
+        return;
+      }
+      id = next;
+    }
+  };
+
+  for (unsigned id = 0; id < numTasks; id++) {
+    if (numPredecessors_[id] == 0) {
+      pool.enqueue([&runFrom, id]() { runFrom(id); });
+    }
+  }
+  pool.waitUntil([&]() { return numRemaining == 0; });
+}
@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/ThreadPool.h"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace glow;
+
+namespace {
+/// Bind the thread \p thread to the core \p core. This is a no-op on platforms
+/// that do not support thread affinity.
+void pinThreadToCore(std::thread &thread, unsigned core) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(core, &cpuset);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuset);
+#else
+  (void)thread;
+  (void)core;
+#endif
+}
+
+/// The pool that the current thread is a worker of, if any.
+thread_local const ThreadPool *currentPool = nullptr;
+/// The index of the current thread among the workers of currentPool.
+thread_local unsigned currentWorker = 0;
+
+/// The shared state of a single parallelFor invocation. It is reference counted
+/// because helper tasks may be dequeued after the invocation has returned.
+struct ParallelForState {
+  /// The index of the next task to claim.
+  std::atomic<size_t> next{0};
+  /// The number of tasks that have finished.
+  std::atomic<size_t> done{0};
+};
+} // namespace
+
+ThreadPool::ThreadPool(unsigned numWorkers, bool pinWorkers) {
+  // Create all of the queues before the workers start looking at them.
+  for (unsigned i = 0; i <= numWorkers; i++) {
+    queues_.emplace_back(new WorkQueue());
+  }
+  unsigned numCores = std::max(1u, std::thread::hardware_concurrency());
+  workers_.reserve(numWorkers);
+  for (unsigned i = 0; i < numWorkers; i++) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+    if (pinWorkers) {
+      pinThreadToCore(workers_.back(), i % numCores);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+unsigned ThreadPool::getLocalQueue() const {
+  return currentPool == this ? currentWorker : workers_.size();
+}
+
+bool ThreadPool::popTask(unsigned idx, bool lifo,
+                         std::function<void()> &task) {
+  auto &queue = *queues_[idx];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  if (lifo) {
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+  } else {
+    task = std::move(queue.tasks.front());
+    queue.tasks.pop_front();
+  }
+  numPending_--;
+  return true;
+}
+
+bool ThreadPool::runPendingTask() {
+  if (numPending_ == 0) {
+    return false;
+  }
+  std::function<void()> task;
+  unsigned numWorkers = workers_.size();
+  unsigned local = getLocalQueue();
+  // The local queue is used as a stack. Then look at the shared queue, and
+  // finally steal the oldest task of some other worker.
+  bool found = local != numWorkers && popTask(local, true, task);
+  found = found || popTask(numWorkers, false, task);
+  for (unsigned i = 0; i < numWorkers && !found; i++) {
+    unsigned victim = (local + 1 + i) % numWorkers;
+    found = victim != local && popTask(victim, false, task);
+  }
+  if (!found) {
+    return false;
+  }
+  task();
+  notifyWaiters();
+  return true;
+}
+
+void ThreadPool::notifyWaiters() {
+  if (numWaiters_ == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  cv_.notify_all();
+}
+
+void ThreadPool::workerLoop(unsigned id) {
+  currentPool = this;
+  currentWorker = id;
+  while (true) {
+    if (runPendingTask()) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return stop_ || numPending_ != 0; });
+    if (stop_ && numPending_ == 0) {
+      // The pool is shutting down and there is no more work.
+      return;
+    }
+  }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+  // Count the task before it becomes visible, so that the counter never
+  // drops below the number of tasks in the queues.
+  numPending_++;
+  auto &queue = *queues_[getLocalQueue()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  // Take the lock to make sure that a thread that is about to sleep either
+  // sees the new task or receives the notification.
+  { std::lock_guard<std::mutex> lock(mutex_); }
+  cv_.notify_one();
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+  // std::function requires a copyable callable, so keep the packaged task
+  // behind a shared pointer.
+  auto packaged = std::make_shared<std::packaged_task<void()>>(std::move(task));
+  auto future = packaged->get_future();
+  enqueue([packaged]() { (*packaged)(); });
+  return future;
+}
+
+void ThreadPool::waitUntil(const std::function<bool()> &done) {
+  while (!done()) {
+    if (runPendingTask()) {
+      continue;
+    }
+    numWaiters_++;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [&] { return numPending_ != 0 || done(); });
+    }
+    numWaiters_--;
+  }
+}
+
+void ThreadPool::parallelFor(size_t numTasks,
+                             const std::function<void(size_t)> &fn) {
+  if (numTasks == 0) {
+    return;
+  }
+  // Run small or serial loops directly on the calling thread.
+  if (numTasks == 1 || workers_.empty()) {
+    for (size_t i = 0; i < numTasks; i++) {
+      fn(i);
+    }
+    return;
+  }
+
+  auto state = std::make_shared<ParallelForState>();
+  // Claim and run tasks until there are none left. The reference to fn is only
+  // used while some task is unfinished, which means that the calling thread is
+  // still inside of parallelFor.
+  auto runTasks = [state, numTasks, &fn]() {
+    while (true) {
+      size_t i = state->next++;
+      if (i >= numTasks) {
+        return;
+      }
+      fn(i);
+      state->done++;
+    }
+  };
+
+  // Enqueue enough helpers to process the tasks. The calling thread
+  // participates as well, and keeps running pending tasks while it waits,
+  // which guarantees progress even when all of the workers are busy (e.g.
+  // when parallelFor is called from a worker).
+  size_t numHelpers = std::min<size_t>(workers_.size(), numTasks - 1);
+  for (size_t i = 0; i < numHelpers; i++) {
+    enqueue(runTasks);
+  }
+
+  runTasks();
+  waitUntil([&] { return state->done == numTasks; });
+}
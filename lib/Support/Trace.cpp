@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Support/Trace.h"
+#include "glow/Support/Support.h"
+
+#include "llvm/Support/Format.h"
+
+#include <atomic>
+#include <chrono>
+
+#ifdef __linux__
+#include <cstdio>
+#include <unistd.h>
+#endif
+
+using namespace glow;
+
+namespace {
+/// Write the time \p ns into \p os in microseconds, which is the unit of the
+/// trace_event format.
+void writeMicroseconds(llvm::raw_ostream &os, uint64_t ns) {
+  os << ns / 1000 << '.' << llvm::format("%03u", unsigned(ns % 1000));
+}
+} // namespace
+
+uint64_t glow::getTraceTimestamp() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+unsigned glow::getTraceThreadId() {
+  static std::atomic<unsigned> nextId{0};
+  thread_local unsigned id = nextId++;
+  return id;
+}
+
+size_t glow::getMemoryUsageKB() {
+#ifdef __linux__
+  // The second field of statm is the number of resident pages.
+  size_t size = 0;
+  size_t resident = 0;
+  FILE *statm = fopen("/proc/self/statm", "r");
+  if (!statm) {
+    return 0;
+  }
+  int n = fscanf(statm, "%zu %zu", &size, &resident);
+  fclose(statm);
+  if (n == 2) {
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+  }
+#endif
+  return 0;
+}
+
+size_t glow::getPeakMemoryUsageKB() {
+#ifdef __linux__
+  // VmHWM is the high-water mark of the resident set size.
+  FILE *status = fopen("/proc/self/status", "r");
+  if (!status) {
+    return 0;
+  }
+  char line[128];
+  size_t peak = 0;
+  while (fgets(line, sizeof(line), status)) {
+    if (sscanf(line, "VmHWM: %zu kB", &peak) == 1) {
+      break;
+    }
+  }
+  fclose(status);
+  return peak;
+#endif
+  return 0;
+}
+
+bool glow::resetPeakMemoryUsage() {
+#ifdef __linux__
+  // Writing 5 to clear_refs resets VmHWM to the current resident set size.
+  FILE *clearRefs = fopen("/proc/self/clear_refs", "w");
+  if (!clearRefs) {
+    return false;
+  }
+  bool written = fputs("5", clearRefs) >= 0;
+  return fclose(clearRefs) == 0 && written;
+#endif
+  return false;
+}
+
+void glow::writeChromeTrace(llvm::raw_ostream &os,
+                            llvm::ArrayRef<TraceEvent> events) {
+  os << "{\"traceEvents\": [\n";
+  for (size_t i = 0, e = events.size(); i < e; i++) {
+    const auto &event = events[i];
+    // Complete events ("X") have a start time and a duration.
+    os << "  {\"name\": ";
+    writeJSONString(os, event.name);
+    os << ", \"cat\": ";
+    writeJSONString(os, event.category);
+    os << ", \"ph\": \"X\", \"ts\": ";
+    writeMicroseconds(os, event.start);
+    os << ", \"dur\": ";
+    writeMicroseconds(os, event.duration);
+    os << ", \"pid\": 0, \"tid\": " << event.tid;
+    if (!event.args.empty()) {
+      os << ", \"args\": {";
+      for (size_t j = 0, n = event.args.size(); j < n; j++) {
+        os << (j ? ", " : "");
+        writeJSONString(os, event.args[j].first);
+        os << ": " << event.args[j].second;
+      }
+      os << "}";
+    }
+    os << (i + 1 < e ? "},\n" : "}\n");
+  }
+  os << "], \"displayTimeUnit\": \"ms\"}\n";
+}
@@ -46,6 +46,27 @@ double bench(Benchmark *b, size_t reps) {
   return best;
 }
 
+/// Run a benchmark until it ran for at least \p minSeconds or \p maxReps
+/// times, whichever comes first, and report the best execution time. The
+/// number of repetitions is stored into \p reps.
+double benchFor(Benchmark *b, double minSeconds, size_t maxReps,
+                size_t &reps) {
+  double best = std::numeric_limits<double>::max();
+  double elapsed = 0;
+  b->setup();
+  for (reps = 0; reps < maxReps && (reps == 0 || elapsed < minSeconds);
+       reps++) {
+    auto start = std::chrono::high_resolution_clock::now();
+    b->run();
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration<double>(end - start).count();
+    best = std::min(best, duration);
+    elapsed += duration;
+  }
+  b->teardown();
+  return best;
+}
+
 } // namespace glow
 
 #endif // GLOW_TESTS_BENCHMARK_H
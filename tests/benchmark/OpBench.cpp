@@ -0,0 +1,1118 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Bench.h"
+
+using namespace glow;
+
+extern "C" {
+// Forward declare functions from libjit.
+extern void libjit_convolution_f(float *outW, const float *inW,
+                                 const float *filterW, const float *biasW,
+                                 const size_t *outWdims, const size_t *inWdims,
+                                 const size_t *filterWdims,
+                                 const size_t *biasWdims, size_t filterSize,
+                                 size_t stride, size_t *pads, size_t group,
+                                 unsigned depthUnroll);
+extern void libjit_convDKKC8_f(float *outW, const float *inW,
+                               const float *filterW, const float *biasW,
+                               const size_t *outWdims, const size_t *inWdims,
+                               const size_t *filterWdims,
+                               const size_t *biasWdims, size_t filterSize,
+                               size_t stride, size_t *pads, size_t group,
+                               unsigned pixelScanFirst, unsigned numDepthRegs,
+                               unsigned sizeGroupY, unsigned depthStrips);
+extern void libjit_convGEMM_f(float *outW, const float *inW,
+                              const float *filterW, const float *biasW,
+                              const size_t *outWdims, const size_t *inWdims,
+                              const size_t *filterWdims,
+                              const size_t *biasWdims, size_t filterSize,
+                              size_t stride, size_t *pads, size_t group);
+extern void libjit_winogradConv_f(float *outW, const float *inW,
+                                  const float *filterW, const float *biasW,
+                                  const size_t *outWdims, const size_t *inWdims,
+                                  const size_t *filterWdims,
+                                  const size_t *biasWdims, size_t *pads,
+                                  size_t group, size_t tileSize);
+extern void libjit_depthwiseConv_f(float *outW, const float *inW,
+                                   const float *filterW, const float *biasW,
+                                   const size_t *outWdims,
+                                   const size_t *inWdims,
+                                   const size_t *filterWdims,
+                                   const size_t *biasWdims, size_t filterSize,
+                                   size_t stride, size_t *pads);
+extern void libjit_depthwiseConv_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW, const int8_t *biasW,
+    const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
+    const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
+    int32_t outOffset, int32_t inOffset, int32_t filterOffset,
+    int32_t biasOffset, int32_t biasPre, int32_t biasPost, int32_t biasScale,
+    int32_t outPre, int32_t outPost, int32_t outScale);
+extern void libjit_convolution_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW, const int8_t *biasW,
+    const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
+    const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
+    size_t group, int32_t outOffset, int32_t inOffset, int32_t filterOffset,
+    int32_t biasOffset, int32_t biasPre, int32_t biasPost, int32_t biasScale,
+    int32_t outPre, int32_t outPost, int32_t outScale, unsigned depthUnroll);
+extern void libjit_quantizedConv_i8(
+    int8_t *outW, const int8_t *inW, const int8_t *filterW, const int8_t *biasW,
+    const size_t *outWdims, const size_t *inWdims, const size_t *filterWdims,
+    const size_t *biasWdims, size_t filterSize, size_t stride, size_t *pads,
+    size_t group, int32_t outOffset, int32_t inOffset, int32_t filterOffset,
+    int32_t biasOffset, int32_t biasPre, int32_t biasPost, int32_t biasScale,
+    int32_t outPre, int32_t outPost, int32_t outScale);
+extern void libjit_matmul_f(float *c, const float *a, const float *b,
+                            const size_t *cDims, const size_t *aDims,
+                            const size_t *bDims);
+extern void libjit_matmul_i8(int8_t *outW, const int8_t *lhsW,
+                             const int8_t *rhsW, const size_t *outWdims,
+                             const size_t *lhsWdims, const size_t *rhsWdims,
+                             int32_t outOffset, int32_t lhsOffset,
+                             int32_t rhsOffset, int32_t outPre,
+                             int32_t outPost, int32_t outScale);
+extern void libjit_pool_max_f(const float *inW, float *outW,
+                              const size_t *inWdims, const size_t *outWdims,
+                              size_t filterSize, size_t stride, size_t *pads);
+extern void libjit_pool_avg_f(const float *inW, float *outW,
+                              const size_t *inWdims, const size_t *outWdims,
+                              size_t filterSize, size_t stride, size_t *pads);
+extern void libjit_softmax_f(const float *inW, float *outW, const size_t *idim,
+                             const size_t *odim);
+extern void libjit_transpose_f(const float *inW, float *outW,
+                               const size_t *idim, const size_t *odim,
+                               const size_t *shuffle, size_t numDims);
+extern void libjit_batchedadd_f(float *dest, const float *batch,
+                                const float *slice, size_t numSlice,
+                                size_t sliceSize);
+extern void libjit_batchedreduceadd_f(float *dest, const float *batch,
+                                      size_t destSize, const size_t *destDims,
+                                      const size_t *batchDims, size_t axis);
+extern void libjit_gather_f(float *dest, const float *data,
+                            const size_t *indices, size_t numIndices,
+                            size_t sliceSize, size_t numSamples,
+                            size_t sampleSize);
+extern void libjit_topk_f(float *values, size_t *indices, const float *input,
+                          size_t *scratch, size_t k, size_t n, size_t size);
+}
+
+namespace {
+
+/// Fill \p v with random values in the range [-1, 1].
+void randomize(std::vector<float> &v) {
+  std::mt19937 gen;
+  std::uniform_real_distribution<> dis(-1.0, 1.0);
+  for (auto &e : v) {
+    e = dis(gen);
+  }
+}
+
+/// Fill \p v with small random values, which keep the int32 accumulators of
+/// the quantized kernels from overflowing.
+void randomize(std::vector<int8_t> &v) {
+  std::mt19937 gen;
+  std::uniform_int_distribution<> dis(-8, 8);
+  for (auto &e : v) {
+    e = dis(gen);
+  }
+}
+
+/// Free the memory of \p v, so that only the benchmark that runs holds on to
+/// its buffers.
+template <typename T> void release(std::vector<T> &v) {
+  v.clear();
+  v.shrink_to_fit();
+}
+
+/// \returns the product of the dimensions \p dims.
+size_t product(const std::vector<size_t> &dims) {
+  size_t size = 1;
+  for (auto d : dims) {
+    size *= d;
+  }
+  return size;
+}
+
+/// A benchmark of a single libjit kernel, which knows how much work a single
+/// run of the kernel performs.
+class OpBenchmark : public Benchmark {
+  /// The name of the benchmark, which identifies it in the baseline.
+  std::string name_;
+
+public:
+  explicit OpBenchmark(const std::string &name) : name_(name) {}
+
+  const std::string &getName() const { return name_; }
+
+  /// \returns the number of arithmetic operations of a run.
+  virtual double flops() const = 0;
+
+  /// \returns the number of bytes that a run reads and writes, counting every
+  /// tensor once.
+  virtual double bytes() const = 0;
+};
+
+/// The shape of a 2D convolution in the NHWC layout.
+struct ConvShape {
+  size_t n, h, w, c, d, kernel, stride, pad, group;
+
+  size_t outH() const { return (h + 2 * pad - kernel) / stride + 1; }
+  size_t outW() const { return (w + 2 * pad - kernel) / stride + 1; }
+
+  double flops() const {
+    return 2.0 * n * outH() * outW() * d * kernel * kernel * (c / group);
+  }
+
+  /// \returns the number of elements of the input, the filter, the bias and
+  /// the output.
+  double elements() const {
+    return double(n) * h * w * c + double(d) * kernel * kernel * (c / group) +
+           d + double(n) * outH() * outW() * d;
+  }
+};
+
+/// Benchmark the direct convolution, or the convolution with the filter in
+/// the [D/8, K, K, C, 8] layout if \p dkkc8 is set.
+class ConvBench : public OpBenchmark {
+  ConvShape s_;
+  bool dkkc8_;
+  std::vector<float> in_, filter_, bias_, out_;
+  std::vector<size_t> inDims_, filterDims_, biasDims_, outDims_;
+  size_t pads_[4];
+
+public:
+  ConvBench(const std::string &name, const ConvShape &s, bool dkkc8)
+      : OpBenchmark(name), s_(s), dkkc8_(dkkc8),
+        pads_{s.pad, s.pad, s.pad, s.pad} {}
+
+  virtual void setup() override {
+    inDims_ = {s_.n, s_.h, s_.w, s_.c};
+    outDims_ = {s_.n, s_.outH(), s_.outW(), s_.d};
+    biasDims_ = {s_.d};
+    if (dkkc8_) {
+      filterDims_ = {s_.d / 8, s_.kernel, s_.kernel, s_.c / s_.group, 8};
+    } else {
+      filterDims_ = {s_.d, s_.kernel, s_.kernel, s_.c / s_.group};
+    }
+    in_.resize(product(inDims_));
+    filter_.resize(product(filterDims_));
+    bias_.resize(product(biasDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+    randomize(filter_);
+    randomize(bias_);
+  }
+
+  virtual void run() override {
+    if (!dkkc8_) {
+      unsigned depthUnroll = (s_.d / s_.group) % 8 == 0 ? 8 : 1;
+      libjit_convolution_f(out_.data(), in_.data(), filter_.data(),
+                           bias_.data(), outDims_.data(), inDims_.data(),
+                           filterDims_.data(), biasDims_.data(), s_.kernel,
+                           s_.stride, pads_, s_.group, depthUnroll);
+      return;
+    }
+    // Pick the parameters of the kernel like LLVMIRGen does.
+    bool pixelScanFirst = s_.c < 16;
+    unsigned numDepthRegs = pixelScanFirst ? 8 : 2;
+    unsigned sizeGroupY = pixelScanFirst ? 1 : 5;
+    unsigned depthStrips = 1;
+    unsigned stripSize = 8 * numDepthRegs * s_.c;
+    while (2 * depthStrips * stripSize <= 16384 &&
+           2 * depthStrips * numDepthRegs * 8 <= s_.d / s_.group &&
+           depthStrips < 8) {
+      depthStrips *= 2;
+    }
+    libjit_convDKKC8_f(out_.data(), in_.data(), filter_.data(), bias_.data(),
+                       outDims_.data(), inDims_.data(), filterDims_.data(),
+                       biasDims_.data(), s_.kernel, s_.stride, pads_, s_.group,
+                       pixelScanFirst, numDepthRegs, sizeGroupY, depthStrips);
+  }
+
+  virtual double flops() const override { return s_.flops(); }
+  virtual double bytes() const override {
+    return s_.elements() * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(filter_);
+    release(bias_);
+    release(out_);
+  }
+};
+
+/// Benchmark the convolution that multiplies the im2col patches with the
+/// filter in the [G, K, K, C, D] layout.
+class ConvGEMMBench : public OpBenchmark {
+  ConvShape s_;
+  std::vector<float> in_, filter_, bias_, out_;
+  std::vector<size_t> inDims_, filterDims_, biasDims_, outDims_;
+  size_t pads_[4];
+
+public:
+  ConvGEMMBench(const std::string &name, const ConvShape &s)
+      : OpBenchmark(name), s_(s), pads_{s.pad, s.pad, s.pad, s.pad} {}
+
+  virtual void setup() override {
+    inDims_ = {s_.n, s_.h, s_.w, s_.c};
+    outDims_ = {s_.n, s_.outH(), s_.outW(), s_.d};
+    biasDims_ = {s_.d};
+    filterDims_ = {s_.group, s_.kernel, s_.kernel, s_.c / s_.group,
+                   s_.d / s_.group};
+    in_.resize(product(inDims_));
+    filter_.resize(product(filterDims_));
+    bias_.resize(product(biasDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+    randomize(filter_);
+    randomize(bias_);
+  }
+
+  virtual void run() override {
+    libjit_convGEMM_f(out_.data(), in_.data(), filter_.data(), bias_.data(),
+                      outDims_.data(), inDims_.data(), filterDims_.data(),
+                      biasDims_.data(), s_.kernel, s_.stride, pads_, s_.group);
+  }
+
+  virtual double flops() const override { return s_.flops(); }
+  virtual double bytes() const override {
+    return s_.elements() * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(filter_);
+    release(bias_);
+    release(out_);
+  }
+};
+
+/// Benchmark the Winograd convolution F(\p tileSize x \p tileSize, 3 x 3) of
+/// a 3 x 3 convolution with stride 1. The GFLOP/s are those of the direct
+/// convolution, so that they are comparable with the other kernels.
+class WinogradBench : public OpBenchmark {
+  ConvShape s_;
+  size_t tileSize_;
+  std::vector<float> in_, filter_, bias_, out_;
+  std::vector<size_t> inDims_, filterDims_, biasDims_, outDims_;
+  size_t pads_[4];
+
+public:
+  WinogradBench(const std::string &name, const ConvShape &s, size_t tileSize)
+      : OpBenchmark(name), s_(s), tileSize_(tileSize),
+        pads_{s.pad, s.pad, s.pad, s.pad} {}
+
+  virtual void setup() override {
+    size_t alpha = tileSize_ + 2;
+    size_t strips = (s_.d / s_.group + 15) / 16;
+    inDims_ = {s_.n, s_.h, s_.w, s_.c};
+    outDims_ = {s_.n, s_.outH(), s_.outW(), s_.d};
+    biasDims_ = {s_.d};
+    filterDims_ = {s_.group, alpha * alpha, strips, s_.c / s_.group, 16};
+    in_.resize(product(inDims_));
+    filter_.resize(product(filterDims_));
+    bias_.resize(product(biasDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+    randomize(filter_);
+    randomize(bias_);
+  }
+
+  virtual void run() override {
+    libjit_winogradConv_f(out_.data(), in_.data(), filter_.data(),
+                          bias_.data(), outDims_.data(), inDims_.data(),
+                          filterDims_.data(), biasDims_.data(), pads_,
+                          s_.group, tileSize_);
+  }
+
+  virtual double flops() const override { return s_.flops(); }
+  virtual double bytes() const override {
+    return s_.elements() * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(filter_);
+    release(bias_);
+    release(out_);
+  }
+};
+
+/// Benchmark the depthwise convolution with the filter in the [K, K, D]
+/// layout, in float or in int8 if \p quantized is set.
+class DepthwiseBench : public OpBenchmark {
+  ConvShape s_;
+  bool quantized_;
+  std::vector<float> in_, filter_, bias_, out_;
+  std::vector<int8_t> inI8_, filterI8_, biasI8_, outI8_;
+  std::vector<size_t> inDims_, filterDims_, biasDims_, outDims_;
+  size_t pads_[4];
+
+public:
+  DepthwiseBench(const std::string &name, const ConvShape &s, bool quantized)
+      : OpBenchmark(name), s_(s), quantized_(quantized),
+        pads_{s.pad, s.pad, s.pad, s.pad} {}
+
+  virtual void setup() override {
+    inDims_ = {s_.n, s_.h, s_.w, s_.c};
+    outDims_ = {s_.n, s_.outH(), s_.outW(), s_.d};
+    biasDims_ = {s_.d};
+    filterDims_ = {s_.kernel, s_.kernel, s_.d};
+    if (quantized_) {
+      inI8_.resize(product(inDims_));
+      filterI8_.resize(product(filterDims_));
+      biasI8_.resize(product(biasDims_));
+      outI8_.resize(product(outDims_));
+      randomize(inI8_);
+      randomize(filterI8_);
+      randomize(biasI8_);
+      return;
+    }
+    in_.resize(product(inDims_));
+    filter_.resize(product(filterDims_));
+    bias_.resize(product(biasDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+    randomize(filter_);
+    randomize(bias_);
+  }
+
+  virtual void run() override {
+    if (quantized_) {
+      // Scale the accumulators down by 2^8 and keep the bias as is.
+      libjit_depthwiseConv_i8(outI8_.data(), inI8_.data(), filterI8_.data(),
+                              biasI8_.data(), outDims_.data(), inDims_.data(),
+                              filterDims_.data(), biasDims_.data(), s_.kernel,
+                              s_.stride, pads_, 0, 0, 0, 0, 0, 0, 1, 0, 8, 1);
+      return;
+    }
+    libjit_depthwiseConv_f(out_.data(), in_.data(), filter_.data(),
+                           bias_.data(), outDims_.data(), inDims_.data(),
+                           filterDims_.data(), biasDims_.data(), s_.kernel,
+                           s_.stride, pads_);
+  }
+
+  virtual double flops() const override { return s_.flops(); }
+  virtual double bytes() const override {
+    return s_.elements() * (quantized_ ? 1 : sizeof(float));
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(filter_);
+    release(bias_);
+    release(out_);
+    release(inI8_);
+    release(filterI8_);
+    release(biasI8_);
+    release(outI8_);
+  }
+};
+
+/// Benchmark the quantized convolution, or the convolution with the filter in
+/// the packed [D/16, K, K, C/2, 16, 2] layout if \p packed is set.
+class ConvI8Bench : public OpBenchmark {
+  ConvShape s_;
+  bool packed_;
+  std::vector<int8_t> in_, filter_, bias_, out_;
+  std::vector<size_t> inDims_, filterDims_, biasDims_, outDims_;
+  size_t pads_[4];
+
+public:
+  ConvI8Bench(const std::string &name, const ConvShape &s, bool packed)
+      : OpBenchmark(name), s_(s), packed_(packed),
+        pads_{s.pad, s.pad, s.pad, s.pad} {}
+
+  virtual void setup() override {
+    inDims_ = {s_.n, s_.h, s_.w, s_.c};
+    outDims_ = {s_.n, s_.outH(), s_.outW(), s_.d};
+    biasDims_ = {s_.d};
+    if (packed_) {
+      size_t strips = (s_.d / s_.group + 15) / 16;
+      filterDims_ = {s_.group * strips, s_.kernel, s_.kernel,
+                     (s_.c / s_.group + 1) / 2, 16, 2};
+    } else {
+      filterDims_ = {s_.d, s_.kernel, s_.kernel, s_.c / s_.group};
+    }
+    in_.resize(product(inDims_));
+    filter_.resize(product(filterDims_));
+    bias_.resize(product(biasDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+    randomize(filter_);
+    randomize(bias_);
+  }
+
+  virtual void run() override {
+    // Scale the accumulators down by 2^8 and keep the bias as is.
+    if (packed_) {
+      libjit_quantizedConv_i8(out_.data(), in_.data(), filter_.data(),
+                              bias_.data(), outDims_.data(), inDims_.data(),
+                              filterDims_.data(), biasDims_.data(), s_.kernel,
+                              s_.stride, pads_, s_.group, 0, 0, 0, 0, 0, 0, 1,
+                              0, 8, 1);
+      return;
+    }
+    unsigned depthUnroll = (s_.d / s_.group) % 8 == 0 ? 8 : 1;
+    libjit_convolution_i8(out_.data(), in_.data(), filter_.data(),
+                          bias_.data(), outDims_.data(), inDims_.data(),
+                          filterDims_.data(), biasDims_.data(), s_.kernel,
+                          s_.stride, pads_, s_.group, 0, 0, 0, 0, 0, 0, 1, 0,
+                          8, 1, depthUnroll);
+  }
+
+  virtual double flops() const override { return s_.flops(); }
+  virtual double bytes() const override { return s_.elements(); }
+
+  virtual void teardown() override {
+    release(in_);
+    release(filter_);
+    release(bias_);
+    release(out_);
+  }
+};
+
+/// Benchmark an (m x k) * (k x n) = (m x n) matrix multiplication.
+class MatMulBench : public OpBenchmark {
+  size_t m_, n_, k_;
+  std::vector<float> a_, b_, c_;
+
+public:
+  MatMulBench(const std::string &name, size_t m, size_t n, size_t k)
+      : OpBenchmark(name), m_(m), n_(n), k_(k) {}
+
+  virtual void setup() override {
+    a_.resize(m_ * k_);
+    b_.resize(k_ * n_);
+    c_.resize(m_ * n_);
+    randomize(a_);
+    randomize(b_);
+  }
+
+  virtual void run() override {
+    size_t aDims[] = {m_, k_};
+    size_t bDims[] = {k_, n_};
+    size_t cDims[] = {m_, n_};
+    libjit_matmul_f(c_.data(), a_.data(), b_.data(), cDims, aDims, bDims);
+  }
+
+  virtual double flops() const override { return 2.0 * m_ * n_ * k_; }
+  virtual double bytes() const override {
+    return (double(m_) * k_ + double(k_) * n_ + double(m_) * n_) *
+           sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(a_);
+    release(b_);
+    release(c_);
+  }
+};
+
+/// Benchmark a quantized (m x k) * (k x n) = (m x n) matrix multiplication.
+class MatMulI8Bench : public OpBenchmark {
+  size_t m_, n_, k_;
+  std::vector<int8_t> a_, b_, c_;
+
+public:
+  MatMulI8Bench(const std::string &name, size_t m, size_t n, size_t k)
+      : OpBenchmark(name), m_(m), n_(n), k_(k) {}
+
+  virtual void setup() override {
+    a_.resize(m_ * k_);
+    b_.resize(k_ * n_);
+    c_.resize(m_ * n_);
+    randomize(a_);
+    randomize(b_);
+  }
+
+  virtual void run() override {
+    size_t aDims[] = {m_, k_};
+    size_t bDims[] = {k_, n_};
+    size_t cDims[] = {m_, n_};
+    libjit_matmul_i8(c_.data(), a_.data(), b_.data(), cDims, aDims, bDims, 0,
+                     0, 0, 0, 8, 1);
+  }
+
+  virtual double flops() const override { return 2.0 * m_ * n_ * k_; }
+  virtual double bytes() const override {
+    return double(m_) * k_ + double(k_) * n_ + double(m_) * n_;
+  }
+
+  virtual void teardown() override {
+    release(a_);
+    release(b_);
+    release(c_);
+  }
+};
+
+/// Benchmark the max or average pooling of an NHWC tensor.
+class PoolBench : public OpBenchmark {
+  ConvShape s_;
+  bool isMax_;
+  std::vector<float> in_, out_;
+  std::vector<size_t> inDims_, outDims_;
+  size_t pads_[4];
+
+public:
+  /// The depth and the group of the shape \p s are ignored.
+  PoolBench(const std::string &name, const ConvShape &s, bool isMax)
+      : OpBenchmark(name), s_(s), isMax_(isMax),
+        pads_{s.pad, s.pad, s.pad, s.pad} {}
+
+  virtual void setup() override {
+    inDims_ = {s_.n, s_.h, s_.w, s_.c};
+    outDims_ = {s_.n, s_.outH(), s_.outW(), s_.c};
+    in_.resize(product(inDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+  }
+
+  virtual void run() override {
+    auto *fn = isMax_ ? &libjit_pool_max_f : &libjit_pool_avg_f;
+    fn(in_.data(), out_.data(), inDims_.data(), outDims_.data(), s_.kernel,
+       s_.stride, pads_);
+  }
+
+  virtual double flops() const override {
+    return double(out_.size()) * s_.kernel * s_.kernel;
+  }
+  virtual double bytes() const override {
+    return double(in_.size() + out_.size()) * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(out_);
+  }
+};
+
+/// Benchmark the softmax of a batch of \p n vectors of \p size elements.
+class SoftMaxBench : public OpBenchmark {
+  size_t n_, size_;
+  std::vector<float> in_, out_;
+
+public:
+  SoftMaxBench(const std::string &name, size_t n, size_t size)
+      : OpBenchmark(name), n_(n), size_(size) {}
+
+  virtual void setup() override {
+    in_.resize(n_ * size_);
+    out_.resize(n_ * size_);
+    randomize(in_);
+  }
+
+  virtual void run() override {
+    size_t dims[] = {n_, size_};
+    libjit_softmax_f(in_.data(), out_.data(), dims, dims);
+  }
+
+  /// The max, the exponent, the sum and the division of every element.
+  virtual double flops() const override { return 4.0 * n_ * size_; }
+  virtual double bytes() const override {
+    return 2.0 * n_ * size_ * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(out_);
+  }
+};
+
+/// Benchmark the transpose of a 4D tensor.
+class TransposeBench : public OpBenchmark {
+  std::vector<size_t> inDims_, outDims_, shuffle_;
+  std::vector<float> in_, out_;
+
+public:
+  TransposeBench(const std::string &name, const std::vector<size_t> &inDims,
+                 const std::vector<size_t> &shuffle)
+      : OpBenchmark(name), inDims_(inDims), shuffle_(shuffle) {
+    for (auto s : shuffle_) {
+      outDims_.push_back(inDims_[s]);
+    }
+  }
+
+  virtual void setup() override {
+    in_.resize(product(inDims_));
+    out_.resize(product(outDims_));
+    randomize(in_);
+  }
+
+  virtual void run() override {
+    libjit_transpose_f(in_.data(), out_.data(), inDims_.data(),
+                       outDims_.data(), shuffle_.data(), shuffle_.size());
+  }
+
+  virtual double flops() const override { return 0; }
+  virtual double bytes() const override {
+    return 2.0 * in_.size() * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(out_);
+  }
+};
+
+/// Benchmark the addition of a slice of \p sliceSize elements to every one of
+/// the \p numSlice slices of a batch.
+class BatchedAddBench : public OpBenchmark {
+  size_t numSlice_, sliceSize_;
+  std::vector<float> batch_, slice_, dest_;
+
+public:
+  BatchedAddBench(const std::string &name, size_t numSlice, size_t sliceSize)
+      : OpBenchmark(name), numSlice_(numSlice), sliceSize_(sliceSize) {}
+
+  virtual void setup() override {
+    batch_.resize(numSlice_ * sliceSize_);
+    slice_.resize(sliceSize_);
+    dest_.resize(numSlice_ * sliceSize_);
+    randomize(batch_);
+    randomize(slice_);
+  }
+
+  virtual void run() override {
+    libjit_batchedadd_f(dest_.data(), batch_.data(), slice_.data(), numSlice_,
+                        sliceSize_);
+  }
+
+  virtual double flops() const override { return double(dest_.size()); }
+  virtual double bytes() const override {
+    return double(batch_.size() + slice_.size() + dest_.size()) *
+           sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(batch_);
+    release(slice_);
+    release(dest_);
+  }
+};
+
+/// Benchmark the reduction of the \p numSlice slices of \p sliceSize elements
+/// of a batch into a single slice.
+class BatchedReduceAddBench : public OpBenchmark {
+  size_t numSlice_, sliceSize_;
+  std::vector<float> batch_, dest_;
+
+public:
+  BatchedReduceAddBench(const std::string &name, size_t numSlice,
+                        size_t sliceSize)
+      : OpBenchmark(name), numSlice_(numSlice), sliceSize_(sliceSize) {}
+
+  virtual void setup() override {
+    batch_.resize(numSlice_ * sliceSize_);
+    dest_.resize(sliceSize_);
+    randomize(batch_);
+  }
+
+  virtual void run() override {
+    // The kernel expects the dimensions to be expanded to 6 dimensions.
+    size_t batchDims[] = {numSlice_, sliceSize_, 1, 1, 1, 1};
+    size_t destDims[] = {1, sliceSize_, 1, 1, 1, 1};
+    libjit_batchedreduceadd_f(dest_.data(), batch_.data(), dest_.size(),
+                              destDims, batchDims, 0);
+  }
+
+  virtual double flops() const override { return double(batch_.size()); }
+  virtual double bytes() const override {
+    return double(batch_.size() + dest_.size()) * sizeof(float);
+  }
+
+  virtual void teardown() override {
+    release(batch_);
+    release(dest_);
+  }
+};
+
+/// Benchmark the lookup of \p numIndices random rows of \p sliceSize elements
+/// in a table of \p numRows rows, e.g. an embedding table.
+class GatherBench : public OpBenchmark {
+  size_t numRows_, sliceSize_, numIndices_;
+  std::vector<float> data_, dest_;
+  std::vector<size_t> indices_;
+
+public:
+  GatherBench(const std::string &name, size_t numRows, size_t sliceSize,
+              size_t numIndices)
+      : OpBenchmark(name), numRows_(numRows), sliceSize_(sliceSize),
+        numIndices_(numIndices) {}
+
+  virtual void setup() override {
+    data_.resize(numRows_ * sliceSize_);
+    dest_.resize(numIndices_ * sliceSize_);
+    indices_.resize(numIndices_);
+    randomize(data_);
+    std::mt19937 gen;
+    std::uniform_int_distribution<size_t> dis(0, numRows_ - 1);
+    for (auto &idx : indices_) {
+      idx = dis(gen);
+    }
+  }
+
+  virtual void run() override {
+    libjit_gather_f(dest_.data(), data_.data(), indices_.data(), numIndices_,
+                    sliceSize_, 1, data_.size());
+  }
+
+  virtual double flops() const override { return 0; }
+  /// Only the rows that are looked up are read.
+  virtual double bytes() const override {
+    return 2.0 * dest_.size() * sizeof(float) +
+           double(indices_.size()) * sizeof(size_t);
+  }
+
+  virtual void teardown() override {
+    release(data_);
+    release(dest_);
+    release(indices_);
+  }
+};
+
+/// Benchmark the selection of the \p k largest elements of each of the \p n
+/// vectors of \p size elements.
+class TopKBench : public OpBenchmark {
+  size_t n_, size_, k_;
+  std::vector<float> in_, values_;
+  std::vector<size_t> indices_, scratch_;
+
+public:
+  TopKBench(const std::string &name, size_t n, size_t size, size_t k)
+      : OpBenchmark(name), n_(n), size_(size), k_(k) {}
+
+  virtual void setup() override {
+    in_.resize(n_ * size_);
+    values_.resize(n_ * k_);
+    indices_.resize(n_ * k_);
+    // The kernel sorts pairs of indices and values in the scratch buffer.
+    scratch_.resize(2 * size_);
+    randomize(in_);
+  }
+
+  virtual void run() override {
+    libjit_topk_f(values_.data(), indices_.data(), in_.data(), scratch_.data(),
+                  k_, size_, in_.size());
+  }
+
+  virtual double flops() const override { return 0; }
+  virtual double bytes() const override {
+    return double(in_.size() + values_.size()) * sizeof(float) +
+           double(indices_.size()) * sizeof(size_t);
+  }
+
+  virtual void teardown() override {
+    release(in_);
+    release(values_);
+    release(indices_);
+    release(scratch_);
+  }
+};
+
+/// \returns the benchmarks of the suite. The shapes are taken from ResNet-50,
+/// ResNeXt, VGG-16, MobileNet, recurrent language models and recommendation
+/// models.
+std::vector<std::unique_ptr<OpBenchmark>> createBenchmarks() {
+  std::vector<std::unique_ptr<OpBenchmark>> benchmarks;
+  auto add = [&](OpBenchmark *b) { benchmarks.emplace_back(b); };
+
+  // {n, h, w, c, d, kernel, stride, pad, group}
+  ConvShape resnetConv1{1, 224, 224, 3, 64, 7, 2, 3, 1};
+  ConvShape resnet3x3{1, 56, 56, 64, 64, 3, 1, 1, 1};
+  ConvShape resnet1x1{1, 56, 56, 256, 64, 1, 1, 0, 1};
+  ConvShape resnet1x1Strided{1, 56, 56, 256, 512, 1, 2, 0, 1};
+  ConvShape resnet3x3Deep{1, 14, 14, 256, 256, 3, 1, 1, 1};
+  ConvShape resnet3x3Last{1, 7, 7, 512, 512, 3, 1, 1, 1};
+  ConvShape resnextGrouped{1, 56, 56, 128, 128, 3, 1, 1, 32};
+  ConvShape vgg3x3{1, 56, 56, 256, 256, 3, 1, 1, 1};
+  ConvShape vgg3x3Batch{8, 28, 28, 128, 128, 3, 1, 1, 1};
+  ConvShape mobilenetDw{1, 112, 112, 32, 32, 3, 1, 1, 32};
+  ConvShape mobilenetDwStrided{1, 112, 112, 64, 64, 3, 2, 1, 64};
+  ConvShape mobilenetDwDeep{1, 14, 14, 512, 512, 3, 1, 1, 512};
+
+  add(new ConvBench("conv_resnet50_conv1_7x7_s2", resnetConv1, false));
+  add(new ConvBench("conv_resnet50_3x3_56x56x64", resnet3x3, false));
+  add(new ConvBench("conv_resnet50_3x3_14x14x256", resnet3x3Deep, false));
+  add(new ConvBench("conv_resnet50_1x1_56x56x256", resnet1x1, false));
+  add(new ConvBench("conv_resnet50_1x1_s2_56x56x256", resnet1x1Strided,
+                    false));
+  add(new ConvBench("conv_resnext_3x3_g32_56x56x128", resnextGrouped, false));
+  add(new ConvBench("conv_vgg16_3x3_56x56x256", vgg3x3, false));
+  add(new ConvBench("conv_vgg16_3x3_n8_28x28x128", vgg3x3Batch, false));
+
+  add(new ConvBench("convDKKC8_resnet50_conv1_7x7_s2", resnetConv1, true));
+  add(new ConvBench("convDKKC8_resnet50_3x3_56x56x64", resnet3x3, true));
+  add(new ConvBench("convDKKC8_resnet50_3x3_14x14x256", resnet3x3Deep, true));
+  add(new ConvBench("convDKKC8_resnet50_1x1_56x56x256", resnet1x1, true));
+  add(new ConvBench("convDKKC8_vgg16_3x3_56x56x256", vgg3x3, true));
+
+  add(new ConvGEMMBench("convGEMM_resnet50_conv1_7x7_s2", resnetConv1));
+  add(new ConvGEMMBench("convGEMM_resnet50_3x3_56x56x64", resnet3x3));
+  add(new ConvGEMMBench("convGEMM_resnet50_3x3_14x14x256", resnet3x3Deep));
+  add(new ConvGEMMBench("convGEMM_resnet50_1x1_56x56x256", resnet1x1));
+  add(new ConvGEMMBench("convGEMM_resnet50_1x1_s2_56x56x256",
+                        resnet1x1Strided));
+  add(new ConvGEMMBench("convGEMM_resnext_3x3_g32_56x56x128", resnextGrouped));
+  add(new ConvGEMMBench("convGEMM_vgg16_3x3_56x56x256", vgg3x3));
+
+  add(new ConvBench("conv_mobilenet_dw_112x112x32", mobilenetDw, false));
+  add(new ConvBench("conv_mobilenet_dw_s2_112x112x64", mobilenetDwStrided,
+                    false));
+  add(new ConvBench("conv_mobilenet_dw_14x14x512", mobilenetDwDeep, false));
+  add(new ConvGEMMBench("convGEMM_mobilenet_dw_112x112x32", mobilenetDw));
+  add(new ConvGEMMBench("convGEMM_mobilenet_dw_14x14x512", mobilenetDwDeep));
+  add(new DepthwiseBench("depthwise_mobilenet_112x112x32", mobilenetDw,
+                         false));
+  add(new DepthwiseBench("depthwise_mobilenet_s2_112x112x64",
+                         mobilenetDwStrided, false));
+  add(new DepthwiseBench("depthwise_mobilenet_14x14x512", mobilenetDwDeep,
+                         false));
+
+  add(new WinogradBench("winograd2_resnet50_3x3_56x56x64", resnet3x3, 2));
+  add(new WinogradBench("winograd4_resnet50_3x3_56x56x64", resnet3x3, 4));
+  add(new WinogradBench("winograd4_resnet50_3x3_14x14x256", resnet3x3Deep,
+                        4));
+  add(new WinogradBench("winograd4_resnet50_3x3_7x7x512", resnet3x3Last, 4));
+  add(new WinogradBench("winograd2_vgg16_3x3_56x56x256", vgg3x3, 2));
+  add(new WinogradBench("winograd4_vgg16_3x3_56x56x256", vgg3x3, 4));
+  add(new WinogradBench("winograd4_vgg16_3x3_n8_28x28x128", vgg3x3Batch, 4));
+
+  add(new ConvI8Bench("conv_i8_resnet50_3x3_56x56x64", resnet3x3, false));
+  add(new ConvI8Bench("conv_i8_resnet50_1x1_56x56x256", resnet1x1, false));
+  add(new ConvI8Bench("conv_i8_resnext_3x3_g32_56x56x128", resnextGrouped,
+                      false));
+  add(new ConvI8Bench("quantizedConv_i8_resnet50_conv1_7x7_s2", resnetConv1,
+                      true));
+  add(new ConvI8Bench("quantizedConv_i8_resnet50_3x3_56x56x64", resnet3x3,
+                      true));
+  add(new ConvI8Bench("quantizedConv_i8_resnet50_3x3_14x14x256",
+                      resnet3x3Deep, true));
+  add(new ConvI8Bench("quantizedConv_i8_resnet50_1x1_56x56x256", resnet1x1,
+                      true));
+  add(new ConvI8Bench("quantizedConv_i8_vgg16_3x3_56x56x256", vgg3x3, true));
+  add(new ConvI8Bench("quantizedConv_i8_resnext_3x3_g32_56x56x128",
+                      resnextGrouped, true));
+
+  add(new ConvI8Bench("conv_i8_mobilenet_dw_112x112x32", mobilenetDw, false));
+  add(new ConvI8Bench("quantizedConv_i8_mobilenet_dw_112x112x32", mobilenetDw,
+                      true));
+  add(new DepthwiseBench("depthwise_i8_mobilenet_112x112x32", mobilenetDw,
+                         true));
+  add(new DepthwiseBench("depthwise_i8_mobilenet_s2_112x112x64",
+                         mobilenetDwStrided, true));
+  add(new DepthwiseBench("depthwise_i8_mobilenet_14x14x512", mobilenetDwDeep,
+                         true));
+
+  add(new MatMulBench("matmul_resnet50_fc_1x2048x1000", 1, 1000, 2048));
+  add(new MatMulBench("matmul_resnet50_fc_n32_2048x1000", 32, 1000, 2048));
+  add(new MatMulBench("matmul_vgg16_fc_n8_4096x4096", 8, 4096, 4096));
+  add(new MatMulBench("matmul_lstm_n64_1024x4096", 64, 4096, 1024));
+  add(new MatMulBench("matmul_square_512", 512, 512, 512));
+  add(new MatMulI8Bench("matmul_i8_resnet50_fc_1x2048x1000", 1, 1000, 2048));
+  add(new MatMulI8Bench("matmul_i8_resnet50_fc_n32_2048x1000", 32, 1000,
+                        2048));
+  add(new MatMulI8Bench("matmul_i8_lstm_n64_1024x4096", 64, 4096, 1024));
+
+  add(new PoolBench("pool_max_resnet50_3x3_s2_112x112x64",
+                    {1, 112, 112, 64, 0, 3, 2, 1, 1}, true));
+  add(new PoolBench("pool_max_vgg16_2x2_s2_112x112x128",
+                    {1, 112, 112, 128, 0, 2, 2, 0, 1}, true));
+  add(new PoolBench("pool_avg_resnet50_7x7_7x7x2048",
+                    {1, 7, 7, 2048, 0, 7, 1, 0, 1}, false));
+  add(new PoolBench("pool_avg_3x3_s1_28x28x256",
+                    {1, 28, 28, 256, 0, 3, 1, 1, 1}, false));
+
+  add(new SoftMaxBench("softmax_imagenet_n32x1000", 32, 1000));
+  add(new SoftMaxBench("softmax_lm_n64x32000", 64, 32000));
+
+  add(new TransposeBench("transpose_nchw_to_nhwc_256x56x56",
+                         {1, 256, 56, 56}, {0, 2, 3, 1}));
+  add(new TransposeBench("transpose_nhwc_to_nchw_56x56x256",
+                         {1, 56, 56, 256}, {0, 3, 1, 2}));
+
+  add(new BatchedAddBench("batchedadd_lstm_bias_n64x4096", 64, 4096));
+  add(new BatchedAddBench("batchedadd_conv_bias_3136x256", 56 * 56, 256));
+  add(new BatchedReduceAddBench("batchedreduceadd_n64x4096", 64, 4096));
+  add(new BatchedReduceAddBench("batchedreduceadd_n1024x512", 1024, 512));
+
+  add(new GatherBench("gather_embedding_1Mx64_4096", 1 << 20, 64, 4096));
+  add(new GatherBench("gather_embedding_100kx256_1024", 100000, 256, 1024));
+
+  add(new TopKBench("topk_imagenet_n32x1000_k5", 32, 1000, 5));
+  add(new TopKBench("topk_lm_n64x32000_k1", 64, 32000, 1));
+  add(new TopKBench("topk_lm_n8x32000_k10", 8, 32000, 10));
+  return benchmarks;
+}
+
+/// \returns the best times of the benchmarks, by name, that are recorded in
+/// the JSON file \p filename, which was written by this tool.
+std::map<std::string, double> loadBaseline(const std::string &filename) {
+  std::map<std::string, double> baseline;
+  std::ifstream in(filename);
+  if (!in) {
+    fprintf(stderr, "Can't open the baseline file %s\n", filename.c_str());
+    exit(1);
+  }
+  // Every benchmark is written on a line of its own.
+  std::string line;
+  const std::string nameKey = "\"name\": \"";
+  const std::string secondsKey = "\"seconds\": ";
+  while (std::getline(in, line)) {
+    auto namePos = line.find(nameKey);
+    auto secondsPos = line.find(secondsKey);
+    if (namePos == std::string::npos || secondsPos == std::string::npos) {
+      continue;
+    }
+    namePos += nameKey.size();
+    auto name = line.substr(namePos, line.find('"', namePos) - namePos);
+    baseline[name] = atof(line.c_str() + secondsPos + secondsKey.size());
+  }
+  return baseline;
+}
+
+void printUsage(const char *argv0) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  -filter=<substr>   Only run the benchmarks whose name contains "
+          "<substr>\n"
+          "  -min-time=<sec>    Repeat every benchmark for at least <sec> "
+          "seconds (default 0.5)\n"
+          "  -reps=<n>          Repeat every benchmark at most <n> times "
+          "(default 100)\n"
+          "  -json=<file>       Write the results into <file>\n"
+          "  -baseline=<file>   Compare the results with <file>, which was "
+          "written by -json\n"
+          "  -tolerance=<frac>  Report the benchmarks that are slower than "
+          "the baseline by more than <frac> (default 0.1)\n",
+          argv0);
+}
+
+} // namespace
+
+/// Run the benchmarks of the libjit kernels. The exit code is 1 if some
+/// benchmark regressed compared to the baseline.
+int main(int argc, char **argv) {
+  std::string filter;
+  std::string jsonFile;
+  std::string baselineFile;
+  double minTime = 0.5;
+  size_t maxReps = 100;
+  double tolerance = 0.1;
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    auto eq = arg.find('=');
+    std::string key = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (key == "-filter") {
+      filter = value;
+    } else if (key == "-json") {
+      jsonFile = value;
+    } else if (key == "-baseline") {
+      baselineFile = value;
+    } else if (key == "-min-time") {
+      minTime = atof(value.c_str());
+    } else if (key == "-reps") {
+      maxReps = std::max(1, atoi(value.c_str()));
+    } else if (key == "-tolerance") {
+      tolerance = atof(value.c_str());
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  std::map<std::string, double> baseline;
+  if (!baselineFile.empty()) {
+    baseline = loadBaseline(baselineFile);
+  }
+
+  FILE *json = nullptr;
+  if (!jsonFile.empty()) {
+    json = fopen(jsonFile.c_str(), "w");
+    if (!json) {
+      fprintf(stderr, "Can't open the output file %s\n", jsonFile.c_str());
+      return 1;
+    }
+    fprintf(json, "{\n  \"benchmarks\": [");
+  }
+
+  printf("%-40s %6s %12s %10s %10s", "name", "reps", "time(us)", "GFLOP/s",
+         "GB/s");
+  if (!baseline.empty()) {
+    printf(" %10s", "speedup");
+  }
+  printf("\n");
+
+  unsigned numRegressions = 0;
+  bool first = true;
+  for (auto &b : createBenchmarks()) {
+    const auto &name = b->getName();
+    if (name.find(filter) == std::string::npos) {
+      continue;
+    }
+    size_t reps;
+    double time = benchFor(b.get(), minTime, maxReps, reps);
+    double gflops = b->flops() / time / 1e9;
+    double gbps = b->bytes() / time / 1e9;
+    printf("%-40s %6zu %12.1f %10.2f %10.2f", name.c_str(), reps, time * 1e6,
+           gflops, gbps);
+
+    auto it = baseline.find(name);
+    if (it != baseline.end()) {
+      // The speedup is above 1 if the benchmark got faster.
+      double speedup = it->second / time;
+      printf(" %10.2f", speedup);
+      if (speedup < 1 / (1 + tolerance)) {
+        printf("  REGRESSION");
+        numRegressions++;
+      }
+    }
+    printf("\n");
+
+    if (json) {
+      fprintf(json,
+              "%s\n    {\"name\": \"%s\", \"seconds\": %.9f, \"reps\": %zu, "
+              "\"gflops\": %.3f, \"gbps\": %.3f}",
+              first ? "" : ",", name.c_str(), time, reps, gflops, gbps);
+    }
+    first = false;
+  }
+
+  if (json) {
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+  }
+
+  if (numRegressions) {
+    printf("%u benchmark(s) are slower than the baseline by more than %.0f%%\n",
+           numRegressions, tolerance * 100);
+    return 1;
+  }
+  return 0;
+}
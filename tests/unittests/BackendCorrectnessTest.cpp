@@ -26,6 +26,7 @@
 #include "gtest/gtest.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace glow;
 using llvm::cast;
@@ -346,6 +347,25 @@ TEST_P(CPUOnly, quantizedMatMulTest) {
   EXPECT_TRUE(out1.isEqual(out2));
 }
 
+/// Test a quantized matrix multiplication that is large enough to exercise the
+/// blocked kernel of the CPU backend, including its ragged edges.
+TEST_P(CPUOnly, quantizedMatMulBlockedTest) {
+  PseudoRNG PRNG;
+  Tensor lhs(ElemKind::Int8QTy, {37, 131}, 2.7, 31);
+  Tensor rhs(ElemKind::Int8QTy, {131, 70}, 3.2, -12);
+  lhs.getHandle<int8_t>().randomize(-129, 128, PRNG);
+  rhs.getHandle<int8_t>().randomize(-129, 128, PRNG);
+  std::array<size_t, 2> S{{37, 70}};
+  llvm::ArrayRef<size_t> shape(S);
+  Tensor out1(ElemKind::Int8QTy, shape, 9000, 3);
+  Tensor out2(ElemKind::Int8QTy, shape, 9000, 3);
+
+  inferMatMulNet(&lhs, &rhs, &out1, backendKind_);
+  inferMatMulNet(&lhs, &rhs, &out2, BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
 TEST_P(BackendCorrectnessTest, maxTest) {
   PseudoRNG PRNG;
   std::array<size_t, 1> S{{1941}};
@@ -590,7 +610,7 @@ TEST_P(BackendCorrectnessTest, smallConv) {
   EXPECT_TRUE(out1.isEqual(out2));
 }
 
-/// This test targets the DKKC8 optimization.
+/// This test targets the grouped GEMM convolution.
 TEST_P(CPUOnly, groupConvTest) {
   std::array<size_t, 4> S{{1, 2, 1, 128}};
   llvm::ArrayRef<size_t> shape(S);
@@ -602,7 +622,7 @@ TEST_P(CPUOnly, groupConvTest) {
   EXPECT_TRUE(out1.isEqual(out2));
 }
 
-/// This test targets the DKKC8 optimization.
+/// This test targets the GEMM convolution with non-square padding.
 TEST_P(CPUOnly, nonSquarePaddingConvTest) {
   std::array<size_t, 4> S{{1, 2, 1, 128}};
   Tensor out1(ElemKind::FloatTy, S);
@@ -613,7 +633,8 @@ TEST_P(CPUOnly, nonSquarePaddingConvTest) {
   EXPECT_TRUE(out1.isEqual(out2));
 }
 
-/// This test targets the DKKC8 opt correctionimization.
+/// This test targets the DKKC8 optimization, which computes the padded layers
+/// with a single output pixel.
 TEST_P(CPUOnly, convDKKC8Test) {
   std::array<size_t, 4> S{{3, 3, 3, 192}};
   Tensor out1(ElemKind::FloatTy, S);
@@ -621,6 +642,173 @@ TEST_P(CPUOnly, convDKKC8Test) {
   inferConvDKKC8(&out1, BackendKind::CPU);
   inferConvDKKC8(&out2, BackendKind::Interpreter);
   EXPECT_TRUE(out1.isEqual(out2));
+
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {1, 1, 1, 32});
+  Tensor kernel(ElemKind::FloatTy, {192, 3, 3, 32});
+  Tensor bias(ElemKind::FloatTy, {192});
+  inputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  kernel.getHandle().randomize(-0.2, 0.2, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  std::array<size_t, 4> pixelS{{1, 1, 1, 192}};
+  Tensor out3(ElemKind::FloatTy, pixelS);
+  Tensor out4(ElemKind::FloatTy, pixelS);
+
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out3, 1, 1, 1,
+                         backendKind_);
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out4, 1, 1, 1,
+                         BackendKind::Interpreter);
+  EXPECT_TRUE(out3.isEqual(out4, 0.001));
+}
+
+/// This test targets the GEMM convolution, with a grouped, strided 5x5 layer
+/// whose patches are gathered with padding, and a 1x1 layer whose input is
+/// multiplied directly.
+TEST_P(CPUOnly, convGEMMTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 13, 11, 12});
+  Tensor kernel(ElemKind::FloatTy, {20, 5, 5, 6});
+  Tensor bias(ElemKind::FloatTy, {20});
+  inputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  kernel.getHandle().randomize(-0.2, 0.2, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  std::array<size_t, 4> S{{2, 7, 6, 20}};
+  Tensor out1(ElemKind::FloatTy, S);
+  Tensor out2(ElemKind::FloatTy, S);
+
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out1, 2, 2, 2,
+                         backendKind_);
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out2, 2, 2, 2,
+                         BackendKind::Interpreter);
+  EXPECT_TRUE(out1.isEqual(out2, 0.001));
+
+  Tensor pointInputs(ElemKind::FloatTy, {2, 5, 7, 16});
+  Tensor pointKernel(ElemKind::FloatTy, {24, 1, 1, 16});
+  Tensor pointBias(ElemKind::FloatTy, {24});
+  pointInputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  pointKernel.getHandle().randomize(-0.2, 0.2, PRNG);
+  pointBias.getHandle().randomize(-0.5, 0.5, PRNG);
+  std::array<size_t, 4> pointS{{2, 5, 7, 24}};
+  Tensor out3(ElemKind::FloatTy, pointS);
+  Tensor out4(ElemKind::FloatTy, pointS);
+
+  inferPrivateFilterConv(&pointInputs, &pointKernel, &pointBias, &out3, 1, 0,
+                         1, backendKind_);
+  inferPrivateFilterConv(&pointInputs, &pointKernel, &pointBias, &out4, 1, 0,
+                         1, BackendKind::Interpreter);
+  EXPECT_TRUE(out3.isEqual(out4, 0.001));
+}
+
+/// This test targets the packed quantized convolution of the CPU backend,
+/// with a grouped, strided layer whose channels are not a multiple of the
+/// vector width.
+TEST_P(CPUOnly, quantizedPackedConvTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::Int8QTy, {2, 13, 11, 18}, 0.025, -7);
+  Tensor kernel(ElemKind::Int8QTy, {36, 3, 3, 9}, 0.003, 3);
+  Tensor bias(ElemKind::Int8QTy, {36}, 0.5, -4);
+  inputs.getHandle<int8_t>().randomize(-129, 128, PRNG);
+  kernel.getHandle<int8_t>().randomize(-129, 128, PRNG);
+  bias.getHandle<int8_t>().randomize(-11, 8, PRNG);
+  std::array<size_t, 4> S{{2, 7, 6, 36}};
+  Tensor out1(ElemKind::Int8QTy, S, 0.05, -17);
+  Tensor out2(ElemKind::Int8QTy, S, 0.05, -17);
+
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out1, 2, 1, 2,
+                         backendKind_);
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out2, 2, 1, 2,
+                         BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2, 1.0));
+}
+
+/// This test targets the Winograd convolutions F(4x4, 3x3) and F(2x2, 3x3),
+/// with outputs that are not a multiple of the tiles and channels that are
+/// not a multiple of the vector width.
+TEST_P(CPUOnly, winogradConvTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 11, 9, 24});
+  Tensor kernel(ElemKind::FloatTy, {36, 3, 3, 12});
+  Tensor bias(ElemKind::FloatTy, {36});
+  inputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  kernel.getHandle().randomize(-0.2, 0.2, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  std::array<size_t, 4> S{{2, 11, 9, 36}};
+  Tensor out1(ElemKind::FloatTy, S);
+  Tensor out2(ElemKind::FloatTy, S);
+
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out1, 1, 1, 2,
+                         backendKind_);
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out2, 1, 1, 2,
+                         BackendKind::Interpreter);
+  EXPECT_TRUE(out1.isEqual(out2, 0.001));
+
+  // The output is too small for F(4x4, 3x3).
+  Tensor smallInputs(ElemKind::FloatTy, {1, 5, 4, 24});
+  smallInputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  std::array<size_t, 4> smallS{{1, 5, 4, 36}};
+  Tensor out3(ElemKind::FloatTy, smallS);
+  Tensor out4(ElemKind::FloatTy, smallS);
+
+  inferPrivateFilterConv(&smallInputs, &kernel, &bias, &out3, 1, 1, 2,
+                         backendKind_);
+  inferPrivateFilterConv(&smallInputs, &kernel, &bias, &out4, 1, 1, 2,
+                         BackendKind::Interpreter);
+  EXPECT_TRUE(out3.isEqual(out4, 0.001));
+}
+
+/// This test targets the depthwise convolution, with channels that are not a
+/// multiple of the vector width, a strided layer with two output channels per
+/// input channel, and a quantized layer.
+TEST_P(CPUOnly, depthwiseConvTest) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {2, 10, 9, 24});
+  Tensor kernel(ElemKind::FloatTy, {24, 3, 3, 1});
+  Tensor bias(ElemKind::FloatTy, {24});
+  inputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  kernel.getHandle().randomize(-1.0, 1.0, PRNG);
+  bias.getHandle().randomize(-0.5, 0.5, PRNG);
+  std::array<size_t, 4> S{{2, 10, 9, 24}};
+  Tensor out1(ElemKind::FloatTy, S);
+  Tensor out2(ElemKind::FloatTy, S);
+
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out1, 1, 1, 24,
+                         backendKind_);
+  inferPrivateFilterConv(&inputs, &kernel, &bias, &out2, 1, 1, 24,
+                         BackendKind::Interpreter);
+  EXPECT_TRUE(out1.isEqual(out2, 0.001));
+
+  Tensor stridedInputs(ElemKind::FloatTy, {1, 9, 11, 8});
+  Tensor stridedKernel(ElemKind::FloatTy, {16, 3, 3, 1});
+  Tensor stridedBias(ElemKind::FloatTy, {16});
+  stridedInputs.getHandle().randomize(-1.0, 1.0, PRNG);
+  stridedKernel.getHandle().randomize(-1.0, 1.0, PRNG);
+  stridedBias.getHandle().randomize(-0.5, 0.5, PRNG);
+  std::array<size_t, 4> stridedS{{1, 5, 6, 16}};
+  Tensor out3(ElemKind::FloatTy, stridedS);
+  Tensor out4(ElemKind::FloatTy, stridedS);
+
+  inferPrivateFilterConv(&stridedInputs, &stridedKernel, &stridedBias, &out3,
+                         2, 1, 8, backendKind_);
+  inferPrivateFilterConv(&stridedInputs, &stridedKernel, &stridedBias, &out4,
+                         2, 1, 8, BackendKind::Interpreter);
+  EXPECT_TRUE(out3.isEqual(out4, 0.001));
+
+  Tensor qInputs(ElemKind::Int8QTy, {2, 9, 10, 20}, 0.025, -7);
+  Tensor qKernel(ElemKind::Int8QTy, {20, 3, 3, 1}, 0.003, 3);
+  Tensor qBias(ElemKind::Int8QTy, {20}, 0.5, -4);
+  qInputs.getHandle<int8_t>().randomize(-129, 128, PRNG);
+  qKernel.getHandle<int8_t>().randomize(-129, 128, PRNG);
+  qBias.getHandle<int8_t>().randomize(-11, 8, PRNG);
+  std::array<size_t, 4> qS{{2, 9, 10, 20}};
+  Tensor out5(ElemKind::Int8QTy, qS, 0.05, -17);
+  Tensor out6(ElemKind::Int8QTy, qS, 0.05, -17);
+
+  inferPrivateFilterConv(&qInputs, &qKernel, &qBias, &out5, 1, 1, 20,
+                         backendKind_);
+  inferPrivateFilterConv(&qInputs, &qKernel, &qBias, &out6, 1, 1, 20,
+                         BackendKind::Interpreter);
+  EXPECT_TRUE(out5.isEqual(out6, 1.0));
 }
 
 TEST_P(BackendCorrectnessTest, softmaxTest) {
@@ -708,6 +896,44 @@ TEST_P(BackendCorrectnessTest, convOps) {
   }
 }
 
+/// Sets the option -cpu-threads of the CPU backend while it is in scope. The
+/// option is read when a function is compiled.
+class CPUThreadsScope {
+  llvm::cl::opt<unsigned> *opt_;
+  unsigned saved_;
+
+public:
+  explicit CPUThreadsScope(unsigned numThreads) {
+    auto &opts = llvm::cl::getRegisteredOptions();
+    auto it = opts.find("cpu-threads");
+    assert(it != opts.end() && "The CPU backend is not linked");
+    opt_ = static_cast<llvm::cl::opt<unsigned> *>(it->second);
+    saved_ = *opt_;
+    opt_->setValue(numThreads);
+  }
+  ~CPUThreadsScope() { opt_->setValue(saved_); }
+};
+
+/// Check that the kernels produce the same bits no matter how many threads
+/// they split their work across.
+TEST_P(CPUOnly, threadCountBitExact) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {4, 3, 32, 32});
+  inputs.getHandle().initXavier(1, PRNG);
+  Tensor expected;
+  {
+    CPUThreadsScope threads(1);
+    inferBasicConvNet(&inputs, &expected, backendKind_, 64);
+  }
+
+  for (unsigned numThreads : {2, 3, 4}) {
+    CPUThreadsScope threads(numThreads);
+    Tensor out;
+    inferBasicConvNet(&inputs, &out, backendKind_, 64);
+    EXPECT_TRUE(out.isEqual(expected, 0.0));
+  }
+}
+
 TEST_P(BackendCorrectnessTest, basicFCNet) {
   PseudoRNG PRNG;
   Tensor inputs(ElemKind::FloatTy, {2, 3, 16, 16});
@@ -721,6 +947,19 @@ TEST_P(BackendCorrectnessTest, basicFCNet) {
   EXPECT_TRUE(out1.isEqual(out2));
 }
 
+TEST_P(BackendCorrectnessTest, parallelBranchesNet) {
+  PseudoRNG PRNG;
+  Tensor inputs(ElemKind::FloatTy, {4, 32});
+  inputs.getHandle().initXavier(1, PRNG);
+  Tensor out1;
+  Tensor out2;
+
+  inferParallelBranchesNet(&inputs, &out1, backendKind_);
+  inferParallelBranchesNet(&inputs, &out2, BackendKind::Interpreter);
+
+  EXPECT_TRUE(out1.isEqual(out2));
+}
+
 TEST_P(CPUOnly, complexNet1) {
   PseudoRNG PRNG;
   std::array<size_t, 4> S{{8, 7, 14, 11}};
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include "BackendTestUtils.h"
+
+#include "glow/ExecutionEngine/BatchBuckets.h"
 #include "glow/ExecutionEngine/ExecutionEngine.h"
+#include "glow/ExecutionEngine/RequestBatcher.h"
 #include "glow/Graph/Graph.h"
 #include "glow/IR/IRBuilder.h"
 
@@ -23,6 +27,10 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Casting.h"
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 using namespace glow;
 
 class BackendTest : public ::testing::TestWithParam<BackendKind> {
@@ -146,6 +154,472 @@ TEST_P(BackendTest, debugPrint) {
   function->execute();
 }
 
+/// Run the same compiled function with several contexts from different
+/// threads at once, and check that every context gets its own results.
+TEST_P(BackendTest, concurrentExecutionContexts) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = createFCReluInput(mod, 2);
+  auto *output = createFCReluNet(F, input);
+
+  EE_.compile(CompilationMode::Infer, F);
+
+  // Compute the expected results serially.
+  constexpr unsigned numContexts = 4;
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> expected;
+  for (unsigned i = 0; i < numContexts; i++) {
+    inputs.emplace_back(ElemKind::FloatTy, std::vector<size_t>{2, 16});
+    inputs.back().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+    EE_.run({input}, {&inputs.back()});
+    expected.push_back(output->getPayload().clone());
+  }
+
+  std::vector<std::unique_ptr<ExecutionContext>> contexts;
+  for (unsigned i = 0; i < numContexts; i++) {
+    contexts.push_back(EE_.createExecutionContext());
+  }
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < numContexts; i++) {
+    threads.emplace_back([&, i]() {
+      for (unsigned iter = 0; iter < 10; iter++) {
+        EE_.run(*contexts[i], {input}, {&inputs[i]});
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (unsigned i = 0; i < numContexts; i++) {
+    EXPECT_TRUE(contexts[i]->getTensor(output)->isEqual(expected[i]));
+  }
+}
+
+/// Check that runWithBindings() reads and writes the tensors of the caller and
+/// leaves the payloads of the variables alone.
+TEST_P(BackendTest, runWithBindings) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = createFCReluInput(mod, 2);
+  auto *output = createFCReluNet(F, input);
+
+  EE_.compile(CompilationMode::Infer, F);
+
+  Tensor in(ElemKind::FloatTy, {2, 16});
+  in.getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  EE_.run({input}, {&in});
+  Tensor expected = output->getPayload().clone();
+
+  // Reset the payloads, and run with the tensors of the caller.
+  input->getPayload().zero();
+  output->getPayload().zero();
+  Tensor out(ElemKind::FloatTy, {2, 8});
+  for (unsigned iter = 0; iter < 2; iter++) {
+    EE_.runWithBindings({input, output}, {&in, &out});
+    EXPECT_TRUE(out.isEqual(expected));
+  }
+
+  Tensor zeroIn(ElemKind::FloatTy, {2, 16});
+  Tensor zeroOut(ElemKind::FloatTy, {2, 8});
+  zeroIn.zero();
+  zeroOut.zero();
+  EXPECT_TRUE(input->getPayload().isEqual(zeroIn));
+  EXPECT_TRUE(output->getPayload().isEqual(zeroOut));
+
+  // The payloads are bound again after the run.
+  EE_.run({input}, {&in});
+  EXPECT_TRUE(output->getPayload().isEqual(expected));
+}
+
+/// Check that the asynchronous runs produce the same results as the
+/// synchronous runs, with a queue that is smaller than the number of runs.
+TEST_P(BackendTest, runAsync) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = createFCReluInput(mod, 2);
+  auto *output = createFCReluNet(F, input);
+
+  EE_.compile(CompilationMode::Infer, F);
+
+  constexpr unsigned numRuns = 16;
+  std::vector<Tensor> inputs;
+  std::vector<Tensor> expected;
+  std::vector<Tensor> outputs;
+  for (unsigned i = 0; i < numRuns; i++) {
+    inputs.emplace_back(ElemKind::FloatTy, std::vector<size_t>{2, 16});
+    inputs.back().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+    EE_.run({input}, {&inputs.back()});
+    expected.push_back(output->getPayload().clone());
+    outputs.emplace_back(ElemKind::FloatTy, std::vector<size_t>{2, 8});
+  }
+
+  EE_.startWorkers(3, 2);
+
+  // Use futures for half of the runs and callbacks for the other half.
+  std::vector<std::future<void>> futures;
+  std::atomic<unsigned> numCallbacks{0};
+  for (unsigned i = 0; i < numRuns; i++) {
+    if (i % 2) {
+      futures.push_back(
+          EE_.runAsync({input, output}, {&inputs[i], &outputs[i]}));
+    } else {
+      EE_.runAsync({input, output}, {&inputs[i], &outputs[i]},
+                   [&]() { numCallbacks++; });
+    }
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  EE_.waitForAsyncRuns();
+  EXPECT_EQ(numCallbacks, numRuns / 2);
+
+  for (unsigned i = 0; i < numRuns; i++) {
+    EXPECT_TRUE(outputs[i].isEqual(expected[i]));
+  }
+  EE_.stopWorkers();
+}
+
+/// Check that the batcher packs the samples of concurrent requests into
+/// batches and returns the right slice of the output to every request.
+TEST_P(BackendTest, requestBatcher) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = createFCReluInput(mod, 4);
+  auto *output = createFCReluNet(F, input);
+  EE_.compile(CompilationMode::Infer, F);
+
+  // Compute the expected result of every sample with a batch that contains
+  // only this sample.
+  constexpr unsigned numRequests = 10;
+  std::vector<Tensor> samples;
+  std::vector<Tensor> expected;
+  std::vector<Tensor> outputs;
+  Tensor batch(ElemKind::FloatTy, {4, 16});
+  for (unsigned i = 0; i < numRequests; i++) {
+    samples.emplace_back(ElemKind::FloatTy, std::vector<size_t>{16});
+    samples.back().getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+    batch.zero();
+    batch.copyToSlice(&samples.back(), 0);
+    EE_.run({input}, {&batch});
+    expected.emplace_back(ElemKind::FloatTy, std::vector<size_t>{8});
+    expected.back().copySlice(&output->getPayload(), 0);
+    outputs.emplace_back(ElemKind::FloatTy, std::vector<size_t>{8});
+  }
+
+  RequestBatcher::Config config;
+  config.maxDelay = std::chrono::milliseconds(5);
+  RequestBatcher batcher(EE_, {input}, {output}, config);
+  EXPECT_EQ(batcher.getMaxBatchSize(), 4);
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < numRequests; i++) {
+    threads.emplace_back([&, i]() {
+      batcher.enqueue({&samples[i]}, {&outputs[i]}).wait();
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (unsigned i = 0; i < numRequests; i++) {
+    EXPECT_TRUE(outputs[i].isEqual(expected[i]));
+  }
+
+  // The batcher keeps running its own function when another function of the
+  // module, with a variable that is created after the first function was
+  // compiled, becomes active.
+  Function *other = mod.createFunction("other");
+  other->createSave("other", other->createTanh("tanh", input));
+  EE_.compile(CompilationMode::Infer, other);
+  outputs[0].zero();
+  batcher.enqueue({&samples[0]}, {&outputs[0]}).wait();
+  EXPECT_TRUE(outputs[0].isEqual(expected[0]));
+}
+
+/// Check that a request that is not joined by other requests is run once it
+/// has waited for the latency budget, and not later.
+TEST_P(BackendTest, requestBatcherDelay) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = createFCReluInput(mod, 4);
+  auto *output = createFCReluNet(F, input);
+
+  EE_.compile(CompilationMode::Infer, F);
+
+  RequestBatcher::Config config;
+  config.maxDelay = std::chrono::milliseconds(200);
+  RequestBatcher batcher(EE_, {input}, {output}, config);
+
+  Tensor sample(ElemKind::FloatTy, {16});
+  Tensor out(ElemKind::FloatTy, {8});
+  auto start = std::chrono::steady_clock::now();
+  auto future = batcher.enqueue({&sample}, {&out});
+  // The batch is not full, so the request waits for the whole budget.
+  auto status = future.wait_for(config.maxDelay / 2);
+  EXPECT_EQ(status, std::future_status::timeout);
+  // The run of a single small batch fits easily into the remaining slack.
+  status = future.wait_until(start + 2 * config.maxDelay);
+  EXPECT_EQ(status, std::future_status::ready);
+}
+
+/// Check that the engine keeps several compiled functions of one module that
+/// share the variables, and switches between them without recompiling.
+TEST_P(BackendTest, multipleCompiledFunctions) {
+  auto &mod = EE_.getModule();
+  auto *input = createFCReluInput(mod, 2);
+  Function *F1 = mod.createFunction("relu");
+  auto *out1 = createFCReluNet(F1, input);
+  Function *F2 = mod.createFunction("tanh");
+  auto *FC2 = F2->createFullyConnected("fc2", input, 8);
+  auto *out2 =
+      F2->createSave("ret2", F2->createTanh("tanh", FC2))->getVariable();
+
+  Tensor in(ElemKind::FloatTy, {2, 16});
+  in.getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+
+  EE_.compile(CompilationMode::Infer, F1);
+  EE_.run({input}, {&in});
+  Tensor expected1 = out1->getPayload().clone();
+  EE_.compile(CompilationMode::Infer, F2);
+  EE_.run({input}, {&in});
+  Tensor expected2 = out2->getPayload().clone();
+  EXPECT_TRUE(EE_.isCompiled(F1));
+  EXPECT_TRUE(EE_.isCompiled(F2));
+
+  for (unsigned iter = 0; iter < 2; iter++) {
+    out1->getPayload().zero();
+    out2->getPayload().zero();
+    EE_.setActiveFunction(F1);
+    EE_.run({input}, {&in});
+    EXPECT_TRUE(out1->getPayload().isEqual(expected1));
+    EE_.setActiveFunction(F2);
+    EE_.run({input}, {&in});
+    EXPECT_TRUE(out2->getPayload().isEqual(expected2));
+  }
+
+  EE_.eraseCompiledFunction(F1);
+  EXPECT_FALSE(EE_.isCompiled(F1));
+  EE_.run({input}, {&in});
+  EXPECT_TRUE(out2->getPayload().isEqual(expected2));
+}
+
+/// Check that batches of any size are run with the bucket that fits them and
+/// produce the same results as the original function.
+TEST_P(BackendTest, batchBuckets) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = mod.createVariable(ElemKind::FloatTy, {4, 4, 4}, "input",
+                                   VisibilityKind::Public, false);
+  auto *RS = F->createReshape("reshape", input, {4, 16});
+  auto *output = createFCReluNet(F, RS);
+
+  // Compute the expected result of every sample with the original function.
+  constexpr unsigned numSamples = 7;
+  Tensor samples(ElemKind::FloatTy, {numSamples, 4, 4});
+  samples.getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+  Tensor expected(ElemKind::FloatTy, {numSamples, 8});
+  // The clone shares the variables of F, but F itself is not optimized.
+  EE_.compile(CompilationMode::Infer, F->clone("reference"));
+  Tensor batch(ElemKind::FloatTy, {4, 4, 4});
+  for (unsigned i = 0; i < numSamples; i++) {
+    Tensor sample(ElemKind::FloatTy, {4, 4});
+    sample.copySlice(&samples, i);
+    batch.copyToSlice(&sample, 0);
+    EE_.run({input}, {&batch});
+    Tensor out(ElemKind::FloatTy, {8});
+    out.copySlice(&output->getPayload(), 0);
+    expected.copyToSlice(&out, i);
+  }
+
+  BatchBuckets buckets(EE_, CompilationMode::Infer, F, {input}, {output},
+                       {1, 4});
+  EXPECT_EQ(buckets.getBucketSize(1), 1);
+  EXPECT_EQ(buckets.getBucketSize(3), 4);
+  EXPECT_EQ(buckets.getBucketSize(9), 4);
+
+  // Run batches that fit a bucket, need padding, and need several chunks.
+  for (size_t n : {1, 3, 4, 7}) {
+    Tensor in(ElemKind::FloatTy, {n, 4, 4});
+    Tensor out(ElemKind::FloatTy, {n, 8});
+    Tensor ref(ElemKind::FloatTy, {n, 8});
+    in.copyConsecutiveSlices(&samples, 0);
+    ref.copyConsecutiveSlices(&expected, 0);
+    buckets.run({&in}, {&out});
+    EXPECT_TRUE(out.isEqual(ref));
+  }
+}
+
+/// Check that the batch sizes that the function can't be cloned with are not
+/// used.
+TEST_P(BackendTest, batchBucketsUnsupported) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = mod.createVariable(ElemKind::FloatTy, {4, 8}, "input",
+                                   VisibilityKind::Public, false);
+  // The reduction adds up the samples of the batch.
+  auto *save =
+      F->createSave("ret", F->createBatchedReduceAdd("reduce", input, 0));
+
+  BatchBuckets buckets(EE_, CompilationMode::Infer, F, {input},
+                       {save->getVariable()}, {2, 4});
+  EXPECT_EQ(buckets.getBucketSize(1), 4);
+  EXPECT_FALSE(mod.hasFunction("main_b2"));
+}
+
+/// Check that runBatch, which stages the next minibatch while the current one
+/// runs, feeds every minibatch once and leaves the last one in the input.
+TEST_P(BackendTest, runBatchStaging) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = mod.createVariable(ElemKind::FloatTy, {2, 4}, "input",
+                                   VisibilityKind::Public, false);
+  auto *acc = mod.createVariable(ElemKind::FloatTy, {2, 4}, "acc",
+                                 VisibilityKind::Private, false);
+  acc->getPayload().zero();
+  // Accumulate the minibatches into acc.
+  F->createSave("acc", F->createAdd("add", acc, input), acc);
+
+  EE_.compile(CompilationMode::Infer, F);
+
+  // The samples fit a single minibatch, because the position of the first
+  // minibatch depends on the previous calls to runBatch.
+  Tensor samples(ElemKind::FloatTy, {2, 4});
+  auto SH = samples.getHandle();
+  for (size_t i = 0; i < samples.size(); i++) {
+    SH.raw(i) = i;
+  }
+  EE_.runBatch(5, {input}, {&samples});
+
+  auto AH = acc->getPayload().getHandle();
+  for (size_t i = 0; i < samples.size(); i++) {
+    EXPECT_EQ(AH.raw(i), 5 * SH.raw(i));
+  }
+  EXPECT_TRUE(input->getPayload().isEqual(samples));
+}
+
+/// Check that a tiered function produces the same results before and after
+/// it switches to the final tier.
+TEST_P(BackendTest, compileTiered) {
+  auto &mod = EE_.getModule();
+  auto *input = createFCReluInput(mod, 2);
+  Function *F = mod.createFunction("main");
+  auto *out = createFCReluNet(F, input);
+  Function *ref = F->clone("ref");
+
+  Tensor in(ElemKind::FloatTy, {2, 16});
+  in.getHandle().randomize(-1.0, 1.0, mod.getPRNG());
+
+  EE_.compile(CompilationMode::Infer, ref);
+  EE_.run({input}, {&in});
+  Tensor expected = out->getPayload().clone();
+
+  auto &tiered = EE_.compileTiered(CompilationMode::Infer, F);
+  out->getPayload().zero();
+  EE_.run({input}, {&in});
+  EXPECT_TRUE(out->getPayload().isEqual(expected));
+
+  auto ctx = EE_.createExecutionContext();
+  Tensor result(ElemKind::FloatTy, {2, 8});
+  EE_.runWithBindings(*ctx, {input, out}, {&in, &result});
+  EXPECT_TRUE(result.isEqual(expected));
+
+  tiered.waitForFinalTier();
+  EXPECT_TRUE(tiered.isFinalTierActive());
+  out->getPayload().zero();
+  EE_.run({input}, {&in});
+  EXPECT_TRUE(out->getPayload().isEqual(expected));
+  result.zero();
+  EE_.runWithBindings(*ctx, {input, out}, {&in, &result});
+  EXPECT_TRUE(result.isEqual(expected));
+}
+
+/// \returns the buffer named \p name in \p footprint, or null.
+static const MemoryFootprint::Buffer *findBuffer(const MemoryFootprint &fp,
+                                                 llvm::StringRef name) {
+  for (const auto &B : fp.buffers) {
+    if (B.name == name) {
+      return &B;
+    }
+  }
+  return nullptr;
+}
+
+TEST_P(BackendTest, memoryFootprint) {
+  auto &mod = EE_.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = mod.createVariable(ElemKind::FloatTy, {4, 64}, "input",
+                                   VisibilityKind::Public);
+  auto *FC1 = F->createFullyConnected("fc1", input, 128);
+  auto *RL = F->createRELU("relu", FC1);
+  auto *FC2 = F->createFullyConnected("fc2", RL, 10);
+  auto *save = F->createSave("ret", FC2);
+  EE_.compile(CompilationMode::Infer, F);
+  auto fp = EE_.getMemoryFootprint(F);
+
+  size_t constantBytes = 0;
+  size_t mutableBytes = 0;
+  for (auto *v : mod.getVars()) {
+    auto size = v->getType()->getSizeInBytes();
+    (v->isPrivate() ? constantBytes : mutableBytes) += size;
+    auto *B = findBuffer(fp, v->getName());
+    ASSERT_TRUE(B);
+    EXPECT_EQ(B->size, size);
+    EXPECT_NE(B->kind, MemoryFootprint::BufferKind::Activation);
+  }
+  EXPECT_EQ(fp.constantWeightBytes, constantBytes);
+  EXPECT_EQ(fp.mutableWeightBytes, mutableBytes);
+  size_t ioBytes = input->getType()->getSizeInBytes() +
+                   save->getVariable()->getType()->getSizeInBytes();
+  EXPECT_EQ(fp.mutableWeightBytes, ioBytes);
+  EXPECT_EQ(fp.getTotalBytes(), fp.constantWeightBytes + fp.getContextBytes());
+
+  // The activations that are alive at the peak add up to the peak, and fit
+  // into the memory that is reserved for the activations.
+  EXPECT_GT(fp.peakLiveBytes, 0);
+  EXPECT_GE(fp.activationBytes, fp.peakLiveBytes);
+  size_t peakBytes = 0;
+  for (const auto &name : fp.peakLiveBuffers) {
+    auto *B = findBuffer(fp, name);
+    ASSERT_TRUE(B);
+    EXPECT_EQ(B->kind, MemoryFootprint::BufferKind::Activation);
+    peakBytes += B->size;
+  }
+  EXPECT_EQ(peakBytes, fp.peakLiveBytes);
+  for (const auto &B : fp.buffers) {
+    if (B.kind == MemoryFootprint::BufferKind::Activation &&
+        B.offset != MemoryFootprint::noOffset) {
+      EXPECT_LE(B.offset + B.size, fp.activationBytes);
+    }
+  }
+
+  // A variable that is added to the module after the compilation is not part
+  // of the footprint.
+  mod.createVariable(ElemKind::FloatTy, {16}, "late", VisibilityKind::Public);
+  auto lateFp = EE_.getMemoryFootprint(F);
+  EXPECT_EQ(lateFp.mutableWeightBytes, fp.mutableWeightBytes);
+  EXPECT_FALSE(findBuffer(lateFp, "late"));
+}
+
+/// Check that the scratch memory of the instructions is reported.
+TEST(Interpreter, memoryFootprintScratch) {
+  ExecutionEngine EE;
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+  auto *input = mod.createVariable(ElemKind::FloatTy, {3, 100}, "input",
+                                   VisibilityKind::Public);
+  auto *TK = F->createTopK("topk", input, 5);
+  F->createSave("values", TK->getValues());
+  F->createSave("indices", TK->getIndices());
+  EE.compile(CompilationMode::Infer, F);
+  auto fp = EE.getMemoryFootprint(F);
+
+  // TopK uses a scratch buffer with a value and an index per input column.
+  EXPECT_EQ(fp.scratchBytes, 2 * 100 * sizeof(size_t));
+  EXPECT_EQ(fp.activationBytes, fp.peakLiveBytes);
+}
+
 INSTANTIATE_TEST_CASE_P(Interpreter, BackendTest,
                         ::testing::Values(BackendKind::Interpreter));
 
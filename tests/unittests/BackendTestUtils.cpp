@@ -27,6 +27,17 @@ using llvm::cast;
 #define VarFrom(T)                                                             \
   mod.createVariable(&T->getType(), #T, VisibilityKind::Public, false)
 
+Variable *createFCReluInput(Module &mod, size_t batchSize) {
+  return mod.createVariable(ElemKind::FloatTy, {batchSize, 16}, "input",
+                            VisibilityKind::Public, false);
+}
+
+Variable *createFCReluNet(Function *F, NodeValue input) {
+  auto *FC = F->createFullyConnected("fc", input, 8);
+  auto *RL = F->createRELU("relu", FC);
+  return F->createSave("ret", RL)->getVariable();
+}
+
 void inferBatchedAddNet(Tensor *batch, Tensor *slice, Tensor *out,
                         BackendKind kind) {
   ExecutionEngine EE(kind);
@@ -536,6 +547,40 @@ void inferConvDKKC8(Tensor *out, BackendKind kind) {
   out->copyFrom(&result->getVariable()->getPayload());
 }
 
+void inferPrivateFilterConv(Tensor *inputs, Tensor *filter, Tensor *bias,
+                            Tensor *out, size_t stride, size_t pad,
+                            size_t group, BackendKind kind) {
+  ExecutionEngine EE(kind);
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+  auto *inputVar = VarFrom(inputs);
+  auto *biasVar = VarFrom(bias);
+  // The filter is private, which allows the CPU backend to change its layout.
+  Variable *filterVar;
+  TypeRef OT;
+  if (inputs->getType().isQuantizedType()) {
+    auto &filterTy = filter->getType();
+    auto &outTy = out->getType();
+    filterVar =
+        mod.createVariable(filter->getElementType(), filter->dims(),
+                           filterTy.getScale(), filterTy.getOffset(), "filter");
+    OT = mod.uniqueType(out->getElementType(), out->dims(), outTy.getScale(),
+                        outTy.getOffset());
+  } else {
+    filterVar = mod.createVariable(filter->getElementType(), filter->dims(),
+                                   "filter");
+    OT = mod.uniqueType(out->getElementType(), out->dims());
+  }
+  filterVar->getPayload().copyFrom(filter);
+
+  auto *conv = F->createConv("conv", inputVar, filterVar, biasVar, OT,
+                             filter->dims()[1], stride, pad, group);
+  auto *result = F->createSave("ret", conv);
+  EE.compile(CompilationMode::Infer, F);
+  EE.run({inputVar, biasVar}, {inputs, bias});
+  out->copyFrom(&result->getVariable()->getPayload());
+}
+
 void inferSoftMaxNet(Tensor *inputs, Tensor *selected, Tensor *out,
                      BackendKind kind) {
   ExecutionEngine EE(kind);
@@ -655,6 +700,27 @@ void inferBasicFCNet(Tensor *inputs, Tensor *out, BackendKind kind) {
   out->copyFrom(&result->getVariable()->getPayload());
 }
 
+void inferParallelBranchesNet(Tensor *inputs, Tensor *out, BackendKind kind) {
+  ExecutionEngine EE(kind);
+  auto &mod = EE.getModule();
+  Function *F = mod.createFunction("main");
+  auto *var = VarFrom(inputs);
+  // Four independent branches that only share the input.
+  std::vector<NodeValue> branches;
+  for (size_t i = 0; i < 4; i++) {
+    auto *fc = F->createFullyConnected("fc", var, 16);
+    cast<Variable>(fc->getWeights())->getHandle().clear(0.1 * (i + 1));
+    auto *fc2 = F->createFullyConnected("fc2", F->createTanh("tanh", fc), 8);
+    cast<Variable>(fc2->getWeights())->getHandle().clear(0.2 * (i + 1));
+    branches.push_back(F->createRELU("relu", fc2));
+  }
+  auto *concat = F->createConcat("concat", branches, 1);
+  auto result = F->createSave("ret", concat);
+  EE.compile(CompilationMode::Infer, F);
+  EE.run({var}, {inputs});
+  out->copyFrom(&result->getVariable()->getPayload());
+}
+
 void inferMixedNet(Tensor *inputs, Tensor *out, BackendKind kind) {
   ExecutionEngine EE(kind);
   auto &mod = EE.getModule();
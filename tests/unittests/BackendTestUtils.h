@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include "glow/Backends/ExecutionContext.h"
 #include "glow/ExecutionEngine/ExecutionEngine.h"
 #include "glow/Graph/Graph.h"
 #include "glow/IR/IR.h"
@@ -23,7 +24,21 @@ namespace glow {
 /// MockBackend used only for unit testing.
 class MockBackend : public Backend {
   class MockFunction : public CompiledFunction {
+    ExecutionContext ctx_;
     void execute() override {}
+    ExecutionContext &getDefaultContext() override {
+      ctx_.setOwner(this);
+      return ctx_;
+    }
+    std::unique_ptr<ExecutionContext> createExecutionContext() override {
+      auto ctx = llvm::make_unique<ExecutionContext>();
+      ctx->setOwner(this);
+      return ctx;
+    }
+    void execute(ExecutionContext &ctx) override {}
+    MemoryFootprint getMemoryFootprint() const override {
+      return MemoryFootprint();
+    }
   };
   std::unique_ptr<CompiledFunction>
   compile(std::unique_ptr<IRFunction> IR) const override {
@@ -34,6 +49,14 @@ class MockBackend : public Backend {
   }
 };
 
+/// \returns a public input variable of \p mod with \p batchSize samples of 16
+/// floats, which is the input of the net of createFCReluNet.
+Variable *createFCReluInput(Module &mod, size_t batchSize);
+
+/// Add a fully connected layer with 8 outputs on \p input and a RELU to \p F,
+/// and save the result. \returns the variable of the result.
+Variable *createFCReluNet(Function *F, NodeValue input);
+
 void inferBatchedAddNet(Tensor *inputs1, Tensor *inputs2, Tensor *out,
                         BackendKind kind);
 
@@ -103,6 +126,10 @@ void inferNonSquarePaddingConv(Tensor *out, BackendKind kind);
 
 void inferConvDKKC8(Tensor *out, BackendKind kind);
 
+void inferPrivateFilterConv(Tensor *inputs, Tensor *filter, Tensor *bias,
+                            Tensor *out, size_t stride, size_t pad,
+                            size_t group, BackendKind kind);
+
 void inferSmallConv(Tensor *inputs, Tensor *out, BackendKind kind);
 
 void inferSoftMaxNet(Tensor *inputs, Tensor *selected, Tensor *out,
@@ -128,6 +155,8 @@ void inferMixedNet(Tensor *inputs, Tensor *out, BackendKind kind);
 void inferComplexNet1(Tensor *inputs1, Tensor *inputs2, Tensor *inputs3,
                       Tensor *inputs4, Tensor *out, BackendKind kind);
 
+void inferParallelBranchesNet(Tensor *inputs, Tensor *out, BackendKind kind);
+
 void inferTinyResnet(Tensor *input, Tensor *out, std::vector<Tensor> &weights,
                      BackendKind kind);
 
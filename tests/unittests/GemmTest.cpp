@@ -22,6 +22,7 @@
 #include "glow/IR/IRBuilder.h"
 #include "glow/IR/Instrs.h"
 #include "glow/Support/Random.h"
+#include "glow/Support/ThreadPool.h"
 
 #include "gtest/gtest.h"
 
@@ -81,3 +82,55 @@ TEST(Gemm, jitTest) {
     }
   }
 }
+
+extern "C" {
+// Forward declare the runtime hooks from libjit.
+typedef void (*libjit_task_fn)(void *ctx, size_t taskId);
+extern void (*libjit_hook_parallel_for)(size_t numTasks, libjit_task_fn fn,
+                                        void *ctx);
+extern size_t libjit_hook_num_threads;
+}
+
+/// The pool that runs the libjit tasks in the parallel tests.
+static ThreadPool *libjitPool;
+
+static void libjitParallelFor(size_t numTasks, libjit_task_fn fn, void *ctx) {
+  libjitPool->parallelFor(numTasks, [=](size_t i) { fn(ctx, i); });
+}
+
+/// Check that splitting the matrix multiplication between threads produces
+/// exactly the same results as the serial computation.
+TEST(Gemm, parallelJitTest) {
+  PseudoRNG PRNG;
+  ThreadPool pool(3);
+  libjitPool = &pool;
+
+  for (size_t m : {1, 5, 40}) {
+    for (size_t n : {1, 17, 300, 1100}) {
+      for (size_t k : {3, 130}) {
+        Tensor lhs(ElemKind::FloatTy, {m, k});
+        Tensor rhs(ElemKind::FloatTy, {k, n});
+        lhs.getHandle().randomize(-7.2, 8.3, PRNG);
+        rhs.getHandle().randomize(-6.3, 10.1, PRNG);
+        Tensor out1(ElemKind::FloatTy, {m, n});
+        Tensor out2(ElemKind::FloatTy, {m, n});
+
+        libjit_matmul_f(out1.getRawDataPointer<float>(),
+                        lhs.getRawDataPointer<float>(),
+                        rhs.getRawDataPointer<float>(), out1.dims().data(),
+                        lhs.dims().data(), rhs.dims().data());
+
+        libjit_hook_parallel_for = libjitParallelFor;
+        libjit_hook_num_threads = pool.getNumWorkers() + 1;
+        libjit_matmul_f(out2.getRawDataPointer<float>(),
+                        lhs.getRawDataPointer<float>(),
+                        rhs.getRawDataPointer<float>(), out2.dims().data(),
+                        lhs.dims().data(), rhs.dims().data());
+        libjit_hook_parallel_for = nullptr;
+        libjit_hook_num_threads = 1;
+
+        EXPECT_TRUE(out1.isEqual(out2, 0.0));
+      }
+    }
+  }
+}
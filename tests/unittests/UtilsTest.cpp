@@ -14,10 +14,20 @@
  * limitations under the License.
  */
 
+#include "glow/Support/CompileProfile.h"
+#include "glow/Support/ExecutionProfile.h"
+#include "glow/Support/PerfCounters.h"
 #include "glow/Support/Random.h"
+#include "glow/Support/Support.h"
+#include "glow/Support/TaskGraph.h"
+#include "glow/Support/ThreadPool.h"
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <memory>
+#include <string>
+
 using namespace glow;
 
 // Test that nextRandInt generates every number in the closed interval [lb, ub].
@@ -49,3 +59,279 @@ TEST(Utils, deterministicPRNG) {
     EXPECT_EQ(dist(genA), dist(genB));
   }
 }
+
+// Test that parallelFor runs every task exactly once.
+TEST(Utils, threadPoolParallelFor) {
+  ThreadPool pool(4);
+  for (size_t numTasks : {0, 1, 3, 1000}) {
+    std::vector<std::atomic<unsigned>> counts(numTasks);
+    for (auto &count : counts) {
+      count = 0;
+    }
+    pool.parallelFor(numTasks, [&](size_t i) { counts[i]++; });
+    for (auto &count : counts) {
+      EXPECT_EQ(count, 1);
+    }
+  }
+}
+
+// Test that tasks submitted to the pool run and that parallel loops can be
+// nested inside of the tasks without deadlocking.
+TEST(Utils, threadPoolSubmit) {
+  ThreadPool pool(2);
+  std::atomic<size_t> sum{0};
+  std::vector<std::future<void>> futures;
+  for (size_t i = 0; i < 8; i++) {
+    futures.push_back(pool.submit([&]() {
+      pool.parallelFor(100, [&](size_t j) { sum += j; });
+    }));
+  }
+  for (auto &future : futures) {
+    future.wait();
+  }
+  EXPECT_EQ(sum, 8 * 4950);
+}
+
+// Test that the dependencies of a task graph are derived from the memory
+// accesses of the tasks.
+TEST(Utils, taskGraphDependencies) {
+  TaskGraph graph;
+  // 0: writes [0, 8) of space 0.
+  graph.addTask({{0, 0, 8, true}});
+  // 1: writes [0, 8) of space 1. Independent of 0.
+  graph.addTask({{1, 0, 8, true}});
+  // 2: reads [4, 12) of space 0. Depends on 0.
+  graph.addTask({{0, 4, 12, false}});
+  // 3: reads [0, 4) of space 0. Depends on 0, but not on the other read.
+  graph.addTask({{0, 0, 4, false}});
+  // 4: writes [8, 16) of space 0. Depends on the read 2 only.
+  graph.addTask({{0, 8, 16, true}, {1, 0, 8, false}});
+
+  EXPECT_EQ(graph.size(), 5);
+  EXPECT_EQ(graph.getNumPredecessors(0), 0);
+  EXPECT_EQ(graph.getNumPredecessors(1), 0);
+  EXPECT_EQ(graph.getNumPredecessors(2), 1);
+  EXPECT_EQ(graph.getNumPredecessors(3), 1);
+  EXPECT_EQ(graph.getNumPredecessors(4), 2);
+  EXPECT_EQ(graph.getSuccessors(0).vec(), std::vector<unsigned>({2, 3}));
+  EXPECT_EQ(graph.getSuccessors(1).vec(), std::vector<unsigned>({4}));
+  EXPECT_EQ(graph.getSuccessors(2).vec(), std::vector<unsigned>({4}));
+  EXPECT_EQ(graph.getCriticalPathLength(), 3);
+}
+
+// Test that running a task graph on a pool gives the same results as running
+// the tasks sequentially.
+TEST(Utils, taskGraphRun) {
+  PseudoRNG PRNG;
+  constexpr size_t numBuffers = 8;
+  constexpr size_t numTasks = 200;
+  // Task i computes buf[dst[i]] = buf[a[i]] * 3 + buf[b[i]] + i.
+  std::vector<size_t> a, b, dst;
+  TaskGraph graph;
+  for (size_t i = 0; i < numTasks; i++) {
+    a.push_back(PRNG.nextRandInt(0, numBuffers - 1));
+    b.push_back(PRNG.nextRandInt(0, numBuffers - 1));
+    dst.push_back(PRNG.nextRandInt(0, numBuffers - 1));
+    graph.addTask({{0, a[i], a[i] + 1, false},
+                   {0, b[i], b[i] + 1, false},
+                   {0, dst[i], dst[i] + 1, true}});
+  }
+  auto runTask = [&](std::vector<uint64_t> &buf, size_t i) {
+    buf[dst[i]] = (buf[a[i]] * 3 + buf[b[i]] + i) % 1000003;
+  };
+
+  std::vector<uint64_t> expected(numBuffers, 1);
+  for (size_t i = 0; i < numTasks; i++) {
+    runTask(expected, i);
+  }
+
+  for (unsigned numWorkers : {0, 1, 4}) {
+    ThreadPool pool(numWorkers);
+    std::vector<uint64_t> buf(numBuffers, 1);
+    graph.run(pool, [&](unsigned i) { runTask(buf, i); });
+    EXPECT_EQ(buf, expected);
+  }
+}
+
+// Test that the JSON strings escape the quotes, the backslashes and the
+// control characters.
+TEST(Utils, writeJSONString) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  writeJSONString(os, "C:\\models\\\"a\"\tb\n\x01.onnx");
+  os.flush();
+  EXPECT_EQ(str, "\"C:\\\\models\\\\\\\"a\\\"\\tb\\n\\u0001.onnx\"");
+}
+
+// Test that the compile profile records the nested phases with their sizes.
+TEST(Utils, compileProfile) {
+  auto &profile = CompileProfile::get();
+  { CompilePhase phase("ignored", "test"); }
+  profile.enable();
+  profile.clear();
+
+  size_t size = 3;
+  {
+    CompilePhase outer("outer", "test");
+    CompilePhase inner("inner", "test", "nodes", [&]() { return size; });
+    size = 5;
+  }
+
+  std::string report;
+  llvm::raw_string_ostream os(report);
+  profile.writeReport(os);
+  os.flush();
+  EXPECT_EQ(report.find("ignored"), std::string::npos);
+  auto inner = report.find("\"name\": \"inner\"");
+  auto outer = report.find("\"name\": \"outer\"");
+  ASSERT_NE(inner, std::string::npos);
+  ASSERT_NE(outer, std::string::npos);
+  // The inner phase ends first.
+  EXPECT_LT(inner, outer);
+  EXPECT_NE(report.find("\"nodes_before\": 3"), std::string::npos);
+  EXPECT_NE(report.find("\"nodes_after\": 5"), std::string::npos);
+  EXPECT_NE(report.find("rss_delta_kb"), std::string::npos);
+  profile.clear();
+}
+
+/// \returns the value of the argument \p arg of the event \p name in the
+/// report \p report, or 0 if it is not found.
+static size_t getEventArg(const std::string &report, const std::string &name,
+                          const std::string &arg) {
+  auto event = report.find("\"name\": \"" + name + "\"");
+  if (event == std::string::npos) {
+    return 0;
+  }
+  auto end = report.find('\n', event);
+  auto pos = report.find("\"" + arg + "\": ", event);
+  if (pos == std::string::npos || pos > end) {
+    return 0;
+  }
+  return std::stoull(report.substr(pos + arg.size() + 4));
+}
+
+// Test that the compile phases report the memory that is freed before they
+// end in their peak, and that the enclosing phases keep the peak of the nested
+// phases.
+TEST(Utils, compilePhasePeakMemory) {
+  if (!resetPeakMemoryUsage()) {
+    return;
+  }
+  auto &profile = CompileProfile::get();
+  profile.enable();
+  profile.clear();
+
+  constexpr size_t bytes = 64 << 20;
+  {
+    CompilePhase outer("outer", "test");
+    {
+      CompilePhase inner("inner", "test");
+      std::unique_ptr<char[]> buffer(new char[bytes]);
+      // Touch every page, so that the buffer becomes resident.
+      volatile char *data = buffer.get();
+      for (size_t i = 0; i < bytes; i += 1024) {
+        data[i] = 1;
+      }
+    }
+    CompilePhase after("after", "test");
+  }
+
+  std::string report;
+  llvm::raw_string_ostream os(report);
+  profile.writeReport(os);
+  os.flush();
+  size_t inner = getEventArg(report, "inner", "peak_rss_kb");
+  size_t outer = getEventArg(report, "outer", "peak_rss_kb");
+  EXPECT_GE(inner, bytes / 1024);
+  EXPECT_GE(outer, inner);
+  EXPECT_GT(getEventArg(report, "after", "peak_rss_kb"), 0);
+  profile.clear();
+}
+
+// Test that the execution profile aggregates the times of the instructions and
+// sorts the summary by the total time.
+TEST(Utils, executionProfile) {
+  ExecutionProfile profile("test", 2);
+  profile.addEvent("conv", "ConvolutionInst", 0, 3000);
+  profile.addEvent("relu", "ReluInst", 3000, 4000, 2048);
+  profile.addEvent("conv", "ConvolutionInst", 4000, 9000);
+
+  auto stats = profile.getStats();
+  ASSERT_EQ(stats.size(), 2);
+  EXPECT_EQ(stats["conv"].kind, "ConvolutionInst");
+  EXPECT_EQ(stats["conv"].count, 2);
+  EXPECT_EQ(stats["conv"].total, 8000);
+  EXPECT_EQ(stats["conv"].min, 3000);
+  EXPECT_EQ(stats["conv"].max, 5000);
+  EXPECT_EQ(stats["conv"].allocatedBytes, 0);
+  EXPECT_EQ(stats["relu"].count, 1);
+  EXPECT_EQ(stats["relu"].allocatedBytes, 2048);
+
+  // Only the first two events are kept for the trace.
+  std::string trace;
+  llvm::raw_string_ostream traceOS(trace);
+  profile.writeChromeTrace(traceOS);
+  traceOS.flush();
+  EXPECT_NE(trace.find("\"ts\": 3.000, \"dur\": 1.000"), std::string::npos);
+  EXPECT_NE(trace.find("\"allocated_bytes\": 2048"), std::string::npos);
+  EXPECT_EQ(trace.find("\"ts\": 4.000"), std::string::npos);
+
+  std::string summary;
+  llvm::raw_string_ostream summaryOS(summary);
+  profile.writeSummary(summaryOS);
+  summaryOS.flush();
+  auto conv = summary.find("conv");
+  auto relu = summary.find("relu");
+  ASSERT_NE(conv, std::string::npos);
+  ASSERT_NE(relu, std::string::npos);
+  EXPECT_LT(conv, relu);
+  EXPECT_NE(summary.find("alloc(KB)"), std::string::npos);
+
+  profile.clear();
+  EXPECT_TRUE(profile.getStats().empty());
+}
+
+// Test that the summary shows the achieved performance and the counters of the
+// instructions.
+TEST(Utils, executionProfileCounters) {
+  ExecutionProfile profile("test");
+  ExecutionProfile::Sample begin, end;
+  begin.timestamp = 1000;
+  end.timestamp = 3000;
+  end.counters.cycles = 4000;
+  end.counters.instructions = 6000;
+  end.counters.cacheReferences = 100;
+  end.counters.cacheMisses = 25;
+  ExecutionProfile::InstrCost cost;
+  cost.flops = 8000;
+  cost.bytes = 2000;
+  profile.addEvent("fc", "MatMulInst", begin, end, cost);
+
+  auto stats = profile.getStats()["fc"];
+  EXPECT_EQ(stats.counters.cycles, 4000);
+  EXPECT_EQ(stats.cost.flops, 8000);
+
+  std::string summary;
+  llvm::raw_string_ostream os(summary);
+  profile.writeSummary(os);
+  os.flush();
+  // IPC, miss rate, GFLOP/s, GB/s and FLOP/B.
+  EXPECT_NE(summary.find("    1.50   25.00      4.00      1.00      4.00  fc"),
+            std::string::npos);
+}
+
+// Test that the counters of a thread can be read, if the machine allows it.
+TEST(Utils, perfCounters) {
+  const auto &counters = PerfCounters::getThreadCounters();
+  auto begin = counters.read();
+  volatile double sum = 0;
+  for (int i = 0; i < 100000; i++) {
+    sum = sum + i;
+  }
+  auto diff = counters.read() - begin;
+  if (counters.isAvailable()) {
+    EXPECT_GT(diff.cycles, 0);
+  } else {
+    EXPECT_EQ(diff.cycles, 0);
+  }
+}
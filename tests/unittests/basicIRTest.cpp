@@ -18,6 +18,7 @@
 
 #include "glow/IR/IR.h"
 #include "glow/IR/IRBuilder.h"
+#include "glow/IR/IRUtils.h"
 #include "glow/IR/Instrs.h"
 
 #include "llvm/Support/Casting.h"
@@ -189,3 +190,33 @@ TEST(IR, predicateIR) {
     M.verify();
   }
 }
+
+TEST(IR, estimateFLOPs) {
+  Module mod;
+  Function *F = mod.createFunction("main");
+  IRFunction M(F);
+  {
+    IRBuilder builder(&M);
+    auto *in = builder.createWeightVar(ElemKind::FloatTy, {1, 24, 24, 3});
+    auto *out = builder.createWeightVar(ElemKind::FloatTy, {1, 12, 12, 64});
+    auto *filter = builder.createWeightVar(ElemKind::FloatTy, {64, 7, 7, 3});
+    auto *bias = builder.createWeightVar(ElemKind::FloatTy, {64});
+    auto *conv = builder.createConvolutionInst("", out, in, filter, bias, 7, 2,
+                                               {3, 3, 3, 3}, 1);
+    // Every output element is the dot product of 7 * 7 * 3 values.
+    EXPECT_EQ(estimateFLOPs(conv), 2 * 12 * 12 * 64 * 7 * 7 * 3);
+
+    auto *lhs = builder.createWeightVar(ElemKind::FloatTy, {10, 20});
+    auto *rhs = builder.createWeightVar(ElemKind::FloatTy, {20, 30});
+    auto *dest = builder.createWeightVar(ElemKind::FloatTy, {10, 30});
+    auto *matmul = builder.createMatMulInst("", dest, lhs, rhs);
+    EXPECT_EQ(estimateFLOPs(matmul), 2 * 10 * 30 * 20);
+    EXPECT_EQ(getOperandsSizeInBytes(matmul),
+              (10 * 20 + 20 * 30 + 10 * 30) * sizeof(float));
+
+    auto *copy = builder.createCopyInst("", lhs, lhs);
+    EXPECT_EQ(estimateFLOPs(copy), 0);
+    auto *mul = builder.createElementMulInst("", dest, dest, dest);
+    EXPECT_EQ(estimateFLOPs(mul), 10 * 30);
+  }
+}
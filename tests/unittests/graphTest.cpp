@@ -366,6 +366,157 @@ TEST(Graph, cloneTest2) {
   EXPECT_EQ(newF->getParent(), F->getParent());
 }
 
+TEST(Graph, cloneWithBatchSize) {
+  Module M;
+
+  auto *F = M.createFunction("main");
+  auto *K = M.createVariable(ElemKind::FloatTy, {4, 32, 20, 3}, "input",
+                             VisibilityKind::Public);
+  auto *S = M.createVariable(ElemKind::IndexTy, {4, 1}, "select",
+                             VisibilityKind::Public);
+  auto *conv = F->createConv("Conv1", K, 16, 3, 2, 3, 1);
+  Node *relu = F->createRELU("Relu", conv);
+  Node *reshape = F->createReshape("reshape", relu, {4, 18 * 12 * 16});
+  Node *FC = F->createFullyConnected("fc", reshape, 10);
+  Node *SM = F->createSoftMax("SoftMax", FC, S);
+  auto *save = F->createSave("Save", SM);
+
+  llvm::DenseMap<Variable *, Variable *> varMap;
+  auto *newF = F->cloneWithBatchSize("main_b1", {K, S}, 1, &varMap);
+  ASSERT_TRUE(newF);
+  EXPECT_EQ(newF->getNodes().size(), F->getNodes().size());
+
+  // The public variables with the batch dimension are replaced.
+  ASSERT_EQ(varMap.size(), 3);
+  EXPECT_EQ(varMap[K]->dims(), llvm::ArrayRef<size_t>({1, 32, 20, 3}));
+  EXPECT_EQ(varMap[S]->dims(), llvm::ArrayRef<size_t>({1, 1}));
+  EXPECT_EQ(varMap[save->getVariable()]->dims(),
+            llvm::ArrayRef<size_t>({1, 10}));
+
+  // The weights are shared, and the original function is not modified.
+  for (auto &N : newF->getNodes()) {
+    if (auto *newConv = llvm::dyn_cast<ConvolutionNode>(&N)) {
+      EXPECT_EQ(newConv->getFilter().getNode(), conv->getFilter().getNode());
+      EXPECT_EQ(newConv->getInput().getNode(), varMap[K]);
+      EXPECT_EQ(newConv->getResult().dims()[0], 1);
+    }
+    if (auto *newReshape = llvm::dyn_cast<ReshapeNode>(&N)) {
+      EXPECT_EQ(newReshape->getDims(),
+                llvm::ArrayRef<size_t>({1, 18 * 12 * 16}));
+    }
+  }
+  EXPECT_EQ(conv->getInput().getNode(), K);
+  EXPECT_EQ(conv->getResult().dims()[0], 4);
+  F->verify();
+}
+
+/// Check that the batch dimension is followed through the nodes that move it
+/// or that have members with the batch size.
+TEST(Graph, cloneWithBatchSizeShapes) {
+  Module M;
+
+  auto *F = M.createFunction("main");
+  auto *X = M.createVariable(ElemKind::FloatTy, {4, 16}, "input",
+                             VisibilityKind::Public);
+  auto *slice = F->createSlice("slice", X, {0, 2}, {4, 10});
+  auto *tile = F->createTile("tile", slice, 2, 1);
+  auto *concat = F->createConcat("concat", {tile, X}, 1);
+  auto *reshape = F->createReshape("reshape", concat, {4, 2, 16});
+  auto *transpose = F->createTranspose("transpose", reshape, {1, 0, 2});
+  auto *reduce = F->createBatchedReduceAdd("reduce", transpose, 0);
+  auto *save = F->createSave("save", reduce);
+
+  llvm::DenseMap<Variable *, Variable *> varMap;
+  auto *newF = F->cloneWithBatchSize("main_b3", {X}, 3, &varMap);
+  ASSERT_TRUE(newF);
+  EXPECT_EQ(newF->getNodes().size(), F->getNodes().size());
+  ASSERT_EQ(varMap.size(), 2);
+  EXPECT_EQ(varMap[save->getVariable()]->dims(),
+            llvm::ArrayRef<size_t>({3, 16}));
+
+  for (auto &N : newF->getNodes()) {
+    if (auto *newSlice = llvm::dyn_cast<SliceNode>(&N)) {
+      EXPECT_EQ(newSlice->getResult().dims(), llvm::ArrayRef<size_t>({3, 8}));
+      EXPECT_EQ(newSlice->getStart(), llvm::ArrayRef<size_t>({0, 2}));
+    }
+    if (auto *splat = llvm::dyn_cast<SplatNode>(&N)) {
+      EXPECT_EQ(splat->getResult().dims(), llvm::ArrayRef<size_t>({3, 16}));
+    }
+    if (auto *newConcat = llvm::dyn_cast<ConcatNode>(&N)) {
+      EXPECT_EQ(newConcat->getResult().dims(), llvm::ArrayRef<size_t>({3, 32}));
+    }
+    if (auto *newReshape = llvm::dyn_cast<ReshapeNode>(&N)) {
+      EXPECT_EQ(newReshape->getDims(), llvm::ArrayRef<size_t>({3, 2, 16}));
+    }
+    if (auto *newTranspose = llvm::dyn_cast<TransposeNode>(&N)) {
+      EXPECT_EQ(newTranspose->getResult().dims(),
+                llvm::ArrayRef<size_t>({2, 3, 16}));
+    }
+  }
+  EXPECT_EQ(tile->getResult().dims(), llvm::ArrayRef<size_t>({4, 16}));
+  F->verify();
+}
+
+/// Check that the variables that are not derived from the batched inputs keep
+/// their shape, even if their first dimension is equal to the batch size.
+TEST(Graph, cloneWithBatchSizeConstants) {
+  Module M;
+
+  auto *F = M.createFunction("main");
+  auto *X = M.createVariable(ElemKind::FloatTy, {4, 4}, "input",
+                             VisibilityKind::Public);
+  auto *W = M.createVariable(ElemKind::FloatTy, {4, 4}, "weights",
+                             VisibilityKind::Private);
+  auto *B = M.createVariable(ElemKind::FloatTy, {4}, "bias",
+                             VisibilityKind::Private);
+  auto *C = M.createVariable(ElemKind::FloatTy, {4, 4}, "matrix",
+                             VisibilityKind::Public);
+  auto *FC = F->createFullyConnected("fc", X, W, B);
+  auto *MM = F->createMatMul("matmul", FC, C);
+  auto *save = F->createSave("save", MM);
+
+  llvm::DenseMap<Variable *, Variable *> varMap;
+  auto *newF = F->cloneWithBatchSize("main_b2", {X}, 2, &varMap);
+  ASSERT_TRUE(newF);
+  ASSERT_EQ(varMap.size(), 2);
+  EXPECT_TRUE(varMap.count(X));
+  EXPECT_TRUE(varMap.count(save->getVariable()));
+  EXPECT_EQ(C->dims(), llvm::ArrayRef<size_t>({4, 4}));
+
+  for (auto &N : newF->getNodes()) {
+    if (auto *newFC = llvm::dyn_cast<FullyConnectedNode>(&N)) {
+      EXPECT_EQ(newFC->getWeights().getNode(), W);
+      EXPECT_EQ(newFC->getResult().dims(), llvm::ArrayRef<size_t>({2, 4}));
+    }
+    if (auto *newMM = llvm::dyn_cast<MatMulNode>(&N)) {
+      EXPECT_EQ(newMM->getRHS().getNode(), C);
+      EXPECT_EQ(newMM->getResult().dims(), llvm::ArrayRef<size_t>({2, 4}));
+    }
+  }
+}
+
+/// Check that the functions that mix the samples of the batch are not cloned,
+/// and that nothing is added to the module for them.
+TEST(Graph, cloneWithBatchSizeUnsupported) {
+  Module M;
+
+  auto *F = M.createFunction("main");
+  auto *X = M.createVariable(ElemKind::FloatTy, {4, 8}, "input",
+                             VisibilityKind::Public);
+  auto *relu = F->createRELU("relu", X);
+  F->createSave("save", F->createBatchedReduceAdd("reduce", relu, 0));
+  size_t numVars = M.getVars().size();
+
+  llvm::DenseMap<Variable *, Variable *> varMap;
+  EXPECT_EQ(F->cloneWithBatchSize("main_b2", {X}, 2, &varMap), nullptr);
+  EXPECT_TRUE(varMap.empty());
+  EXPECT_EQ(M.getFunctions().size(), 1);
+  EXPECT_FALSE(M.hasFunction("main_b2"));
+  EXPECT_EQ(M.getVars().size(), numVars);
+  EXPECT_EQ(relu->getResult().dims(), llvm::ArrayRef<size_t>({4, 8}));
+  F->verify();
+}
+
 TEST(Graph, NodeValue) {
   ExecutionEngine EE;
   auto &mod = EE.getModule();
@@ -0,0 +1,226 @@
+/**
+ * Copyright (c) 2017-present, Facebook, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "glow/Base/Tensor.h"
+#include "glow/Support/Memory.h"
+
+#include "gtest/gtest.h"
+
+#include "onnx.pb.h"
+#include "onnx/onnxifi.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace glow;
+
+namespace {
+/// The shape of the tensors of the test models.
+const uint64_t shape[] = {4, 4};
+constexpr size_t numElements = 16;
+
+/// Add a float tensor of the test shape named \p name to \p values.
+void addValue(google::protobuf::RepeatedPtrField<onnx::ValueInfoProto> *values,
+              const std::string &name) {
+  auto *value = values->Add();
+  value->set_name(name);
+  auto *type = value->mutable_type()->mutable_tensor_type();
+  type->set_elem_type(onnx::TensorProto::FLOAT);
+  for (auto dim : shape) {
+    type->mutable_shape()->add_dim()->set_dim_value(dim);
+  }
+}
+
+/// \returns the serialized model of y = \p opType(Add(x, w)), where x is an
+/// input and w is a weight.
+std::string createModel(const std::string &opType) {
+  onnx::ModelProto model;
+  model.set_ir_version(3);
+  model.add_opset_import()->set_version(7);
+  auto *graph = model.mutable_graph();
+  graph->set_name("test");
+
+  auto *add = graph->add_node();
+  add->set_op_type("Add");
+  add->set_name("add");
+  add->add_input("x");
+  add->add_input("w");
+  add->add_output("sum");
+  auto *op = graph->add_node();
+  op->set_op_type(opType);
+  op->set_name("op");
+  op->add_input("sum");
+  op->add_output("y");
+
+  addValue(graph->mutable_input(), "x");
+  addValue(graph->mutable_input(), "w");
+  addValue(graph->mutable_output(), "y");
+
+  std::string str;
+  model.SerializeToString(&str);
+  return str;
+}
+
+/// \returns a descriptor of the float tensor \p name of the test shape whose
+/// data is at \p buffer.
+onnxTensorDescriptorV1 createDescriptor(const char *name, float *buffer) {
+  onnxTensorDescriptorV1 desc;
+  desc.tag = ONNXIFI_TAG_TENSOR_DESCRIPTOR_V1;
+  desc.name = name;
+  desc.dataType = ONNXIFI_DATATYPE_FLOAT32;
+  desc.memoryType = ONNXIFI_MEMORY_TYPE_CPU;
+  desc.dimensions = 2;
+  desc.shape = shape;
+  desc.buffer = reinterpret_cast<onnxPointer>(buffer);
+  return desc;
+}
+
+/// Creates the Glow backend for the tests.
+class OnnxifiTest : public ::testing::Test {
+public:
+  void SetUp() override {
+    size_t numBackends = 1;
+    ASSERT_EQ(onnxGetBackendIDs(&backendID_, &numBackends),
+              ONNXIFI_STATUS_SUCCESS);
+    ASSERT_EQ(onnxInitBackend(backendID_, nullptr, &backend_),
+              ONNXIFI_STATUS_SUCCESS);
+
+    for (size_t i = 0; i < numElements; i++) {
+      weight_[i] = float(i) - 8;
+    }
+  }
+
+  void TearDown() override {
+    EXPECT_EQ(onnxReleaseBackend(backend_), ONNXIFI_STATUS_SUCCESS);
+    EXPECT_EQ(onnxReleaseBackendID(backendID_), ONNXIFI_STATUS_SUCCESS);
+  }
+
+protected:
+  onnxBackendID backendID_{nullptr};
+  onnxBackend backend_{nullptr};
+  /// The data of the weight w.
+  float weight_[numElements];
+
+  /// Initialize \p graph with the model of \p opType and the weight w.
+  onnxStatus initGraph(const std::string &opType, onnxGraph *graph) {
+    auto model = createModel(opType);
+    auto weight = createDescriptor("w", weight_);
+    return onnxInitGraph(backend_, model.size(), model.data(), 1, &weight,
+                         graph);
+  }
+
+  /// Bind \p x and \p y to the graph \p graph, fill \p x, run the graph and
+  /// check that \p y holds the outputs.
+  void runGraph(onnxGraph graph, float *x, float *y) {
+    for (size_t i = 0; i < numElements; i++) {
+      x[i] = float(i) / 2;
+      y[i] = -1;
+    }
+    auto input = createDescriptor("x", x);
+    auto output = createDescriptor("y", y);
+    ASSERT_EQ(onnxSetGraphIO(graph, 1, &input, 1, &output),
+              ONNXIFI_STATUS_SUCCESS);
+
+    onnxMemoryFenceV1 inputFence;
+    inputFence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
+    inputFence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
+    ASSERT_EQ(onnxInitEvent(backend_, &inputFence.event),
+              ONNXIFI_STATUS_SUCCESS);
+    onnxMemoryFenceV1 outputFence;
+    outputFence.tag = ONNXIFI_TAG_MEMORY_FENCE_V1;
+    outputFence.type = ONNXIFI_SYNCHRONIZATION_EVENT;
+    outputFence.event = nullptr;
+
+    ASSERT_EQ(onnxRunGraph(graph, &inputFence, &outputFence),
+              ONNXIFI_STATUS_SUCCESS);
+    ASSERT_NE(outputFence.event, nullptr);
+    EXPECT_EQ(onnxSignalEvent(inputFence.event), ONNXIFI_STATUS_SUCCESS);
+    EXPECT_EQ(onnxWaitEvent(outputFence.event), ONNXIFI_STATUS_SUCCESS);
+    EXPECT_EQ(onnxReleaseEvent(inputFence.event), ONNXIFI_STATUS_SUCCESS);
+    EXPECT_EQ(onnxReleaseEvent(outputFence.event), ONNXIFI_STATUS_SUCCESS);
+
+    for (size_t i = 0; i < numElements; i++) {
+      EXPECT_EQ(y[i], std::max(x[i] + weight_[i], 0.0f));
+    }
+  }
+};
+} // namespace
+
+/// Run a graph with one buffer that is aligned like the tensors of Glow and
+/// is used in place, and one misaligned buffer that is copied.
+TEST_F(OnnxifiTest, runGraph) {
+  onnxGraph graph{nullptr};
+  ASSERT_EQ(initGraph("Relu", &graph), ONNXIFI_STATUS_SUCCESS);
+  ASSERT_NE(graph, nullptr);
+
+  Tensor aligned(ElemKind::FloatTy, {numElements});
+  auto *alignedPtr = reinterpret_cast<float *>(aligned.getUnsafePtr());
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(alignedPtr) % TensorAlignment, 0);
+  std::vector<float> misaligned(numElements + 1);
+  auto *misalignedPtr = misaligned.data() + 1;
+  ASSERT_NE(reinterpret_cast<uintptr_t>(misalignedPtr) % TensorAlignment, 0);
+
+  // The aligned buffer is the input and the misaligned one the output, and
+  // then the other way round.
+  runGraph(graph, alignedPtr, misalignedPtr);
+  runGraph(graph, misalignedPtr, alignedPtr);
+
+  EXPECT_EQ(onnxReleaseGraph(graph), ONNXIFI_STATUS_SUCCESS);
+}
+
+/// Check that the buffers are bound by name and checked against the graph.
+TEST_F(OnnxifiTest, setGraphIOErrors) {
+  onnxGraph graph{nullptr};
+  ASSERT_EQ(initGraph("Relu", &graph), ONNXIFI_STATUS_SUCCESS);
+
+  float x[numElements];
+  float y[numElements];
+  auto input = createDescriptor("x", x);
+  auto output = createDescriptor("z", y);
+  EXPECT_EQ(onnxSetGraphIO(graph, 1, &input, 1, &output),
+            ONNXIFI_STATUS_UNIDENTIFIED_NAME);
+
+  const uint64_t otherShape[] = {2, 8};
+  output = createDescriptor("y", y);
+  output.shape = otherShape;
+  EXPECT_EQ(onnxSetGraphIO(graph, 1, &input, 1, &output),
+            ONNXIFI_STATUS_MISMATCHING_SHAPE);
+
+  EXPECT_EQ(onnxReleaseGraph(graph), ONNXIFI_STATUS_SUCCESS);
+}
+
+/// Check that a model with an unsupported operator is rejected and that no
+/// graph is returned for it.
+TEST_F(OnnxifiTest, initGraphUnsupportedOperator) {
+  onnxGraph graph{nullptr};
+  EXPECT_EQ(initGraph("NoSuchOperator", &graph),
+            ONNXIFI_STATUS_UNSUPPORTED_OPERATOR);
+  EXPECT_EQ(graph, nullptr);
+}
+
+/// Check that a weight of an unsupported type is rejected.
+TEST_F(OnnxifiTest, initGraphUnsupportedDatatype) {
+  auto model = createModel("Relu");
+  auto weight = createDescriptor("w", weight_);
+  weight.dataType = ONNXIFI_DATATYPE_UINT8;
+  onnxGraph graph{nullptr};
+  EXPECT_EQ(onnxInitGraph(backend_, model.size(), model.data(), 1, &weight,
+                          &graph),
+            ONNXIFI_STATUS_UNSUPPORTED_DATATYPE);
+  EXPECT_EQ(graph, nullptr);
+}
@@ -292,6 +292,24 @@ TEST(Tensor, copySlice) {
   }
 }
 
+TEST(Tensor, copyToSlice) {
+  PseudoRNG PRNG;
+  Tensor A(ElemKind::FloatTy, {10, 5, 3});
+  Tensor B(ElemKind::FloatTy, {5, 3});
+  Tensor C(ElemKind::FloatTy, {5, 3});
+
+  A.zero();
+  B.getHandle<>().randomize(-2.0, 2.0, PRNG);
+
+  A.copyToSlice(&B, 7);
+  C.copySlice(&A, 7);
+  EXPECT_TRUE(B.isEqual(C));
+
+  // The other slices are untouched.
+  C.copySlice(&A, 6);
+  EXPECT_TRUE(C.getHandle<>().isZero());
+}
+
 TEST(Tensor, reset) {
   Tensor A(ElemKind::FloatTy, {2, 3});
   Tensor QA(ElemKind::Int8QTy, {3, 4}, 2.2, 7);
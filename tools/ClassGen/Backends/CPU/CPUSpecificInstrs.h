@@ -34,6 +34,48 @@ BB.newBackendSpecificInstr("CPUConvDKKC8")
     .addMember(MemberType::SizeT, "Group")
     .autoIRGen();
 
+BB.newBackendSpecificInstr("CPUQuantizedConv")
+    .addOperand("Dest", OperandKind::Out)
+    .addOperand("Src", OperandKind::In)
+    .addOperand("Filter", OperandKind::In)
+    .addOperand("Bias", OperandKind::In)
+    .addMember(MemberType::SizeT, "Kernel")
+    .addMember(MemberType::SizeT, "Stride")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addMember(MemberType::SizeT, "Group")
+    .autoIRGen();
+
+BB.newBackendSpecificInstr("CPUWinogradConv")
+    .addOperand("Dest", OperandKind::Out)
+    .addOperand("Src", OperandKind::In)
+    .addOperand("Filter", OperandKind::In)
+    .addOperand("Bias", OperandKind::In)
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addMember(MemberType::SizeT, "Group")
+    .addMember(MemberType::SizeT, "TileSize")
+    .autoIRGen();
+
+BB.newBackendSpecificInstr("CPUConvGEMM")
+    .addOperand("Dest", OperandKind::Out)
+    .addOperand("Src", OperandKind::In)
+    .addOperand("Filter", OperandKind::In)
+    .addOperand("Bias", OperandKind::In)
+    .addMember(MemberType::SizeT, "Kernel")
+    .addMember(MemberType::SizeT, "Stride")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addMember(MemberType::SizeT, "Group")
+    .autoIRGen();
+
+BB.newBackendSpecificInstr("CPUDepthwiseConv")
+    .addOperand("Dest", OperandKind::Out)
+    .addOperand("Src", OperandKind::In)
+    .addOperand("Filter", OperandKind::In)
+    .addOperand("Bias", OperandKind::In)
+    .addMember(MemberType::SizeT, "Kernel")
+    .addMember(MemberType::SizeT, "Stride")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .autoIRGen();
+
 BB.includeBackendSpecificVerification("glow/CPUSpecificInstrsVerification.h");
 
 #endif // GLOW_WITH_CPU
@@ -33,4 +33,60 @@ void CPUConvDKKC8Inst::verify() const {
          "Invalid Element Type");
 }
 
+void CPUQuantizedConvInst::verify() const {
+  assert(getSrc()->dims()[3] % getGroup() == 0 &&
+         "Input channels must be divisible by group.");
+  assert(getDest()->dims()[3] % getGroup() == 0 &&
+         "Output channels must be divisible by group.");
+  assert(getDest()->getElementType() == ElemKind::Int8QTy &&
+         "Invalid Element Type");
+  assert(getSrc()->getElementType() == ElemKind::Int8QTy &&
+         "Invalid Element Type");
+  assert(getFilter()->getElementType() == ElemKind::Int8QTy &&
+         "Invalid Element Type");
+  assert(getBias()->getElementType() == ElemKind::Int8QTy &&
+         "Invalid Element Type");
+}
+
+void CPUWinogradConvInst::verify() const {
+  assert(getSrc()->dims()[3] % getGroup() == 0 &&
+         "Input channels must be divisible by group.");
+  assert(getDest()->dims()[3] % getGroup() == 0 &&
+         "Output channels must be divisible by group.");
+  assert(getDest()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getSrc()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getFilter()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getBias()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+}
+
+void CPUConvGEMMInst::verify() const {
+  assert(getSrc()->dims()[3] % getGroup() == 0 &&
+         "Input channels must be divisible by group.");
+  assert(getDest()->dims()[3] % getGroup() == 0 &&
+         "Output channels must be divisible by group.");
+  assert(getDest()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getSrc()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getFilter()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+  assert(getBias()->getElementType() == ElemKind::FloatTy &&
+         "Invalid Element Type");
+}
+
+void CPUDepthwiseConvInst::verify() const {
+  assert(getDest()->dims()[3] % getSrc()->dims()[3] == 0 &&
+         "Output channels must be divisible by input channels.");
+  assert(getDest()->getElementType() == getSrc()->getElementType() &&
+         "Invalid Element Type");
+  assert(getDest()->getElementType() == getFilter()->getElementType() &&
+         "Invalid Element Type");
+  assert(getDest()->getElementType() == getBias()->getElementType() &&
+         "Invalid Element Type");
+}
+
 #endif // GLOW_WITH_CPU
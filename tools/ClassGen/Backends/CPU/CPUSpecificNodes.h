@@ -33,6 +33,57 @@ BB.newNode("CPUConvDKKC8")
     .setDocstring("This is a cpu-specific convolution implementation where the "
                   "filter is transposed to the shape [D/8, K, K, C, 8]");
 
+BB.newNode("CPUQuantizedConv")
+    .addInput("Input")
+    .addInput("Filter")
+    .addInput("Bias")
+    .addMember(MemberType::SizeT, "Kernel")
+    .addMember(MemberType::SizeT, "Stride")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addMember(MemberType::SizeT, "Group")
+    .addResultFromCtorArg()
+    .setDocstring("This is a cpu-specific quantized convolution where the "
+                  "filter is packed to the shape [D/16, K, K, C/2, 16, 2]");
+
+BB.newNode("CPUWinogradConv")
+    .addInput("Input")
+    .addInput("Filter")
+    .addInput("Bias")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addMember(MemberType::SizeT, "Group")
+    .addMember(MemberType::SizeT, "TileSize")
+    .addResultFromCtorArg()
+    .setDocstring("This is a cpu-specific Winograd convolution of a 3x3 "
+                  "filter with stride 1, which computes tiles of "
+                  "TileSize x TileSize pixels. The filter is transformed to "
+                  "the shape [G, A * A, D/16, C, 16], where A = TileSize + 2");
+
+BB.newNode("CPUConvGEMM")
+    .addInput("Input")
+    .addInput("Filter")
+    .addInput("Bias")
+    .addMember(MemberType::SizeT, "Kernel")
+    .addMember(MemberType::SizeT, "Stride")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addMember(MemberType::SizeT, "Group")
+    .addResultFromCtorArg()
+    .setDocstring("This is a cpu-specific convolution that is computed as a "
+                  "matrix multiplication of the input patches (im2col) with "
+                  "the filter, which is transposed to the shape [G, K, K, C, "
+                  "D/G]");
+
+BB.newNode("CPUDepthwiseConv")
+    .addInput("Input")
+    .addInput("Filter")
+    .addInput("Bias")
+    .addMember(MemberType::SizeT, "Kernel")
+    .addMember(MemberType::SizeT, "Stride")
+    .addMember(MemberType::VectorSizeT, "Pads")
+    .addResultFromCtorArg()
+    .setDocstring("This is a cpu-specific depthwise convolution, whose group "
+                  "is the number of input channels. The filter is transposed "
+                  "to the shape [K, K, D]");
+
 BB.includeBackendSpecificVerification("glow/CPUSpecificNodesVerification.h");
 
 #endif // GLOW_WITH_CPU
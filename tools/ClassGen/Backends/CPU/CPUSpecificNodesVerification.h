@@ -30,4 +30,50 @@ void CPUConvDKKC8Node::verify() const {
   assert(exp == odim && "Invalid output dimensions");
 }
 
+void CPUQuantizedConvNode::verify() const {
+  ShapeNHWC idim(getInput().getType()->dims());
+  ShapeNHWC odim(getResult().getType()->dims());
+  auto outSz = calculateConvPoolOutputDims(idim.h, idim.w, getKernel(),
+                                           getStride(), getPads());
+  ShapeNHWC exp(idim.n, outSz.first, outSz.second, getBias().dims()[0]);
+  (void)exp;
+  assert(exp == odim && "Invalid output dimensions");
+  assert(getFilter().dims().size() == 6 && "Invalid filter layout");
+}
+
+void CPUWinogradConvNode::verify() const {
+  ShapeNHWC idim(getInput().getType()->dims());
+  ShapeNHWC odim(getResult().getType()->dims());
+  // The filter is always 3x3 and the stride is 1.
+  auto outSz = calculateConvPoolOutputDims(idim.h, idim.w, 3, 1, getPads());
+  ShapeNHWC exp(idim.n, outSz.first, outSz.second, getBias().dims()[0]);
+  (void)exp;
+  assert(exp == odim && "Invalid output dimensions");
+  assert((getTileSize() == 2 || getTileSize() == 4) && "Invalid tile size");
+  assert(getFilter().dims().size() == 5 && "Invalid filter layout");
+}
+
+void CPUConvGEMMNode::verify() const {
+  ShapeNHWC idim(getInput().getType()->dims());
+  ShapeNHWC odim(getResult().getType()->dims());
+  auto outSz = calculateConvPoolOutputDims(idim.h, idim.w, getKernel(),
+                                           getStride(), getPads());
+  ShapeNHWC exp(idim.n, outSz.first, outSz.second, getBias().dims()[0]);
+  (void)exp;
+  assert(exp == odim && "Invalid output dimensions");
+  assert(getFilter().dims().size() == 5 && "Invalid filter layout");
+}
+
+void CPUDepthwiseConvNode::verify() const {
+  ShapeNHWC idim(getInput().getType()->dims());
+  ShapeNHWC odim(getResult().getType()->dims());
+  auto outSz = calculateConvPoolOutputDims(idim.h, idim.w, getKernel(),
+                                           getStride(), getPads());
+  ShapeNHWC exp(idim.n, outSz.first, outSz.second, getBias().dims()[0]);
+  (void)exp;
+  assert(exp == odim && "Invalid output dimensions");
+  assert(odim.c % idim.c == 0 && "Invalid channel multiplier");
+  assert(getFilter().dims().size() == 3 && "Invalid filter layout");
+}
+
 #endif // GLOW_WITH_CPU
@@ -20,6 +20,8 @@
 #include "glow/ExecutionEngine/ExecutionEngine.h"
 #include "glow/IR/IR.h"
 #include "glow/Quantization/Serialization.h"
+#include "glow/Support/Compiler.h"
+#include "glow/Support/Support.h"
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FileSystem.h"
@@ -27,6 +29,13 @@
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 using namespace glow;
 
 namespace {
@@ -91,6 +100,33 @@ llvm::cl::opt<BackendKind> ExecutionBackend(
                      clEnumValN(BackendKind::OpenCL, "opencl", "Use OpenCL")),
     llvm::cl::init(BackendKind::Interpreter), llvm::cl::cat(loaderCat));
 
+llvm::cl::OptionCategory benchmarkCat("Benchmark Options");
+
+llvm::cl::opt<bool> benchmarkOpt(
+    "benchmark",
+    llvm::cl::desc("Measure the latency and the throughput of the inference. "
+                   "Every thread runs -warmup iterations, and then "
+                   "-iterations timed iterations"),
+    llvm::cl::Optional, llvm::cl::cat(benchmarkCat));
+
+llvm::cl::opt<unsigned> warmupOpt(
+    "warmup",
+    llvm::cl::desc("Number of iterations that every thread runs before the "
+                   "timed iterations in the benchmark mode"),
+    llvm::cl::Optional, llvm::cl::init(10), llvm::cl::cat(benchmarkCat));
+
+llvm::cl::opt<unsigned> benchmarkThreadsOpt(
+    "benchmark-threads",
+    llvm::cl::desc("Number of threads that run the inference concurrently in "
+                   "the benchmark mode, each with its own execution context"),
+    llvm::cl::Optional, llvm::cl::init(1), llvm::cl::cat(benchmarkCat));
+
+llvm::cl::opt<std::string> benchmarkJSONOpt(
+    "benchmark-json",
+    llvm::cl::desc("Write the results of the benchmark mode to this file"),
+    llvm::cl::value_desc("file.json"), llvm::cl::Optional,
+    llvm::cl::cat(benchmarkCat));
+
 /// Debugging options.
 llvm::cl::OptionCategory
     modelExportCat("How to export the Glow Intermediate Representation/Graphs",
@@ -123,9 +159,43 @@ static bool commandLineIsInvalid() {
                  << " options may not be specified together.\n";
     return true;
   }
+  if (benchmarkOpt && !dumpProfileFileOpt.empty()) {
+    // The profiling runs update the private variables of the function, so
+    // they can't run concurrently and would distort the timings.
+    llvm::errs() << "Loader: the -" << benchmarkOpt.ArgStr << " and -"
+                 << dumpProfileFileOpt.ArgStr
+                 << " options may not be specified together.\n";
+    return true;
+  }
+  if (benchmarkOpt && (benchmarkThreadsOpt == 0 || iterationsOpt == 0)) {
+    llvm::errs() << "Loader: the -" << benchmarkThreadsOpt.ArgStr << " and -"
+                 << iterationsOpt.ArgStr << " options must be positive.\n";
+    return true;
+  }
   return false;
 }
 
+/// \returns the name of the backend \p kind.
+static const char *getBackendName(BackendKind kind) {
+  switch (kind) {
+  case BackendKind::Interpreter:
+    return "interpreter";
+  case BackendKind::CPU:
+    return "cpu";
+  case BackendKind::OpenCL:
+    return "opencl";
+  }
+  llvm_unreachable("Unknown backend kind");
+}
+
+/// \returns the \p p-th percentile (0 < p <= 1) of the values \p sorted,
+/// which are sorted in ascending order, using the nearest-rank method.
+static double getPercentile(llvm::ArrayRef<double> sorted, double p) {
+  assert(!sorted.empty() && "No values");
+  size_t rank = std::ceil(p * sorted.size());
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
 void Loader::compile() {
   // Handle the request to profile the graph in preperation for quantization.
   if (!dumpProfileFileOpt.empty()) {
@@ -179,18 +249,25 @@ void Loader::runInference(llvm::ArrayRef<Variable *> variables,
   assert(!emittingBundle() &&
          "No inference is performed in the bundle generation mode.");
 
+  if (benchmarkOpt) {
+    runBenchmark(variables, tensors);
+  }
+
+  // The benchmark has run the timed iterations already, and a single run
+  // produces the results of the model.
+  unsigned numIterations = benchmarkOpt ? 1 : unsigned(iterationsOpt);
   llvm::Timer timer("Infer", "Infer");
   if (timeOpt) {
     timer.startTimer();
   }
-  for (unsigned i = 0; i < iterationsOpt; i++) {
+  for (unsigned i = 0; i < numIterations; i++) {
     EE_.run(variables, tensors);
   }
   if (timeOpt) {
     timer.stopTimer();
     llvm::outs() << llvm::formatv("Wall time per iteration (s): {0:f4}\n",
                                   timer.getTotalTime().getWallTime() /
-                                      iterationsOpt);
+                                      numIterations);
   }
 
   if (!dumpProfileFileOpt.empty()) {
@@ -200,6 +277,123 @@ void Loader::runInference(llvm::ArrayRef<Variable *> variables,
   }
 }
 
+void Loader::runBenchmark(llvm::ArrayRef<Variable *> variables,
+                          llvm::ArrayRef<Tensor *> tensors) {
+  using Clock = std::chrono::steady_clock;
+  unsigned numThreads = benchmarkThreadsOpt;
+  unsigned numIterations = iterationsOpt;
+
+  // The latencies of the timed iterations of every thread, in milliseconds.
+  std::vector<std::vector<double>> latencies(numThreads);
+  // The threads wait for each other after the warmup, so that the timed
+  // iterations of all of the threads overlap.
+  std::mutex mutex;
+  std::condition_variable cv;
+  unsigned numReady = 0;
+  Clock::time_point start;
+
+  auto worker = [&](unsigned id) {
+    auto ctx = EE_.createExecutionContext();
+    for (unsigned i = 0; i < warmupOpt; i++) {
+      EE_.run(*ctx, variables, tensors);
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (++numReady == numThreads) {
+        start = Clock::now();
+        cv.notify_all();
+      } else {
+        cv.wait(lock, [&] { return numReady == numThreads; });
+      }
+    }
+    auto &threadLatencies = latencies[id];
+    threadLatencies.reserve(numIterations);
+    for (unsigned i = 0; i < numIterations; i++) {
+      auto begin = Clock::now();
+      EE_.run(*ctx, variables, tensors);
+      auto end = Clock::now();
+      threadLatencies.push_back(
+          std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < numThreads; i++) {
+    threads.emplace_back(worker, i);
+  }
+  worker(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  double wallTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> sorted;
+  for (const auto &threadLatencies : latencies) {
+    sorted.insert(sorted.end(), threadLatencies.begin(),
+                  threadLatencies.end());
+  }
+  std::sort(sorted.begin(), sorted.end());
+  double mean = 0;
+  for (auto latency : sorted) {
+    mean += latency;
+  }
+  mean /= sorted.size();
+
+  // Every inference processes the whole batch of the first input.
+  size_t batchSize = tensors.empty() ? 1 : tensors[0]->dims()[0];
+  double throughput = sorted.size() / wallTime;
+  std::pair<const char *, double> percentiles[] = {{"p50", 0.5},
+                                                   {"p90", 0.9},
+                                                   {"p99", 0.99},
+                                                   {"p999", 0.999}};
+
+  llvm::outs() << llvm::formatv("Benchmark: {0} thread(s), {1} warmup and {2} "
+                                "timed iterations per thread\n",
+                                numThreads, unsigned(warmupOpt), numIterations);
+  llvm::outs() << llvm::formatv("Latency (ms): min {0:f3}, mean {1:f3}",
+                                sorted.front(), mean);
+  for (const auto &p : percentiles) {
+    llvm::outs() << llvm::formatv(", {0} {1:f3}", p.first,
+                                  getPercentile(sorted, p.second));
+  }
+  llvm::outs() << llvm::formatv(", max {0:f3}\n", sorted.back());
+  llvm::outs() << llvm::formatv("Throughput: {0:f2} inferences/s, {1:f2} "
+                                "samples/s (batch size {2})\n",
+                                throughput, throughput * batchSize, batchSize);
+
+  if (benchmarkJSONOpt.empty()) {
+    return;
+  }
+  std::error_code EC;
+  llvm::raw_fd_ostream os(benchmarkJSONOpt, EC, llvm::sys::fs::F_Text);
+  GLOW_ASSERT(!EC && "Unable to open the benchmark output file");
+  os << "{\n";
+  os << "  \"model\": ";
+  writeJSONString(os, modelPathOpt[0]);
+  os << ",\n";
+  os << "  \"backend\": ";
+  writeJSONString(os, getBackendName(ExecutionBackend));
+  os << ",\n";
+  os << "  \"quantized\": " << (loadProfileFileOpt.empty() ? "false" : "true")
+     << ",\n";
+  os << "  \"batch_size\": " << batchSize << ",\n";
+  os << "  \"threads\": " << numThreads << ",\n";
+  os << "  \"warmup_iterations\": " << warmupOpt << ",\n";
+  os << "  \"iterations\": " << numIterations << ",\n";
+  os << "  \"latency_ms\": {";
+  os << llvm::formatv("\"min\": {0:f4}, \"mean\": {1:f4}", sorted.front(),
+                      mean);
+  for (const auto &p : percentiles) {
+    os << llvm::formatv(", \"{0}\": {1:f4}", p.first,
+                        getPercentile(sorted, p.second));
+  }
+  os << llvm::formatv(", \"max\": {0:f4}", sorted.back()) << "},\n";
+  os << llvm::formatv("  \"inferences_per_second\": {0:f3},\n", throughput);
+  os << llvm::formatv("  \"samples_per_second\": {0:f3}\n",
+                      throughput * batchSize);
+  os << "}\n";
+}
+
 Loader::Loader(int argc, char **argv) {
   llvm::cl::ParseCommandLineOptions(
       argc, argv,
@@ -39,6 +39,12 @@ class Loader {
   /// Function containing the model.
   Function *F_{nullptr};
 
+  /// Measure the latency and the throughput of the inference with the inputs
+  /// \p tensors for the variables \p variables, on the threads requested on
+  /// the command line, and report the results.
+  void runBenchmark(llvm::ArrayRef<Variable *> variables,
+                    llvm::ArrayRef<Tensor *> tensors);
+
 public:
   /// Getter for the Function.
   Function *getFunction() { return F_; }
@@ -56,7 +62,9 @@ public:
   void compile();
 
   /// Runs inference, unless emit bundle mode is enabled. If inference is run
-  /// then it will \return true, else false.
+  /// then it will \return true, else false. In the benchmark mode, the
+  /// inference is measured first with execution contexts of its own, and then
+  /// runs once more to produce the results of the model as usual.
   void runInference(llvm::ArrayRef<Variable *> variables,
                     llvm::ArrayRef<Tensor *> tensors);
 